@@ -10,6 +10,127 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// calc_stream_open
+SEXP calc_stream_open(double jd_start, double jd_end, double step, Rcpp::IntegerVector ipl, int iflag, int chunk_size, bool ut, bool background);
+RcppExport SEXP _swephR_calc_stream_open(SEXP jd_startSEXP, SEXP jd_endSEXP, SEXP stepSEXP, SEXP iplSEXP, SEXP iflagSEXP, SEXP chunk_sizeSEXP, SEXP utSEXP, SEXP backgroundSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type jd_start(jd_startSEXP);
+    Rcpp::traits::input_parameter< double >::type jd_end(jd_endSEXP);
+    Rcpp::traits::input_parameter< double >::type step(stepSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< int >::type iflag(iflagSEXP);
+    Rcpp::traits::input_parameter< int >::type chunk_size(chunk_sizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type ut(utSEXP);
+    Rcpp::traits::input_parameter< bool >::type background(backgroundSEXP);
+    rcpp_result_gen = Rcpp::wrap(calc_stream_open(jd_start, jd_end, step, ipl, iflag, chunk_size, ut, background));
+    return rcpp_result_gen;
+END_RCPP
+}
+// calc_stream_next
+SEXP calc_stream_next(SEXP stream);
+RcppExport SEXP _swephR_calc_stream_next(SEXP streamSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    rcpp_result_gen = Rcpp::wrap(calc_stream_next(stream));
+    return rcpp_result_gen;
+END_RCPP
+}
+// calc_stream_write
+double calc_stream_write(SEXP stream, std::string file, bool single, bool delta);
+RcppExport SEXP _swephR_calc_stream_write(SEXP streamSEXP, SEXP fileSEXP, SEXP singleSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type single(singleSEXP);
+    Rcpp::traits::input_parameter< bool >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(calc_stream_write(stream, file, single, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// calc_stream_read
+Rcpp::List calc_stream_read(std::string file);
+RcppExport SEXP _swephR_calc_stream_read(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(calc_stream_read(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fast_table_create
+Rcpp::List fast_table_create(std::string file, double jd_start, double jd_end, Rcpp::IntegerVector ipl, int iflag, double tolerance, double speed_tolerance);
+RcppExport SEXP _swephR_fast_table_create(SEXP fileSEXP, SEXP jd_startSEXP, SEXP jd_endSEXP, SEXP iplSEXP, SEXP iflagSEXP, SEXP toleranceSEXP, SEXP speed_toleranceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< double >::type jd_start(jd_startSEXP);
+    Rcpp::traits::input_parameter< double >::type jd_end(jd_endSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< int >::type iflag(iflagSEXP);
+    Rcpp::traits::input_parameter< double >::type tolerance(toleranceSEXP);
+    Rcpp::traits::input_parameter< double >::type speed_tolerance(speed_toleranceSEXP);
+    rcpp_result_gen = Rcpp::wrap(fast_table_create(file, jd_start, jd_end, ipl, iflag, tolerance, speed_tolerance));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fast_table_load
+SEXP fast_table_load(std::string file);
+RcppExport SEXP _swephR_fast_table_load(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(fast_table_load(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fast_calc
+Rcpp::List fast_calc(SEXP table, Rcpp::NumericVector jd_et, Rcpp::IntegerVector ipl);
+RcppExport SEXP _swephR_fast_calc(SEXP tableSEXP, SEXP jd_etSEXP, SEXP iplSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_et(jd_etSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    rcpp_result_gen = Rcpp::wrap(fast_calc(table, jd_et, ipl));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fast_calc_ut
+Rcpp::List fast_calc_ut(SEXP table, Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl);
+RcppExport SEXP _swephR_fast_calc_ut(SEXP tableSEXP, SEXP jd_utSEXP, SEXP iplSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    rcpp_result_gen = Rcpp::wrap(fast_calc_ut(table, jd_ut, ipl));
+    return rcpp_result_gen;
+END_RCPP
+}
+// calc_ut_lazy
+Rcpp::List calc_ut_lazy(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, int iflag);
+RcppExport SEXP _swephR_calc_ut_lazy(SEXP jd_utSEXP, SEXP iplSEXP, SEXP iflagSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< int >::type iflag(iflagSEXP);
+    rcpp_result_gen = Rcpp::wrap(calc_ut_lazy(jd_ut, ipl, iflag));
+    return rcpp_result_gen;
+END_RCPP
+}
 // set_ephe_path
 void set_ephe_path(Rcpp::Nullable<Rcpp::CharacterVector> path);
 RcppExport SEXP _swephR_set_ephe_path(SEXP pathSEXP) {
@@ -39,6 +160,67 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// prefetch
+Rcpp::List prefetch(double jd_start, double jd_end, Rcpp::IntegerVector ipl, int ephe_flag);
+RcppExport SEXP _swephR_prefetch(SEXP jd_startSEXP, SEXP jd_endSEXP, SEXP iplSEXP, SEXP ephe_flagSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type jd_start(jd_startSEXP);
+    Rcpp::traits::input_parameter< double >::type jd_end(jd_endSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< int >::type ephe_flag(ephe_flagSEXP);
+    rcpp_result_gen = Rcpp::wrap(prefetch(jd_start, jd_end, ipl, ephe_flag));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_ephe_buffer
+int set_ephe_buffer(std::string fname, Rcpp::Nullable<Rcpp::RawVector> data);
+RcppExport SEXP _swephR_set_ephe_buffer(SEXP fnameSEXP, SEXP dataSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type fname(fnameSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::RawVector> >::type data(dataSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_ephe_buffer(fname, data));
+    return rcpp_result_gen;
+END_RCPP
+}
+// create_ephe_bundle
+Rcpp::List create_ephe_bundle(std::string path, Rcpp::CharacterVector files);
+RcppExport SEXP _swephR_create_ephe_bundle(SEXP pathSEXP, SEXP filesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type files(filesSEXP);
+    rcpp_result_gen = Rcpp::wrap(create_ephe_bundle(path, files));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_ephe_bundle
+Rcpp::List set_ephe_bundle(Rcpp::Nullable<Rcpp::CharacterVector> path);
+RcppExport SEXP _swephR_set_ephe_bundle(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_ephe_bundle(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_segment_cache
+Rcpp::List set_segment_cache(Rcpp::Nullable<Rcpp::CharacterVector> path, double bytes);
+RcppExport SEXP _swephR_set_segment_cache(SEXP pathSEXP, SEXP bytesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< double >::type bytes(bytesSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_segment_cache(path, bytes));
+    return rcpp_result_gen;
+END_RCPP
+}
 // version
 std::string version();
 RcppExport SEXP _swephR_version() {
@@ -347,38 +529,40 @@ BEGIN_RCPP
 END_RCPP
 }
 // pheno_ut
-Rcpp::List pheno_ut(double jd_ut, int ipl, int ephe_flag);
-RcppExport SEXP _swephR_pheno_ut(SEXP jd_utSEXP, SEXP iplSEXP, SEXP ephe_flagSEXP) {
+Rcpp::List pheno_ut(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, int ephe_flag, int nthreads);
+RcppExport SEXP _swephR_pheno_ut(SEXP jd_utSEXP, SEXP iplSEXP, SEXP ephe_flagSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
-    Rcpp::traits::input_parameter< int >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
     Rcpp::traits::input_parameter< int >::type ephe_flag(ephe_flagSEXP);
-    rcpp_result_gen = Rcpp::wrap(pheno_ut(jd_ut, ipl, ephe_flag));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(pheno_ut(jd_ut, ipl, ephe_flag, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // pheno
-Rcpp::List pheno(double jd_et, int ipl, int ephe_flag);
-RcppExport SEXP _swephR_pheno(SEXP jd_etSEXP, SEXP iplSEXP, SEXP ephe_flagSEXP) {
+Rcpp::List pheno(Rcpp::NumericVector jd_et, Rcpp::IntegerVector ipl, int ephe_flag, int nthreads);
+RcppExport SEXP _swephR_pheno(SEXP jd_etSEXP, SEXP iplSEXP, SEXP ephe_flagSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_et(jd_etSEXP);
-    Rcpp::traits::input_parameter< int >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_et(jd_etSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
     Rcpp::traits::input_parameter< int >::type ephe_flag(ephe_flagSEXP);
-    rcpp_result_gen = Rcpp::wrap(pheno(jd_et, ipl, ephe_flag));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(pheno(jd_et, ipl, ephe_flag, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // azalt
-Rcpp::List azalt(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, double atpress, double attemp, Rcpp::NumericVector xin);
+Rcpp::List azalt(Rcpp::NumericVector jd_ut, int coord_flag, Rcpp::NumericVector geopos, double atpress, double attemp, Rcpp::NumericVector xin);
 RcppExport SEXP _swephR_azalt(SEXP jd_utSEXP, SEXP coord_flagSEXP, SEXP geoposSEXP, SEXP atpressSEXP, SEXP attempSEXP, SEXP xinSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
     Rcpp::traits::input_parameter< int >::type coord_flag(coord_flagSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type geopos(geoposSEXP);
     Rcpp::traits::input_parameter< double >::type atpress(atpressSEXP);
@@ -389,12 +573,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // azalt_rev
-Rcpp::List azalt_rev(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, Rcpp::NumericVector xin);
+Rcpp::List azalt_rev(Rcpp::NumericVector jd_ut, int coord_flag, Rcpp::NumericVector geopos, Rcpp::NumericVector xin);
 RcppExport SEXP _swephR_azalt_rev(SEXP jd_utSEXP, SEXP coord_flagSEXP, SEXP geoposSEXP, SEXP xinSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
     Rcpp::traits::input_parameter< int >::type coord_flag(coord_flagSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type geopos(geoposSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type xin(xinSEXP);
@@ -403,12 +587,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // refrac
-double refrac(double InAlt, double atpress, double attemp, int calc_flag);
+Rcpp::NumericVector refrac(Rcpp::NumericVector InAlt, double atpress, double attemp, int calc_flag);
 RcppExport SEXP _swephR_refrac(SEXP InAltSEXP, SEXP atpressSEXP, SEXP attempSEXP, SEXP calc_flagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type InAlt(InAltSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type InAlt(InAltSEXP);
     Rcpp::traits::input_parameter< double >::type atpress(atpressSEXP);
     Rcpp::traits::input_parameter< double >::type attemp(attempSEXP);
     Rcpp::traits::input_parameter< int >::type calc_flag(calc_flagSEXP);
@@ -417,12 +601,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // refrac_extended
-Rcpp::List refrac_extended(double InAlt, double height, double atpress, double attemp, double lapse_rate, int calc_flag);
+Rcpp::List refrac_extended(Rcpp::NumericVector InAlt, double height, double atpress, double attemp, double lapse_rate, int calc_flag);
 RcppExport SEXP _swephR_refrac_extended(SEXP InAltSEXP, SEXP heightSEXP, SEXP atpressSEXP, SEXP attempSEXP, SEXP lapse_rateSEXP, SEXP calc_flagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type InAlt(InAltSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type InAlt(InAltSEXP);
     Rcpp::traits::input_parameter< double >::type height(heightSEXP);
     Rcpp::traits::input_parameter< double >::type atpress(atpressSEXP);
     Rcpp::traits::input_parameter< double >::type attemp(attempSEXP);
@@ -432,6 +616,16 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_lapse_rate
+void set_lapse_rate(double lapse_rate);
+RcppExport SEXP _swephR_set_lapse_rate(SEXP lapse_rateSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type lapse_rate(lapse_rateSEXP);
+    set_lapse_rate(lapse_rate);
+    return R_NilValue;
+END_RCPP
+}
 // heliacal_ut
 Rcpp::List heliacal_ut(double jd_utstart, Rcpp::NumericVector dgeo, Rcpp::NumericVector datm, Rcpp::NumericVector dobs, std::string objectname, int event_type, int helflag);
 RcppExport SEXP _swephR_heliacal_ut(SEXP jd_utstartSEXP, SEXP dgeoSEXP, SEXP datmSEXP, SEXP dobsSEXP, SEXP objectnameSEXP, SEXP event_typeSEXP, SEXP helflagSEXP) {
@@ -524,15 +718,15 @@ BEGIN_RCPP
 END_RCPP
 }
 // julday
-double julday(int year, int month, int day, double hourd, int gregflag);
+Rcpp::NumericVector julday(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day, Rcpp::NumericVector hourd, int gregflag);
 RcppExport SEXP _swephR_julday(SEXP yearSEXP, SEXP monthSEXP, SEXP daySEXP, SEXP hourdSEXP, SEXP gregflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type year(yearSEXP);
-    Rcpp::traits::input_parameter< int >::type month(monthSEXP);
-    Rcpp::traits::input_parameter< int >::type day(daySEXP);
-    Rcpp::traits::input_parameter< double >::type hourd(hourdSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type year(yearSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type month(monthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type day(daySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type hourd(hourdSEXP);
     Rcpp::traits::input_parameter< int >::type gregflag(gregflagSEXP);
     rcpp_result_gen = Rcpp::wrap(julday(year, month, day, hourd, gregflag));
     return rcpp_result_gen;
@@ -554,75 +748,110 @@ BEGIN_RCPP
 END_RCPP
 }
 // revjul
-Rcpp::List revjul(double jd, int gregflag);
+Rcpp::List revjul(Rcpp::NumericVector jd, int gregflag);
 RcppExport SEXP _swephR_revjul(SEXP jdSEXP, SEXP gregflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd(jdSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd(jdSEXP);
     Rcpp::traits::input_parameter< int >::type gregflag(gregflagSEXP);
     rcpp_result_gen = Rcpp::wrap(revjul(jd, gregflag));
     return rcpp_result_gen;
 END_RCPP
 }
 // utc_time_zone
-Rcpp::List utc_time_zone(int year, int month, int day, int houri, int min, double sec, double d_timezone);
+Rcpp::List utc_time_zone(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day, Rcpp::IntegerVector houri, Rcpp::IntegerVector min, Rcpp::NumericVector sec, Rcpp::NumericVector d_timezone);
 RcppExport SEXP _swephR_utc_time_zone(SEXP yearSEXP, SEXP monthSEXP, SEXP daySEXP, SEXP houriSEXP, SEXP minSEXP, SEXP secSEXP, SEXP d_timezoneSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type year(yearSEXP);
-    Rcpp::traits::input_parameter< int >::type month(monthSEXP);
-    Rcpp::traits::input_parameter< int >::type day(daySEXP);
-    Rcpp::traits::input_parameter< int >::type houri(houriSEXP);
-    Rcpp::traits::input_parameter< int >::type min(minSEXP);
-    Rcpp::traits::input_parameter< double >::type sec(secSEXP);
-    Rcpp::traits::input_parameter< double >::type d_timezone(d_timezoneSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type year(yearSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type month(monthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type day(daySEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type houri(houriSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type min(minSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type sec(secSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type d_timezone(d_timezoneSEXP);
     rcpp_result_gen = Rcpp::wrap(utc_time_zone(year, month, day, houri, min, sec, d_timezone));
     return rcpp_result_gen;
 END_RCPP
 }
 // utc_to_jd
-Rcpp::List utc_to_jd(int year, int month, int day, int houri, int min, double sec, int gregflag);
+Rcpp::List utc_to_jd(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day, Rcpp::IntegerVector houri, Rcpp::IntegerVector min, Rcpp::NumericVector sec, int gregflag);
 RcppExport SEXP _swephR_utc_to_jd(SEXP yearSEXP, SEXP monthSEXP, SEXP daySEXP, SEXP houriSEXP, SEXP minSEXP, SEXP secSEXP, SEXP gregflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type year(yearSEXP);
-    Rcpp::traits::input_parameter< int >::type month(monthSEXP);
-    Rcpp::traits::input_parameter< int >::type day(daySEXP);
-    Rcpp::traits::input_parameter< int >::type houri(houriSEXP);
-    Rcpp::traits::input_parameter< int >::type min(minSEXP);
-    Rcpp::traits::input_parameter< double >::type sec(secSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type year(yearSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type month(monthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type day(daySEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type houri(houriSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type min(minSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type sec(secSEXP);
     Rcpp::traits::input_parameter< int >::type gregflag(gregflagSEXP);
     rcpp_result_gen = Rcpp::wrap(utc_to_jd(year, month, day, houri, min, sec, gregflag));
     return rcpp_result_gen;
 END_RCPP
 }
 // jdet_to_utc
-Rcpp::List jdet_to_utc(double jd_et, int gregflag);
+Rcpp::List jdet_to_utc(Rcpp::NumericVector jd_et, int gregflag);
 RcppExport SEXP _swephR_jdet_to_utc(SEXP jd_etSEXP, SEXP gregflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_et(jd_etSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_et(jd_etSEXP);
     Rcpp::traits::input_parameter< int >::type gregflag(gregflagSEXP);
     rcpp_result_gen = Rcpp::wrap(jdet_to_utc(jd_et, gregflag));
     return rcpp_result_gen;
 END_RCPP
 }
 // jdut1_to_utc
-Rcpp::List jdut1_to_utc(double jd_ut, int gregflag);
+Rcpp::List jdut1_to_utc(Rcpp::NumericVector jd_ut, int gregflag);
 RcppExport SEXP _swephR_jdut1_to_utc(SEXP jd_utSEXP, SEXP gregflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
     Rcpp::traits::input_parameter< int >::type gregflag(gregflagSEXP);
     rcpp_result_gen = Rcpp::wrap(jdut1_to_utc(jd_ut, gregflag));
     return rcpp_result_gen;
 END_RCPP
 }
+// time_to_jd
+Rcpp::List time_to_jd(SEXP time);
+RcppExport SEXP _swephR_time_to_jd(SEXP timeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type time(timeSEXP);
+    rcpp_result_gen = Rcpp::wrap(time_to_jd(time));
+    return rcpp_result_gen;
+END_RCPP
+}
+// jdet_to_time
+SEXP jdet_to_time(Rcpp::NumericVector jd_et, bool date);
+RcppExport SEXP _swephR_jdet_to_time(SEXP jd_etSEXP, SEXP dateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_et(jd_etSEXP);
+    Rcpp::traits::input_parameter< bool >::type date(dateSEXP);
+    rcpp_result_gen = Rcpp::wrap(jdet_to_time(jd_et, date));
+    return rcpp_result_gen;
+END_RCPP
+}
+// jdut1_to_time
+SEXP jdut1_to_time(Rcpp::NumericVector jd_ut, bool date);
+RcppExport SEXP _swephR_jdut1_to_time(SEXP jd_utSEXP, SEXP dateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< bool >::type date(dateSEXP);
+    rcpp_result_gen = Rcpp::wrap(jdut1_to_time(jd_ut, date));
+    return rcpp_result_gen;
+END_RCPP
+}
 // time_equ
 Rcpp::List time_equ(double jd_ut);
 RcppExport SEXP _swephR_time_equ(SEXP jd_utSEXP) {
@@ -747,24 +976,24 @@ BEGIN_RCPP
 END_RCPP
 }
 // get_ayanamsa_ex_ut
-Rcpp::List get_ayanamsa_ex_ut(double jd_ut, int iflag);
+Rcpp::List get_ayanamsa_ex_ut(Rcpp::NumericVector jd_ut, int iflag);
 RcppExport SEXP _swephR_get_ayanamsa_ex_ut(SEXP jd_utSEXP, SEXP iflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
     Rcpp::traits::input_parameter< int >::type iflag(iflagSEXP);
     rcpp_result_gen = Rcpp::wrap(get_ayanamsa_ex_ut(jd_ut, iflag));
     return rcpp_result_gen;
 END_RCPP
 }
 // get_ayanamsa_ex
-Rcpp::List get_ayanamsa_ex(double jd_et, int iflag);
+Rcpp::List get_ayanamsa_ex(Rcpp::NumericVector jd_et, int iflag);
 RcppExport SEXP _swephR_get_ayanamsa_ex(SEXP jd_etSEXP, SEXP iflagSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_et(jd_etSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_et(jd_etSEXP);
     Rcpp::traits::input_parameter< int >::type iflag(iflagSEXP);
     rcpp_result_gen = Rcpp::wrap(get_ayanamsa_ex(jd_et, iflag));
     return rcpp_result_gen;
@@ -799,6 +1028,21 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// houses_multi
+Rcpp::List houses_multi(Rcpp::NumericVector jd_ut, int cuspflag, Rcpp::NumericVector geolat, Rcpp::NumericVector geolon, Rcpp::CharacterVector hsys);
+RcppExport SEXP _swephR_houses_multi(SEXP jd_utSEXP, SEXP cuspflagSEXP, SEXP geolatSEXP, SEXP geolonSEXP, SEXP hsysSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< int >::type cuspflag(cuspflagSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type geolat(geolatSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type geolon(geolonSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type hsys(hsysSEXP);
+    rcpp_result_gen = Rcpp::wrap(houses_multi(jd_ut, cuspflag, geolat, geolon, hsys));
+    return rcpp_result_gen;
+END_RCPP
+}
 // house_name
 std::string house_name(char hsys);
 RcppExport SEXP _swephR_house_name(SEXP hsysSEXP) {
@@ -826,30 +1070,31 @@ BEGIN_RCPP
 END_RCPP
 }
 // gauquelin_sector
-Rcpp::List gauquelin_sector(double jd_ut, int ipl, std::string starname, int ephe_flag, int imeth, Rcpp::NumericVector geopos, double atpress, double attemp);
-RcppExport SEXP _swephR_gauquelin_sector(SEXP jd_utSEXP, SEXP iplSEXP, SEXP starnameSEXP, SEXP ephe_flagSEXP, SEXP imethSEXP, SEXP geoposSEXP, SEXP atpressSEXP, SEXP attempSEXP) {
+Rcpp::List gauquelin_sector(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, std::string starname, int ephe_flag, int imeth, Rcpp::NumericVector geopos, double atpress, double attemp, int nthreads);
+RcppExport SEXP _swephR_gauquelin_sector(SEXP jd_utSEXP, SEXP iplSEXP, SEXP starnameSEXP, SEXP ephe_flagSEXP, SEXP imethSEXP, SEXP geoposSEXP, SEXP atpressSEXP, SEXP attempSEXP, SEXP nthreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
-    Rcpp::traits::input_parameter< int >::type ipl(iplSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ipl(iplSEXP);
     Rcpp::traits::input_parameter< std::string >::type starname(starnameSEXP);
     Rcpp::traits::input_parameter< int >::type ephe_flag(ephe_flagSEXP);
     Rcpp::traits::input_parameter< int >::type imeth(imethSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type geopos(geoposSEXP);
     Rcpp::traits::input_parameter< double >::type atpress(atpressSEXP);
     Rcpp::traits::input_parameter< double >::type attemp(attempSEXP);
-    rcpp_result_gen = Rcpp::wrap(gauquelin_sector(jd_ut, ipl, starname, ephe_flag, imeth, geopos, atpress, attemp));
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(gauquelin_sector(jd_ut, ipl, starname, ephe_flag, imeth, geopos, atpress, attemp, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
 // sidtime
-double sidtime(double jd_ut);
+Rcpp::NumericVector sidtime(Rcpp::NumericVector jd_ut);
 RcppExport SEXP _swephR_sidtime(SEXP jd_utSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< double >::type jd_ut(jd_utSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type jd_ut(jd_utSEXP);
     rcpp_result_gen = Rcpp::wrap(sidtime(jd_ut));
     return rcpp_result_gen;
 END_RCPP
@@ -865,11 +1110,38 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_interpolate_nut
+void set_interpolate_nut(bool do_interpolate);
+RcppExport SEXP _swephR_set_interpolate_nut(SEXP do_interpolateSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type do_interpolate(do_interpolateSEXP);
+    set_interpolate_nut(do_interpolate);
+    return R_NilValue;
+END_RCPP
+}
+
+void calc_stream_init(DllInfo* dll);
+void lazy_calc_init(DllInfo* dll);
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_swephR_calc_stream_open", (DL_FUNC) &_swephR_calc_stream_open, 8},
+    {"_swephR_calc_stream_next", (DL_FUNC) &_swephR_calc_stream_next, 1},
+    {"_swephR_calc_stream_write", (DL_FUNC) &_swephR_calc_stream_write, 4},
+    {"_swephR_calc_stream_read", (DL_FUNC) &_swephR_calc_stream_read, 1},
+    {"_swephR_fast_table_create", (DL_FUNC) &_swephR_fast_table_create, 7},
+    {"_swephR_fast_table_load", (DL_FUNC) &_swephR_fast_table_load, 1},
+    {"_swephR_fast_calc", (DL_FUNC) &_swephR_fast_calc, 3},
+    {"_swephR_fast_calc_ut", (DL_FUNC) &_swephR_fast_calc_ut, 3},
+    {"_swephR_calc_ut_lazy", (DL_FUNC) &_swephR_calc_ut_lazy, 3},
     {"_swephR_set_ephe_path", (DL_FUNC) &_swephR_set_ephe_path, 1},
     {"_swephR_close", (DL_FUNC) &_swephR_close, 0},
     {"_swephR_set_jpl_file", (DL_FUNC) &_swephR_set_jpl_file, 1},
+    {"_swephR_prefetch", (DL_FUNC) &_swephR_prefetch, 4},
+    {"_swephR_set_ephe_buffer", (DL_FUNC) &_swephR_set_ephe_buffer, 2},
+    {"_swephR_create_ephe_bundle", (DL_FUNC) &_swephR_create_ephe_bundle, 2},
+    {"_swephR_set_ephe_bundle", (DL_FUNC) &_swephR_set_ephe_bundle, 1},
+    {"_swephR_set_segment_cache", (DL_FUNC) &_swephR_set_segment_cache, 2},
     {"_swephR_version", (DL_FUNC) &_swephR_version, 0},
     {"_swephR_get_library_path", (DL_FUNC) &_swephR_get_library_path, 0},
     {"_swephR_calc_ut", (DL_FUNC) &_swephR_calc_ut, 3},
@@ -893,12 +1165,13 @@ static const R_CallMethodDef CallEntries[] = {
     {"_swephR_lun_eclipse_how", (DL_FUNC) &_swephR_lun_eclipse_how, 3},
     {"_swephR_lun_eclipse_when", (DL_FUNC) &_swephR_lun_eclipse_when, 4},
     {"_swephR_rise_trans_true_hor", (DL_FUNC) &_swephR_rise_trans_true_hor, 9},
-    {"_swephR_pheno_ut", (DL_FUNC) &_swephR_pheno_ut, 3},
-    {"_swephR_pheno", (DL_FUNC) &_swephR_pheno, 3},
+    {"_swephR_pheno_ut", (DL_FUNC) &_swephR_pheno_ut, 4},
+    {"_swephR_pheno", (DL_FUNC) &_swephR_pheno, 4},
     {"_swephR_azalt", (DL_FUNC) &_swephR_azalt, 6},
     {"_swephR_azalt_rev", (DL_FUNC) &_swephR_azalt_rev, 4},
     {"_swephR_refrac", (DL_FUNC) &_swephR_refrac, 4},
     {"_swephR_refrac_extended", (DL_FUNC) &_swephR_refrac_extended, 6},
+    {"_swephR_set_lapse_rate", (DL_FUNC) &_swephR_set_lapse_rate, 1},
     {"_swephR_heliacal_ut", (DL_FUNC) &_swephR_heliacal_ut, 7},
     {"_swephR_vis_limit_mag", (DL_FUNC) &_swephR_vis_limit_mag, 6},
     {"_swephR_heliacal_pheno_ut", (DL_FUNC) &_swephR_heliacal_pheno_ut, 7},
@@ -911,6 +1184,9 @@ static const R_CallMethodDef CallEntries[] = {
     {"_swephR_utc_to_jd", (DL_FUNC) &_swephR_utc_to_jd, 7},
     {"_swephR_jdet_to_utc", (DL_FUNC) &_swephR_jdet_to_utc, 2},
     {"_swephR_jdut1_to_utc", (DL_FUNC) &_swephR_jdut1_to_utc, 2},
+    {"_swephR_time_to_jd", (DL_FUNC) &_swephR_time_to_jd, 1},
+    {"_swephR_jdet_to_time", (DL_FUNC) &_swephR_jdet_to_time, 2},
+    {"_swephR_jdut1_to_time", (DL_FUNC) &_swephR_jdut1_to_time, 2},
     {"_swephR_time_equ", (DL_FUNC) &_swephR_time_equ, 1},
     {"_swephR_lmt_to_lat", (DL_FUNC) &_swephR_lmt_to_lat, 2},
     {"_swephR_lat_to_lmt", (DL_FUNC) &_swephR_lat_to_lmt, 2},
@@ -926,15 +1202,19 @@ static const R_CallMethodDef CallEntries[] = {
     {"_swephR_get_ayanamsa_ex", (DL_FUNC) &_swephR_get_ayanamsa_ex, 2},
     {"_swephR_houses_ex", (DL_FUNC) &_swephR_houses_ex, 5},
     {"_swephR_houses_armc", (DL_FUNC) &_swephR_houses_armc, 4},
+    {"_swephR_houses_multi", (DL_FUNC) &_swephR_houses_multi, 5},
     {"_swephR_house_name", (DL_FUNC) &_swephR_house_name, 1},
     {"_swephR_house_pos", (DL_FUNC) &_swephR_house_pos, 5},
-    {"_swephR_gauquelin_sector", (DL_FUNC) &_swephR_gauquelin_sector, 8},
+    {"_swephR_gauquelin_sector", (DL_FUNC) &_swephR_gauquelin_sector, 9},
     {"_swephR_sidtime", (DL_FUNC) &_swephR_sidtime, 1},
     {"_swephR_day_of_week", (DL_FUNC) &_swephR_day_of_week, 1},
+    {"_swephR_set_interpolate_nut", (DL_FUNC) &_swephR_set_interpolate_nut, 1},
     {NULL, NULL, 0}
 };
 
 RcppExport void R_init_swephR(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    calc_stream_init(dll);
+    lazy_calc_init(dll);
 }
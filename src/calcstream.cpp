@@ -0,0 +1,644 @@
+// Copyright 2026 Ralf Stubner and Victor Reijs
+//
+// This file is part of swephR.
+//
+// swephR is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// swephR is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with swephR.  If not, see <http://www.gnu.org/licenses/>.
+
+// Position streams: the positions of a set of bodies on a uniform grid of
+// dates, delivered in chunks of dates, so that a long time series never
+// has to be held in memory at once.
+//
+// A chunk is computed as calc() and calc_ut() compute a batch (blocks of
+// swe_calc_prefetch(), uniform grid), row by row for each date and body.
+// Files, segments and tables of the library stay loaded from one chunk to
+// the next. With 'background', the chunks are computed by a thread of the
+// stream, which has the ephemeris settings in effect when the stream was
+// opened, one chunk ahead of the one R is working with. The chunk buffers
+// of that thread are plain C++ vectors; R objects are only created in
+// calc_stream_next().
+//
+// calc_stream_write() writes the rest of a stream chunk by chunk into a
+// column file, one column per coordinate, mapped into memory and filled in
+// place. Layout (native byte order, checked through 'endian' on load):
+//
+//   header   magic[8] uint32 endian uint32 ncol uint64 nrow int32 iflag
+//            int32 unused
+//   ncol x   char name[32] uint8 type uint8 encoding uint8 unused[6]
+//            uint64 offset double origin uint64 unused
+//   data     nrow values per column, each column at a multiple of 8 bytes
+//
+// Types are double, float and int32. With delta encoding, value i is the
+// difference to the value reconstructed from origin and the differences
+// before it, so that rounding to float does not accumulate. The magic is
+// written last, files of interrupted writes are removed. calc_stream_read()
+// maps a file and returns double and int32 columns without encoding as
+// ALTREP vectors that point into the mapping.
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Rversion.h>
+#if R_VERSION < R_Version(3, 6, 0)
+// before R 3.6 the header uses 'class' as a parameter name and does not
+// declare its functions with C linkage
+#define class klass
+extern "C" {
+#endif
+#include <R_ext/Altrep.h>
+#if R_VERSION < R_Version(3, 6, 0)
+}
+#undef class
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <swephexp.h>
+
+namespace {
+
+// dates per block of swe_calc_prefetch(), as in calc() and calc_ut()
+const size_t prefetch_block = 1024;
+
+struct stream_chunk {
+  std::vector<double> jd;
+  std::vector<int> ipl;
+  std::vector<int> rc;
+  std::vector<double> xx;    // 6 values per row
+  std::vector<std::string> serr;
+};
+
+struct calc_stream {
+  double jd_start;
+  double step;
+  long ndates;
+  std::vector<int32> ipl;
+  int32 iflag;
+  bool ut;
+  long chunk_size;
+  long next_date = 0;        // first date of the next chunk for R
+  // background computation
+  void *thread = nullptr;
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool stop = false;
+  long ahead_date = -1;      // first date the thread is asked to compute
+  bool ahead_ready = false;
+  stream_chunk ahead;
+
+  ~calc_stream() {
+    if (thread != nullptr) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+      }
+      cv.notify_all();
+      swe_thread_join(thread);
+    }
+  }
+};
+
+// Computes the dates first .. first + chunk_size - 1 of the stream into c.
+// Uses only the library and C++ containers, so that it can run in the
+// thread of the stream.
+void compute_chunk(const calc_stream &s, long first, stream_chunk &c) {
+  long nd = std::min(s.chunk_size, s.ndates - first);
+  size_t nb = s.ipl.size();
+  size_t nrow = static_cast<size_t>(nd) * nb;
+  c.jd.resize(nrow);
+  c.ipl.resize(nrow);
+  c.rc.resize(nrow);
+  c.xx.assign(nrow * 6, 0.0);
+  c.serr.assign(nrow, std::string());
+
+  int32 eflag = s.iflag;
+  if ((eflag & (SEFLG_JPLEPH | SEFLG_SWIEPH | SEFLG_MOSEPH)) == 0)
+    eflag |= SEFLG_SWIEPH;
+  std::vector<double> jd(nd), tt(nd);
+  for (long i = 0; i < nd; ++i) {
+    jd[i] = s.jd_start + (first + i) * s.step;
+    tt[i] = s.ut ? jd[i] + swe_deltat_ex(jd[i], eflag, NULL) : jd[i];
+  }
+  double step = 0;
+  if (nd >= 3) {
+    step = tt[1] - tt[0];
+    for (long i = 2; i < nd; ++i)
+      if (std::fabs(tt[i] - tt[i - 1] - step) > 1e-7)
+        step = 0;
+  }
+  swe_set_uniform_grid(step);
+  std::vector<double> tjd;
+  std::vector<int32> ipl;
+  for (size_t b = 0; b < nrow; b += prefetch_block) {
+    size_t last = std::min(nrow, b + prefetch_block);
+    tjd.clear();
+    ipl.clear();
+    for (size_t r = b; r < last; ++r) {
+      tjd.push_back(tt[r / nb]);
+      ipl.push_back(s.ipl[r % nb]);
+    }
+    swe_calc_prefetch(tjd.data(), ipl.data(), tjd.size(), s.iflag);
+    for (size_t r = b; r < last; ++r) {
+      std::array<char, 256> serr{{'\0'}};
+      c.jd[r] = jd[r / nb];
+      c.ipl[r] = s.ipl[r % nb];
+      if (s.ut)
+        c.rc[r] = swe_calc_ut(c.jd[r], c.ipl[r], s.iflag, &c.xx[r * 6], serr.begin());
+      else
+        c.rc[r] = swe_calc(c.jd[r], c.ipl[r], s.iflag, &c.xx[r * 6], serr.begin());
+      if (serr[0] != '\0')
+        c.serr[r] = std::string(serr.begin());
+    }
+  }
+  swe_calc_prefetch(NULL, NULL, 0, s.iflag);
+  swe_set_uniform_grid(0);
+}
+
+// body of the thread of a stream: computes the chunk asked for, then waits
+void stream_thread(void *arg) {
+  calc_stream *s = static_cast<calc_stream *>(arg);
+  std::unique_lock<std::mutex> lock(s->mtx);
+  for (;;) {
+    s->cv.wait(lock, [s] { return s->stop || (s->ahead_date >= 0 && !s->ahead_ready); });
+    if (s->stop)
+      break;
+    long first = s->ahead_date;
+    lock.unlock();
+    compute_chunk(*s, first, s->ahead);
+    lock.lock();
+    s->ahead_ready = true;
+    s->cv.notify_all();
+  }
+}
+
+// Takes the next chunk of the stream into c, from the thread of the stream
+// or computed here. Returns false after the last chunk.
+bool next_chunk(calc_stream &s, stream_chunk &c) {
+  if (s.next_date >= s.ndates)
+    return false;
+  if (s.thread != nullptr) {
+    std::unique_lock<std::mutex> lock(s.mtx);
+    s.cv.wait(lock, [&s] { return s.ahead_ready; });
+    std::swap(c, s.ahead);
+    s.ahead_ready = false;
+    long ahead = s.next_date + s.chunk_size;
+    s.ahead_date = ahead < s.ndates ? ahead : -1;
+    lock.unlock();
+    s.cv.notify_all();
+  } else {
+    compute_chunk(s, s.next_date, c);
+  }
+  s.next_date += s.chunk_size;
+  return true;
+}
+
+Rcpp::XPtr<calc_stream> stream_pointer(SEXP stream) {
+  Rcpp::XPtr<calc_stream> ptr(stream);
+  if (ptr.get() == nullptr)
+    Rcpp::stop("Position stream is no longer valid, please open it again!");
+  return ptr;
+}
+
+const char column_magic[8] = {'S', 'W', 'E', 'C', 'O', 'L', 'S', '\0'};
+const uint32_t column_endian = 0x01020304;
+
+enum column_type : uint8_t { col_double = 1, col_float = 2, col_int32 = 3 };
+enum column_encoding : uint8_t { enc_plain = 0, enc_delta = 1 };
+
+struct column_header {
+  char magic[8];
+  uint32_t endian;
+  uint32_t ncol;
+  uint64_t nrow;
+  int32_t iflag;
+  int32_t unused;
+};
+
+struct column_entry {
+  char name[32];
+  uint8_t type;
+  uint8_t encoding;
+  uint8_t unused1[6];
+  uint64_t offset;
+  double origin;
+  uint64_t unused2;
+};
+
+static_assert(sizeof(column_header) == 32, "unexpected padding in column_header");
+static_assert(sizeof(column_entry) == 64, "unexpected padding in column_entry");
+
+size_t type_size(uint8_t type) {
+  return type == col_double ? sizeof(double) : sizeof(float);
+}
+
+// a column while it is written
+struct out_column {
+  std::string name;
+  uint8_t type;
+  uint8_t encoding;
+  uint64_t offset;
+  double origin;
+  double last;               // delta: value reconstructed so far
+};
+
+// Puts n values x[0], x[stride], ... of column col into dst, as T.
+template <typename T>
+void put_values(T *dst, const double *x, size_t stride, size_t n, out_column &col, bool first) {
+  if (col.encoding == enc_plain) {
+    for (size_t i = 0; i < n; ++i)
+      dst[i] = static_cast<T>(x[i * stride]);
+    return;
+  }
+  if (first)
+    col.origin = col.last = x[0];
+  for (size_t i = 0; i < n; ++i) {
+    T d = static_cast<T>(x[i * stride] - col.last);
+    col.last += d;
+    dst[i] = d;
+  }
+}
+
+// Output file of calc_stream_write(): mapped and filled in place, or
+// written with stdio where it cannot be mapped. The file is removed
+// unless finish() succeeds.
+class column_writer {
+public:
+  column_writer(const std::string &file, uint64_t size) : file(file), size(size) {}
+  ~column_writer() {
+    close();
+    if (!done)
+      std::remove(file.c_str());
+  }
+
+  bool open() {
+#ifndef _WIN32
+    fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+      return false;
+    if (ftruncate(fd, size) == 0) {
+      void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (p != MAP_FAILED) {
+        base = static_cast<char *>(p);
+        return true;
+      }
+    }
+    ::close(fd);
+    fd = -1;
+#endif
+    fp = std::fopen(file.c_str(), "wb");
+    return fp != nullptr;
+  }
+
+  // memory for the bytes at offset, to be handed to put() when filled
+  char *area(uint64_t offset, size_t bytes) {
+    if (base != nullptr)
+      return base + offset;
+    scratch.resize(bytes);
+    return scratch.data();
+  }
+
+  bool put(uint64_t offset, size_t bytes) {
+    if (base != nullptr)
+      return true;
+#ifdef _WIN32
+    if (_fseeki64(fp, offset, SEEK_SET) != 0)
+#else
+    if (fseeko(fp, offset, SEEK_SET) != 0)
+#endif
+      return false;
+    return std::fwrite(scratch.data(), 1, bytes, fp) == bytes;
+  }
+
+  bool finish() {
+    done = close();
+    return done;
+  }
+
+private:
+  bool close() {
+    bool ok = true;
+#ifndef _WIN32
+    if (base != nullptr)
+      ok = munmap(base, size) == 0 && ok;
+    if (fd >= 0)
+      ok = ::close(fd) == 0 && ok;
+    fd = -1;
+#endif
+    base = nullptr;
+    if (fp != nullptr)
+      ok = std::fclose(fp) == 0 && ok;
+    fp = nullptr;
+    return ok;
+  }
+
+  std::string file;
+  uint64_t size;
+  int fd = -1;
+  char *base = nullptr;
+  std::FILE *fp = nullptr;
+  std::vector<char> scratch;
+  bool done = false;
+};
+
+// A column file in memory: mapped copy-on-write, or read where it cannot
+// be mapped. Owned by the columns that point into it.
+struct column_map {
+  char *base = nullptr;
+  size_t len = 0;
+  bool mapped = false;
+  std::vector<char> data;
+
+  ~column_map() {
+#ifndef _WIN32
+    if (mapped)
+      munmap(base, len);
+#endif
+  }
+};
+
+column_map *map_columns(const std::string &file) {
+  std::unique_ptr<column_map> m(new column_map);
+#ifndef _WIN32
+  int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        m->base = static_cast<char *>(p);
+        m->len = st.st_size;
+        m->mapped = true;
+      }
+    }
+    ::close(fd);
+    if (m->mapped)
+      return m.release();
+  }
+#endif
+  std::ifstream in(file, std::ios::binary | std::ios::ate);
+  if (!in)
+    Rcpp::stop("Cannot open '" + file + "' for reading.");
+  std::streamoff size = in.tellg();
+  if (size < 0)
+    Rcpp::stop("Error while reading '" + file + "'.");
+  m->data.resize(static_cast<size_t>(size));
+  in.seekg(0);
+  in.read(m->data.data(), m->data.size());
+  if (!in)
+    Rcpp::stop("Error while reading '" + file + "'.");
+  m->base = m->data.data();
+  m->len = m->data.size();
+  return m.release();
+}
+
+// ALTREP classes of double and int32 columns that point into a column_map;
+// data1 is the external pointer to the map, data2 holds offset and length.
+R_altrep_class_t mapped_real;
+R_altrep_class_t mapped_integer;
+
+R_xlen_t mapped_length(SEXP x) {
+  return static_cast<R_xlen_t>(REAL(R_altrep_data2(x))[1]);
+}
+
+void *mapped_dataptr(SEXP x, Rboolean) {
+  column_map *m = static_cast<column_map *>(R_ExternalPtrAddr(R_altrep_data1(x)));
+  return m->base + static_cast<size_t>(REAL(R_altrep_data2(x))[0]);
+}
+
+const void *mapped_dataptr_or_null(SEXP x) {
+  return mapped_dataptr(x, FALSE);
+}
+
+} // namespace
+
+// Open a position stream
+// internal function that is called in CalcStream.R
+// [[Rcpp::export]]
+SEXP calc_stream_open(double jd_start, double jd_end, double step, Rcpp::IntegerVector ipl,
+                      int iflag, int chunk_size, bool ut, bool background) {
+  if (!(step > 0.0))
+    Rcpp::stop("'step' must be positive!");
+  if (!(jd_end >= jd_start))
+    Rcpp::stop("'jd_end' must not be smaller than 'jd_start'!");
+  if (ipl.length() == 0)
+    Rcpp::stop("At least one body is needed in 'ipl'!");
+  if (chunk_size < 1)
+    Rcpp::stop("'chunk_size' must be positive!");
+
+  calc_stream *s = new calc_stream();
+  s->jd_start = jd_start;
+  s->step = step;
+  s->ndates = static_cast<long>(std::floor((jd_end - jd_start) / step + 1e-9)) + 1;
+  s->ipl.assign(ipl.begin(), ipl.end());
+  s->iflag = iflag;
+  s->ut = ut;
+  s->chunk_size = chunk_size;
+  Rcpp::XPtr<calc_stream> ptr(s, true);
+  if (background) {
+    s->ahead_date = 0;
+    s->thread = swe_thread_start(stream_thread, s);
+    if (s->thread == nullptr)
+      s->ahead_date = -1;
+  }
+  ptr.attr("class") = "swe_calc_stream";
+  return ptr;
+}
+
+// Next chunk of a position stream, NULL after the last one
+// internal function that is called in CalcStream.R
+// [[Rcpp::export]]
+SEXP calc_stream_next(SEXP stream) {
+  Rcpp::XPtr<calc_stream> s = stream_pointer(stream);
+  stream_chunk c;
+  if (!next_chunk(*s, c))
+    return R_NilValue;
+
+  R_xlen_t nrow = c.jd.size();
+  Rcpp::NumericVector jd_(c.jd.begin(), c.jd.end());
+  Rcpp::IntegerVector ipl_(c.ipl.begin(), c.ipl.end());
+  Rcpp::IntegerVector rc_(c.rc.begin(), c.rc.end());
+  Rcpp::NumericMatrix xx_(nrow, 6);
+  Rcpp::CharacterVector serr_(nrow);
+  for (R_xlen_t i = 0; i < nrow; ++i) {
+    for (int j = 0; j < 6; ++j)
+      xx_(i, j) = c.xx[i * 6 + j];
+    serr_(i) = c.serr[i];
+  }
+  return Rcpp::List::create(Rcpp::Named("jd") = jd_,
+                            Rcpp::Named("ipl") = ipl_,
+                            Rcpp::Named("return") = rc_,
+                            Rcpp::Named("xx") = xx_,
+                            Rcpp::Named("serr") = serr_);
+}
+
+// Write the rest of a position stream to a column file
+// internal function that is called in CalcStream.R
+// [[Rcpp::export]]
+double calc_stream_write(SEXP stream, std::string file, bool single, bool delta) {
+  Rcpp::XPtr<calc_stream> s = stream_pointer(stream);
+  size_t nb = s->ipl.size();
+  uint64_t nrow = std::max(0L, s->ndates - s->next_date);
+  uint8_t xx_type = single ? col_float : col_double;
+  uint8_t xx_encoding = delta ? enc_delta : enc_plain;
+  std::vector<out_column> cols;
+  cols.push_back({"jd", col_double, enc_plain, 0, 0.0, 0.0});
+  for (int32 ipl : s->ipl) {
+    std::string body = "ipl" + std::to_string(ipl);
+    for (int k = 1; k <= 6; ++k)
+      cols.push_back({body + ".xx" + std::to_string(k), xx_type, xx_encoding, 0, 0.0, 0.0});
+    cols.push_back({body + ".return", col_int32, enc_plain, 0, 0.0, 0.0});
+  }
+  uint64_t size = sizeof(column_header) + cols.size() * sizeof(column_entry);
+  for (out_column &col : cols) {
+    col.offset = (size + 7) & ~static_cast<uint64_t>(7);
+    size = col.offset + nrow * type_size(col.type);
+  }
+
+  column_writer out(file, size);
+  if (!out.open())
+    Rcpp::stop("Cannot open '" + file + "' for writing.");
+  stream_chunk c;
+  uint64_t row = 0;
+  while (next_chunk(*s, c)) {
+    size_t nd = c.jd.size() / nb;
+    for (size_t j = 0; j < cols.size(); ++j) {
+      out_column &col = cols[j];
+      size_t bytes = nd * type_size(col.type);
+      uint64_t at = col.offset + row * type_size(col.type);
+      char *dst = out.area(at, bytes);
+      // column 0 is jd, then 6 coordinates and the return flag per body
+      size_t b = (j + 6) / 7 - 1, k = (j + 6) % 7;
+      if (j == 0) {
+        put_values(reinterpret_cast<double *>(dst), c.jd.data(), nb, nd, col, row == 0);
+      } else if (k == 6) {
+        int32_t *rc = reinterpret_cast<int32_t *>(dst);
+        for (size_t i = 0; i < nd; ++i)
+          rc[i] = c.rc[i * nb + b];
+      } else if (col.type == col_float) {
+        put_values(reinterpret_cast<float *>(dst), &c.xx[b * 6 + k], nb * 6, nd, col, row == 0);
+      } else {
+        put_values(reinterpret_cast<double *>(dst), &c.xx[b * 6 + k], nb * 6, nd, col, row == 0);
+      }
+      if (!out.put(at, bytes))
+        Rcpp::stop("Error while writing '" + file + "'.");
+    }
+    row += nd;
+    Rcpp::checkUserInterrupt();
+  }
+
+  size_t schema = cols.size() * sizeof(column_entry);
+  column_entry *entry = reinterpret_cast<column_entry *>(out.area(sizeof(column_header), schema));
+  std::memset(entry, 0, schema);
+  for (size_t j = 0; j < cols.size(); ++j) {
+    std::strncpy(entry[j].name, cols[j].name.c_str(), sizeof(entry[j].name) - 1);
+    entry[j].type = cols[j].type;
+    entry[j].encoding = cols[j].encoding;
+    entry[j].offset = cols[j].offset;
+    entry[j].origin = cols[j].origin;
+  }
+  if (!out.put(sizeof(column_header), schema))
+    Rcpp::stop("Error while writing '" + file + "'.");
+  column_header *head = reinterpret_cast<column_header *>(out.area(0, sizeof(column_header)));
+  std::memset(head, 0, sizeof(column_header));
+  head->endian = column_endian;
+  head->ncol = cols.size();
+  head->nrow = row;
+  head->iflag = s->iflag;
+  std::memcpy(head->magic, column_magic, sizeof(column_magic));
+  if (!out.put(0, sizeof(column_header)) || !out.finish())
+    Rcpp::stop("Error while writing '" + file + "'.");
+  return static_cast<double>(row);
+}
+
+// Read a column file
+// internal function that is called in CalcStream.R
+// [[Rcpp::export]]
+Rcpp::List calc_stream_read(std::string file) {
+  Rcpp::XPtr<column_map> map(map_columns(file), true);
+  const char *base = map->base;
+  size_t len = map->len;
+  column_header head;
+  if (len < sizeof(head))
+    Rcpp::stop("'" + file + "' is not a position column file.");
+  std::memcpy(&head, base, sizeof(head));
+  if (std::memcmp(head.magic, column_magic, sizeof(column_magic)) != 0)
+    Rcpp::stop("'" + file + "' is not a position column file.");
+  if (head.endian != column_endian)
+    Rcpp::stop("Position column file was written on a machine with different byte order.");
+  if (head.ncol > (len - sizeof(head)) / sizeof(column_entry))
+    Rcpp::stop("Position column file is corrupt.");
+
+  R_xlen_t nrow = static_cast<R_xlen_t>(head.nrow);
+  R_xlen_t ncol = head.ncol;
+  Rcpp::List cols(ncol);
+  Rcpp::CharacterVector names(ncol);
+  for (uint32_t j = 0; j < head.ncol; ++j) {
+    column_entry e;
+    std::memcpy(&e, base + sizeof(head) + j * sizeof(e), sizeof(e));
+    bool valid = e.type >= col_double && e.type <= col_int32 &&
+      (e.encoding == enc_plain || (e.encoding == enc_delta && e.type != col_int32)) &&
+      e.offset % 8 == 0 && e.offset <= len &&
+      head.nrow <= (len - e.offset) / type_size(e.type) &&
+      std::memchr(e.name, '\0', sizeof(e.name)) != nullptr;
+    if (!valid)
+      Rcpp::stop("Position column file is corrupt.");
+    names[j] = std::string(e.name);
+    const char *p = base + e.offset;
+    if (e.encoding == enc_plain && e.type != col_float) {
+      Rcpp::NumericVector info = {static_cast<double>(e.offset), static_cast<double>(head.nrow)};
+      cols[j] = R_new_altrep(e.type == col_double ? mapped_real : mapped_integer, map, info);
+      continue;
+    }
+    Rcpp::NumericVector x(nrow);
+    double r = e.origin;
+    for (R_xlen_t i = 0; i < nrow; ++i) {
+      double v = e.type == col_float ? reinterpret_cast<const float *>(p)[i]
+                                     : reinterpret_cast<const double *>(p)[i];
+      if (e.encoding == enc_delta) {
+        r += v;
+        v = r;
+      }
+      x[i] = v;
+    }
+    cols[j] = x;
+  }
+  cols.attr("names") = names;
+  cols.attr("iflag") = head.iflag;
+  return cols;
+}
+
+// Registers the ALTREP classes of mapped columns
+// [[Rcpp::init]]
+void calc_stream_init(DllInfo *dll) {
+  mapped_real = R_make_altreal_class("swe_mapped_real", "swephR", dll);
+  R_set_altrep_Length_method(mapped_real, mapped_length);
+  R_set_altvec_Dataptr_method(mapped_real, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_real, mapped_dataptr_or_null);
+  mapped_integer = R_make_altinteger_class("swe_mapped_integer", "swephR", dll);
+  R_set_altrep_Length_method(mapped_integer, mapped_length);
+  R_set_altvec_Dataptr_method(mapped_integer, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_integer, mapped_dataptr_or_null);
+}
@@ -0,0 +1,493 @@
+// Copyright 2026 Ralf Stubner and Victor Reijs
+//
+// This file is part of swephR.
+//
+// swephR is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// swephR is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with swephR.  If not, see <http://www.gnu.org/licenses/>.
+
+// Fast ephemeris tables: apparent positions of a set of bodies for a fixed
+// iflag and date range, stored as piecewise Chebyshev polynomials.
+//
+// File layout (native byte order, checked through 'endian' on load):
+//
+//   header   magic[8] int32 version int32 endian int32 iflag int32 nbody
+//            double jd_start double jd_end double tolerance
+//            double speed_tolerance
+//   settings int32 topo int32 sid_mode double geolon double geolat
+//            double geoalt double sid_t0 double sid_ayan_t0
+//            char ephe_path[AS_MAXCH] char jpl_file[AS_MAXCH]
+//   nbody x  int32 ipl int32 retflag int32 ncoef int32 ncomp int32 nseg
+//            int32 unused double wrap
+//   data     for each body: nseg + 1 segment boundaries (double) followed
+//            by nseg x ncomp x ncoef coefficients (double)
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <swephexp.h>
+
+namespace {
+
+const char table_magic[8] = {'S', 'W', 'E', 'F', 'A', 'S', 'T', '\0'};
+const int32_t table_version = 2;
+const int32_t table_endian = 0x01020304;
+// Chebyshev coefficients per component and segment (degree 11)
+const int32_t table_ncoef = 12;
+// longest segment (day) and shortest one produced by bisection
+const double max_seglen = 32.0;
+const double min_seglen = 1.0 / 64.0;
+
+struct body_table {
+  int32_t ipl;
+  int32_t retflag;  // flag returned by swe_calc() while sampling
+  int32_t ncoef;
+  int32_t ncomp;    // 3 (positions) or 6 (positions and speeds)
+  int32_t nseg;
+  double wrap;      // period of the first coordinate, 0 if none
+  std::vector<double> start;  // segment boundaries, nseg + 1 values
+  std::vector<double> coef;
+};
+
+// settings of the library the positions depend on, besides iflag
+struct table_settings {
+  int32_t topo;     // swe_set_topo() was called
+  int32_t sid_mode;
+  double geolon, geolat, geoalt;
+  double sid_t0, sid_ayan_t0;
+  char ephe_path[AS_MAXCH];
+  char jpl_file[AS_MAXCH];
+};
+
+struct fast_table {
+  int32_t iflag;
+  double jd_start;
+  double jd_end;
+  double tolerance;
+  double speed_tolerance;
+  table_settings settings;
+  std::vector<body_table> bodies;
+};
+
+// largest errors of a fit, of the positions and of the speeds
+struct fit_error {
+  double pos = 0.0;
+  double speed = 0.0;
+};
+
+table_settings current_settings() {
+  table_settings st;
+  std::memset(&st, 0, sizeof(st));
+  st.topo = swe_get_topo(&st.geolon, &st.geolat, &st.geoalt);
+  st.sid_mode = swe_get_sid_mode(&st.sid_t0, &st.sid_ayan_t0);
+  swe_get_ephe_path(st.ephe_path);
+  swe_get_jpl_file(st.jpl_file);
+  return st;
+}
+
+// Stops if a setting that the positions of the table depend on differs
+// from the one in effect when the table was created.
+void check_settings(const fast_table &tab) {
+  const table_settings &t = tab.settings;
+  table_settings st = current_settings();
+  if ((tab.iflag & SEFLG_TOPOCTR) &&
+      (st.topo != t.topo || st.geolon != t.geolon || st.geolat != t.geolat ||
+       st.geoalt != t.geoalt))
+    Rcpp::stop("Fast ephemeris table was created for another topocentric position (swe_set_topo()).");
+  if ((tab.iflag & SEFLG_SIDEREAL) &&
+      (st.sid_mode != t.sid_mode || st.sid_t0 != t.sid_t0 ||
+       st.sid_ayan_t0 != t.sid_ayan_t0))
+    Rcpp::stop("Fast ephemeris table was created for another sidereal mode (swe_set_sid_mode()).");
+  if (!(tab.iflag & SEFLG_MOSEPH) && std::strcmp(st.ephe_path, t.ephe_path) != 0)
+    Rcpp::stop("Fast ephemeris table was created with another ephemeris path (swe_set_ephe_path()).");
+  if ((tab.iflag & SEFLG_JPLEPH) && std::strcmp(st.jpl_file, t.jpl_file) != 0)
+    Rcpp::stop("Fast ephemeris table was created with another JPL file (swe_set_jpl_file()).");
+}
+
+double coordinate_period(int iflag) {
+  if (iflag & SEFLG_XYZ)
+    return 0.0;
+  return (iflag & SEFLG_RADIANS) ? 2.0 * M_PI : 360.0;
+}
+
+// value of the Chebyshev series c[0..n-1] at x in [-1, 1] (Clenshaw)
+double chebyshev(const double *c, int n, double x) {
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  for (int j = n - 1; j >= 1; --j) {
+    b0 = 2.0 * x * b1 - b2 + c[j];
+    b2 = b1;
+    b1 = b0;
+  }
+  return x * b1 - b2 + c[0];
+}
+
+double unwrap(double x, double ref, double wrap) {
+  if (wrap > 0.0)
+    x -= wrap * std::floor((x - ref) / wrap + 0.5);
+  return x;
+}
+
+void sample(double jd_et, int ipl, int iflag, double *xx, int32_t *retflag) {
+  std::array<char, 256> serr{{'\0'}};
+  int32 rc = swe_calc(jd_et, ipl, iflag, xx, serr.begin());
+  if (rc < 0)
+    Rcpp::stop(std::string(serr.begin()));
+  *retflag = rc;
+}
+
+// Fit one segment [a, b], appending its coefficients to 'bt'. Returns the
+// largest deviations of the positions and of the speeds from swe_calc() at
+// the points half way between the Chebyshev nodes.
+fit_error fit_segment(body_table &bt, int iflag, double a, double b) {
+  const int n = bt.ncoef;
+  const int ncomp = bt.ncomp;
+  const double half = (b - a) / 2.0;
+  const double mid = (a + b) / 2.0;
+  std::vector<double> f(static_cast<size_t>(n) * ncomp);
+  std::array<double, 6> xx;
+  // nodes of the first kind, in order of increasing time
+  for (int k = 0; k < n; ++k) {
+    double x = -std::cos(M_PI * (k + 0.5) / n);
+    sample(mid + half * x, bt.ipl, iflag, xx.data(), &bt.retflag);
+    for (int c = 0; c < ncomp; ++c)
+      f[c * n + k] = xx[c];
+    if (k > 0)
+      f[k] = unwrap(f[k], f[k - 1], bt.wrap);
+  }
+  size_t offset = bt.coef.size();
+  bt.coef.resize(offset + static_cast<size_t>(ncomp) * n);
+  double *coef = &bt.coef[offset];
+  for (int c = 0; c < ncomp; ++c) {
+    for (int j = 0; j < n; ++j) {
+      double sum = 0.0;
+      for (int k = 0; k < n; ++k)
+        sum += f[c * n + k] * std::cos(M_PI * j * (n - k - 0.5) / n);
+      coef[c * n + j] = (j == 0 ? 1.0 : 2.0) * sum / n;
+    }
+  }
+  fit_error maxerr;
+  for (int k = 0; k < n - 1; ++k) {
+    double x = -0.5 * (std::cos(M_PI * (k + 0.5) / n) +
+                       std::cos(M_PI * (k + 1.5) / n));
+    sample(mid + half * x, bt.ipl, iflag, xx.data(), &bt.retflag);
+    for (int c = 0; c < ncomp; ++c) {
+      double v = chebyshev(&coef[c * n], n, x);
+      double d = (c == 0) ? unwrap(xx[0], v, bt.wrap) - v : xx[c] - v;
+      if (c < 3)
+        maxerr.pos = std::max(maxerr.pos, std::fabs(d));
+      else
+        maxerr.speed = std::max(maxerr.speed, std::fabs(d));
+    }
+  }
+  return maxerr;
+}
+
+// Cover [a, b] with segments, bisecting where a tolerance is not met.
+// Segments are only split down to 'min_seglen': close to a conjunction
+// with the Sun, light deflection makes the apparent positions of the
+// inner planets non-smooth and the error there is reported instead.
+fit_error fit_interval(body_table &bt, int iflag, double a, double b,
+                       const fast_table &tab) {
+  size_t offset = bt.coef.size();
+  fit_error err = fit_segment(bt, iflag, a, b);
+  if ((err.pos > tab.tolerance || err.speed > tab.speed_tolerance) &&
+      (b - a) / 2.0 >= min_seglen) {
+    bt.coef.resize(offset);
+    double m = (a + b) / 2.0;
+    err = fit_interval(bt, iflag, a, m, tab);
+    fit_error err2 = fit_interval(bt, iflag, m, b, tab);
+    err.pos = std::max(err.pos, err2.pos);
+    err.speed = std::max(err.speed, err2.speed);
+    return err;
+  }
+  bt.start.push_back(a);
+  return err;
+}
+
+void write_table(const fast_table &tab, const std::string &file) {
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  if (!out)
+    Rcpp::stop("Cannot open '" + file + "' for writing.");
+  int32_t nbody = tab.bodies.size();
+  out.write(table_magic, sizeof(table_magic));
+  out.write(reinterpret_cast<const char *>(&table_version), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&table_endian), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&tab.iflag), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&nbody), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&tab.jd_start), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&tab.jd_end), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&tab.tolerance), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&tab.speed_tolerance), sizeof(double));
+  const table_settings &st = tab.settings;
+  out.write(reinterpret_cast<const char *>(&st.topo), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&st.sid_mode), sizeof(int32_t));
+  out.write(reinterpret_cast<const char *>(&st.geolon), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&st.geolat), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&st.geoalt), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&st.sid_t0), sizeof(double));
+  out.write(reinterpret_cast<const char *>(&st.sid_ayan_t0), sizeof(double));
+  out.write(st.ephe_path, sizeof(st.ephe_path));
+  out.write(st.jpl_file, sizeof(st.jpl_file));
+  for (const body_table &bt : tab.bodies) {
+    int32_t head[6] = {bt.ipl, bt.retflag, bt.ncoef, bt.ncomp, bt.nseg, 0};
+    out.write(reinterpret_cast<const char *>(head), sizeof(head));
+    out.write(reinterpret_cast<const char *>(&bt.wrap), sizeof(double));
+  }
+  for (const body_table &bt : tab.bodies) {
+    out.write(reinterpret_cast<const char *>(bt.start.data()),
+              bt.start.size() * sizeof(double));
+    out.write(reinterpret_cast<const char *>(bt.coef.data()),
+              bt.coef.size() * sizeof(double));
+  }
+  if (!out)
+    Rcpp::stop("Error while writing '" + file + "'.");
+}
+
+template <typename T> void read_value(std::ifstream &in, T *x, size_t n = 1) {
+  in.read(reinterpret_cast<char *>(x), n * sizeof(T));
+  if (!in)
+    Rcpp::stop("Fast ephemeris table is truncated.");
+}
+
+fast_table *read_table(const std::string &file) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in)
+    Rcpp::stop("Cannot open '" + file + "' for reading.");
+  char magic[8];
+  int32_t version, endian, nbody;
+  read_value(in, magic, sizeof(magic));
+  if (std::memcmp(magic, table_magic, sizeof(magic)) != 0)
+    Rcpp::stop("'" + file + "' is not a fast ephemeris table.");
+  read_value(in, &version);
+  read_value(in, &endian);
+  if (endian != table_endian)
+    Rcpp::stop("Fast ephemeris table was written on a machine with different byte order.");
+  if (version != table_version)
+    Rcpp::stop("Unsupported fast ephemeris table version.");
+  std::unique_ptr<fast_table> tab(new fast_table);
+  read_value(in, &tab->iflag);
+  read_value(in, &nbody);
+  read_value(in, &tab->jd_start);
+  read_value(in, &tab->jd_end);
+  read_value(in, &tab->tolerance);
+  read_value(in, &tab->speed_tolerance);
+  table_settings &st = tab->settings;
+  read_value(in, &st.topo);
+  read_value(in, &st.sid_mode);
+  read_value(in, &st.geolon);
+  read_value(in, &st.geolat);
+  read_value(in, &st.geoalt);
+  read_value(in, &st.sid_t0);
+  read_value(in, &st.sid_ayan_t0);
+  read_value(in, st.ephe_path, sizeof(st.ephe_path));
+  read_value(in, st.jpl_file, sizeof(st.jpl_file));
+  st.ephe_path[sizeof(st.ephe_path) - 1] = '\0';
+  st.jpl_file[sizeof(st.jpl_file) - 1] = '\0';
+  if (nbody < 0)
+    Rcpp::stop("Fast ephemeris table is corrupt.");
+  tab->bodies.resize(nbody);
+  for (body_table &bt : tab->bodies) {
+    int32_t head[6];
+    read_value(in, head, 6);
+    bt.ipl = head[0];
+    bt.retflag = head[1];
+    bt.ncoef = head[2];
+    bt.ncomp = head[3];
+    bt.nseg = head[4];
+    read_value(in, &bt.wrap);
+    if (bt.ncoef < 1 || (bt.ncomp != 3 && bt.ncomp != 6) || bt.nseg < 1)
+      Rcpp::stop("Fast ephemeris table is corrupt.");
+  }
+  for (body_table &bt : tab->bodies) {
+    bt.start.resize(bt.nseg + 1);
+    read_value(in, bt.start.data(), bt.start.size());
+    bt.coef.resize(static_cast<size_t>(bt.nseg) * bt.ncomp * bt.ncoef);
+    read_value(in, bt.coef.data(), bt.coef.size());
+  }
+  return tab.release();
+}
+
+int32 table_eval(const fast_table &tab, double jd_et, int ipl, double *xx, char *serr) {
+  for (int c = 0; c < 6; ++c)
+    xx[c] = 0.0;
+  const body_table *bt = nullptr;
+  for (const body_table &b : tab.bodies)
+    if (b.ipl == ipl)
+      bt = &b;
+  if (bt == nullptr) {
+    snprintf(serr, AS_MAXCH, "body %d is not in the table.", ipl);
+    return ERR;
+  }
+  if (!(jd_et >= tab.jd_start && jd_et <= tab.jd_end)) {
+    snprintf(serr, AS_MAXCH, "jd %f outside table range %f .. %f.",
+             jd_et, tab.jd_start, tab.jd_end);
+    return ERR;
+  }
+  int s = std::upper_bound(bt->start.begin() + 1, bt->start.end() - 1, jd_et) -
+          (bt->start.begin() + 1);
+  double a = bt->start[s], b = bt->start[s + 1];
+  double x = (2.0 * jd_et - a - b) / (b - a);
+  const double *coef = &bt->coef[static_cast<size_t>(s) * bt->ncomp * bt->ncoef];
+  for (int c = 0; c < bt->ncomp; ++c)
+    xx[c] = chebyshev(&coef[c * bt->ncoef], bt->ncoef, x);
+  if (bt->wrap > 0.0) {
+    xx[0] = std::fmod(xx[0], bt->wrap);
+    if (xx[0] < 0.0)
+      xx[0] += bt->wrap;
+  }
+  return bt->retflag;
+}
+
+Rcpp::XPtr<fast_table> table_pointer(SEXP table) {
+  Rcpp::XPtr<fast_table> ptr(table);
+  if (ptr.get() == nullptr)
+    Rcpp::stop("Fast ephemeris table is no longer valid, please load it again!");
+  return ptr;
+}
+
+} // namespace
+
+// Create a fast ephemeris table
+// internal function that is called in FastTable.R
+// [[Rcpp::export]]
+Rcpp::List fast_table_create(std::string file, double jd_start, double jd_end,
+                             Rcpp::IntegerVector ipl, int iflag, double tolerance,
+                             double speed_tolerance) {
+  if (!(jd_end > jd_start))
+    Rcpp::stop("'jd_end' must be larger than 'jd_start'!");
+  if (!(tolerance > 0.0) || !(speed_tolerance > 0.0))
+    Rcpp::stop("'tolerance' and 'speed_tolerance' must be positive!");
+
+  fast_table tab;
+  tab.iflag = iflag;
+  tab.jd_start = jd_start;
+  tab.jd_end = jd_end;
+  tab.tolerance = tolerance;
+  tab.speed_tolerance = speed_tolerance;
+  tab.settings = current_settings();
+  Rcpp::IntegerVector nseg_(ipl.length());
+  Rcpp::NumericVector maxerr_(ipl.length());
+  Rcpp::NumericVector maxerr_speed_(ipl.length());
+  for (int i = 0; i < ipl.length(); ++i) {
+    body_table bt;
+    bt.ipl = ipl(i);
+    bt.ncoef = table_ncoef;
+    bt.ncomp = (iflag & SEFLG_SPEED) ? 6 : 3;
+    bt.wrap = coordinate_period(iflag);
+    int ncoarse = std::ceil((jd_end - jd_start) / max_seglen);
+    fit_error err;
+    for (int s = 0; s < ncoarse; ++s) {
+      double a = jd_start + (jd_end - jd_start) * s / ncoarse;
+      double b = jd_start + (jd_end - jd_start) * (s + 1) / ncoarse;
+      fit_error e = fit_interval(bt, iflag, a, b, tab);
+      err.pos = std::max(err.pos, e.pos);
+      err.speed = std::max(err.speed, e.speed);
+    }
+    bt.start.push_back(jd_end);
+    bt.nseg = bt.start.size() - 1;
+    if (err.pos > tolerance)
+      Rcpp::warning("Tolerance not reached for body " + std::to_string(bt.ipl) +
+                    ", largest error is " + std::to_string(err.pos) + ".");
+    if (err.speed > speed_tolerance)
+      Rcpp::warning("Speed tolerance not reached for body " + std::to_string(bt.ipl) +
+                    ", largest error is " + std::to_string(err.speed) + ".");
+    nseg_(i) = bt.nseg;
+    maxerr_(i) = err.pos;
+    maxerr_speed_(i) = err.speed;
+    tab.bodies.push_back(std::move(bt));
+  }
+  write_table(tab, file);
+
+  return Rcpp::List::create(Rcpp::Named("ipl") = ipl,
+                            Rcpp::Named("nseg") = nseg_,
+                            Rcpp::Named("maxerr") = maxerr_,
+                            Rcpp::Named("maxerr_speed") = maxerr_speed_);
+}
+
+// Load a fast ephemeris table
+// internal function that is called in FastTable.R
+// [[Rcpp::export]]
+SEXP fast_table_load(std::string file) {
+  Rcpp::XPtr<fast_table> ptr(read_table(file), true);
+  ptr.attr("class") = "swe_fast_table";
+  return ptr;
+}
+
+// Compute positions from a fast ephemeris table (ET)
+// internal function that is called in FastTable.R
+// [[Rcpp::export]]
+Rcpp::List fast_calc(SEXP table, Rcpp::NumericVector jd_et, Rcpp::IntegerVector ipl) {
+  if (jd_et.length() != ipl.length())
+    Rcpp::stop("The number of bodies in 'ipl' and the number of dates in 'jd_et' must be identical!");
+
+  Rcpp::XPtr<fast_table> tab = table_pointer(table);
+  check_settings(*tab);
+  Rcpp::IntegerVector rc_(ipl.length());
+  Rcpp::CharacterVector serr_(ipl.length());
+  Rcpp::NumericMatrix xx_(ipl.length(), 6);
+
+  for (int i = 0; i < ipl.length(); ++i) {
+    std::array<double, 6> xx{{0.0}};
+    std::array<char, 256> serr{{'\0'}};
+    rc_(i) = table_eval(*tab, jd_et[i], ipl(i), xx.begin(), serr.begin());
+    Rcpp::NumericVector tmp(xx.begin(), xx.end());
+    xx_(i, Rcpp::_) = tmp;
+    serr_(i) = std::string(serr.begin());
+  }
+  // remove dim attribute to return a vector
+  if (ipl.length() == 1)
+    xx_.attr("dim") = R_NilValue;
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("xx") = xx_,
+                            Rcpp::Named("serr") = serr_);
+}
+
+// Compute positions from a fast ephemeris table (UT)
+// internal function that is called in FastTable.R
+// [[Rcpp::export]]
+Rcpp::List fast_calc_ut(SEXP table, Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl) {
+  if (jd_ut.length() != ipl.length())
+    Rcpp::stop("The number of bodies in 'ipl' and the number of dates in 'jd_ut' must be identical!");
+
+  Rcpp::XPtr<fast_table> tab = table_pointer(table);
+  check_settings(*tab);
+  Rcpp::IntegerVector rc_(ipl.length());
+  Rcpp::CharacterVector serr_(ipl.length());
+  Rcpp::NumericMatrix xx_(ipl.length(), 6);
+
+  for (int i = 0; i < ipl.length(); ++i) {
+    std::array<double, 6> xx{{0.0}};
+    std::array<char, 256> serr{{'\0'}};
+    // same Delta T as swe_calc_ut() with the table's flags
+    double jd_et = jd_ut[i] + swe_deltat_ex(jd_ut[i], tab->iflag, serr.begin());
+    rc_(i) = table_eval(*tab, jd_et, ipl(i), xx.begin(), serr.begin());
+    Rcpp::NumericVector tmp(xx.begin(), xx.end());
+    xx_(i, Rcpp::_) = tmp;
+    serr_(i) = std::string(serr.begin());
+  }
+  // remove dim attribute to return a vector
+  if (ipl.length() == 1)
+    xx_.attr("dim") = R_NilValue;
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("xx") = xx_,
+                            Rcpp::Named("serr") = serr_);
+}
@@ -0,0 +1,342 @@
+// Copyright 2026 Ralf Stubner and Victor Reijs
+//
+// This file is part of swephR.
+//
+// swephR is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// swephR is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with swephR.  If not, see <http://www.gnu.org/licenses/>.
+
+// Lazy results of swe_calc_ut(): 'return', 'xx' and 'serr' are ALTREP
+// vectors over one lazy_calc, which computes the rows that are accessed in
+// blocks of block_rows rows, like calc_ut() computes a batch (uniform grid,
+// swe_calc_prefetch()). The last max_blocks blocks are cached. Elt and
+// Get_region are answered from the cache; anything that needs a data
+// pointer materialises the whole vector once, block by block, without
+// going through the cache. Blocks are computed with the ephemeris settings
+// of the call (swe_save_settings()), not those in effect at the access.
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Rversion.h>
+#if R_VERSION < R_Version(3, 6, 0)
+// before R 3.6 the header uses 'class' as a parameter name and does not
+// declare its functions with C linkage
+#define class klass
+extern "C" {
+#endif
+#include <R_ext/Altrep.h>
+#if R_VERSION < R_Version(3, 6, 0)
+}
+#undef class
+#endif
+#include <swephexp.h>
+
+namespace {
+
+// rows per block, as prefetch_block in calc_ut(), and blocks in the cache
+const size_t block_rows = 1024;
+const size_t max_blocks = 64;
+
+struct calc_block {
+  size_t index;
+  uint64_t used;
+  std::vector<int> rc;
+  std::vector<double> xx;    // 6 values per row
+  std::vector<std::string> serr;
+};
+
+struct lazy_calc {
+  std::vector<double> jd;
+  std::vector<int32> ipl;
+  int32 iflag;
+  void *settings = nullptr;  // from swe_save_settings() at the call
+  std::vector<calc_block> cache;
+  uint64_t clock = 0;
+
+  ~lazy_calc() { swe_free_settings(settings); }
+
+  size_t nrow() const { return jd.size(); }
+
+  // Computes rows index * block_rows ... of block index into blk.
+  void compute(size_t index, calc_block &blk) {
+    size_t first = index * block_rows;
+    size_t n = std::min(block_rows, nrow() - first);
+    blk.index = index;
+    blk.rc.assign(n, 0);
+    blk.xx.assign(n * 6, 0.0);
+    blk.serr.assign(n, std::string());
+
+    void *current = swe_save_settings();
+    swe_restore_settings(settings);
+    int32 eflag = iflag;
+    if ((eflag & (SEFLG_JPLEPH | SEFLG_SWIEPH | SEFLG_MOSEPH)) == 0)
+      eflag |= SEFLG_SWIEPH;
+    std::vector<double> tt(n);
+    for (size_t i = 0; i < n; ++i)
+      tt[i] = jd[first + i] + swe_deltat_ex(jd[first + i], eflag, NULL);
+    double step = 0;
+    if (n >= 3) {
+      step = tt[1] - tt[0];
+      for (size_t i = 2; i < n; ++i)
+        if (std::fabs(tt[i] - tt[i - 1] - step) > 1e-7)
+          step = 0;
+    }
+    swe_set_uniform_grid(step);
+    swe_calc_prefetch(tt.data(), &ipl[first], n, iflag);
+    for (size_t i = 0; i < n; ++i) {
+      std::array<char, 256> serr{{'\0'}};
+      blk.rc[i] = swe_calc_ut(jd[first + i], ipl[first + i], iflag, &blk.xx[i * 6], serr.begin());
+      if (serr[0] != '\0')
+        blk.serr[i] = std::string(serr.begin());
+    }
+    swe_calc_prefetch(NULL, NULL, 0, iflag);
+    swe_set_uniform_grid(0);
+    swe_restore_settings(current);
+    swe_free_settings(current);
+  }
+
+  // block of row i, from the cache or computed into the least recently
+  // used slot
+  const calc_block &block(size_t i) {
+    size_t index = i / block_rows;
+    calc_block *slot = nullptr;
+    for (calc_block &blk : cache) {
+      if (blk.index == index) {
+        blk.used = ++clock;
+        return blk;
+      }
+      if (slot == nullptr || blk.used < slot->used)
+        slot = &blk;
+    }
+    if (cache.size() < max_blocks) {
+      cache.emplace_back();
+      slot = &cache.back();
+    }
+    compute(index, *slot);
+    slot->used = ++clock;
+    return *slot;
+  }
+};
+
+// ALTREP classes of the columns; data1 is the external pointer to the
+// lazy_calc, data2 the materialised vector or NULL.
+R_altrep_class_t lazy_xx;
+R_altrep_class_t lazy_return;
+R_altrep_class_t lazy_serr;
+
+lazy_calc *calc_of(SEXP x) {
+  return static_cast<lazy_calc *>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+R_xlen_t xx_length(SEXP x) {
+  return 6 * calc_of(x)->nrow();
+}
+
+R_xlen_t row_length(SEXP x) {
+  return calc_of(x)->nrow();
+}
+
+// 'xx' is a column-major nrow x 6 matrix: element i is coordinate i / nrow
+// of row i % nrow
+double xx_elt(SEXP x, R_xlen_t i) {
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue)
+    return REAL(data)[i];
+  lazy_calc *c = calc_of(x);
+  size_t row = i % c->nrow();
+  return c->block(row).xx[(row % block_rows) * 6 + i / c->nrow()];
+}
+
+R_xlen_t xx_get_region(SEXP x, R_xlen_t start, R_xlen_t size, double *buf) {
+  lazy_calc *c = calc_of(x);
+  R_xlen_t n = std::min(size, xx_length(x) - start);
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) {
+    std::copy(REAL(data) + start, REAL(data) + start + n, buf);
+    return n;
+  }
+  for (R_xlen_t j = 0; j < n;) {
+    R_xlen_t i = start + j;
+    size_t row = i % c->nrow(), k = i / c->nrow();
+    const calc_block &blk = c->block(row);
+    size_t last = std::min(blk.index * block_rows + blk.rc.size(), row + (n - j));
+    for (; row < last; ++row, ++j)
+      buf[j] = blk.xx[(row % block_rows) * 6 + k];
+  }
+  return n;
+}
+
+void *xx_dataptr(SEXP x, Rboolean) {
+  SEXP data = R_altrep_data2(x);
+  if (data == R_NilValue) {
+    lazy_calc *c = calc_of(x);
+    size_t nrow = c->nrow();
+    data = PROTECT(Rf_allocVector(REALSXP, 6 * nrow));
+    double *xx = REAL(data);
+    calc_block blk;
+    for (size_t index = 0; index * block_rows < nrow; ++index) {
+      c->compute(index, blk);
+      for (size_t r = 0; r < blk.rc.size(); ++r)
+        for (size_t k = 0; k < 6; ++k)
+          xx[k * nrow + index * block_rows + r] = blk.xx[r * 6 + k];
+    }
+    R_set_altrep_data2(x, data);
+    UNPROTECT(1);
+  }
+  return REAL(data);
+}
+
+const void *xx_dataptr_or_null(SEXP x) {
+  SEXP data = R_altrep_data2(x);
+  return data == R_NilValue ? nullptr : REAL(data);
+}
+
+int return_elt(SEXP x, R_xlen_t i) {
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue)
+    return INTEGER(data)[i];
+  return calc_of(x)->block(i).rc[i % block_rows];
+}
+
+R_xlen_t return_get_region(SEXP x, R_xlen_t start, R_xlen_t size, int *buf) {
+  lazy_calc *c = calc_of(x);
+  R_xlen_t n = std::min(size, row_length(x) - start);
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) {
+    std::copy(INTEGER(data) + start, INTEGER(data) + start + n, buf);
+    return n;
+  }
+  for (R_xlen_t j = 0; j < n;) {
+    size_t row = start + j;
+    const calc_block &blk = c->block(row);
+    size_t last = std::min(blk.index * block_rows + blk.rc.size(), row + (n - j));
+    for (; row < last; ++row, ++j)
+      buf[j] = blk.rc[row % block_rows];
+  }
+  return n;
+}
+
+void *return_dataptr(SEXP x, Rboolean) {
+  SEXP data = R_altrep_data2(x);
+  if (data == R_NilValue) {
+    lazy_calc *c = calc_of(x);
+    data = PROTECT(Rf_allocVector(INTSXP, c->nrow()));
+    int *rc = INTEGER(data);
+    calc_block blk;
+    for (size_t index = 0; index * block_rows < c->nrow(); ++index) {
+      c->compute(index, blk);
+      std::copy(blk.rc.begin(), blk.rc.end(), rc + index * block_rows);
+    }
+    R_set_altrep_data2(x, data);
+    UNPROTECT(1);
+  }
+  return INTEGER(data);
+}
+
+const void *return_dataptr_or_null(SEXP x) {
+  SEXP data = R_altrep_data2(x);
+  return data == R_NilValue ? nullptr : INTEGER(data);
+}
+
+SEXP serr_elt(SEXP x, R_xlen_t i) {
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue)
+    return STRING_ELT(data, i);
+  return Rf_mkChar(calc_of(x)->block(i).serr[i % block_rows].c_str());
+}
+
+SEXP serr_materialize(SEXP x) {
+  SEXP data = R_altrep_data2(x);
+  if (data == R_NilValue) {
+    lazy_calc *c = calc_of(x);
+    data = PROTECT(Rf_allocVector(STRSXP, c->nrow()));
+    calc_block blk;
+    for (size_t index = 0; index * block_rows < c->nrow(); ++index) {
+      c->compute(index, blk);
+      for (size_t r = 0; r < blk.serr.size(); ++r)
+        SET_STRING_ELT(data, index * block_rows + r, Rf_mkChar(blk.serr[r].c_str()));
+    }
+    R_set_altrep_data2(x, data);
+    UNPROTECT(1);
+  }
+  return data;
+}
+
+void *serr_dataptr(SEXP x, Rboolean) {
+  return const_cast<void *>(static_cast<const void *>(STRING_PTR_RO(serr_materialize(x))));
+}
+
+const void *serr_dataptr_or_null(SEXP x) {
+  SEXP data = R_altrep_data2(x);
+  return data == R_NilValue ? nullptr : STRING_PTR_RO(data);
+}
+
+void serr_set_elt(SEXP x, R_xlen_t i, SEXP v) {
+  SET_STRING_ELT(serr_materialize(x), i, v);
+}
+
+} // namespace
+
+// Compute information of planet (UT) when it is accessed
+// internal function that is called in Section2.R
+// [[Rcpp::export]]
+Rcpp::List calc_ut_lazy(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, int iflag) {
+  if (jd_ut.length() != ipl.length())
+    Rcpp::stop("The number of bodies in 'ipl' and the number of dates in 'jd_ut' must be identical!");
+
+  lazy_calc *c = new lazy_calc();
+  c->jd.assign(jd_ut.begin(), jd_ut.end());
+  c->ipl.assign(ipl.begin(), ipl.end());
+  c->iflag = iflag;
+  c->settings = swe_save_settings();
+  Rcpp::XPtr<lazy_calc> ptr(c, true);
+  // RObject, since Rcpp vectors would ask for a data pointer
+  Rcpp::RObject rc_(R_new_altrep(lazy_return, ptr, R_NilValue));
+  Rcpp::RObject xx_(R_new_altrep(lazy_xx, ptr, R_NilValue));
+  Rcpp::RObject serr_(R_new_altrep(lazy_serr, ptr, R_NilValue));
+
+  // a matrix, except for one body and date as in calc_ut()
+  if (ipl.length() != 1)
+    xx_.attr("dim") = Rcpp::Dimension(ipl.length(), 6);
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("xx") = xx_,
+                            Rcpp::Named("serr") = serr_);
+}
+
+// Registers the ALTREP classes of lazy results
+// [[Rcpp::init]]
+void lazy_calc_init(DllInfo *dll) {
+  lazy_xx = R_make_altreal_class("swe_lazy_xx", "swephR", dll);
+  R_set_altrep_Length_method(lazy_xx, xx_length);
+  R_set_altvec_Dataptr_method(lazy_xx, xx_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_xx, xx_dataptr_or_null);
+  R_set_altreal_Elt_method(lazy_xx, xx_elt);
+  R_set_altreal_Get_region_method(lazy_xx, xx_get_region);
+  lazy_return = R_make_altinteger_class("swe_lazy_return", "swephR", dll);
+  R_set_altrep_Length_method(lazy_return, row_length);
+  R_set_altvec_Dataptr_method(lazy_return, return_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_return, return_dataptr_or_null);
+  R_set_altinteger_Elt_method(lazy_return, return_elt);
+  R_set_altinteger_Get_region_method(lazy_return, return_get_region);
+  lazy_serr = R_make_altstring_class("swe_lazy_serr", "swephR", dll);
+  R_set_altrep_Length_method(lazy_serr, row_length);
+  R_set_altvec_Dataptr_method(lazy_serr, serr_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_serr, serr_dataptr_or_null);
+  R_set_altstring_Elt_method(lazy_serr, serr_elt);
+  R_set_altstring_Set_elt_method(lazy_serr, serr_set_elt);
+}
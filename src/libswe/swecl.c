@@ -71,6 +71,7 @@ static int find_zero(double y00, double y11, double y2, double dx,
 			double *dxret, double *dxret2);
 static double calc_dip(double geoalt, double atpress, double attemp, double lapse_rate);
 static double calc_astronomical_refr(double geoalt,double atpress, double attemp);
+static double calc_refr_true_to_app(double inalt, double atpress, double attemp);
 static TLS double const_lapse_rate = SE_LAPSE_RATE;  /* for refraction */
 
 #if 0
@@ -103,6 +104,11 @@ static int32 calc_mer_trans(
                double *tret,
                char *serr); 
 static int32 calc_planet_star(double tjd_et, int32 ipl, char *starname, int32 iflag, double *x, char *serr);
+static int32 gauquelin_rise_set(double t_ut, int32 ipl, char *starname, int32 epheflag, int32 imeth, 
+               double *geopos, double atpress, double attemp, 
+               double *tret, AS_BOOL *above, AS_BOOL *found, char *serr);
+static int32 gauquelin_sector_from_rise_set(double t_ut, int32 ipl, double *tret, 
+               AS_BOOL above_horizon, AS_BOOL found, double *dgsect, char *serr);
 
 struct saros_data {int series_no; double tstart;};
 
@@ -2874,6 +2880,142 @@ void CALL_CONV swe_azalt_rev(
   }
 }
 
+/* Rotation of swe_azalt() as one matrix: from ecliptic (SE_ECL2HOR) or
+ * equatorial (SE_EQU2HOR) cartesian coordinates of date into the horizon
+ * system, with the x-axis pointing north and the y-axis east, i.e. the
+ * azimuth is 360 minus the polar longitude. The transposed matrix is the
+ * rotation of swe_azalt_rev().
+ */
+static void azalt_rotate_x(double m[3][3], double eps)
+{
+  int j;
+  double y, s = sin(eps * DEGTORAD), c = cos(eps * DEGTORAD);
+  for (j = 0; j < 3; j++) {
+    y = m[1][j];
+    m[1][j] = y * c + m[2][j] * s;
+    m[2][j] = -y * s + m[2][j] * c;
+  }
+}
+
+static void azalt_rotate_z(double m[3][3], double ang)
+{
+  int j;
+  double x, s = sin(ang * DEGTORAD), c = cos(ang * DEGTORAD);
+  for (j = 0; j < 3; j++) {
+    x = m[0][j];
+    m[0][j] = x * c + m[1][j] * s;
+    m[1][j] = -x * s + m[1][j] * c;
+  }
+}
+
+static void azalt_matrix(double tjd_ut, int32 calc_flag, double *geopos, double m[3][3])
+{
+  int i, j;
+  double x[6];
+  double armc = swe_degnorm(swe_sidtime(tjd_ut) * 15 + geopos[0]);
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 3; j++)
+      m[i][j] = (i == j);
+  /* SE_ECL2HOR == SE_HOR2ECL */
+  if (calc_flag == SE_ECL2HOR) {
+    swe_calc(tjd_ut + swe_deltat_ex(tjd_ut, -1, NULL), SE_ECL_NUT, 0, x, NULL);
+    azalt_rotate_x(m, -x[0]);
+  }
+  azalt_rotate_z(m, armc + 90);
+  azalt_rotate_x(m, 90 - geopos[1]);
+  azalt_rotate_z(m, -90);
+}
+
+/* 
+ * swe_azalt_array()
+ * swe_azalt() for n positions at the same date and place. Sidereal 
+ * time, obliquity and the rotation are computed once; the apparent
+ * altitudes are computed by swe_refrac_extended_array().
+ *
+ * input:
+ *   xin[2 * n]   input coordinates polar, in degrees, two per position
+ * output:
+ *   xaz[3 * n]   azimuth, true altitude and apparent altitude, three
+ *                per position
+ */
+void CALL_CONV swe_azalt_array(
+      double tjd_ut,
+      int32  calc_flag,
+      double *geopos,
+      double atpress,
+      double attemp,
+      int32  n,
+      double *xin, 
+      double *xaz) 
+{
+  int32 i;
+  double m[3][3], x[3], y[3], *alt;
+  if (n <= 0)
+    return;
+  azalt_matrix(tjd_ut, calc_flag, geopos, m);
+  if ((alt = (double *) malloc(n * sizeof(double))) == NULL) {
+    for (i = 0; i < n; i++)
+      swe_azalt(tjd_ut, calc_flag, geopos, atpress, attemp, xin + 2 * i, xaz + 3 * i);
+    return;
+  }
+  for (i = 0; i < n; i++) {
+    x[0] = xin[2 * i] * DEGTORAD;
+    x[1] = xin[2 * i + 1] * DEGTORAD;
+    x[2] = 1;
+    swi_polcart(x, x);
+    y[0] = m[0][0] * x[0] + m[0][1] * x[1] + m[0][2] * x[2];
+    y[1] = m[1][0] * x[0] + m[1][1] * x[1] + m[1][2] * x[2];
+    y[2] = m[2][0] * x[0] + m[2][1] * x[1] + m[2][2] * x[2];
+    swi_cartpol(y, y);
+    xaz[3 * i] = 360 - y[0] * RADTODEG;
+    xaz[3 * i + 1] = alt[i] = y[1] * RADTODEG;
+  }
+  if (atpress == 0) {
+    /* estimate atmospheric pressure */
+    atpress = 1013.25 * pow(1 - 0.0065 * geopos[2] / 288, 5.255);
+  } 
+  swe_refrac_extended_array(n, alt, geopos[2], atpress, attemp, const_lapse_rate, SE_TRUE_TO_APP, alt, NULL);
+  for (i = 0; i < n; i++)
+    xaz[3 * i + 2] = alt[i];
+  free(alt);
+}
+
+/* 
+ * swe_azalt_rev_array()
+ * swe_azalt_rev() for n positions at the same date and place.
+ *
+ * input:
+ *   xin[2 * n]   azimuth and true altitude, in degrees, two per position
+ * output:
+ *   xout[2 * n]  ecliptical or equatorial coordinates, two per position
+ */
+void CALL_CONV swe_azalt_rev_array(
+      double tjd_ut,
+      int32  calc_flag,
+      double *geopos,
+      int32  n,
+      double *xin, 
+      double *xout) 
+{
+  int32 i;
+  double m[3][3], x[3], y[3];
+  if (n <= 0)
+    return;
+  azalt_matrix(tjd_ut, calc_flag, geopos, m);
+  for (i = 0; i < n; i++) {
+    x[0] = (360 - xin[2 * i]) * DEGTORAD;
+    x[1] = xin[2 * i + 1] * DEGTORAD;
+    x[2] = 1;
+    swi_polcart(x, x);
+    y[0] = m[0][0] * x[0] + m[1][0] * x[1] + m[2][0] * x[2];
+    y[1] = m[0][1] * x[0] + m[1][1] * x[1] + m[2][1] * x[2];
+    y[2] = m[0][2] * x[0] + m[1][2] * x[1] + m[2][2] * x[2];
+    swi_cartpol(y, y);
+    xout[2 * i] = y[0] * RADTODEG;
+    xout[2 * i + 1] = y[1] * RADTODEG;
+  }
+}
+
 /* swe_refrac()
  * Transforms apparent to true altitude and vice-versa.
  * These formulae do not handle the case when the
@@ -2990,6 +3132,11 @@ void CALL_CONV swe_set_lapse_rate(double lapse_rate)
   const_lapse_rate = lapse_rate;
 }
 
+double swi_get_lapse_rate(void)
+{
+  return const_lapse_rate;
+}
+
 /* swe_refrac_extended()
  *
  * This function was created thanks to and with the help of the
@@ -3039,8 +3186,6 @@ double CALL_CONV swe_refrac_extended(double inalt, double geoalt, double atpress
   double refr;
   double trualt;
   double dip = calc_dip(geoalt, atpress, attemp, lapse_rate);
-  double D, D0, N, y, yy0;
-  int i;
   /* make sure that inalt <=90 */
   if( (inalt>90) )
     inalt=180-inalt;
@@ -3054,24 +3199,7 @@ double CALL_CONV swe_refrac_extended(double inalt, double geoalt, double atpress
       }
       return inalt;
     }
-    /* by iteration */
-    y = inalt;
-    D = 0.0;
-    yy0 = 0;
-    D0 = D;
-    for(i=0; i<5; i++) {
-      D = calc_astronomical_refr(y,atpress,attemp);
-      N = y - yy0;
-      yy0 = D - D0 - N; /* denominator of derivative */
-      if (N != 0.0 && yy0 != 0.0) /* sic !!! code by Moshier */
-        N = y - N*(inalt + D - y)/yy0; /* Newton iteration with numerically estimated derivative */
-      else /* Can't do it on first pass */
-        N = inalt + D;
-      yy0 = y;
-      D0 = D;
-      y = N;
-    }
-    refr = D;
+    refr = calc_refr_true_to_app(inalt, atpress, attemp);
     if (inalt + refr < dip) {
       if (dret != NULL) {
 	dret[0]=inalt;
@@ -3171,6 +3299,152 @@ static double calc_dip(double geoalt, double atpress, double attemp, double laps
 }
 
 
+/* refraction for a true altitude inalt, from the apparent altitude 
+ * found by iteration (by Moshier), as in swe_refrac_extended() */
+static double calc_refr_true_to_app(double inalt, double atpress, double attemp)
+{
+  double D, D0, N, y, yy0;
+  int i;
+  y = inalt;
+  D = 0.0;
+  yy0 = 0;
+  D0 = D;
+  for(i=0; i<5; i++) {
+    D = calc_astronomical_refr(y,atpress,attemp);
+    N = y - yy0;
+    yy0 = D - D0 - N; /* denominator of derivative */
+    if (N != 0.0 && yy0 != 0.0) /* sic !!! code by Moshier */
+      N = y - N*(inalt + D - y)/yy0; /* Newton iteration with numerically estimated derivative */
+    else /* Can't do it on first pass */
+      N = inalt + D;
+    yy0 = y;
+    D0 = D;
+    y = N;
+  }
+  return D;
+}
+
+/* Refraction as a function of the true altitude, for the conversion
+ * of many altitudes at the same pressure and temperature by 
+ * swe_refrac_extended_array(): tabulated every REFR_TAB_STEP degrees 
+ * from -10 to 90 degrees and interpolated by cubic polynomials. One 
+ * Newton step with the exact refraction at the interpolated apparent 
+ * altitude then solves y = inalt + refr(y) within 1e-8 degree (1e-10
+ * above the horizon). The five iterations of swe_refrac_extended() are
+ * less converged near and below the horizon, so both differ there by
+ * up to 1e-5 degree. The table is kept for further calls with the same
+ * pressure and temperature (e.g. successive frames of a planetarium)
+ * until swe_close(). Calls with fewer than REFR_TAB_MIN_N altitudes
+ * never use it, so that their results do not depend on earlier calls.
+ */
+#define REFR_TAB_STEP	0.1
+#define REFR_TAB_N	1004	/* nodes from -10 - REFR_TAB_STEP */
+#define REFR_TAB_MIN_N	256	/* fewer altitudes are iterated directly */
+static TLS struct refr_table {
+  int32 ok;
+  double atpress, attemp;
+  double d[REFR_TAB_N];
+} refr_table;
+
+static double refr_table_true_to_app(double inalt)
+{
+  struct refr_table *rt = &refr_table;
+  int32 i;
+  double p, h0 = -10 - REFR_TAB_STEP, *d;
+  double l0, l1, l2, l3, D, dD, y, g;
+  p = (inalt - h0) / REFR_TAB_STEP;
+  i = (int32) floor(p);
+  if (i < 1) i = 1;
+  if (i > REFR_TAB_N - 3) i = REFR_TAB_N - 3;
+  p -= i;
+  d = rt->d + i - 1;
+  /* cubic Lagrange through nodes i-1 .. i+2, and its derivative */
+  l0 = -p * (p - 1) * (p - 2) / 6;
+  l1 = (p + 1) * (p - 1) * (p - 2) / 2;
+  l2 = -(p + 1) * p * (p - 2) / 2;
+  l3 = (p + 1) * p * (p - 1) / 6;
+  D = l0 * d[0] + l1 * d[1] + l2 * d[2] + l3 * d[3];
+  dD = (-(3 * p * p - 6 * p + 2) / 6 * d[0] + (3 * p * p - 4 * p - 1) / 2 * d[1]
+       - (3 * p * p - 2 * p - 2) / 2 * d[2] + (3 * p * p - 1) / 6 * d[3]) / REFR_TAB_STEP;
+  /* Newton step for y = inalt + refr(y) */
+  y = inalt + D;
+  g = y - calc_astronomical_refr(y, rt->atpress, rt->attemp) - inalt;
+  y -= g * (1 + dD);
+  return y - inalt;
+}
+
+static int refr_table_build(double atpress, double attemp)
+{
+  struct refr_table *rt = &refr_table;
+  int32 i;
+  double h0 = -10 - REFR_TAB_STEP;
+  for (i = 0; i < REFR_TAB_N; i++)
+    rt->d[i] = calc_refr_true_to_app(h0 + i * REFR_TAB_STEP, atpress, attemp);
+  rt->atpress = atpress;
+  rt->attemp = attemp;
+  rt->ok = TRUE;
+  return OK;
+}
+
+void swi_refr_table_free(void)
+{
+  refr_table.ok = FALSE;
+}
+
+/* swe_refrac_extended_array()
+ * swe_refrac_extended() for n altitudes inalt[0..n-1] at the same
+ * place and atmospheric conditions. The altitudes are returned in 
+ * outalt[0..n-1] (outalt = inalt is allowed), and, if dret != NULL, 
+ * the four values of dret of swe_refrac_extended() for each altitude 
+ * in dret[4 * i .. 4 * i + 3].
+ */
+void CALL_CONV swe_refrac_extended_array(int32 n, double *inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *outalt, double *dret)
+{
+  int32 i;
+  int use_table = FALSE;
+  double alt, refr, ret, dip = calc_dip(geoalt, atpress, attemp, lapse_rate);
+  if (calc_flag == SE_TRUE_TO_APP && n >= REFR_TAB_MIN_N) {
+    use_table = (refr_table.ok && refr_table.atpress == atpress && refr_table.attemp == attemp);
+    if (!use_table)
+      use_table = (refr_table_build(atpress, attemp) == OK);
+  }
+  for (i = 0; i < n; i++) {
+    alt = inalt[i];
+    /* make sure that inalt <=90 */
+    if (alt > 90)
+      alt = 180 - alt;
+    if (calc_flag == SE_TRUE_TO_APP) {
+      if (alt < -10) 
+	refr = 0;
+      else if (use_table) 
+	refr = refr_table_true_to_app(alt);
+      else 
+	refr = calc_refr_true_to_app(alt, atpress, attemp);
+      if (alt + refr < dip) 
+	refr = 0;
+      ret = alt + refr;
+      if (dret != NULL) {
+	dret[4 * i] = alt;
+	dret[4 * i + 1] = ret;
+      }
+    } else {
+      refr = calc_astronomical_refr(alt, atpress, attemp);
+      ret = (alt >= dip) ? alt - refr : alt;
+      if (alt <= dip)
+	refr = 0;
+      if (dret != NULL) {
+	dret[4 * i] = alt - refr;
+	dret[4 * i + 1] = alt;
+      }
+    }
+    if (dret != NULL) {
+      dret[4 * i + 2] = refr;
+      dret[4 * i + 3] = dip;
+    }
+    outalt[i] = ret;
+  }
+}
+
 /* Computes attributes of a lunar eclipse for given tjd and geopos
  * 
  * retflag	SE_ECL_TOTAL or SE_ECL_PARTIAL
@@ -3790,7 +4064,70 @@ static const double mag_elem[NMAG_ELEM][4] = {
                 {5.33, 0.32, 0, 0},     /* Juno */
                 {3.20, 0.32, 0, 0},     /* Vesta */
                 };
+/* Sun of a date, shared by the bodies of swe_pheno_array() */
+struct pheno_sun {
+  int32 iflag;		/* flags of the calculation */
+  int32 retc;
+  double xx[6], lbr[6];	/* cartesian and polar */
+  char serr[AS_MAXCH];
+};
+
+/* flags of swe_pheno() used for the calculation of positions */
+static int32 pheno_iflag(int32 iflag)
+{
+  iflag &= ~(SEFLG_JPLHOR | SEFLG_JPLHOR_APPROX);
+  return iflag & (SEFLG_EPHMASK | 
+                   SEFLG_TRUEPOS | 
+                   SEFLG_J2000 | 
+                   SEFLG_NONUT |
+                   SEFLG_NOGDEFL |
+                   SEFLG_NOABERR |
+                   SEFLG_TOPOCTR);
+}
+
+static void pheno_sun_init(double tjd, int32 iflag, struct pheno_sun *psun)
+{
+  psun->iflag = pheno_iflag(iflag);
+  *psun->serr = '\0';
+  psun->retc = swe_calc(tjd, SE_SUN, psun->iflag | SEFLG_XYZ, psun->xx, psun->serr);
+  if (psun->retc != ERR 
+    && swe_calc(tjd, SE_SUN, psun->iflag, psun->lbr, psun->serr) == ERR)
+    psun->retc = ERR;
+}
+
+/* Sun at tjd, cartesian xx and, if lbr != NULL, polar lbr: taken from 
+ * *psun if it was computed with the same flags, else computed */
+static int32 pheno_get_sun(double tjd, int32 iflag, struct pheno_sun *psun, double *xx, double *lbr, char *serr)
+{
+  int i;
+  if (psun != NULL && psun->iflag == iflag) {
+    if (serr != NULL && *psun->serr != '\0')
+      strcpy(serr, psun->serr);
+    if (psun->retc == ERR)
+      return ERR;
+    for (i = 0; i < 6; i++) {
+      xx[i] = psun->xx[i];
+      if (lbr != NULL)
+	lbr[i] = psun->lbr[i];
+    }
+    return OK;
+  }
+  if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xx, serr) == ERR)
+    return ERR;
+  if (lbr != NULL && swe_calc(tjd, SE_SUN, iflag, lbr, serr) == ERR)
+    return ERR;
+  return OK;
+}
+
+static int32 pheno(double tjd, int32 ipl, int32 iflag, struct pheno_sun *psun, double *attr, char *serr);
+
 int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char *serr)
+{
+  return pheno(tjd, ipl, iflag, NULL, attr, serr);
+}
+
+/* swe_pheno() with the sun *psun of the date, if psun != NULL */
+static int32 pheno(double tjd, int32 ipl, int32 iflag, struct pheno_sun *psun, double *attr, char *serr)
 {
   int i;
   double xx[6], xx2[6], xxs[6], lbr[6], lbr2[6], dt = 0, dd;
@@ -3800,7 +4137,6 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
   int32 iflagp, epheflag, retflag, epheflag2;
   char serr2[AS_MAXCH];
   *serr2 = '\0';
-  iflag &= ~(SEFLG_JPLHOR | SEFLG_JPLHOR_APPROX);
   /* function calls for Pluto with asteroid number 134340
    * are treated as calls for Pluto as main body SE_PLUTO */
   if (ipl == SE_AST_OFFSET + 134340)
@@ -3810,13 +4146,7 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
   /* Ceres - Vesta must be SE_CERES etc., not 10001 etc. */
   if (ipl > SE_AST_OFFSET && ipl <= SE_AST_OFFSET + 4)
         ipl = ipl - SE_AST_OFFSET - 1 + SE_CERES;
-  iflag = iflag & (SEFLG_EPHMASK | 
-                   SEFLG_TRUEPOS | 
-                   SEFLG_J2000 | 
-                   SEFLG_NONUT |
-                   SEFLG_NOGDEFL |
-                   SEFLG_NOABERR |
-                   SEFLG_TOPOCTR);
+  iflag = pheno_iflag(iflag);
   iflagp = iflag & (SEFLG_EPHMASK | 
                    SEFLG_TRUEPOS | 
                    SEFLG_J2000 | 
@@ -3844,7 +4174,7 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
     return ERR;
   /* if moon, we need sun as well, for magnitude */
   if (ipl == SE_MOON) {
-    if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xxs, serr) == ERR)
+    if (pheno_get_sun(tjd, iflag, psun, xxs, NULL, serr) == ERR)
       return ERR;
   }
   if (ipl != SE_SUN && ipl != SE_EARTH &&
@@ -4061,9 +4391,7 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
     /* 
      * elongation of planet
      */
-    if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xx2, serr) == ERR)
-      return ERR;
-    if (swe_calc(tjd, SE_SUN, iflag, lbr2, serr) == ERR)
+    if (pheno_get_sun(tjd, iflag, psun, xx2, lbr2, serr) == ERR)
       return ERR;
     attr[2] = acos(swi_dot_prod_unit(xx, xx2)) * RADTODEG;
   }
@@ -4132,6 +4460,137 @@ int32 CALL_CONV swe_pheno_ut(double tjd_ut, int32 ipl, int32 iflag, double *attr
   return retflag;
 }
 
+/* message s of row r of a batch: serr[r] is a copy of a non-empty 
+ * message, to be released by the caller with free(), or NULL */
+static void batch_serr(char **serr, int32 r, const char *s)
+{
+  if (serr == NULL)
+    return;
+  serr[r] = NULL;
+  if (*s != '\0' && (serr[r] = (char *) malloc(strlen(s) + 1)) != NULL)
+    strcpy(serr[r], s);
+}
+
+/* rows of swe_pheno_array() and swe_pheno_ut_array() */
+struct pheno_batch {
+  int32 n;
+  double *tjd;
+  int32 *ipl;
+  int32 iflag;
+  AS_BOOL is_ut;
+  int nthreads;
+  double *attr;
+  int32 *retc;
+  char **serr;		/* one per row, or NULL */
+};
+
+#define PHENO_PREFETCH_BLOCK	256	/* rows */
+
+/* rows of thread k. Consecutive rows of the same date share the sun;
+ * with the Moshier ephemeris, the planetary theory is evaluated for 
+ * blocks of rows at once (swe_calc_prefetch()). */
+static void pheno_batch_run(void *arg, int k)
+{
+  struct pheno_batch *pb = (struct pheno_batch *) arg;
+  struct pheno_sun sun;
+  int32 beg = (int32) ((double) pb->n * k / pb->nthreads);
+  int32 end = (int32) ((double) pb->n * (k + 1) / pb->nthreads);
+  int32 r, b, bend, retflag;
+  int32 iflag = pb->iflag;
+  int32 epheflag = iflag & SEFLG_EPHMASK;
+  double deltat, *tt;
+  AS_BOOL have_sun = FALSE;
+  char s[AS_MAXCH];
+  if (pb->is_ut && epheflag == 0) {
+    epheflag = SEFLG_SWIEPH;
+    iflag |= SEFLG_SWIEPH;
+  }
+  if ((tt = (double *) malloc((end - beg + 1) * sizeof(double))) == NULL) {
+    for (r = beg; r < end; r++) {
+      pb->retc[r] = ERR;
+      batch_serr(pb->serr, r, "error in malloc()");
+    }
+    return;
+  }
+  for (r = beg; r < end; r++) {
+    tt[r - beg] = pb->tjd[r];
+    if (pb->is_ut)
+      tt[r - beg] += swe_deltat_ex(pb->tjd[r], iflag, NULL);
+  }
+  for (b = beg; b < end; b += PHENO_PREFETCH_BLOCK) {
+    bend = (b + PHENO_PREFETCH_BLOCK < end) ? b + PHENO_PREFETCH_BLOCK : end;
+    swe_calc_prefetch(tt + (b - beg), pb->ipl + b, bend - b, iflag);
+    for (r = b; r < bend; r++) {
+      if (!have_sun || tt[r - beg] != tt[r - beg - 1]) {
+	pheno_sun_init(tt[r - beg], iflag, &sun);
+	have_sun = TRUE;
+      }
+      *s = '\0';
+      retflag = pheno(tt[r - beg], pb->ipl[r], iflag, &sun, pb->attr + 20 * r, s);
+      /* if ephe required is not ephe returned, adjust delta t, 
+       * as swe_pheno_ut() does */
+      if (pb->is_ut && (retflag & SEFLG_EPHMASK) != epheflag) {
+	deltat = swe_deltat_ex(pb->tjd[r], retflag, s);
+	retflag = pheno(pb->tjd[r] + deltat, pb->ipl[r], iflag, NULL, pb->attr + 20 * r, s);
+      }
+      pb->retc[r] = retflag;
+      batch_serr(pb->serr, r, s);
+    }
+  }
+  swe_calc_prefetch(NULL, NULL, 0, iflag);
+  free(tt);
+}
+
+static int32 pheno_array(int32 n, double *tjd, int32 *ipl, int32 iflag, AS_BOOL is_ut, int32 nthreads, double *attr, int32 *retc, char **serr)
+{
+  struct pheno_batch pb;
+  int32 r, retval = OK;
+  if (n <= 0)
+    return OK;
+  if (nthreads < 1)
+    nthreads = 1;
+  if (nthreads > n)
+    nthreads = n;
+  pb.n = n;
+  pb.tjd = tjd;
+  pb.ipl = ipl;
+  pb.iflag = iflag;
+  pb.is_ut = is_ut;
+  pb.nthreads = nthreads;
+  pb.attr = attr;
+  pb.retc = retc;
+  pb.serr = serr;
+  swi_run_threads(nthreads, pheno_batch_run, &pb);
+  for (r = 0; r < n; r++) {
+    if (retc[r] == ERR)
+      retval = ERR;
+  }
+  return retval;
+}
+
+/* 
+ * swe_pheno_array(), swe_pheno_ut_array()
+ * swe_pheno() and swe_pheno_ut() for n rows of date tjd[r] (ET or UT)
+ * and body ipl[r]. The phenomena of row r are returned in 
+ * attr[20 * r ...], the return flag in retc[r] and, if serr is not 
+ * NULL, its message in serr[r]: a copy that the caller releases with
+ * free(), or NULL if there is none.
+ * Consecutive rows of the same date share the position of the sun, 
+ * and the rows are divided into nthreads parts that are computed in
+ * parallel; each thread takes over the ephemeris settings of the 
+ * calling thread.
+ * Function returns OK, or ERR if any row failed.
+ */
+int32 CALL_CONV swe_pheno_array(int32 n, double *tjd, int32 *ipl, int32 iflag, int32 nthreads, double *attr, int32 *retc, char **serr)
+{
+  return pheno_array(n, tjd, ipl, iflag, FALSE, nthreads, attr, retc, serr);
+}
+
+int32 CALL_CONV swe_pheno_ut_array(int32 n, double *tjd_ut, int32 *ipl, int32 iflag, int32 nthreads, double *attr, int32 *retc, char **serr)
+{
+  return pheno_array(n, tjd_ut, ipl, iflag, TRUE, nthreads, attr, retc, serr);
+}
+
 static int find_maximum(double y00, double y11, double y2, double dx, 
                         double *dxret, double *yret)
 {
@@ -6315,15 +6774,13 @@ int32 CALL_CONV swe_gauquelin_sector(
   char *serr)     /* return address for error message */
 {
   AS_BOOL rise_found = TRUE;
-  AS_BOOL set_found = TRUE;
   int32 retval;
   double tret[3];
-  double t_et, t;
+  double t_et;
   double x0[6];
   double eps, nutlo[2], armc;
   int32 epheflag = iflag & SEFLG_EPHMASK;
   AS_BOOL do_fixstar = (starname != NULL && *starname != '\0');
-  int32 risemeth = 0;
   AS_BOOL above_horizon = FALSE;
   if (imeth < 0 || imeth > 5) {
     if (serr)
@@ -6359,6 +6816,25 @@ int32 CALL_CONV swe_gauquelin_sector(
   /* 
    * from rise and set times
    */
+  retval = gauquelin_rise_set(t_ut, ipl, starname, epheflag, imeth, geopos, atpress, attemp, tret, &above_horizon, &rise_found, serr);
+  if (retval == ERR)
+    return ERR;
+  return gauquelin_sector_from_rise_set(t_ut, ipl, tret, above_horizon, rise_found, dgsect, serr);
+}
+
+/* Rise and set of the body that bracket t_ut, for the Gauquelin sector 
+ * with methods imeth = 2 .. 5: the next rise tret[0] and last set tret[1]
+ * if the body is below the horizon, the last rise and next set if above.
+ * *found is FALSE if a rise or set was not found.
+ */
+static int32 gauquelin_rise_set(double t_ut, int32 ipl, char *starname, int32 epheflag, int32 imeth, double *geopos, double atpress, double attemp, double *tret, AS_BOOL *above, AS_BOOL *found, char *serr)
+{
+  AS_BOOL rise_found = TRUE;
+  AS_BOOL set_found = TRUE;
+  AS_BOOL above_horizon = FALSE;
+  int32 retval;
+  int32 risemeth = 0;
+  double t;
   if (imeth == 2 || imeth == 4) 
     risemeth |= SE_BIT_NO_REFRACTION;
   if (imeth == 2 || imeth == 3)
@@ -6414,7 +6890,16 @@ int32 CALL_CONV swe_gauquelin_sector(
       rise_found = FALSE;
     }
   }
-  if (rise_found && set_found) {
+  *above = above_horizon;
+  *found = (rise_found && set_found);
+  return OK;
+}
+
+/* Gauquelin sector at t_ut between the rise and set times tret[0..1] 
+ * of gauquelin_rise_set() */
+static int32 gauquelin_sector_from_rise_set(double t_ut, int32 ipl, double *tret, AS_BOOL above_horizon, AS_BOOL found, double *dgsect, char *serr)
+{
+  if (found) {
     if (above_horizon) {
       *dgsect = (t_ut - tret[0]) / (tret[1] - tret[0]) * 18 + 1;
     } else {
@@ -6428,3 +6913,179 @@ int32 CALL_CONV swe_gauquelin_sector(
     return ERR;
   }
 }
+
+/* one row of swe_gauquelin_sector_array(), in sort order */
+struct gauquelin_row {
+  int32 ipl;
+  double geopos[3];
+  double t_ut;
+  int32 i;	/* index of row in input */
+};
+
+static int gauquelin_row_cmp(const void *a, const void *b)
+{
+  const struct gauquelin_row *ra = (const struct gauquelin_row *) a;
+  const struct gauquelin_row *rb = (const struct gauquelin_row *) b;
+  int j;
+  if (ra->ipl != rb->ipl)
+    return (ra->ipl < rb->ipl) ? -1 : 1;
+  for (j = 0; j < 3; j++) {
+    if (ra->geopos[j] != rb->geopos[j])
+      return (ra->geopos[j] < rb->geopos[j]) ? -1 : 1;
+  }
+  if (ra->t_ut != rb->t_ut)
+    return (ra->t_ut < rb->t_ut) ? -1 : 1;
+  return ra->i - rb->i;
+}
+
+static AS_BOOL gauquelin_same_place(const struct gauquelin_row *ra, const struct gauquelin_row *rb)
+{
+  return ra->ipl == rb->ipl && ra->geopos[0] == rb->geopos[0] 
+    && ra->geopos[1] == rb->geopos[1] && ra->geopos[2] == rb->geopos[2];
+}
+
+struct gauquelin_batch {
+  struct gauquelin_row *rows;
+  int32 *beg;		/* rows beg[k] .. beg[k + 1] - 1 belong to thread k */
+  char *starname;
+  int32 iflag, imeth;
+  double atpress, attemp;
+  double *dgsect;
+  int32 *retc;
+  char **serr;		/* one per row, or NULL */
+};
+
+/* rows of thread k. With imeth = 2 .. 5, the rise and set that bracket 
+ * a birth also bracket the following births of the same body and place 
+ * until the next rise or set, so they are searched only once for them. */
+static void gauquelin_batch_run(void *arg, int k)
+{
+  struct gauquelin_batch *gb = (struct gauquelin_batch *) arg;
+  struct gauquelin_row *r, *r0 = NULL;
+  double tret[3], tnext = 0;
+  AS_BOOL above = FALSE, found = FALSE;
+  int32 epheflag = gb->iflag & SEFLG_EPHMASK;
+  int32 m;
+  char s[AS_MAXCH], star[SE_MAX_STNAME * 2 + 1], *starname = NULL;
+  for (m = gb->beg[k]; m < gb->beg[k + 1]; m++) {
+    r = &gb->rows[m];
+    *s = '\0';
+    /* the star name is written back by the library; each row resolves
+     * its own copy of the caller's name */
+    if (gb->starname != NULL) {
+      strncpy(star, gb->starname, SE_MAX_STNAME);
+      star[SE_MAX_STNAME] = '\0';
+      starname = star;
+    }
+    if (gb->imeth < 2 || gb->imeth > 5) {
+      gb->retc[r->i] = swe_gauquelin_sector(r->t_ut, r->ipl, starname, gb->iflag, gb->imeth, r->geopos, gb->atpress, gb->attemp, &gb->dgsect[r->i], s);
+    } else {
+      if (r0 == NULL || !found || !gauquelin_same_place(r, r0) || r->t_ut >= tnext) {
+	r0 = r;
+	if (gauquelin_rise_set(r->t_ut, r->ipl, starname, epheflag, gb->imeth, r->geopos, gb->atpress, gb->attemp, tret, &above, &found, s) == ERR) {
+	  r0 = NULL;
+	  gb->retc[r->i] = ERR;
+	  gb->dgsect[r->i] = 0;
+	  batch_serr(gb->serr, r->i, s);
+	  continue;
+	}
+	/* next rise if below the horizon, next set if above */
+	tnext = above ? tret[1] : tret[0];
+      }
+      gb->retc[r->i] = gauquelin_sector_from_rise_set(r->t_ut, r->ipl, tret, above, found, &gb->dgsect[r->i], s);
+    }
+    batch_serr(gb->serr, r->i, s);
+  }
+}
+
+/* 
+ * swe_gauquelin_sector_array()
+ * swe_gauquelin_sector() for n rows of date t_ut[i], body ipl[i] and 
+ * place geopos[3 * i .. 3 * i + 2]. starname, iflag, imeth, atpress 
+ * and attemp are the same for all rows.
+ * The rows are sorted by body, place and date. With the methods from 
+ * rise and set (imeth = 2 .. 5), births of the same body and place 
+ * between the same rise and set share these two times, which are then 
+ * searched only once. The times found for a later birth may differ from 
+ * those of swe_gauquelin_sector() by the precision of swe_rise_trans().
+ * The sorted rows are divided into nthreads parts of about equal size 
+ * (without splitting a body and place) that are computed in parallel;
+ * each thread takes over the ephemeris settings of the calling thread.
+ * dgsect[i] receives the sector and retc[i] the return code of row i,
+ * and serr[i] its message if serr is not NULL (see swe_pheno_array()).
+ * Function returns OK, or ERR if any row failed.
+ */
+int32 CALL_CONV swe_gauquelin_sector_array(int32 n, double *t_ut, int32 *ipl,
+               char *starname, int32 iflag, int32 imeth, double *geopos, 
+               double atpress, double attemp, int32 nthreads, 
+               double *dgsect, int32 *retc, char **serr)
+{
+  struct gauquelin_batch gb;
+  int32 i, k, m;
+  int32 retval = OK;
+  char s[AS_MAXCH];
+  if (n <= 0)
+    return OK;
+  if (imeth < 0 || imeth > 5) {
+    for (i = 0; i < n; i++) {
+      retc[i] = ERR;
+      dgsect[i] = 0;
+      sprintf(s, "invalid method: %d", imeth);
+      batch_serr(serr, i, s);
+    }
+    return ERR;
+  }
+  if (nthreads < 1)
+    nthreads = 1;
+  if (nthreads > n)
+    nthreads = n;
+  gb.rows = (struct gauquelin_row *) malloc(n * sizeof(struct gauquelin_row));
+  gb.beg = (int32 *) malloc((nthreads + 1) * sizeof(int32));
+  if (gb.rows == NULL || gb.beg == NULL) {
+    for (i = 0; i < n; i++) {
+      retc[i] = ERR;
+      dgsect[i] = 0;
+      batch_serr(serr, i, "error in malloc()");
+    }
+    free(gb.rows);
+    free(gb.beg);
+    return ERR;
+  }
+  for (i = 0; i < n; i++) {
+    /* Pluto as asteroid 134340 is Pluto, see swe_gauquelin_sector() */
+    gb.rows[i].ipl = (ipl[i] == SE_AST_OFFSET + 134340) ? SE_PLUTO : ipl[i];
+    gb.rows[i].geopos[0] = geopos[3 * i];
+    gb.rows[i].geopos[1] = geopos[3 * i + 1];
+    gb.rows[i].geopos[2] = geopos[3 * i + 2];
+    gb.rows[i].t_ut = t_ut[i];
+    gb.rows[i].i = i;
+  }
+  qsort(gb.rows, n, sizeof(struct gauquelin_row), gauquelin_row_cmp);
+  /* parts of about n / nthreads rows, ending with a body and place */
+  gb.beg[0] = 0;
+  for (k = 1; k < nthreads; k++) {
+    m = (int32) ((double) n * k / nthreads);
+    if (m < gb.beg[k - 1])
+      m = gb.beg[k - 1];
+    while (m > 0 && m < n && gauquelin_same_place(&gb.rows[m], &gb.rows[m - 1]))
+      m++;
+    gb.beg[k] = m;
+  }
+  gb.beg[nthreads] = n;
+  gb.starname = starname;
+  gb.iflag = iflag;
+  gb.imeth = imeth;
+  gb.atpress = atpress;
+  gb.attemp = attemp;
+  gb.dgsect = dgsect;
+  gb.retc = retc;
+  gb.serr = serr;
+  swi_run_threads(nthreads, gauquelin_batch_run, &gb);
+  for (i = 0; i < n; i++) {
+    if (retc[i] == ERR)
+      retval = ERR;
+  }
+  free(gb.rows);
+  free(gb.beg);
+  return retval;
+}
@@ -306,14 +306,16 @@ static TLS int leap_seconds[NLEAP_SECONDS_SPACE] = {
 #define J1972 2441317.5
 #define NLEAP_INIT 10
 
+static TLS int leap_seconds_tabsiz = NLEAP_SECONDS;
+
 /* Read additional leap second dates from external file, if given.
+ * This is done once; the size of the table is kept.
  */
 static int init_leapsec(void)
 {
   FILE *fp;
   int ndat, ndat_last;
   int tabsiz = 0;
-  int i;
   char s[AS_MAXCH];
   char *sp;
   if (!init_leapseconds_done) {
@@ -322,7 +324,7 @@ static int init_leapsec(void)
     ndat_last = leap_seconds[NLEAP_SECONDS - 1];
     /* no error message if file is missing */
     if ((fp = swi_fopen(-1, "seleapsec.txt", swed.ephepath, NULL)) == NULL)
-      return NLEAP_SECONDS; 
+      return leap_seconds_tabsiz = NLEAP_SECONDS; 
     while(fgets(s, AS_MAXCH, fp) != NULL) {
       sp = s;
       while (*sp == ' ' || *sp == '\t') sp++;
@@ -334,23 +336,31 @@ static int init_leapsec(void)
         continue;
       /* table space is limited. no error msg, if exceeded */
       if (tabsiz >= NLEAP_SECONDS_SPACE)
-        return tabsiz;
+        break;
       leap_seconds[tabsiz] = ndat;
+      ndat_last = ndat;
       tabsiz++;
     }
-    if (tabsiz > NLEAP_SECONDS) leap_seconds[tabsiz] = 0; /* end mark */
+    if (tabsiz > NLEAP_SECONDS && tabsiz < NLEAP_SECONDS_SPACE) leap_seconds[tabsiz] = 0; /* end mark */
     fclose(fp);
-    return tabsiz;
+    leap_seconds_tabsiz = tabsiz;
   }
-  /* find table size */
-  tabsiz = 0;
-  for (i = 0; i < NLEAP_SECONDS_SPACE; i++) {
-    if (leap_seconds[i] == 0) 
-      break;
+  return leap_seconds_tabsiz;
+}
+
+/* number of leap seconds inserted before date ndat (yyyymmdd), by binary
+ * search in the first tabsiz entries of the table */
+static int leapsec_before(int ndat, int tabsiz)
+{
+  int lo = 0, hi = tabsiz, mid;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (leap_seconds[mid] < ndat)
+      lo = mid + 1;
     else
-      tabsiz++;
+      hi = mid;
   }
-  return tabsiz;
+  return lo;
 }
 
 /*
@@ -376,7 +386,7 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
 {
   double tjd_ut1, tjd_et, tjd_et_1972, dhour, d;
   int iyear2, imonth2, iday2;
-  int i, j, ndat, nleap, tabsiz_nleap;
+  int i, ndat, nleap, tabsiz_nleap;
   /* 
    * error handling: invalid iyear etc. 
    */
@@ -415,13 +425,10 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
    * number of leap seconds since 1972: 
    */
   tabsiz_nleap = init_leapsec();
-  nleap = NLEAP_INIT; /* initial difference between UTC and TAI in 1972 */
+  /* initial difference between UTC and TAI in 1972 */
   ndat = iyear * 10000 + imonth * 100 + iday;
-  for (i = 0; i < tabsiz_nleap; i++) {
-    if (ndat <= leap_seconds[i])
-      break;
-    nleap++;
-  }
+  i = leapsec_before(ndat, tabsiz_nleap);
+  nleap = NLEAP_INIT + i;
   /*
    * For input dates > today:
    * If leap seconds table is not up to date, we'd better interpret the
@@ -438,14 +445,7 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
    * if input second is 60: is it a valid leap second ? 
    */
   if (dsec >= 60) {
-    j = 0;
-    for (i = 0; i < tabsiz_nleap; i++) {
-      if (ndat == leap_seconds[i]) {
-	j = 1;
-	break;
-      }
-    }
-    if (j != 1) {
+    if (i >= tabsiz_nleap || leap_seconds[i] != ndat) {
       if (serr != NULL)
 	sprintf(serr, "invalid time (no leap second!): %d:%d:%.2f", ihour, imin, dsec);
       return ERR;
@@ -512,12 +512,7 @@ void CALL_CONV swe_jdet_to_utc(double tjd_et, int32 gregflag, int32 *iyear, int3
   tabsiz_nleap = init_leapsec();
   swe_revjul(tjd_ut-1, SE_GREG_CAL, &iyear2, &imonth2, &iday2, &d);
   ndat = iyear2 * 10000 + imonth2 * 100 + iday2;
-  nleap = 0; 
-  for (i = 0; i < tabsiz_nleap; i++) {
-    if (ndat <= leap_seconds[i])
-      break;
-    nleap++;
-  }
+  nleap = leapsec_before(ndat, tabsiz_nleap);
   /* date of potentially missing leapsecond */
   if (nleap < tabsiz_nleap) {
     i = leap_seconds[nleap];
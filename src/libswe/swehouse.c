@@ -84,8 +84,7 @@ static int sidereal_houses_ecl_t0(double tjde,
 			   double *cusp_speed,
 			   double *ascmc_speed,
 			   char *serr);
-static int sidereal_houses_trad(double tjde, 
-			   int32 iflag,
+static int sidereal_houses_trad(double ay, 
                            double armc, 
                            double eps, 
                            double nutl, 
@@ -107,6 +106,34 @@ static int sidereal_houses_ssypl(double tjde,
 			   double *cusp_speed,
 			   double *ascmc_speed,
 			   char *serr);
+/* quantities of swe_houses_ex2() that depend on date and place only */
+struct houses_epoch {
+  double tjd_ut, tjde;
+  int32 iflag;
+  double armc, eps_mean, nutlo[2];
+  AS_BOOL have_sun;	/* sun for Sunshine houses computed */
+  int32 retc_sun;
+  double xsun[6];
+  AS_BOOL have_ayan;	/* ayanamsha computed */
+  double ayan;
+};
+static void houses_epoch_init(double tjd_ut, int32 iflag, double geolon, struct houses_epoch *hep);
+static int houses_at_epoch(struct houses_epoch *hep, double geolat, int hsys, 
+                           double *cusp, double *ascmc, double *cusp_speed, 
+			   double *ascmc_speed, char *serr);
+/* quantities of swe_house_pos() that depend on the house frame only */
+struct house_frame {
+  double armc, geolat, eps, sine, cose;
+  int hsys;
+  int retc;		/* return code of swe_houses_armc_ex2() */
+  double hcusp[37], ascmc[10];
+  double dsun;		/* declination of sun (I) or ascendant (Y) */
+  double asc, mc;	/* A, E, D, V, W, O, B, S, F, U */
+  double raaz, oblaz, xasc;	/* house plane of Krusinski (U) */
+  double jcusp[13];	/* Savard-A (J) cusps on prime vertical */
+};
+static void house_frame_init(double armc, double geolat, double eps, int hsys, struct house_frame *hfp);
+static double house_pos_in_frame(struct house_frame *hfp, double *xpin, char *serr);
 static int sunshine_solution_makransky(double ramc, double lat, double ecl, struct houses *hsp);
 static int sunshine_solution_treindl(double ramc, double lat, double ecl, struct houses *hsp);
 #if 0
@@ -215,27 +242,7 @@ int CALL_CONV swe_houses_ex2(double tjd_ut,
 				double *ascmc_speed,
 				char *serr)
 {
-  int i, retc = 0;
-  double armc, eps_mean, nutlo[2];
-  double tjde = tjd_ut + swe_deltat_ex(tjd_ut, iflag, NULL);
-  struct sid_data *sip = &swed.sidd;
-  double xp[6];
-  int retc_makr = 0;
-  int ito;
-  if (toupper(hsys) == 'G')
-    ito = 36;
-  else
-    ito = 12;
-  if ((iflag & SEFLG_SIDEREAL) && !swed.ayana_is_set)
-    swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
-  eps_mean = swi_epsiln(tjde, 0) * RADTODEG;
-  swi_nutation(tjde, 0, nutlo);
-  for (i = 0; i < 2; i++)
-    nutlo[i] *= RADTODEG;
-  if (iflag & SEFLG_NONUT) {
-    for (i = 0; i < 2; i++)
-      nutlo[i] = 0;
-  }
+  struct houses_epoch he;
 #ifdef TRACE
   swi_open_trace(NULL);
   if (swi_trace_count <= TRACE_COUNT_MAX) {
@@ -254,29 +261,125 @@ int CALL_CONV swe_houses_ex2(double tjd_ut,
     }
   }
 #endif
+  houses_epoch_init(tjd_ut, iflag, geolon, &he);
+  return houses_at_epoch(&he, geolat, hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
+}
+
+/* 
+ * swe_houses_multi()
+ * swe_houses_ex() for nsys house systems hsys[0..nsys-1] of the same
+ * chart. Delta T, obliquity, nutation, ARMC, the declination of the sun
+ * (Sunshine houses) and the ayanamsha are computed once for all systems.
+ * Function returns OK, or ERR if any system failed.
+ * cusps are returned in cusp[37 * k + 1 ...], the additional points in
+ * ascmc[10 * k ...] and the return codes in retc[k], for system hsys[k].
+ * serr receives the first error message or warning, if any.
+ */
+int32 CALL_CONV swe_houses_multi(double tjd_ut,
+                                int32 iflag, 
+				double geolat,
+				double geolon,
+				int32 nsys,
+				int *hsys,
+				double *cusp,
+				double *ascmc,
+				int32 *retc,
+				char *serr)
+{
+  struct houses_epoch he;
+  int32 k, retval = OK;
+  char s[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  if (nsys <= 0)
+    return OK;
+  houses_epoch_init(tjd_ut, iflag, geolon, &he);
+  for (k = 0; k < nsys; k++) {
+    *s = '\0';
+    retc[k] = houses_at_epoch(&he, geolat, hsys[k], cusp + 37 * k, ascmc + 10 * k, NULL, NULL, s);
+    if (retc[k] < 0)
+      retval = ERR;
+    if (serr != NULL && *serr == '\0' && *s != '\0')
+      strcpy(serr, s);
+  }
+  return retval;
+}
+
+/* date and place of swe_houses_ex2(): ARMC, obliquity and nutation */
+static void houses_epoch_init(double tjd_ut, int32 iflag, double geolon, struct houses_epoch *hep)
+{
+  int i;
+  hep->tjd_ut = tjd_ut;
+  hep->iflag = iflag;
+  hep->tjde = tjd_ut + swe_deltat_ex(tjd_ut, iflag, NULL);
+  if ((iflag & SEFLG_SIDEREAL) && !swed.ayana_is_set)
+    swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
+  hep->eps_mean = swi_epsiln(hep->tjde, 0) * RADTODEG;
+  swi_nutation(hep->tjde, 0, hep->nutlo);
+  for (i = 0; i < 2; i++)
+    hep->nutlo[i] *= RADTODEG;
+  if (iflag & SEFLG_NONUT) {
+    for (i = 0; i < 2; i++)
+      hep->nutlo[i] = 0;
+  }
     /*houses_to_sidereal(tjde, geolat, hsys, eps, cusp, ascmc, iflag);*/
-  armc = swe_degnorm(swe_sidtime0(tjd_ut, eps_mean + nutlo[1], nutlo[0]) * 15 + geolon);
+  hep->armc = swe_degnorm(swe_sidtime0(tjd_ut, hep->eps_mean + hep->nutlo[1], hep->nutlo[0]) * 15 + geolon);
 //fprintf(stderr, "armc=%f, iflag=%d\n", armc, iflag);
+  hep->have_sun = FALSE;
+  hep->have_ayan = FALSE;
+}
+
+/* houses of one system for the date and place of hep; the position of 
+ * the sun and the ayanamsha are computed on first use */
+static int houses_at_epoch(struct houses_epoch *hep,
+				double geolat,
+				int hsys,
+				double *cusp,
+				double *ascmc,
+			        double *cusp_speed,
+				double *ascmc_speed,
+				char *serr)
+{
+  int i, retc = 0;
+  int32 iflag = hep->iflag;
+  double tjde = hep->tjde, armc = hep->armc, eps_mean = hep->eps_mean;
+  double *nutlo = hep->nutlo;
+  struct sid_data *sip = &swed.sidd;
+  int retc_makr = 0;
+  int ito;
+  if (toupper(hsys) == 'G')
+    ito = 36;
+  else
+    ito = 12;
   if (toupper(hsys) ==  'I') {	// compute sun declination for sunshine houses
     int flags = SEFLG_SPEED| SEFLG_EQUATORIAL;
-    retc_makr = swe_calc_ut(tjd_ut, SE_SUN, flags, xp, NULL);
+    if (!hep->have_sun) {
+      hep->retc_sun = swe_calc_ut(hep->tjd_ut, SE_SUN, flags, hep->xsun, NULL);
+      hep->have_sun = TRUE;
+    }
+    retc_makr = hep->retc_sun;
     if (retc_makr < 0) {
       // in case of failure, provide Porphyry houses
       hsys = (int) 'O';
     }
-    ascmc[9] = xp[1];	// declination in ascmc[9];
+    ascmc[9] = hep->xsun[1];	// declination in ascmc[9];
   }
   if (iflag & SEFLG_SIDEREAL) { 
     if (sip->sid_mode & SE_SIDBIT_ECL_T0)
       retc = sidereal_houses_ecl_t0(tjde, armc, eps_mean + nutlo[1], nutlo, geolat, hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
     else if (sip->sid_mode & SE_SIDBIT_SSY_PLANE)
       retc = sidereal_houses_ssypl(tjde, armc, eps_mean + nutlo[1], nutlo, geolat, hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
-    else
-      retc = sidereal_houses_trad(tjde, iflag, armc, eps_mean + nutlo[1], nutlo[0], geolat, hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
+    else {
+      if (!hep->have_ayan) {
+	swe_get_ayanamsa_ex(tjde, iflag, &hep->ayan, NULL);
+	hep->have_ayan = TRUE;
+      }
+      retc = sidereal_houses_trad(hep->ayan, armc, eps_mean + nutlo[1], nutlo[0], geolat, hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
+    }
   } else {
     retc = swe_houses_armc_ex2(armc, geolat, eps_mean + nutlo[1], hsys, cusp, ascmc, cusp_speed, ascmc_speed, serr);
     if (toupper(hsys) ==  'I') 	
-      ascmc[9] = xp[1];	// declination in ascmc[9];
+      ascmc[9] = hep->xsun[1];	// declination in ascmc[9];
   }
   if (iflag & SEFLG_RADIANS) {
     for (i = 1; i <= ito; i++)
@@ -532,8 +635,7 @@ static int sidereal_houses_ssypl(double tjde,
 }
 
 /* common simplified procedure */
-static int sidereal_houses_trad(double tjde,
-			   int32 iflag,
+static int sidereal_houses_trad(double ay,
                            double armc, 
                            double eps, 
                            double nutl, 
@@ -546,14 +648,10 @@ static int sidereal_houses_trad(double tjde,
 			   char *serr)
 {
   int i, retc = OK;
-  double ay;
   int ito;
   int ihs = toupper(hsys);
   int ihs2 = ihs;
-// ay = swe_get_ayanamsa(tjde);
-//fprintf(stderr, "ay=%f\n", ay);
-  retc = swe_get_ayanamsa_ex(tjde, iflag, &ay, NULL);
-//fprintf(stderr, "ay=%f\n", ay);
+  /* ay = ayanamsha of tjde, computed by the caller */
 //fprintf(stderr, "nutl=%f\n", nutl);
   if (ihs == 'G')
     ito = 36;
@@ -889,6 +987,25 @@ double swi_armc_to_mc(double armc, double eps)
 
 //#define DEBUG_PLAC_ITER 1
 #define VERY_SMALL_PLAC_ITER (1.0 / 360000.0 )
+/* MC and ascendant (calch_axes), and vertex, equatorial ascendant, 
+ * co-ascendants and polar ascendant (calch_points) of the last call of
+ * CalcH(). They do not depend on the house system, so that they are
+ * computed only once if several house systems of the same chart are
+ * computed one after the other (swe_houses_multi()). Some systems change
+ * ARMC or latitude before the points are computed; the cache is keyed 
+ * by the values actually used. */
+static TLS struct {
+  AS_BOOL valid, do_speed;
+  double th, fi, ekl;
+  double mc, mc_speed, ac, ac_speed;
+} calch_axes;
+static TLS struct {
+  AS_BOOL valid, do_speed;
+  double th, fi, ekl, mc;
+  double vertex, vertex_speed, equasc, equasc_speed;
+  double coasc1, coasc1_speed, coasc2, coasc2_speed;
+  double polasc, polasc_speed;
+} calch_points;
 static int CalcH(
 	double th, double fi, double ekl, char hsy, struct houses *hsp)
 /* *********************************************************
@@ -952,6 +1069,15 @@ static int CalcH(
       fi = 90 - VERY_SMALL;
   }
   tanfi = tand(fi);
+  if (calch_axes.valid && calch_axes.th == th && calch_axes.fi == fi 
+      && calch_axes.ekl == ekl && calch_axes.do_speed == hsp->do_speed) {
+    hsp->mc = calch_axes.mc;
+    hsp->ac = calch_axes.ac;
+    if (hsp->do_speed) {
+      hsp->mc_speed = calch_axes.mc_speed;
+      hsp->ac_speed = calch_axes.ac_speed;
+    }
+  } else {
   /* mc */
   if (fabs(th - 90) > VERY_SMALL
       && fabs(th - 270) > VERY_SMALL) {
@@ -971,6 +1097,18 @@ static int CalcH(
   hsp->ac = Asc1(th + 90, fi, sine, cose);
   if (hsp->do_speed) 
     hsp->ac_speed = AscDash(th + 90, fi, sine, cose);
+  calch_axes.th = th;
+  calch_axes.fi = fi;
+  calch_axes.ekl = ekl;
+  calch_axes.do_speed = hsp->do_speed;
+  calch_axes.mc = hsp->mc;
+  calch_axes.ac = hsp->ac;
+  if (hsp->do_speed) {
+    calch_axes.mc_speed = hsp->mc_speed;
+    calch_axes.ac_speed = hsp->ac_speed;
+  }
+  calch_axes.valid = TRUE;
+  }
   if (hsp->do_hspeed) {
     for (i = 0; i <= 12; i++)
       hsp->cusp_speed[i] = 0;
@@ -1996,6 +2134,23 @@ porphyry:
       hsp->cusp_speed[9] = hsp->cusp_speed[3];
     }
   }
+  if (calch_points.valid && calch_points.th == th && calch_points.fi == fi 
+      && calch_points.ekl == ekl && calch_points.mc == hsp->mc
+      && calch_points.do_speed == hsp->do_speed) {
+    hsp->vertex = calch_points.vertex;
+    hsp->equasc = calch_points.equasc;
+    hsp->coasc1 = calch_points.coasc1;
+    hsp->coasc2 = calch_points.coasc2;
+    hsp->polasc = calch_points.polasc;
+    if (hsp->do_speed) {
+      hsp->vertex_speed = calch_points.vertex_speed;
+      hsp->equasc_speed = calch_points.equasc_speed;
+      hsp->coasc1_speed = calch_points.coasc1_speed;
+      hsp->coasc2_speed = calch_points.coasc2_speed;
+      hsp->polasc_speed = calch_points.polasc_speed;
+    }
+    return retc;
+  }
   /* vertex */
   if (fi >= 0)
     f = 90 - fi;
@@ -2044,6 +2199,24 @@ porphyry:
   /* "polar ascendant" M. Munkasey */
   hsp->polasc = Asc1(th - 90, fi, sine, cose);
   if (hsp->do_speed) hsp->polasc_speed = AscDash(th - 90, fi, sine, cose);
+  calch_points.th = th;
+  calch_points.fi = fi;
+  calch_points.ekl = ekl;
+  calch_points.mc = hsp->mc;
+  calch_points.do_speed = hsp->do_speed;
+  calch_points.vertex = hsp->vertex;
+  calch_points.equasc = hsp->equasc;
+  calch_points.coasc1 = hsp->coasc1;
+  calch_points.coasc2 = hsp->coasc2;
+  calch_points.polasc = hsp->polasc;
+  if (hsp->do_speed) {
+    calch_points.vertex_speed = hsp->vertex_speed;
+    calch_points.equasc_speed = hsp->equasc_speed;
+    calch_points.coasc1_speed = hsp->coasc1_speed;
+    calch_points.coasc2_speed = hsp->coasc2_speed;
+    calch_points.polasc_speed = hsp->polasc_speed;
+  }
+  calch_points.valid = TRUE;
   return retc;
 } /* procedure houses */
 
@@ -2213,54 +2386,200 @@ static double fix_asc_polar(double asc, double armc, double eps, double geolat)
 double CALL_CONV swe_house_pos(
 	double armc, double geolat, double eps, int hsys, double *xpin, char *serr)
 {
-  double xp[6], xeq[6], ra, de, mdd, mdn, sad, san;
-  double hpos, sinad, ad, a, admc, adp, samc, asc, mc, acmc, tant;
-  //double demc;
-  double fh, ra0, tanfi, sinfi, fac, dfac, tanx;
-  double x[3], xasc[3], xs1, xs2, raep, raaz, oblaz, xtemp; /* BK 21.02.2006 */
-  double hcusp[37], ascmc[10];
-  double sine = sind(eps);
-  double cose = cosd(eps);
-  double c1, c2, d, hsize;
-  int i, j, nloop;
-  double dsun = 0, darmc, harmc, y, sinpsi, sa;
-  AS_BOOL is_western_half = FALSE;
+  struct house_frame hf;
+  house_frame_init(armc, geolat, eps, hsys, &hf);
+  return house_pos_in_frame(&hf, xpin, serr);
+}
+
+/* 
+ * swe_house_pos_array()
+ * swe_house_pos() for n points in the same house frame.
+ * xpin[2 * i], xpin[2 * i + 1] are ecl. long. and lat. of point i,
+ * its house position is returned in hpos[i].
+ * The house cusps and the parts of the calculation that do not depend 
+ * on the point (Ascendant, MC, Koch and Krusinski planes, etc.)
+ * are computed only once.
+ * serr receives the first error message or warning, if any.
+ */
+int32 CALL_CONV swe_house_pos_array(
+	double armc, double geolat, double eps, int hsys, 
+	int32 n, double *xpin, double *hpos, char *serr)
+{
+  struct house_frame hf;
+  int32 i;
+  char s[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  if (n <= 0)
+    return OK;
+  house_frame_init(armc, geolat, eps, hsys, &hf);
+  for (i = 0; i < n; i++) {
+    *s = '\0';
+    hpos[i] = house_pos_in_frame(&hf, xpin + 2 * i, s);
+    if (serr != NULL && *serr == '\0' && *s != '\0')
+      strcpy(serr, s);
+  }
+  return OK;
+}
+
+/* house cusps, Ascendant and the other quantities of swe_house_pos() 
+ * that do not depend on the point */
+static void house_frame_init(double armc, double geolat, double eps, int hsys, struct house_frame *hfp)
+{
+  double x[3], xeq[3], xtemp, tanx, raep, raaz, oblaz, asc, sinfi, xs1, xs2;
   hsys = toupper(hsys);
-  if (1) {
-    /* input is a house cusp: no calculation is required */
-    ascmc[9] = 99;// dirty hack. Sunshine house system needs sun declination
+  hfp->armc = armc;
+  hfp->geolat = geolat;
+  hfp->eps = eps;
+  hfp->hsys = hsys;
+  hfp->sine = sind(eps);
+  hfp->cose = cosd(eps);
+  hfp->dsun = 0;
+  hfp->asc = hfp->mc = 0;
+  hfp->ascmc[9] = 99;// dirty hack. Sunshine house system needs sun declination
 		  // which we do not know. If it sees ascmc[9] == 99, it uses
 		  // the one is saved from last call. can lead to bugs, but can 
 		  // also solve many problems.
-    if (swe_houses_armc_ex2(armc, geolat, eps, hsys, hcusp, ascmc, NULL, NULL, serr) == ERR) {
-      if (serr != NULL)
-	sprintf(serr, "swe_house_pos(): failed for system %c", hsys);
-    } else {
-      hpos = 0;
-      for (i = 1; i <= 12; i++) {
-	if (fabs(swe_difdeg2n(xpin[0], hcusp[i])) < MILLIARCSEC && xpin[1] == 0) {
-	  hpos = (double) i;
-	}
+  hfp->retc = swe_houses_armc_ex2(armc, geolat, eps, hsys, hfp->hcusp, hfp->ascmc, NULL, NULL, NULL);
+  if (hfp->retc != ERR) {
+    // for Sunshine houses: declination of Sun
+    if (hsys == 'I')
+      hfp->dsun = hfp->ascmc[9];  
+    // for APC houses: declination of ascendant into dsun
+    if (hsys == 'Y') {
+      xeq[0] = hfp->ascmc[0];
+      xeq[1] = 0;
+      xeq[2] = 1;
+      swe_cotrans(xeq, xeq, -eps);
+      hfp->dsun = xeq[1]; 
+    }
+  }
+  switch(hsys) {
+    case 'A': case 'E': case 'D': case 'V': case 'W':
+    case 'O': case 'B': case 'S': case 'F':
+      hfp->asc = Asc1(swe_degnorm(armc + 90), geolat, hfp->sine, hfp->cose);
+      hfp->mc = armc_to_mc(armc, eps);
+      /* while MC is always south,
+       * Asc must always be in eastern hemisphere */
+      hfp->asc = fix_asc_polar(hfp->asc, armc, eps, geolat);
+      break;
+    case 'J': // Savard-A
+      sinfi = sind(geolat);
+      if (fabs(geolat) < VERY_SMALL) {	
+	xs2 = 1 / 3.0;
+	xs1 = 2 / 3.0;
+      } else {
+	xs2 = sind(geolat / 3) / sinfi;	
+	xs1 = sind(2 * geolat / 3) / sinfi;
       }
-      for (i = 1; i <= 12; i += 3) {
-	if (fabs(swe_difdeg2n(xpin[0], hcusp[i])) < MILLIARCSEC && xpin[1] == 0) {
-	  xp[0] = (double) i;
-	}
+      xs2 = asind(xs2);
+      xs1 = asind(xs1);
+      // xs1 and xs2 always in >= 0 < 90
+      // house borders on prime vertical are, measured from EP downwards
+      // h1 = 0, h4 = 90, h7 = 180, h10 = 270
+      // h2 = xs2, h3 = xs1, h12 = 360 - xs2, h11 = 360 - xs1
+      // h5 = h11 - 180, h6 = h12 - 180, h8 = h2 + 180, h9 = h3 + 180
+      hfp->jcusp[1] = 0;
+      hfp->jcusp[2] = xs2;
+      hfp->jcusp[3] = xs1;
+      hfp->jcusp[4] = 90;
+      hfp->jcusp[5] = 180 - xs1;
+      hfp->jcusp[6] = 180 - xs2;
+      hfp->jcusp[7] = 180;
+      hfp->jcusp[8] = 180 + xs2;
+      hfp->jcusp[9] = 180 + xs1;
+      hfp->jcusp[10] = 270;
+      hfp->jcusp[11] = 360 - xs1;
+      hfp->jcusp[12] = 360 - xs2;
+      break;
+    case 'U': /* Krusinski-Pisa-Goelzer */
+      if (fabs(geolat) < VERY_SMALL) {	/* code below does not like geolat 0 */
+        geolat = (geolat >= 0) ? VERY_SMALL : -VERY_SMALL;
       }
-      if (hpos > 0)
-	return hpos;
-      // for Sunshine houses: declination of Sun
-      if (hsys == 'I')
-	dsun = ascmc[9];  
-      // for APC houses: declination of ascendant into dsun
-      if (hsys == 'Y') {
-	xeq[0] = ascmc[0];
-	xeq[1] = 0;
-	xeq[2] = 1;
-	swe_cotrans(xeq, xeq, -eps);
-	dsun = xeq[1]; 
+      /* Purpose: find point where planet's house circle (meridian)
+       *   cuts house plane, giving exact planet's house position.
+       * Input data: ramc, geolat, asc.
+       */
+      asc = Asc1(swe_degnorm(armc + 90), geolat, hfp->sine, hfp->cose);
+      /* while MC is always south, 
+       * Asc must always be in eastern hemisphere */
+      asc = fix_asc_polar(asc, armc, eps, geolat);
+      hfp->asc = asc;
+      /*
+       * Descr: find the house plane 'asc-zenith' - where it intersects 
+       * with equator and at what angle, and then simple find arc 
+       * from asc on that plane to planet's meridian intersection 
+       * with this plane.
+       */
+      /* I. find plane of 'asc-zenith' great circle relative to equator: 
+       *   solve spherical triangle 'EP-asc-intersection of house circle with equator' */
+      /* Ia. Find intersection of house plane with equator: */
+      x[0] = asc; x[1] = 0.0; x[2] = 1.0;          /* 1. Start with ascendent on ecliptic     */
+      swe_cotrans(x, x, -eps);                     /* 2. Transform asc into equatorial coords */
+      raep = swe_degnorm(armc + 90);               /* 3. RA of east point                     */
+      x[0] = swe_degnorm(raep - x[0]);             /* 4. Rotation - found arc raas-raep      */
+      swe_cotrans(x, x, -(90-geolat));             /* 5. Transform into horizontal coords - arc EP-asc on horizon */
+      tanx = tand(x[0]);
+      if (geolat == 0) {
+        xtemp = (tanx >= 0) ? 90 : -90;
+      } else {
+	xtemp = atand(tanx/cosd((90-geolat))); /* 6. Rotation from horizon on circle perpendicular to equator */
+      }
+      if (x[0] > 90 && x[0] <= 270)
+	xtemp = swe_degnorm(xtemp + 180);
+      x[0] = swe_degnorm(xtemp);        
+      hfp->raaz = raaz = swe_degnorm(raep - x[0]); /* result: RA of intersection 'asc-zenith' great circle with equator */
+      /* Ib. Find obliquity to equator of 'asc-zenith' house plane: */
+      x[0] = raaz; x[1] = 0.0; 
+      x[0] = swe_degnorm(raep - x[0]);  /* 1. Rotate start point relative to EP   */
+      swe_cotrans(x, x, -(90-geolat));  /* 2. Transform into horizontal coords    */
+      x[1] = x[1] + 90;                 /* 3. Add 90 deg do decl - so get the point on house plane most distant from equ. */
+      swe_cotrans(x, x, 90-geolat);     /* 4. Rotate back to equator              */
+      hfp->oblaz = oblaz = x[1];        /* 5. Obliquity of house plane to equator */
+      /* II. Next find asc and planet position on house plane, 
+       *     so to find relative distance of planet from 
+       *     coords beginning. */
+      /* IIa. Asc on house plane relative to intersection 
+       *      of equator with 'asc-zenith' plane. */
+      x[0] = asc; x[1] = 0.0; x[2] = 1.0;
+      swe_cotrans(x, x, -eps);
+      x[0] = swe_degnorm(x[0] - raaz);
+      xtemp = atand(tand(x[0])/cosd(oblaz));
+      if (x[0] > 90 && x[0] <= 270)
+          xtemp = swe_degnorm(xtemp + 180);
+      hfp->xasc = swe_degnorm(xtemp);
+      break;
+    default:
+      break;
+  }
+}
+
+/* house position of point xpin[0..1] in house frame *hfp */
+static double house_pos_in_frame(struct house_frame *hfp, double *xpin, char *serr)
+{
+  double xp[6], xeq[6], ra, de, mdd, mdn, sad, san;
+  double hpos, sinad, ad, a, admc, adp, samc, asc, mc, acmc, tant;
+  //double demc;
+  double fh, ra0, tanfi, fac, dfac;
+  double x[3], raaz, oblaz, xtemp; /* BK 21.02.2006 */
+  double *hcusp = hfp->hcusp;
+  double armc = hfp->armc, geolat = hfp->geolat, eps = hfp->eps;
+  double cose = hfp->cose;
+  double c1, c2, d, hsize;
+  int i, j, nloop;
+  int hsys = hfp->hsys;
+  double dsun = hfp->dsun, darmc, harmc, y, sinpsi, sa;
+  AS_BOOL is_western_half = FALSE;
+  /* input is a house cusp: no calculation is required */
+  if (hfp->retc != ERR && xpin[1] == 0) {
+    hpos = 0;
+    for (i = 1; i <= 12; i++) {
+      if (fabs(swe_difdeg2n(xpin[0], hcusp[i])) < MILLIARCSEC) {
+	hpos = (double) i;
       }
     }
+    if (hpos > 0)
+      return hpos;
   }
   AS_BOOL is_above_hor = FALSE;
   AS_BOOL is_invalid = FALSE;
@@ -2290,9 +2609,8 @@ double CALL_CONV swe_house_pos(
     case 'D': // equal (MC)
     case 'V': // Vehlow
     case 'W': // whole signs
-      asc = Asc1(swe_degnorm(armc + 90), geolat, sine, cose);
-      mc = armc_to_mc(armc, eps);
-      asc = fix_asc_polar(asc, armc, eps, geolat);
+      asc = hfp->asc;
+      mc = hfp->mc;
       xp[0] = swe_degnorm(xpin[0] - asc);
       if (hsys == 'V')
 	xp[0] = swe_degnorm(xp[0] + 15);
@@ -2308,12 +2626,8 @@ double CALL_CONV swe_house_pos(
     case 'O':  /* Porphyry */
     case 'B':  /* Alcabitius */
     case 'S':  /* Sripati */
-      asc = Asc1(swe_degnorm(armc + 90), geolat, sine, cose);
-      /* mc */
-      mc = armc_to_mc(armc, eps);
-      /* while MC is always south,
-       * Asc must always be in eastern hemisphere */
-      asc = fix_asc_polar(asc, armc, eps, geolat);
+      asc = hfp->asc;
+      mc = hfp->mc;
       if (hsys ==  'O' || hsys == 'S') {
 	xp[0] = swe_degnorm(xpin[0] - asc);
 	/* to make sure that a call with a house cusp position returns
@@ -2336,7 +2650,7 @@ double CALL_CONV swe_house_pos(
 	}
       } else { /* Alcabitius */
 	double dek, r, sna, sda;
-	dek = asind(sind(asc) * sine);	/* declination of Ascendant */
+	dek = asind(sind(asc) * hfp->sine);	/* declination of Ascendant */
 	/* must treat the case fi == 90 or -90 */
 	tanfi = tand(geolat);
 	r = -tanfi * tand(dek);
@@ -2365,8 +2679,7 @@ double CALL_CONV swe_house_pos(
       hpos = swe_degnorm(mdd - 90) / 30.0 + 1.0;
       break;
     case 'F': /* Carter poli-equatorial */
-      x[0] = Asc1(swe_degnorm(armc + 90), geolat, sine, cose);
-      x[0] = fix_asc_polar(x[0], armc, eps, geolat);
+      x[0] = hfp->asc;
       x[1] = 0;
       swe_cotrans(x, x, -eps);
       hpos = swe_degnorm(ra - x[0]) / 30.0 + 1;
@@ -2467,33 +2780,7 @@ double CALL_CONV swe_house_pos(
       hpos = xp[0] / 30.0 + 1;
       break;
     case 'J': // Savard-A
-      sinfi = sind(geolat);
-      if (fabs(geolat) < VERY_SMALL) {	
-	xs2 = 1 / 3.0;
-	xs1 = 2 / 3.0;
-      } else {
-	xs2 = sind(geolat / 3) / sinfi;	
-	xs1 = sind(2 * geolat / 3) / sinfi;
-      }
-      xs2 = asind(xs2);
-      xs1 = asind(xs1);
-      // xs1 and xs2 always in >= 0 < 90
-      // house borders on prime vertical are, measured from EP downwards
-      // h1 = 0, h4 = 90, h7 = 180, h10 = 270
-      // h2 = xs2, h3 = xs1, h12 = 360 - xs2, h11 = 360 - xs1
-      // h5 = h11 - 180, h6 = h12 - 180, h8 = h2 + 180, h9 = h3 + 180
-      hcusp[1] = 0;
-      hcusp[2] = xs2;
-      hcusp[3] = xs1;
-      hcusp[4] = 90;
-      hcusp[5] = 180 - xs1;
-      hcusp[6] = 180 - xs2;
-      hcusp[7] = 180;
-      hcusp[8] = 180 + xs2;
-      hcusp[9] = 180 + xs1;
-      hcusp[10] = 270;
-      hcusp[11] = 360 - xs1;
-      hcusp[12] = 360 - xs2;
+      hcusp = hfp->jcusp;
       xeq[0] = swe_degnorm(mdd - 90);
       swe_cotrans(xeq, xp, -geolat);
       a = xp[0];
@@ -2528,60 +2815,9 @@ double CALL_CONV swe_house_pos(
       }
       break;
     case 'U': /* Krusinski-Pisa-Goelzer */
-      if (fabs(geolat) < VERY_SMALL) {	/* code below does not like geolat 0 */
-        geolat = (geolat >= 0) ? VERY_SMALL : -VERY_SMALL;
-      }
-      /* Purpose: find point where planet's house circle (meridian)
-       *   cuts house plane, giving exact planet's house position.
-       * Input data: ramc, geolat, asc.
-       */
-      asc = Asc1(swe_degnorm(armc + 90), geolat, sine, cose);
-      /* while MC is always south, 
-       * Asc must always be in eastern hemisphere */
-      asc = fix_asc_polar(asc, armc, eps, geolat);
-      /*
-       * Descr: find the house plane 'asc-zenith' - where it intersects 
-       * with equator and at what angle, and then simple find arc 
-       * from asc on that plane to planet's meridian intersection 
-       * with this plane.
-       */
-      /* I. find plane of 'asc-zenith' great circle relative to equator: 
-       *   solve spherical triangle 'EP-asc-intersection of house circle with equator' */
-      /* Ia. Find intersection of house plane with equator: */
-      x[0] = asc; x[1] = 0.0; x[2] = 1.0;          /* 1. Start with ascendent on ecliptic     */
-      swe_cotrans(x, x, -eps);                     /* 2. Transform asc into equatorial coords */
-      raep = swe_degnorm(armc + 90);               /* 3. RA of east point                     */
-      x[0] = swe_degnorm(raep - x[0]);             /* 4. Rotation - found arc raas-raep      */
-      swe_cotrans(x, x, -(90-geolat));             /* 5. Transform into horizontal coords - arc EP-asc on horizon */
-      tanx = tand(x[0]);
-      if (geolat == 0) {
-        xtemp = (tanx >= 0) ? 90 : -90;
-      } else {
-	xtemp = atand(tanx/cosd((90-geolat))); /* 6. Rotation from horizon on circle perpendicular to equator */
-      }
-      if (x[0] > 90 && x[0] <= 270)
-	xtemp = swe_degnorm(xtemp + 180);
-      x[0] = swe_degnorm(xtemp);        
-      raaz = swe_degnorm(raep - x[0]); /* result: RA of intersection 'asc-zenith' great circle with equator */
-      /* Ib. Find obliquity to equator of 'asc-zenith' house plane: */
-      x[0] = raaz; x[1] = 0.0; 
-      x[0] = swe_degnorm(raep - x[0]);  /* 1. Rotate start point relative to EP   */
-      swe_cotrans(x, x, -(90-geolat));  /* 2. Transform into horizontal coords    */
-      x[1] = x[1] + 90;                 /* 3. Add 90 deg do decl - so get the point on house plane most distant from equ. */
-      swe_cotrans(x, x, 90-geolat);     /* 4. Rotate back to equator              */
-      oblaz = x[1];                     /* 5. Obliquity of house plane to equator */
-      /* II. Next find asc and planet position on house plane, 
-       *     so to find relative distance of planet from 
-       *     coords beginning. */
-      /* IIa. Asc on house plane relative to intersection 
-       *      of equator with 'asc-zenith' plane. */
-      xasc[0] = asc; xasc[1] = 0.0; xasc[2] = 1.0;
-      swe_cotrans(xasc, xasc, -eps);
-      xasc[0] = swe_degnorm(xasc[0] - raaz);
-      xtemp = atand(tand(xasc[0])/cosd(oblaz));
-      if (xasc[0] > 90 && xasc[0] <= 270)
-          xtemp = swe_degnorm(xtemp + 180);
-      xasc[0] = swe_degnorm(xtemp);
+      /* house plane 'asc-zenith' and asc on it, see house_frame_init() */
+      raaz = hfp->raaz;
+      oblaz = hfp->oblaz;
       /* IIb. Planet on house plane relative to intersection 
        *      of equator with 'asc-zenith' plane */
       xp[0] = swe_degnorm(xeq[0] - raaz);        /* Rotate on equator  */
@@ -2589,7 +2825,7 @@ double CALL_CONV swe_house_pos(
       if (xp[0] > 90 && xp[0] <= 270)
 	xtemp = swe_degnorm(xtemp + 180);
       xp[0] = swe_degnorm(xtemp);
-      xp[0] = swe_degnorm(xp[0]-xasc[0]); /* find arc between asc and planet, and get planet house position  */
+      xp[0] = swe_degnorm(xp[0]-hfp->xasc); /* find arc between asc and planet, and get planet house position  */
       /* IIc. Distance from planet to house plane on declination circle: */
       x[0] = xeq[0];
       x[1] = xeq[1];
@@ -2831,7 +3067,7 @@ double CALL_CONV swe_house_pos(
     break;
   default:
     hpos = 0;
-    if (swe_houses_armc_ex2(armc, geolat, eps, hsys, hcusp, ascmc, NULL, NULL, serr) == ERR) {
+    if (hfp->retc == ERR) {
       if (serr != NULL)
 	sprintf(serr, "swe_house_pos(): failed for system %c", hsys);
       break;
@@ -72,6 +72,15 @@
 #include "swephexp.h"
 #include "sweph.h"
 #include "swejpl.h"
+#include "swephlib.h"
+#if MSDOS
+# include <io.h>
+#else
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
 
 #if MSDOS
   typedef __int64 off_t64;
@@ -85,6 +94,31 @@
 
 #define DEBUG_DO_SHOW	FALSE
 
+#define JPL_NREC	8	/* decoded records kept per thread */
+#define JPL_NX		70	/* cached doubles per date: 10 bodies, sun, nutation */
+
+/* A DE file mapped read-only into memory. There is one mapping per file,
+ * shared by all threads and reference counted; the list of mappings is 
+ * guarded by swi_lock().
+ */
+struct jpl_map {
+  char *addr;
+  size_t len;
+  unsigned long long dev, ino;
+  AS_BOOL is_mem;	/* file registered from memory, not mapped by us */
+  int nref;
+  struct jpl_map *next;
+};
+
+static struct jpl_map *jpl_maps = NULL;
+
+/* a record of Chebyshev coefficients, converted to native byte order */
+struct jpl_rec {
+  int32 nr;		/* record number, 0 if slot is empty */
+  uint32 used;		/* time stamp of last use */
+  double *buf;
+};
+
 /*
  * local globals
  */
@@ -99,7 +133,14 @@ struct jpl_save {
   char ch_cnam[6*400];
   double pv[78];
   double pvsun[6];
-  double buf[1500];
+  int32 irecsz, ncoeffs;
+  struct jpl_map *map;
+  struct jpl_rec rec[JPL_NREC];
+  uint32 nuse;
+  int pf_n;		/* dates evaluated by swi_pleph_prefetch() */
+  int32 pf_mask;
+  double *pf_et;	/* sorted dates */
+  double *pf_x;		/* JPL_NX values per date */
   double pc[18], vc[18], ac[18], jc[18];
   short do_km;
 };
@@ -113,6 +154,11 @@ static int interp(double *buf, double t, double intv, int32 ncfin,
 static int32 fsizer(char *serr);
 static void reorder(char *x, int size, int number);
 static int read_const_jpl(double *ss, char *serr);
+static struct jpl_map *jpl_map_open(FILE *fp, char *fname, off_t64 flen);
+static void jpl_map_close(struct jpl_map *mp);
+static double *jpl_record(int32 nr, double et, char *serr);
+static int prefetch_lookup(double et, int32 *list, int do_bary, 
+		  double *pv, double *pvsun, double *nut);
 
 /* information about eh_ipt[] and buf[]
 DE200	DE102		  	DE403
@@ -649,15 +695,14 @@ static int state(double et, int32 *list, int do_bary,
   int i, j, k;
   int32 nseg;
   off_t64 flen, nb;
-  double *buf = js->buf;
+  double *buf;
   double aufac, s, t, intv, ts[4];
   int32 nrecl, ksize;
   int32 nr;
   double et_mn, et_fr;
   int32 *ipt = js->eh_ipt;
   char ch_ttl[252];
-  static TLS int32 irecsz;
-  static TLS int32 nrl, lpt[3], ncoeffs;
+  int32 irecsz, lpt[3];
   size_t nrd; /* unused, removes compile warnings */
   if (js->jplfptr == NULL) {
     ksize = fsizer(serr); /* the number of single precision words in a record */
@@ -665,7 +710,8 @@ static int state(double et, int32 *list, int do_bary,
     if (ksize == NOT_AVAILABLE)
       return NOT_AVAILABLE;
     irecsz = nrecl * ksize; 	/* record size in bytes */
-    ncoeffs = ksize / 2;	/* # of coefficients, doubles */
+    js->irecsz = irecsz;
+    js->ncoeffs = ksize / 2;	/* # of coefficients, doubles */
     /* ttl = ephemeris title, e.g.
      * "JPL Planetary Ephemeris DE404/LE404
      *  Start Epoch: JED=   625296.5-3001 DEC 21 00:00:00
@@ -722,7 +768,6 @@ static int state(double et, int32 *list, int do_bary,
     /* new 26-aug-2008: verify correct block size */
     for (i = 0; i < 3; ++i) 
       ipt[i + 36] = lpt[i];
-    nrl = 0;
     /* is file length correct? */
     /* file length */
     FSEEK(js->jplfptr, (off_t64) 0L, SEEK_END);
@@ -771,6 +816,9 @@ static int state(double et, int32 *list, int do_bary,
 	sprintf(serr, "JPL ephemeris file is corrupt; start/end date check failed. %.1f != %.1f || %.1f != %.1f", ts[0],js->eh_ss[0],ts[3],js->eh_ss[1]);
       return NOT_AVAILABLE;
     }
+    /* records are read from memory if the file can be mapped, 
+     * else from jplfptr */
+    js->map = jpl_map_open(js->jplfptr, js->jplfname, flen);
   }
   if (list == NULL) 
     return 0;
@@ -784,29 +832,15 @@ static int state(double et, int32 *list, int do_bary,
       sprintf(serr,"jd %f outside JPL eph. range %.2f .. %.2f;", et, js->eh_ss[0], js->eh_ss[1]);
     return BEYOND_EPH_LIMITS;
   }
+  if (js->pf_n > 0 && prefetch_lookup(et, list, do_bary, pv, pvsun, nut))
+    return OK;
   /*       calculate record # and relative time in interval */
   nr = (int32) ((et_mn - js->eh_ss[0]) / js->eh_ss[2]) + 2;
   if (et_mn == js->eh_ss[1]) 
     --nr;	/* end point of ephemeris, use last record */
   t = (et_mn - ((nr - 2) * js->eh_ss[2] + js->eh_ss[0]) + et_fr) / js->eh_ss[2];
-  /* read correct record if not in core */
-  if (nr != nrl) {
-    nrl = nr;
-    if (FSEEK(js->jplfptr, (off_t64) (nr * ((off_t64) irecsz)), 0) != 0) {
-      if (serr != NULL) 
-	sprintf(serr, "Read error in JPL eph. at %f\n", et);
-      return NOT_AVAILABLE;
-    }
-    for (k = 1; k <= ncoeffs; ++k) {
-      if ( fread((void *) &buf[k - 1], sizeof(double), 1, js->jplfptr) != 1) {
-	if (serr != NULL) 
-	  sprintf(serr, "Read error in JPL eph. at %f\n", et);
-	return NOT_AVAILABLE;
-      }
-      if (js->do_reorder)
-	reorder((char *) &buf[k-1], sizeof(double), 1);
-    }
-  }
+  if ((buf = jpl_record(nr, et, serr)) == NULL)
+    return NOT_AVAILABLE;
   if (js->do_km) {
     intv = js->eh_ss[2] * 86400.;
     aufac = 1.;
@@ -886,6 +920,432 @@ static int read_const_jpl(double *ss,  char *serr)
   return OK;
 } 
 
+/*
+ * Chebyshev polynomials pc[0..ncf-1] and their derivatives vc[0..ncf-1]
+ * at time t of a set of coefficients with na sub-intervals, and the 
+ * sub-interval ni, computed as in interp(). 
+ */
+static void cheby_basis(double t, int na, int ncf, double *pc, double *vc, int *ni)
+{
+  int i;
+  double dt1, temp, tc, twot;
+  if (t >= 0)
+    dt1 = floor(t);
+  else
+    dt1 = -floor(-t);
+  temp = na * t;
+  *ni = (int) (temp - dt1);
+  tc = (fmod(temp, 1.0) + dt1) * 2. - 1.;
+  twot = tc + tc;
+  pc[0] = 1;
+  pc[1] = tc;
+  vc[0] = 0;
+  vc[1] = 1;
+  vc[2] = twot + twot;
+  for (i = 2; i < ncf; ++i) 
+    pc[i] = twot * pc[i - 1] - pc[i - 2];
+  for (i = 3; i < ncf; ++i) 
+    vc[i] = twot * vc[i - 1] + pc[i - 1] + pc[i - 1] - vc[i - 2];
+}
+
+/*
+ * position and velocity of the ncm components of a set of coefficients,
+ * from the polynomials of cheby_basis(); the same sums as in interp() 
+ */
+static void cheby_eval(double *buf, int ncf, int ncm, int ni, double bma, 
+		  double *pc, double *vc, double *pv)
+{
+  int i, j;
+  double *b;
+  for (i = 0; i < ncm; ++i) {
+    b = buf + (i + ni * ncm) * ncf;
+    pv[i] = 0.;
+    for (j = ncf-1; j >= 0; --j) 
+      pv[i] += pc[j] * b[j];
+    pv[i + ncm] = 0.;
+    for (j = ncf-1; j >= 1; --j) 
+      pv[i + ncm] += vc[j] * b[j];
+    pv[i + ncm] *= bma;
+  }
+}
+
+static int dcmp(const void *a, const void *b)
+{
+  double d = *(const double *) a - *(const double *) b;
+  return d < 0 ? -1 : (d > 0 ? 1 : 0);
+}
+
+static void prefetch_free(void)
+{
+  if (js->pf_et != NULL)
+    FREE((void *) js->pf_et);
+  if (js->pf_x != NULL)
+    FREE((void *) js->pf_x);
+  js->pf_et = js->pf_x = NULL;
+  js->pf_n = 0;
+}
+
+/*
+ * Evaluates the bodies in mask at the times et[0..n-1] in one batch.
+ * The times are sorted, so that all times within a record are done 
+ * together while the record is at hand, and all bodies with the same 
+ * number of sub-intervals share the Chebyshev polynomials of a time.
+ * The barycentric states and the nutations are kept, exactly as state() 
+ * computes them, until the next call. Times outside the file are left 
+ * to state(). n = 0 frees the cache.
+ */
+int swi_pleph_prefetch(const double *et, int n, int32 mask, char *serr)
+{
+  int i, k, m, ib, nb, ncf, ncfmax, ni;
+  int32 nr, nrl = -1;
+  int32 *ipt;
+  int nabas[13], nibas[13];
+  double pcbas[13][18], vcbas[13][18];
+  double s, t, et_mn, et_fr, intv, aufac, bma;
+  double *buf = NULL, *x;
+  if (js == NULL)
+    return OK;
+  prefetch_free();
+  if (et == NULL || n <= 0)
+    return OK;
+  ipt = js->eh_ipt;
+  if (js->eh_ipt[34] <= 0)
+    mask &= ~(1 << J_NUT);
+  if (mask & (1 << J_MOON))	/* Moon needs Earth */
+    mask |= (1 << J_EARTH);
+  if (mask & (1 << J_EARTH))	/* Earth needs Moon */
+    mask |= (1 << J_MOON);
+  for (i = 0, ncfmax = ipt[31]; i < 12; i++) {
+    if (i < 10 && !(mask & (1 << i)))
+      continue;
+    if (i == 11 && !(mask & (1 << J_NUT)))
+      continue;
+    if (ipt[i * 3 + 1] > ncfmax)
+      ncfmax = ipt[i * 3 + 1];
+  }
+  if (ncfmax > 18)	/* beyond the arrays of interp() */
+    return OK;
+  if ((js->pf_et = (double *) MALLOC(n * sizeof(double))) == NULL)
+    return OK;
+  for (i = 0, m = 0; i < n; i++) {
+    if (et[i] >= js->eh_ss[0] && et[i] <= js->eh_ss[1])
+      js->pf_et[m++] = et[i];
+  }
+  qsort((void *) js->pf_et, (size_t) m, sizeof(double), dcmp);
+  for (i = 0, k = 0; i < m; i++) {
+    if (k == 0 || js->pf_et[i] != js->pf_et[k - 1])
+      js->pf_et[k++] = js->pf_et[i];
+  }
+  m = k;
+  if (m == 0 || (js->pf_x = (double *) MALLOC(m * JPL_NX * sizeof(double))) == NULL) {
+    prefetch_free();
+    return OK;
+  }
+  if (js->do_km) {
+    intv = js->eh_ss[2] * 86400.;
+    aufac = 1.;
+  } else {
+    intv = js->eh_ss[2];
+    aufac = 1. / js->eh_au;
+  }
+  for (k = 0; k < m; k++) {
+    x = js->pf_x + k * JPL_NX;
+    /* record # and relative time in interval, as in state() */
+    s = js->pf_et[k] - .5;
+    et_mn = floor(s);
+    et_fr = s - et_mn;
+    et_mn += .5;
+    nr = (int32) ((et_mn - js->eh_ss[0]) / js->eh_ss[2]) + 2;
+    if (et_mn == js->eh_ss[1]) 
+      --nr;
+    t = (et_mn - ((nr - 2) * js->eh_ss[2] + js->eh_ss[0]) + et_fr) / js->eh_ss[2];
+    if (nr != nrl && (buf = jpl_record(nr, js->pf_et[k], serr)) == NULL) {
+      prefetch_free();
+      return NOT_AVAILABLE;
+    }
+    nrl = nr;
+    /* sun, bodies 0..9, nutation; the sun at index 10 has its pointers 
+     * in ipt[30..32], the nutation in ipt[33..35] */
+    for (i = 0, nb = 0; i < 12; i++) {
+      if (i < 10 && !(mask & (1 << i)))
+	continue;
+      if (i == 11 && !(mask & (1 << J_NUT)))
+	continue;
+      for (ib = 0; ib < nb; ib++) {
+	if (nabas[ib] == ipt[i * 3 + 2])
+	  break;
+      }
+      if (ib == nb) {
+	nabas[nb] = ipt[i * 3 + 2];
+	cheby_basis(t, nabas[nb], ncfmax, pcbas[nb], vcbas[nb], &nibas[nb]);
+	nb++;
+      }
+      ncf = ipt[i * 3 + 1];
+      bma = (nabas[ib] + nabas[ib]) / intv;
+      if (i == 11) {
+	cheby_eval(&buf[(int) ipt[33] - 1], ncf, 2, nibas[ib], bma, 
+		  pcbas[ib], vcbas[ib], x + 66);
+	continue;
+      }
+      cheby_eval(&buf[(int) ipt[i * 3] - 1], ncf, 3, nibas[ib], bma, 
+		  pcbas[ib], vcbas[ib], x + i * 6);
+      for (ni = 0; ni < 6; ni++)
+	x[i * 6 + ni] *= aufac;
+    }
+  }
+  js->pf_n = m;
+  js->pf_mask = mask;
+  return OK;
+}
+
+size_t swi_jpl_prefetch_range(double et0, double et1)
+{
+  int32 nr0, nr1, nrmax;
+  size_t pos0, pos1, pos;
+  volatile char c;
+  if (js == NULL || js->map == NULL || et1 < et0)
+    return 0;
+  if (et0 < js->eh_ss[0])
+    et0 = js->eh_ss[0];
+  if (et1 > js->eh_ss[1])
+    et1 = js->eh_ss[1];
+  if (et1 < et0)
+    return 0;
+  nrmax = (int32) (js->map->len / js->irecsz) - 1;
+  nr0 = (int32) ((et0 - js->eh_ss[0]) / js->eh_ss[2]) + 2;
+  nr1 = (int32) ((et1 - js->eh_ss[0]) / js->eh_ss[2]) + 2;
+  if (nr1 > nrmax)
+    nr1 = nrmax;
+  if (nr0 > nr1)
+    return 0;
+  pos0 = (size_t) nr0 * js->irecsz;
+  pos1 = (size_t) (nr1 + 1) * js->irecsz;
+#if !MSDOS && defined(MADV_WILLNEED)
+  if (!js->map->is_mem) {
+    size_t pg = (size_t) sysconf(_SC_PAGESIZE), a = pos0 - pos0 % pg;
+    madvise(js->map->addr + a, pos1 - a, MADV_WILLNEED);
+  }
+#endif
+  /* touch every page, so that the first access does not fault */
+  for (pos = pos0; pos < pos1; pos += 4096)
+    c = js->map->addr[pos];
+  c = js->map->addr[pos1 - 1];
+  (void) c;
+  return pos1 - pos0;
+}
+
+/* 
+ * If the time et and everything state() is asked for has been evaluated 
+ * by swi_pleph_prefetch(), copies it into pv, pvsun and nut and returns
+ * TRUE.
+ */
+static int prefetch_lookup(double et, int32 *list, int do_bary, 
+		  double *pv, double *pvsun, double *nut)
+{
+  int i, j, lo = 0, hi = js->pf_n - 1, mid;
+  double *x;
+  if (list[11] > 0)
+    return FALSE;
+  if (list[10] > 0 && js->eh_ipt[34] > 0 && !(js->pf_mask & (1 << J_NUT)))
+    return FALSE;
+  for (i = 0; i < 10; i++) {
+    if (list[i] > 0 && (list[i] > 2 || !(js->pf_mask & (1 << i))))
+      return FALSE;
+  }
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (js->pf_et[mid] < et)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (js->pf_et[lo] != et)
+    return FALSE;
+  x = js->pf_x + lo * JPL_NX;
+  for (i = 0; i < 6; ++i) 
+    pvsun[i] = x[60 + i];
+  for (i = 0; i < 10; ++i) {
+    if (list[i] > 0) {
+      for (j = 0; j < 6; ++j) {
+	if (i < 9 && ! do_bary) 
+	  pv[j + i * 6] = x[j + i * 6] - pvsun[j];
+	else
+	  pv[j + i * 6] = x[j + i * 6];
+      }
+    }
+  }
+  if (list[10] > 0 && js->eh_ipt[34] > 0) {
+    for (i = 0; i < 4; ++i) 
+      nut[i] = x[66 + i];
+  }
+  return TRUE;
+}
+
+/* 
+ * Returns the coefficients of record nr. In a mapped file in native 
+ * byte order, the record is used in place. Otherwise it is read or 
+ * copied from the map and converted to native byte order once, into 
+ * a small cache of recently used records.
+ */
+static double *jpl_record(int32 nr, double et, char *serr)
+{
+  int i;
+  off_t64 pos = nr * (off_t64) js->irecsz;
+  size_t nbytes = js->ncoeffs * sizeof(double);
+  AS_BOOL in_map = (js->map != NULL && pos >= 0
+		    && (size_t) pos + nbytes <= js->map->len);
+  struct jpl_rec *rp = &js->rec[0];
+  if (in_map && !js->do_reorder && (size_t) (js->map->addr + pos) % sizeof(double) == 0)
+    return (double *) (js->map->addr + pos);
+  js->nuse++;
+  for (i = 0; i < JPL_NREC; i++) {
+    if (js->rec[i].nr == nr) {
+      js->rec[i].used = js->nuse;
+      return js->rec[i].buf;
+    }
+    if (js->rec[i].used < rp->used)
+      rp = &js->rec[i];
+  }
+  rp->nr = 0;
+  rp->used = 0;
+  if (rp->buf == NULL && (rp->buf = (double *) MALLOC(nbytes)) == NULL) {
+    if (serr != NULL)
+      strcpy(serr, "error in malloc() with JPL ephemeris.");
+    return NULL;
+  }
+  if (in_map) {
+    memcpy(rp->buf, js->map->addr + pos, nbytes);
+  } else if (swi_pread(js->jplfptr, (void *) rp->buf, nbytes, (long long) pos) != nbytes) {
+    if (serr != NULL) 
+      sprintf(serr, "Read error in JPL eph. at %f\n", et);
+    return NULL;
+  }
+  if (js->do_reorder)
+    reorder((char *) rp->buf, sizeof(double), js->ncoeffs);
+  rp->nr = nr;
+  rp->used = js->nuse;
+  return rp->buf;
+}
+
+/*
+ * Maps the DE file fp of length flen read-only into memory, or returns 
+ * the mapping another thread has already made of the same file. 
+ * Returns NULL if the file cannot be mapped, e.g. if it does not fit 
+ * into the address space; it is then read with swi_pread().
+ */
+static struct jpl_map *jpl_map_open(FILE *fp, char *fname, off_t64 flen)
+{
+  struct jpl_map *mp;
+  unsigned long long dev, ino;
+  char *addr;
+  const void *mbuf;
+  size_t mlen;
+  /* a file registered from memory is used as it is */
+  if ((mbuf = swi_mem_lookup(fname, &mlen)) != NULL) {
+    if ((off_t64) mlen != flen)
+      return NULL;
+    swi_lock();
+    for (mp = jpl_maps; mp != NULL; mp = mp->next) {
+      if (mp->is_mem && mp->addr == (char *) mbuf && mp->len == mlen) {
+	mp->nref++;
+	break;
+      }
+    }
+    if (mp == NULL && (mp = (struct jpl_map *) CALLOC(1, sizeof(struct jpl_map))) != NULL) {
+      mp->addr = (char *) mbuf;
+      mp->len = mlen;
+      mp->is_mem = TRUE;
+      mp->nref = 1;
+      mp->next = jpl_maps;
+      jpl_maps = mp;
+    }
+    swi_unlock();
+    return mp;
+  }
+#if MSDOS
+  HANDLE fh, mh;
+  BY_HANDLE_FILE_INFORMATION fi;
+  fh = (HANDLE) _get_osfhandle(_fileno(fp));
+  if (fh == INVALID_HANDLE_VALUE || !GetFileInformationByHandle(fh, &fi))
+    return NULL;
+  dev = fi.dwVolumeSerialNumber;
+  ino = ((unsigned long long) fi.nFileIndexHigh << 32) | fi.nFileIndexLow;
+#else
+  struct stat st;
+  if (fstat(fileno(fp), &st) != 0)
+    return NULL;
+  dev = (unsigned long long) st.st_dev;
+  ino = (unsigned long long) st.st_ino;
+#endif
+  if (flen <= 0 || (unsigned long long) flen > (unsigned long long) ((size_t) -1))
+    return NULL;
+  swi_lock();
+  for (mp = jpl_maps; mp != NULL; mp = mp->next) {
+    if (!mp->is_mem && mp->dev == dev && mp->ino == ino && mp->len == (size_t) flen) {
+      mp->nref++;
+      goto end_map_open;
+    }
+  }
+#if MSDOS
+  addr = NULL;
+  if ((mh = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL)) != NULL) {
+    addr = (char *) MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mh);
+  }
+  if (addr == NULL)
+    goto end_map_open;
+#else
+  addr = (char *) mmap(NULL, (size_t) flen, PROT_READ, MAP_SHARED, fileno(fp), 0);
+  if (addr == (char *) MAP_FAILED) {
+    addr = NULL;
+    goto end_map_open;
+  }
+#endif
+  if ((mp = (struct jpl_map *) CALLOC(1, sizeof(struct jpl_map))) == NULL) {
+#if MSDOS
+    UnmapViewOfFile(addr);
+#else
+    munmap(addr, (size_t) flen);
+#endif
+    goto end_map_open;
+  }
+  mp->addr = addr;
+  mp->len = (size_t) flen;
+  mp->dev = dev;
+  mp->ino = ino;
+  mp->nref = 1;
+  mp->next = jpl_maps;
+  jpl_maps = mp;
+end_map_open:
+  swi_unlock();
+  return mp;
+}
+
+static void jpl_map_close(struct jpl_map *mp)
+{
+  struct jpl_map **mpp;
+  if (mp == NULL)
+    return;
+  swi_lock();
+  if (--mp->nref == 0) {
+    for (mpp = &jpl_maps; *mpp != NULL; mpp = &(*mpp)->next) {
+      if (*mpp == mp) {
+	*mpp = mp->next;
+	break;
+      }
+    }
+    if (!mp->is_mem) {
+#if MSDOS
+      UnmapViewOfFile(mp->addr);
+#else
+      munmap(mp->addr, mp->len);
+#endif
+    }
+    FREE((void *) mp);
+  }
+  swi_unlock();
+}
+
 static void reorder(char *x, int size, int number) 
 {
   int i, j;
@@ -903,7 +1363,14 @@ static void reorder(char *x, int size, int number)
 
 void swi_close_jpl_file(void)
 {
+  int i;
   if (js != NULL) {
+    prefetch_free();
+    jpl_map_close(js->map);
+    for (i = 0; i < JPL_NREC; i++) {
+      if (js->rec[i].buf != NULL)
+	FREE((void *) js->rec[i].buf);
+    }
     if (js->jplfptr != NULL)
       fclose(js->jplfptr);
     if (js->jplfname != NULL) 
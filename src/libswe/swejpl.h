@@ -89,6 +89,20 @@
  */
 extern int swi_pleph(double et, int ntarg, int ncent, double *rrd, char *serr);
 
+/*
+ * evaluate the bodies in mask (bits 1 << J_MERCURY .. 1 << J_MOON, and
+ * 1 << J_NUT for nutations) at the times et[0..n-1] in one batch, record
+ * by record; swi_pleph() then takes them from this cache.
+ * n = 0 frees the cache.
+ */
+extern int swi_pleph_prefetch(const double *et, int n, int32 mask, char *serr);
+
+/*
+ * page the records for the times et0 .. et1 of a mapped file into memory;
+ * returns their size in bytes, 0 if the file is not mapped
+ */
+extern size_t swi_jpl_prefetch_range(double et0, double et1);
+
 /*
  * read the ephemeris constants. ss[0..2] returns start, end and granule size.
  * If do_show is TRUE, a list of constants is printed to stdout.
@@ -182,17 +182,24 @@
 #include "sweph.h"
 #include "swephlib.h"
 
-static void mean_elements(void);
-static void mean_elements_pl(void);
+struct moon_state;
+static void mean_elements(struct moon_state *ms);
+static void mean_elements_pl(struct moon_state *ms);
 static double mods3600(double x);
 static void ecldat_equ2000(double tjd, double *xpm);
-static void chewm(const short *pt, int nlines, int nangles, 
+static void chewm(struct moon_state *ms, const short *pt, int nlines, int nangles, 
   				     int typflg, double *ans );
-static void sscc(int k, double arg, int n );
-static void moon1(void);
-static void moon2(void);
-static void moon3(void);
-static void moon4(void);
+static void sscc(struct moon_state *ms, int k, double arg, int n );
+static void moon1(struct moon_state *ms);
+static void moon2(struct moon_state *ms);
+static void moon3(struct moon_state *ms);
+static void moon3_sum(struct moon_state *ms);
+static void moon4(struct moon_state *ms);
+
+#define MOON_NBATCH 4
+static void chewm_batch(const short *pt, int nlines, int nangles, int typflg,
+  double ss[5][8][MOON_NBATCH], double cc[5][8][MOON_NBATCH],
+  double ans[3][MOON_NBATCH]);
 
 
 #ifdef MOSH_MOON_200
@@ -804,63 +811,111 @@ static const double mean_apsis_corr[] = {
 10.986, 11.25, 11.52,
 };
 
-/* The following times are set up by update() and refer
- * to the same instant.  The distinction between them
- * is required by altaz().
+/* State of the Moshier lunar theory for one date. Each call keeps its
+ * own, so the theory is reentrant, and swi_moshmoon2_batch() keeps one
+ * per date of a batch.
  */
-static TLS double ss[5][8]; 
-static TLS double cc[5][8];
-
-static TLS double l;		/* Moon's ecliptic longitude */
-static TLS double B;		/* Ecliptic latitude */
-
-static TLS double moonpol[3];
-
-/* Orbit calculation begins.
- */
-static TLS double SWELP;
-static TLS double M;
-static TLS double MP;
-static TLS double D;
-static TLS double NF;
-static TLS double T;
-static TLS double T2;
-
-static TLS double T3;
-static TLS double T4;
-static TLS double f;
-static TLS double g;
-static TLS double Ve;
-static TLS double Ea;
-static TLS double Ma;
-static TLS double Ju;
-static TLS double Sa;
-static TLS double cg;
-static TLS double sg;
-static TLS double l1;
-static TLS double l2;
-static TLS double l3;
-static TLS double l4;
+struct moon_state {
+  double ss[5][8];
+  double cc[5][8];
+  double l;		/* Moon's ecliptic longitude */
+  double B;		/* Ecliptic latitude */
+  double moonpol[3];
+  /* Orbit calculation begins. */
+  double SWELP;
+  double M;
+  double MP;
+  double D;
+  double NF;
+  double T;
+  double T2;
+  double T3;
+  double T4;
+  double f;
+  double g;
+  double Ve;
+  double Ea;
+  double Ma;
+  double Ju;
+  double Sa;
+  double cg;
+  double sg;
+  double l1;
+  double l2;
+  double l3;
+  double l4;
+};
 
 /* Calculate geometric coordinates of Moon
  * without light time or nutation correction.
  */
 int swi_moshmoon2(double J, double *pol)
 {
+struct moon_state mst, *ms = &mst;
 int i;
-T = (J-J2000)/36525.0;
-T2 = T*T;
-mean_elements();
-mean_elements_pl();
-moon1();
-moon2();
-moon3();
-moon4();
+ms->T = (J-J2000)/36525.0;
+ms->T2 = ms->T*ms->T;
+mean_elements(ms);
+mean_elements_pl(ms);
+moon1(ms);
+moon2(ms);
+moon3(ms);
+moon4(ms);
 for( i=0; i<3; i++ ) 
-  pol[i] = moonpol[i];
+  pol[i] = ms->moonpol[i];
 return(0);
 }
 
+/* Same as swi_moshmoon2(), for nb dates J[0..nb-1] at once; pol receives
+ * 3 values per date. The large tables LR and MB are walked once per group
+ * of MOON_NBATCH dates and evaluated for all dates of the group in loops
+ * of fixed length (a short last group is padded with its last date).
+ * The operations per date are the same as in swi_moshmoon2().
+ */
+int swi_moshmoon2_batch(const double *J, int nb, double *pol)
+{
+  struct moon_state mst[MOON_NBATCH], *ms;
+  double ss[5][8][MOON_NBATCH], cc[5][8][MOON_NBATCH];
+  double ans[3][MOON_NBATCH];
+  int i, j, k, l, n, i0;
+  for (i0 = 0; i0 < nb; i0 += MOON_NBATCH) {
+    n = nb - i0;
+    if (n > MOON_NBATCH)
+      n = MOON_NBATCH;
+    for (l = 0; l < MOON_NBATCH; l++) {
+      ms = &mst[l];
+      ms->T = (J[i0 + (l < n ? l : n - 1)] - J2000) / 36525.0;
+      ms->T2 = ms->T * ms->T;
+      mean_elements(ms);
+      mean_elements_pl(ms);
+      moon1(ms);
+      moon2(ms);
+      for (j = 0; j < 5; j++) {
+	for (k = 0; k < 8; k++) {
+	  ss[j][k][l] = ms->ss[j][k];
+	  cc[j][k][l] = ms->cc[j][k];
+	}
+      }
+      /* moon3(), terms in T^0 */
+      ans[0][l] = 0.0;
+      ans[1][l] = ms->moonpol[1];
+      ans[2][l] = ms->moonpol[2];
+    }
+    chewm_batch(LR, NLR, 4, 1, ss, cc, ans);
+    chewm_batch(MB, NMB, 4, 3, ss, cc, ans);
+    for (l = 0; l < n; l++) {
+      ms = &mst[l];
+      for (i = 0; i < 3; i++)
+	ms->moonpol[i] = ans[i][l];
+      moon3_sum(ms);
+      moon4(ms);
+      for (i = 0; i < 3; i++)
+	pol[3 * (i0 + l) + i] = ms->moonpol[i];
+    }
+  }
+  return(0);
+}
+
 /* Moshier's moom
  * tjd		julian day
  * xpm		array of 6 doubles for moon's position and speed vectors
@@ -869,7 +924,7 @@ return(0);
 int swi_moshmoon(double tjd, AS_BOOL do_save, double *xpmret, char *serr) 
 {
   int i;
-  double a, b, x1[6], x2[6], t;
+  double a, b, x1[6], x2[6], t, t3[3], x3[9];
   double xx[6], *xpm;
   struct plan_data *pdp = &swed.pldat[SEI_MOON];
   char s[AS_MAXCH];
@@ -894,8 +949,16 @@ int swi_moshmoon(double tjd, AS_BOOL do_save, double *xpmret, char *serr)
 	xpmret[i] = pdp->x[i];
     return(OK);
   }
-  /* else compute moon */
-  swi_moshmoon2(tjd, xpm);
+  /* else compute moon, together with the 2 positions for the speed */
+  t3[0] = tjd;
+  t3[1] = tjd + MOON_SPEED_INTV;
+  t3[2] = tjd - MOON_SPEED_INTV;
+  swi_moshmoon2_batch(t3, 3, x3);
+  for (i = 0; i <= 2; i++) {
+    xpm[i] = x3[i];
+    x1[i] = x3[3 + i];
+    x2[i] = x3[6 + i];
+  }
   if (do_save) {
     pdp->teval = tjd;
     pdp->xflgs = -1;
@@ -913,10 +976,8 @@ int swi_moshmoon(double tjd, AS_BOOL do_save, double *xpmret, char *serr)
   /* one would be good enough for computation of osculating node, 
    * but not for osculating apogee */
   t = tjd + MOON_SPEED_INTV;
-  swi_moshmoon2(t, x1);
   ecldat_equ2000(t, x1);
   t = tjd - MOON_SPEED_INTV;
-  swi_moshmoon2(t, x2);
   ecldat_equ2000(t, x2);
   for (i = 0; i <= 2; i++) {
 #if 0
@@ -934,252 +995,252 @@ int swi_moshmoon(double tjd, AS_BOOL do_save, double *xpmret, char *serr)
 }
 
 #ifdef MOSH_MOON_200
-static void  moon1()
+static void  moon1(struct moon_state *ms)
 {
 double a;
 
-sscc( 0, STR*D, 6 );
-sscc( 1, STR*M,  4 );
-sscc( 2, STR*MP, 4 );
-sscc( 3, STR*NF, 4 );
+sscc(ms, 0, STR*ms->D, 6 );
+sscc(ms, 1, STR*ms->M,  4 );
+sscc(ms, 2, STR*ms->MP, 4 );
+sscc(ms, 3, STR*ms->NF, 4 );
 
-moonpol[0] = 0.0;
-moonpol[1] = 0.0;
-moonpol[2] = 0.0;
+ms->moonpol[0] = 0.0;
+ms->moonpol[1] = 0.0;
+ms->moonpol[2] = 0.0;
 
 /* terms in T^2, scale 1.0 = 10^-5" */
-chewm( LRT2, NLRT2, 4, 2, moonpol );
-chewm( BT2, NBT2, 4, 4, moonpol );
-
-f = 18 * Ve - 16 * Ea;
-
-g = STR*(f - MP );  /* 18V - 16E - l */
-cg = cos(g);
-sg = sin(g);
-l = 6.367278 * cg + 12.747036 * sg;  /* t^0 */
-l1 = 23123.70 * cg - 10570.02 * sg;  /* t^1 */
-l2 = z[24] * cg + z[25] * sg;        /* t^2 */
-l3 = z[26] * cg + z[27] * sg;        /* t^3 */
-l4 = z[28] * cg + z[29] * sg;        /* t^4 */
-moonpol[2] += 5.01 * cg + 2.72 * sg;
-
-g = STR * (10.*Ve - 3.*Ea - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.253102 * cg + 0.503359 * sg;
-l1 += 1258.46 * cg + 707.29 * sg;
-l2 += z[30] * cg + z[31] * sg;
-l3 += z[32] * cg + z[33] * sg;
-l4 += z[34] * cg + z[35] * sg;
-
-g = STR*(8.*Ve - 13.*Ea);
-cg = cos(g);
-sg = sin(g);
-l += -0.187231 * cg - 0.127481 * sg;
-l1 += -319.87 * cg - 18.34 * sg;
-l2 += z[36] * cg + z[37] * sg;
-l3 += z[38] * cg + z[39] * sg;
-l4 += z[40] * cg + z[41] * sg;
-
-a = 4.0*Ea - 8.0*Ma + 3.0*Ju;
-g = STR * a;
-cg = cos(g);
-sg = sin(g);
-l += -0.866287 * cg + 0.248192 * sg;
-l1 += 41.87 * cg + 1053.97 * sg;
-l2 += z[42] * cg + z[43] * sg;
-
-g = STR*(a - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.165009 * cg + 0.044176 * sg;
-l1 += 4.67 * cg + 201.55 * sg;
-
-
-g = STR*f;  /* 18V - 16E */
-cg = cos(g);
-sg = sin(g);
-l += 0.330401 * cg + 0.661362 * sg;
-l1 += 1202.67 * cg - 555.59 * sg;
-l2 += z[44] * cg + z[45] * sg;
-l3 += z[46] * cg + z[47] * sg;
-
-g = STR*(f - 2.0*MP );  /* 18V - 16E - 2l */
-cg = cos(g);
-sg = sin(g);
-l += 0.352185 * cg + 0.705041 * sg;
-l1 += 1283.59 * cg - 586.43 * sg;
-l2 += z[48] * cg + z[49] * sg;
-l3 += z[50] * cg + z[51] * sg;
-
-g = STR * (2.0*Ju - 5.0*Sa);
-cg = cos(g);
-sg = sin(g);
-l += -0.034700 * cg + 0.160041 * sg;
-l2 += z[52] * cg + z[53] * sg;
-
-g = STR * (SWELP - NF);
-cg = cos(g);
-sg = sin(g);
-l += 0.000116 * cg + 7.063040 * sg;
-l1 +=  298.8 * sg;
-l2 += z[54] * cg + z[55] * sg;
+chewm(ms, LRT2, NLRT2, 4, 2, ms->moonpol );
+chewm(ms, BT2, NBT2, 4, 4, ms->moonpol );
+
+ms->f = 18 * ms->Ve - 16 * ms->Ea;
+
+ms->g = STR*(ms->f - ms->MP );  /* 18V - 16E - l */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l = 6.367278 * ms->cg + 12.747036 * ms->sg;  /* t^0 */
+ms->l1 = 23123.70 * ms->cg - 10570.02 * ms->sg;  /* t^1 */
+ms->l2 = z[24] * ms->cg + z[25] * ms->sg;        /* t^2 */
+ms->l3 = z[26] * ms->cg + z[27] * ms->sg;        /* t^3 */
+ms->l4 = z[28] * ms->cg + z[29] * ms->sg;        /* t^4 */
+ms->moonpol[2] += 5.01 * ms->cg + 2.72 * ms->sg;
+
+ms->g = STR * (10.*ms->Ve - 3.*ms->Ea - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.253102 * ms->cg + 0.503359 * ms->sg;
+ms->l1 += 1258.46 * ms->cg + 707.29 * ms->sg;
+ms->l2 += z[30] * ms->cg + z[31] * ms->sg;
+ms->l3 += z[32] * ms->cg + z[33] * ms->sg;
+ms->l4 += z[34] * ms->cg + z[35] * ms->sg;
+
+ms->g = STR*(8.*ms->Ve - 13.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.187231 * ms->cg - 0.127481 * ms->sg;
+ms->l1 += -319.87 * ms->cg - 18.34 * ms->sg;
+ms->l2 += z[36] * ms->cg + z[37] * ms->sg;
+ms->l3 += z[38] * ms->cg + z[39] * ms->sg;
+ms->l4 += z[40] * ms->cg + z[41] * ms->sg;
+
+a = 4.0*ms->Ea - 8.0*ms->Ma + 3.0*ms->Ju;
+ms->g = STR * a;
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.866287 * ms->cg + 0.248192 * ms->sg;
+ms->l1 += 41.87 * ms->cg + 1053.97 * ms->sg;
+ms->l2 += z[42] * ms->cg + z[43] * ms->sg;
+
+ms->g = STR*(a - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.165009 * ms->cg + 0.044176 * ms->sg;
+ms->l1 += 4.67 * ms->cg + 201.55 * ms->sg;
+
+
+ms->g = STR*ms->f;  /* 18V - 16E */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.330401 * ms->cg + 0.661362 * ms->sg;
+ms->l1 += 1202.67 * ms->cg - 555.59 * ms->sg;
+ms->l2 += z[44] * ms->cg + z[45] * ms->sg;
+ms->l3 += z[46] * ms->cg + z[47] * ms->sg;
+
+ms->g = STR*(ms->f - 2.0*ms->MP );  /* 18V - 16E - 2l */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.352185 * ms->cg + 0.705041 * ms->sg;
+ms->l1 += 1283.59 * ms->cg - 586.43 * ms->sg;
+ms->l2 += z[48] * ms->cg + z[49] * ms->sg;
+ms->l3 += z[50] * ms->cg + z[51] * ms->sg;
+
+ms->g = STR * (2.0*ms->Ju - 5.0*ms->Sa);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.034700 * ms->cg + 0.160041 * ms->sg;
+ms->l2 += z[52] * ms->cg + z[53] * ms->sg;
+
+ms->g = STR * (ms->SWELP - ms->NF);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.000116 * ms->cg + 7.063040 * ms->sg;
+ms->l1 +=  298.8 * ms->sg;
+ms->l2 += z[54] * ms->cg + z[55] * ms->sg;
 
 
 /* T^3 terms */
-sg = sin( STR * M );
-l3 +=  z[56] * sg;
-l4 +=  z[57] * sg;
+ms->sg = sin( STR * ms->M );
+ms->l3 +=  z[56] * ms->sg;
+ms->l4 +=  z[57] * ms->sg;
 
-g = STR * (2.0*D - M);
-sg = sin(g);
-cg = cos(g);
-l3 +=  z[58] * sg;
-l4 +=  z[59] * sg;
-moonpol[2] +=  -0.2655 * cg * T;
+ms->g = STR * (2.0*ms->D - ms->M);
+ms->sg = sin(ms->g);
+ms->cg = cos(ms->g);
+ms->l3 +=  z[58] * ms->sg;
+ms->l4 +=  z[59] * ms->sg;
+ms->moonpol[2] +=  -0.2655 * ms->cg * ms->T;
 
-g = g - STR * MP;
-sg = sin(g);
-l3 +=  z[60] * sg;
-l4 +=  z[61] * sg;
+ms->g = ms->g - STR * ms->MP;
+ms->sg = sin(ms->g);
+ms->l3 +=  z[60] * ms->sg;
+ms->l4 +=  z[61] * ms->sg;
 
-g = STR * (M - MP);
-l3 +=  z[62] * sin( g );
-moonpol[2] +=  -0.1568 * cos( g ) * T;
+ms->g = STR * (ms->M - ms->MP);
+ms->l3 +=  z[62] * sin( ms->g );
+ms->moonpol[2] +=  -0.1568 * cos( ms->g ) * ms->T;
 
-g = STR * (M + MP);
-l3 +=  z[63] * sin( g );
-moonpol[2] +=  0.1309 * cos( g ) * T;
+ms->g = STR * (ms->M + ms->MP);
+ms->l3 +=  z[63] * sin( ms->g );
+ms->moonpol[2] +=  0.1309 * cos( ms->g ) * ms->T;
 
-g = STR * 2.0 * (D - M);
-sg = sin(g);
-l3 +=  z[64] * sg;
-l4 +=  z[65] * sg;
+ms->g = STR * 2.0 * (ms->D - ms->M);
+ms->sg = sin(ms->g);
+ms->l3 +=  z[64] * ms->sg;
+ms->l4 +=  z[65] * ms->sg;
 
-g = STR * 2.0 * M;
-sg = sin(g);
-l3 +=  z[66] * sg;
-l4 +=  z[67] * sg;
+ms->g = STR * 2.0 * ms->M;
+ms->sg = sin(ms->g);
+ms->l3 +=  z[66] * ms->sg;
+ms->l4 +=  z[67] * ms->sg;
 
-g = STR * (2.0*D - MP);
-sg = sin(g);
-l3 +=  z[68] * sg;
+ms->g = STR * (2.0*ms->D - ms->MP);
+ms->sg = sin(ms->g);
+ms->l3 +=  z[68] * ms->sg;
 
-g = STR * (2.0*(D - M) - MP);
-sg = sin(g);
-l3 +=  z[69] * sg;
+ms->g = STR * (2.0*(ms->D - ms->M) - ms->MP);
+ms->sg = sin(ms->g);
+ms->l3 +=  z[69] * ms->sg;
 
-g = STR * (2.0*(D + M) - MP);
-sg = sin(g);
-cg = cos(g);
-l3 +=  z[70] * sg;
-moonpol[2] +=   0.5568 * cg * T;
+ms->g = STR * (2.0*(ms->D + ms->M) - ms->MP);
+ms->sg = sin(ms->g);
+ms->cg = cos(ms->g);
+ms->l3 +=  z[70] * ms->sg;
+ms->moonpol[2] +=   0.5568 * ms->cg * ms->T;
 
-l2 += moonpol[0];
+ms->l2 += ms->moonpol[0];
 
-g = STR*(2.0*D - M - MP);
-moonpol[2] +=  -0.1910 * cos( g ) * T;
+ms->g = STR*(2.0*ms->D - ms->M - ms->MP);
+ms->moonpol[2] +=  -0.1910 * cos( ms->g ) * ms->T;
 
 
-moonpol[1] *= T;
-moonpol[2] *= T;
+ms->moonpol[1] *= ms->T;
+ms->moonpol[2] *= ms->T;
 
 /* terms in T */
-moonpol[0] = 0.0;
-chewm( BT, NBT, 4, 4, moonpol );
-chewm( LRT, NLRT, 4, 1, moonpol );
-g = STR*(f - MP - NF - 2355767.6); /* 18V - 16E - l - F */
-moonpol[1] +=  -1127. * sin(g);
-g = STR*(f - MP + NF - 235353.6); /* 18V - 16E - l + F */
-moonpol[1] +=  -1123. * sin(g);
-g = STR*(Ea + D + 51987.6);
-moonpol[1] +=  1303. * sin(g);
-g = STR*SWELP;
-moonpol[1] +=  342. * sin(g);
-
-
-g = STR*(2.*Ve - 3.*Ea);
-cg = cos(g);
-sg = sin(g);
-l +=  -0.343550 * cg - 0.000276 * sg;
-l1 +=  105.90 * cg + 336.53 * sg;
-
-g = STR*(f - 2.*D); /* 18V - 16E - 2D */
-cg = cos(g);
-sg = sin(g);
-l += 0.074668 * cg + 0.149501 * sg;
-l1 += 271.77 * cg - 124.20 * sg;
-
-g = STR*(f - 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.073444 * cg + 0.147094 * sg;
-l1 += 265.24 * cg - 121.16 * sg;
-
-g = STR*(f + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.072844 * cg + 0.145829 * sg;
-l1 += 265.18 * cg - 121.29 * sg;
-
-g = STR*(f + 2.*(D - MP));
-cg = cos(g);
-sg = sin(g);
-l += 0.070201 * cg + 0.140542 * sg;
-l1 += 255.36 * cg - 116.79 * sg;
-
-g = STR*(Ea + D - NF);
-cg = cos(g);
-sg = sin(g);
-l += 0.288209 * cg - 0.025901 * sg;
-l1 += -63.51 * cg - 240.14 * sg;
-
-g = STR*(2.*Ea - 3.*Ju + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.077865 * cg + 0.438460 * sg;
-l1 += 210.57 * cg + 124.84 * sg;
-
-g = STR*(Ea - 2.*Ma);
-cg = cos(g);
-sg = sin(g);
-l += -0.216579 * cg + 0.241702 * sg;
-l1 += 197.67 * cg + 125.23 * sg;
-
-g = STR*(a + MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.165009 * cg + 0.044176 * sg;
-l1 += 4.67 * cg + 201.55 * sg;
-
-g = STR*(a + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.133533 * cg + 0.041116 * sg;
-l1 +=  6.95 * cg + 187.07 * sg;
-
-g = STR*(a - 2.*D + MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.133430 * cg + 0.041079 * sg;
-l1 +=  6.28 * cg + 169.08 * sg;
-
-g = STR*(3.*Ve - 4.*Ea);
-cg = cos(g);
-sg = sin(g);
-l += -0.175074 * cg + 0.003035 * sg;
-l1 +=  49.17 * cg + 150.57 * sg;
-
-g = STR*(2.*(Ea + D - MP) - 3.*Ju + 213534.);
-l1 +=  158.4 * sin(g);
-l1 += moonpol[0];
-
-a = 0.1 * T; /* set amplitude scale of 1.0 = 10^-4 arcsec */
-moonpol[1] *= a;
-moonpol[2] *= a;
+ms->moonpol[0] = 0.0;
+chewm(ms, BT, NBT, 4, 4, ms->moonpol );
+chewm(ms, LRT, NLRT, 4, 1, ms->moonpol );
+ms->g = STR*(ms->f - ms->MP - ms->NF - 2355767.6); /* 18V - 16E - l - F */
+ms->moonpol[1] +=  -1127. * sin(ms->g);
+ms->g = STR*(ms->f - ms->MP + ms->NF - 235353.6); /* 18V - 16E - l + F */
+ms->moonpol[1] +=  -1123. * sin(ms->g);
+ms->g = STR*(ms->Ea + ms->D + 51987.6);
+ms->moonpol[1] +=  1303. * sin(ms->g);
+ms->g = STR*ms->SWELP;
+ms->moonpol[1] +=  342. * sin(ms->g);
+
+
+ms->g = STR*(2.*ms->Ve - 3.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l +=  -0.343550 * ms->cg - 0.000276 * ms->sg;
+ms->l1 +=  105.90 * ms->cg + 336.53 * ms->sg;
+
+ms->g = STR*(ms->f - 2.*ms->D); /* 18V - 16E - 2D */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.074668 * ms->cg + 0.149501 * ms->sg;
+ms->l1 += 271.77 * ms->cg - 124.20 * ms->sg;
+
+ms->g = STR*(ms->f - 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.073444 * ms->cg + 0.147094 * ms->sg;
+ms->l1 += 265.24 * ms->cg - 121.16 * ms->sg;
+
+ms->g = STR*(ms->f + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.072844 * ms->cg + 0.145829 * ms->sg;
+ms->l1 += 265.18 * ms->cg - 121.29 * ms->sg;
+
+ms->g = STR*(ms->f + 2.*(ms->D - ms->MP));
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.070201 * ms->cg + 0.140542 * ms->sg;
+ms->l1 += 255.36 * ms->cg - 116.79 * ms->sg;
+
+ms->g = STR*(ms->Ea + ms->D - ms->NF);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.288209 * ms->cg - 0.025901 * ms->sg;
+ms->l1 += -63.51 * ms->cg - 240.14 * ms->sg;
+
+ms->g = STR*(2.*ms->Ea - 3.*ms->Ju + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.077865 * ms->cg + 0.438460 * ms->sg;
+ms->l1 += 210.57 * ms->cg + 124.84 * ms->sg;
+
+ms->g = STR*(ms->Ea - 2.*ms->Ma);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.216579 * ms->cg + 0.241702 * ms->sg;
+ms->l1 += 197.67 * ms->cg + 125.23 * ms->sg;
+
+ms->g = STR*(a + ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.165009 * ms->cg + 0.044176 * ms->sg;
+ms->l1 += 4.67 * ms->cg + 201.55 * ms->sg;
+
+ms->g = STR*(a + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.133533 * ms->cg + 0.041116 * ms->sg;
+ms->l1 +=  6.95 * ms->cg + 187.07 * ms->sg;
+
+ms->g = STR*(a - 2.*ms->D + ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.133430 * ms->cg + 0.041079 * ms->sg;
+ms->l1 +=  6.28 * ms->cg + 169.08 * ms->sg;
+
+ms->g = STR*(3.*ms->Ve - 4.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.175074 * ms->cg + 0.003035 * ms->sg;
+ms->l1 +=  49.17 * ms->cg + 150.57 * ms->sg;
+
+ms->g = STR*(2.*(ms->Ea + ms->D - ms->MP) - 3.*ms->Ju + 213534.);
+ms->l1 +=  158.4 * sin(ms->g);
+ms->l1 += ms->moonpol[0];
+
+a = 0.1 * ms->T; /* set amplitude scale of 1.0 = 10^-4 arcsec */
+ms->moonpol[1] *= a;
+ms->moonpol[2] *= a;
 }
 #else
-static void moon1(void)
+static void moon1(struct moon_state *ms)
 {
 double a;
 /* This code added by Bhanu Pinnamaneni, 17-aug-2009 */
@@ -1193,274 +1254,280 @@ double a;
 int i, j;
 for (i = 0; i < 5; i++) {
   for (j = 0; j < 8; j++) {
-    ss[i][j] = 0;
-    cc[i][j] = 0;
+    ms->ss[i][j] = 0;
+    ms->cc[i][j] = 0;
   }
 }
 /* End of code addition */
-sscc( 0, STR*D, 6 );
-sscc( 1, STR*M,  4 );
-sscc( 2, STR*MP, 4 );
-sscc( 3, STR*NF, 4 );
-moonpol[0] = 0.0;
-moonpol[1] = 0.0;
-moonpol[2] = 0.0;
+sscc(ms, 0, STR*ms->D, 6 );
+sscc(ms, 1, STR*ms->M,  4 );
+sscc(ms, 2, STR*ms->MP, 4 );
+sscc(ms, 3, STR*ms->NF, 4 );
+ms->moonpol[0] = 0.0;
+ms->moonpol[1] = 0.0;
+ms->moonpol[2] = 0.0;
 /* terms in T^2, scale 1.0 = 10^-5" */
-chewm( LRT2, NLRT2, 4, 2, moonpol );
-chewm( BT2, NBT2, 4, 4, moonpol );
-f = 18 * Ve - 16 * Ea;
-g = STR*(f - MP );  /* 18V - 16E - l */
-cg = cos(g);
-sg = sin(g);
-l = 6.367278 * cg + 12.747036 * sg;  /* t^0 */
-l1 = 23123.70 * cg - 10570.02 * sg;  /* t^1 */
-l2 = z[12] * cg + z[13] * sg;        /* t^2 */
-moonpol[2] += 5.01 * cg + 2.72 * sg;
-g = STR * (10.*Ve - 3.*Ea - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.253102 * cg + 0.503359 * sg;
-l1 += 1258.46 * cg + 707.29 * sg;
-l2 += z[14] * cg + z[15] * sg;
-g = STR*(8.*Ve - 13.*Ea);
-cg = cos(g);
-sg = sin(g);
-l += -0.187231 * cg - 0.127481 * sg;
-l1 += -319.87 * cg - 18.34 * sg;
-l2 += z[16] * cg + z[17] * sg;
-a = 4.0*Ea - 8.0*Ma + 3.0*Ju;
-g = STR * a;
-cg = cos(g);
-sg = sin(g);
-l += -0.866287 * cg + 0.248192 * sg;
-l1 += 41.87 * cg + 1053.97 * sg;
-l2 += z[18] * cg + z[19] * sg;
-g = STR*(a - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.165009 * cg + 0.044176 * sg;
-l1 += 4.67 * cg + 201.55 * sg;
-g = STR*f;  /* 18V - 16E */
-cg = cos(g);
-sg = sin(g);
-l += 0.330401 * cg + 0.661362 * sg;
-l1 += 1202.67 * cg - 555.59 * sg;
-l2 += z[20] * cg + z[21] * sg;
-g = STR*(f - 2.0*MP );  /* 18V - 16E - 2l */
-cg = cos(g);
-sg = sin(g);
-l += 0.352185 * cg + 0.705041 * sg;
-l1 += 1283.59 * cg - 586.43 * sg;
-g = STR * (2.0*Ju - 5.0*Sa);
-cg = cos(g);
-sg = sin(g);
-l += -0.034700 * cg + 0.160041 * sg;
-l2 += z[22] * cg + z[23] * sg;
-g = STR * (SWELP - NF);
-cg = cos(g);
-sg = sin(g);
-l += 0.000116 * cg + 7.063040 * sg;
-l1 +=  298.8 * sg;
+chewm(ms, LRT2, NLRT2, 4, 2, ms->moonpol );
+chewm(ms, BT2, NBT2, 4, 4, ms->moonpol );
+ms->f = 18 * ms->Ve - 16 * ms->Ea;
+ms->g = STR*(ms->f - ms->MP );  /* 18V - 16E - l */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l = 6.367278 * ms->cg + 12.747036 * ms->sg;  /* t^0 */
+ms->l1 = 23123.70 * ms->cg - 10570.02 * ms->sg;  /* t^1 */
+ms->l2 = z[12] * ms->cg + z[13] * ms->sg;        /* t^2 */
+ms->moonpol[2] += 5.01 * ms->cg + 2.72 * ms->sg;
+ms->g = STR * (10.*ms->Ve - 3.*ms->Ea - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.253102 * ms->cg + 0.503359 * ms->sg;
+ms->l1 += 1258.46 * ms->cg + 707.29 * ms->sg;
+ms->l2 += z[14] * ms->cg + z[15] * ms->sg;
+ms->g = STR*(8.*ms->Ve - 13.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.187231 * ms->cg - 0.127481 * ms->sg;
+ms->l1 += -319.87 * ms->cg - 18.34 * ms->sg;
+ms->l2 += z[16] * ms->cg + z[17] * ms->sg;
+a = 4.0*ms->Ea - 8.0*ms->Ma + 3.0*ms->Ju;
+ms->g = STR * a;
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.866287 * ms->cg + 0.248192 * ms->sg;
+ms->l1 += 41.87 * ms->cg + 1053.97 * ms->sg;
+ms->l2 += z[18] * ms->cg + z[19] * ms->sg;
+ms->g = STR*(a - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.165009 * ms->cg + 0.044176 * ms->sg;
+ms->l1 += 4.67 * ms->cg + 201.55 * ms->sg;
+ms->g = STR*ms->f;  /* 18V - 16E */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.330401 * ms->cg + 0.661362 * ms->sg;
+ms->l1 += 1202.67 * ms->cg - 555.59 * ms->sg;
+ms->l2 += z[20] * ms->cg + z[21] * ms->sg;
+ms->g = STR*(ms->f - 2.0*ms->MP );  /* 18V - 16E - 2l */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.352185 * ms->cg + 0.705041 * ms->sg;
+ms->l1 += 1283.59 * ms->cg - 586.43 * ms->sg;
+ms->g = STR * (2.0*ms->Ju - 5.0*ms->Sa);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.034700 * ms->cg + 0.160041 * ms->sg;
+ms->l2 += z[22] * ms->cg + z[23] * ms->sg;
+ms->g = STR * (ms->SWELP - ms->NF);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.000116 * ms->cg + 7.063040 * ms->sg;
+ms->l1 +=  298.8 * ms->sg;
 /* T^3 terms */
-sg = sin( STR * M );
+ms->sg = sin( STR * ms->M );
 /* l3 +=  z[24] * sg;			moshier! l3 not initialized! */
-l3 =  z[24] * sg;			
-l4 = 0;					
-g = STR * (2.0*D - M);
-sg = sin(g);
-cg = cos(g);
-moonpol[2] +=  -0.2655 * cg * T;
-g = STR * (M - MP);
-moonpol[2] +=  -0.1568 * cos( g ) * T;
-g = STR * (M + MP);
-moonpol[2] +=  0.1309 * cos( g ) * T;
-g = STR * (2.0*(D + M) - MP);
-sg = sin(g);
-cg = cos(g);
-moonpol[2] +=   0.5568 * cg * T;
-l2 += moonpol[0];
-g = STR*(2.0*D - M - MP);
-moonpol[2] +=  -0.1910 * cos( g ) * T;
-moonpol[1] *= T;
-moonpol[2] *= T;
+ms->l3 =  z[24] * ms->sg;			
+ms->l4 = 0;					
+ms->g = STR * (2.0*ms->D - ms->M);
+ms->sg = sin(ms->g);
+ms->cg = cos(ms->g);
+ms->moonpol[2] +=  -0.2655 * ms->cg * ms->T;
+ms->g = STR * (ms->M - ms->MP);
+ms->moonpol[2] +=  -0.1568 * cos( ms->g ) * ms->T;
+ms->g = STR * (ms->M + ms->MP);
+ms->moonpol[2] +=  0.1309 * cos( ms->g ) * ms->T;
+ms->g = STR * (2.0*(ms->D + ms->M) - ms->MP);
+ms->sg = sin(ms->g);
+ms->cg = cos(ms->g);
+ms->moonpol[2] +=   0.5568 * ms->cg * ms->T;
+ms->l2 += ms->moonpol[0];
+ms->g = STR*(2.0*ms->D - ms->M - ms->MP);
+ms->moonpol[2] +=  -0.1910 * cos( ms->g ) * ms->T;
+ms->moonpol[1] *= ms->T;
+ms->moonpol[2] *= ms->T;
 /* terms in T */
-moonpol[0] = 0.0;
-chewm( BT, NBT, 4, 4, moonpol );
-chewm( LRT, NLRT, 4, 1, moonpol );
-g = STR*(f - MP - NF - 2355767.6); /* 18V - 16E - l - F */
-moonpol[1] +=  -1127. * sin(g);
-g = STR*(f - MP + NF - 235353.6); /* 18V - 16E - l + F */
-moonpol[1] +=  -1123. * sin(g);
-g = STR*(Ea + D + 51987.6);
-moonpol[1] +=  1303. * sin(g);
-g = STR*SWELP;
-moonpol[1] +=  342. * sin(g);
-g = STR*(2.*Ve - 3.*Ea);
-cg = cos(g);
-sg = sin(g);
-l +=  -0.343550 * cg - 0.000276 * sg;
-l1 +=  105.90 * cg + 336.53 * sg;
-g = STR*(f - 2.*D); /* 18V - 16E - 2D */
-cg = cos(g);
-sg = sin(g);
-l += 0.074668 * cg + 0.149501 * sg;
-l1 += 271.77 * cg - 124.20 * sg;
-g = STR*(f - 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.073444 * cg + 0.147094 * sg;
-l1 += 265.24 * cg - 121.16 * sg;
-g = STR*(f + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.072844 * cg + 0.145829 * sg;
-l1 += 265.18 * cg - 121.29 * sg;
-g = STR*(f + 2.*(D - MP));
-cg = cos(g);
-sg = sin(g);
-l += 0.070201 * cg + 0.140542 * sg;
-l1 += 255.36 * cg - 116.79 * sg;
-g = STR*(Ea + D - NF);
-cg = cos(g);
-sg = sin(g);
-l += 0.288209 * cg - 0.025901 * sg;
-l1 += -63.51 * cg - 240.14 * sg;
-g = STR*(2.*Ea - 3.*Ju + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += 0.077865 * cg + 0.438460 * sg;
-l1 += 210.57 * cg + 124.84 * sg;
-g = STR*(Ea - 2.*Ma);
-cg = cos(g);
-sg = sin(g);
-l += -0.216579 * cg + 0.241702 * sg;
-l1 += 197.67 * cg + 125.23 * sg;
-g = STR*(a + MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.165009 * cg + 0.044176 * sg;
-l1 += 4.67 * cg + 201.55 * sg;
-g = STR*(a + 2.*D - MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.133533 * cg + 0.041116 * sg;
-l1 +=  6.95 * cg + 187.07 * sg;
-g = STR*(a - 2.*D + MP);
-cg = cos(g);
-sg = sin(g);
-l += -0.133430 * cg + 0.041079 * sg;
-l1 +=  6.28 * cg + 169.08 * sg;
-g = STR*(3.*Ve - 4.*Ea);
-cg = cos(g);
-sg = sin(g);
-l += -0.175074 * cg + 0.003035 * sg;
-l1 +=  49.17 * cg + 150.57 * sg;
-g = STR*(2.*(Ea + D - MP) - 3.*Ju + 213534.);
-l1 +=  158.4 * sin(g);
-l1 += moonpol[0];
-a = 0.1 * T; /* set amplitude scale of 1.0 = 10^-4 arcsec */
-moonpol[1] *= a;
-moonpol[2] *= a;
+ms->moonpol[0] = 0.0;
+chewm(ms, BT, NBT, 4, 4, ms->moonpol );
+chewm(ms, LRT, NLRT, 4, 1, ms->moonpol );
+ms->g = STR*(ms->f - ms->MP - ms->NF - 2355767.6); /* 18V - 16E - l - F */
+ms->moonpol[1] +=  -1127. * sin(ms->g);
+ms->g = STR*(ms->f - ms->MP + ms->NF - 235353.6); /* 18V - 16E - l + F */
+ms->moonpol[1] +=  -1123. * sin(ms->g);
+ms->g = STR*(ms->Ea + ms->D + 51987.6);
+ms->moonpol[1] +=  1303. * sin(ms->g);
+ms->g = STR*ms->SWELP;
+ms->moonpol[1] +=  342. * sin(ms->g);
+ms->g = STR*(2.*ms->Ve - 3.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l +=  -0.343550 * ms->cg - 0.000276 * ms->sg;
+ms->l1 +=  105.90 * ms->cg + 336.53 * ms->sg;
+ms->g = STR*(ms->f - 2.*ms->D); /* 18V - 16E - 2D */
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.074668 * ms->cg + 0.149501 * ms->sg;
+ms->l1 += 271.77 * ms->cg - 124.20 * ms->sg;
+ms->g = STR*(ms->f - 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.073444 * ms->cg + 0.147094 * ms->sg;
+ms->l1 += 265.24 * ms->cg - 121.16 * ms->sg;
+ms->g = STR*(ms->f + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.072844 * ms->cg + 0.145829 * ms->sg;
+ms->l1 += 265.18 * ms->cg - 121.29 * ms->sg;
+ms->g = STR*(ms->f + 2.*(ms->D - ms->MP));
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.070201 * ms->cg + 0.140542 * ms->sg;
+ms->l1 += 255.36 * ms->cg - 116.79 * ms->sg;
+ms->g = STR*(ms->Ea + ms->D - ms->NF);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.288209 * ms->cg - 0.025901 * ms->sg;
+ms->l1 += -63.51 * ms->cg - 240.14 * ms->sg;
+ms->g = STR*(2.*ms->Ea - 3.*ms->Ju + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += 0.077865 * ms->cg + 0.438460 * ms->sg;
+ms->l1 += 210.57 * ms->cg + 124.84 * ms->sg;
+ms->g = STR*(ms->Ea - 2.*ms->Ma);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.216579 * ms->cg + 0.241702 * ms->sg;
+ms->l1 += 197.67 * ms->cg + 125.23 * ms->sg;
+ms->g = STR*(a + ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.165009 * ms->cg + 0.044176 * ms->sg;
+ms->l1 += 4.67 * ms->cg + 201.55 * ms->sg;
+ms->g = STR*(a + 2.*ms->D - ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.133533 * ms->cg + 0.041116 * ms->sg;
+ms->l1 +=  6.95 * ms->cg + 187.07 * ms->sg;
+ms->g = STR*(a - 2.*ms->D + ms->MP);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.133430 * ms->cg + 0.041079 * ms->sg;
+ms->l1 +=  6.28 * ms->cg + 169.08 * ms->sg;
+ms->g = STR*(3.*ms->Ve - 4.*ms->Ea);
+ms->cg = cos(ms->g);
+ms->sg = sin(ms->g);
+ms->l += -0.175074 * ms->cg + 0.003035 * ms->sg;
+ms->l1 +=  49.17 * ms->cg + 150.57 * ms->sg;
+ms->g = STR*(2.*(ms->Ea + ms->D - ms->MP) - 3.*ms->Ju + 213534.);
+ms->l1 +=  158.4 * sin(ms->g);
+ms->l1 += ms->moonpol[0];
+a = 0.1 * ms->T; /* set amplitude scale of 1.0 = 10^-4 arcsec */
+ms->moonpol[1] *= a;
+ms->moonpol[2] *= a;
 }
 #endif	/* MOSH_MOON_200 */
 
-static void moon2(void)
+static void moon2(struct moon_state *ms)
 {
 /* terms in T^0 */
-g = STR*(2*(Ea-Ju+D)-MP+648431.172);
-l += 1.14307 * sin(g);
-g = STR*(Ve-Ea+648035.568);
-l += 0.82155 * sin(g);
-g = STR*(3*(Ve-Ea)+2*D-MP+647933.184);
-l += 0.64371 * sin(g);
-g = STR*(Ea-Ju+4424.04);
-l += 0.63880 * sin(g);
-g = STR*(SWELP + MP - NF + 4.68);
-l += 0.49331 * sin(g);
-g = STR*(SWELP - MP - NF + 4.68);
-l += 0.4914 * sin(g);
-g = STR*(SWELP+NF+2.52);
-l += 0.36061 * sin(g);
-g = STR*(2.*Ve - 2.*Ea + 736.2);
-l += 0.30154 * sin(g);
-g = STR*(2.*Ea - 3.*Ju + 2.*D - 2.*MP + 36138.2);
-l += 0.28282 * sin(g);
-g = STR*(2.*Ea - 2.*Ju + 2.*D - 2.*MP + 311.0);
-l += 0.24516 * sin(g);
-g = STR*(Ea - Ju - 2.*D + MP + 6275.88);
-l += 0.21117 * sin(g);
-g = STR*(2.*(Ea - Ma) - 846.36);
-l += 0.19444 * sin(g);
-g = STR*(2.*(Ea - Ju) + 1569.96);
-l -= 0.18457 * sin(g);
-g = STR*(2.*(Ea - Ju) - MP - 55.8);
-l += 0.18256 * sin(g);
-g = STR*(Ea - Ju - 2.*D + 6490.08);
-l += 0.16499 * sin(g);
-g = STR*(Ea - 2.*Ju - 212378.4);
-l += 0.16427 * sin(g);
-g = STR*(2.*(Ve - Ea - D) + MP + 1122.48);
-l += 0.16088 * sin(g);
-g = STR*(Ve - Ea - MP + 32.04);
-l -= 0.15350 * sin(g);
-g = STR*(Ea - Ju - MP + 4488.88);
-l += 0.14346 * sin(g);
-g = STR*(2.*(Ve - Ea + D) - MP - 8.64);
-l += 0.13594 * sin(g);
-g = STR*(2.*(Ve - Ea - D) + 1319.76);
-l += 0.13432 * sin(g);
-g = STR*(Ve - Ea - 2.*D + MP - 56.16);
-l -= 0.13122 * sin(g);
-g = STR*(Ve - Ea + MP + 54.36);
-l -= 0.12722 * sin(g);
-g = STR*(3.*(Ve - Ea) - MP + 433.8);
-l += 0.12539 * sin(g);
-g = STR*(Ea - Ju + MP + 4002.12);
-l += 0.10994 * sin(g);
-g = STR*(20.*Ve - 21.*Ea - 2.*D + MP - 317511.72);
-l += 0.10652 * sin(g);
-g = STR*(26.*Ve - 29.*Ea - MP + 270002.52);
-l += 0.10490 * sin(g);
-g = STR*(3.*Ve - 4.*Ea + D - MP - 322765.56);
-l += 0.10386 * sin(g);
-g = STR*(SWELP+648002.556);
-B =  8.04508 * sin(g);
-g = STR*(Ea+D+996048.252);
-B += 1.51021 * sin(g);
-g = STR*(f - MP + NF + 95554.332);
-B += 0.63037 * sin(g);
-g = STR*(f - MP - NF + 95553.792);
-B += 0.63014 * sin(g);
-g = STR*(SWELP - MP + 2.9);
-B +=  0.45587 * sin(g);
-g = STR*(SWELP + MP + 2.5);
-B +=  -0.41573 * sin(g);
-g = STR*(SWELP - 2.0*NF + 3.2);
-B +=  0.32623 * sin(g);
-g = STR*(SWELP - 2.0*D + 2.5);
-B +=  0.29855 * sin(g);
+ms->g = STR*(2*(ms->Ea-ms->Ju+ms->D)-ms->MP+648431.172);
+ms->l += 1.14307 * sin(ms->g);
+ms->g = STR*(ms->Ve-ms->Ea+648035.568);
+ms->l += 0.82155 * sin(ms->g);
+ms->g = STR*(3*(ms->Ve-ms->Ea)+2*ms->D-ms->MP+647933.184);
+ms->l += 0.64371 * sin(ms->g);
+ms->g = STR*(ms->Ea-ms->Ju+4424.04);
+ms->l += 0.63880 * sin(ms->g);
+ms->g = STR*(ms->SWELP + ms->MP - ms->NF + 4.68);
+ms->l += 0.49331 * sin(ms->g);
+ms->g = STR*(ms->SWELP - ms->MP - ms->NF + 4.68);
+ms->l += 0.4914 * sin(ms->g);
+ms->g = STR*(ms->SWELP+ms->NF+2.52);
+ms->l += 0.36061 * sin(ms->g);
+ms->g = STR*(2.*ms->Ve - 2.*ms->Ea + 736.2);
+ms->l += 0.30154 * sin(ms->g);
+ms->g = STR*(2.*ms->Ea - 3.*ms->Ju + 2.*ms->D - 2.*ms->MP + 36138.2);
+ms->l += 0.28282 * sin(ms->g);
+ms->g = STR*(2.*ms->Ea - 2.*ms->Ju + 2.*ms->D - 2.*ms->MP + 311.0);
+ms->l += 0.24516 * sin(ms->g);
+ms->g = STR*(ms->Ea - ms->Ju - 2.*ms->D + ms->MP + 6275.88);
+ms->l += 0.21117 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ea - ms->Ma) - 846.36);
+ms->l += 0.19444 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ea - ms->Ju) + 1569.96);
+ms->l -= 0.18457 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ea - ms->Ju) - ms->MP - 55.8);
+ms->l += 0.18256 * sin(ms->g);
+ms->g = STR*(ms->Ea - ms->Ju - 2.*ms->D + 6490.08);
+ms->l += 0.16499 * sin(ms->g);
+ms->g = STR*(ms->Ea - 2.*ms->Ju - 212378.4);
+ms->l += 0.16427 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ve - ms->Ea - ms->D) + ms->MP + 1122.48);
+ms->l += 0.16088 * sin(ms->g);
+ms->g = STR*(ms->Ve - ms->Ea - ms->MP + 32.04);
+ms->l -= 0.15350 * sin(ms->g);
+ms->g = STR*(ms->Ea - ms->Ju - ms->MP + 4488.88);
+ms->l += 0.14346 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ve - ms->Ea + ms->D) - ms->MP - 8.64);
+ms->l += 0.13594 * sin(ms->g);
+ms->g = STR*(2.*(ms->Ve - ms->Ea - ms->D) + 1319.76);
+ms->l += 0.13432 * sin(ms->g);
+ms->g = STR*(ms->Ve - ms->Ea - 2.*ms->D + ms->MP - 56.16);
+ms->l -= 0.13122 * sin(ms->g);
+ms->g = STR*(ms->Ve - ms->Ea + ms->MP + 54.36);
+ms->l -= 0.12722 * sin(ms->g);
+ms->g = STR*(3.*(ms->Ve - ms->Ea) - ms->MP + 433.8);
+ms->l += 0.12539 * sin(ms->g);
+ms->g = STR*(ms->Ea - ms->Ju + ms->MP + 4002.12);
+ms->l += 0.10994 * sin(ms->g);
+ms->g = STR*(20.*ms->Ve - 21.*ms->Ea - 2.*ms->D + ms->MP - 317511.72);
+ms->l += 0.10652 * sin(ms->g);
+ms->g = STR*(26.*ms->Ve - 29.*ms->Ea - ms->MP + 270002.52);
+ms->l += 0.10490 * sin(ms->g);
+ms->g = STR*(3.*ms->Ve - 4.*ms->Ea + ms->D - ms->MP - 322765.56);
+ms->l += 0.10386 * sin(ms->g);
+ms->g = STR*(ms->SWELP+648002.556);
+ms->B =  8.04508 * sin(ms->g);
+ms->g = STR*(ms->Ea+ms->D+996048.252);
+ms->B += 1.51021 * sin(ms->g);
+ms->g = STR*(ms->f - ms->MP + ms->NF + 95554.332);
+ms->B += 0.63037 * sin(ms->g);
+ms->g = STR*(ms->f - ms->MP - ms->NF + 95553.792);
+ms->B += 0.63014 * sin(ms->g);
+ms->g = STR*(ms->SWELP - ms->MP + 2.9);
+ms->B +=  0.45587 * sin(ms->g);
+ms->g = STR*(ms->SWELP + ms->MP + 2.5);
+ms->B +=  -0.41573 * sin(ms->g);
+ms->g = STR*(ms->SWELP - 2.0*ms->NF + 3.2);
+ms->B +=  0.32623 * sin(ms->g);
+ms->g = STR*(ms->SWELP - 2.0*ms->D + 2.5);
+ms->B +=  0.29855 * sin(ms->g);
 }
 
-static void moon3(void)
+static void moon3(struct moon_state *ms)
 {
 /* terms in T^0 */
-moonpol[0] = 0.0;
-chewm( LR, NLR, 4, 1, moonpol );
-chewm( MB, NMB, 4, 3, moonpol );
-l += (((l4 * T + l3) * T + l2) * T + l1) * T * 1.0e-5;
-moonpol[0] = SWELP + l + 1.0e-4 * moonpol[0];
-moonpol[1] = 1.0e-4 * moonpol[1] + B;
-moonpol[2] = 1.0e-4 * moonpol[2] + 385000.52899; /* kilometers */
+ms->moonpol[0] = 0.0;
+chewm(ms, LR, NLR, 4, 1, ms->moonpol );
+chewm(ms, MB, NMB, 4, 3, ms->moonpol );
+moon3_sum(ms);
+}
+
+/* Sum up the terms computed by moon1() ... moon3() */
+static void moon3_sum(struct moon_state *ms)
+{
+ms->l += (((ms->l4 * ms->T + ms->l3) * ms->T + ms->l2) * ms->T + ms->l1) * ms->T * 1.0e-5;
+ms->moonpol[0] = ms->SWELP + ms->l + 1.0e-4 * ms->moonpol[0];
+ms->moonpol[1] = 1.0e-4 * ms->moonpol[1] + ms->B;
+ms->moonpol[2] = 1.0e-4 * ms->moonpol[2] + 385000.52899; /* kilometers */
 }
 
 /* Compute final ecliptic polar coordinates
  */
-static void moon4(void)
+static void moon4(struct moon_state *ms)
 {
-moonpol[2] /= AUNIT / 1000;
-moonpol[0] = STR * mods3600( moonpol[0] );
-moonpol[1] = STR * moonpol[1];
-B = moonpol[1];
+ms->moonpol[2] /= AUNIT / 1000;
+ms->moonpol[0] = STR * mods3600( ms->moonpol[0] );
+ms->moonpol[1] = STR * ms->moonpol[1];
+ms->B = ms->moonpol[1];
 }
 
 #define CORR_MNODE_JD_T0GREG  -3063616.5   /* 1 jan -13100 greg. */
@@ -1492,15 +1559,16 @@ static double corr_mean_node(double J)
  */
 int swi_mean_node(double J, double *pol, char *serr)
 {
+  struct moon_state mst, *ms = &mst;
 #if 0
   double a, b, c;
 #endif
   char s[AS_MAXCH];
   double dcor;
-  T = (J-J2000)/36525.0;
-  T2 = T*T;
-  T3 = T*T2;
-  T4 = T2*T2;
+  ms->T = (J-J2000)/36525.0;
+  ms->T2 = ms->T*ms->T;
+  ms->T3 = ms->T*ms->T2;
+  ms->T4 = ms->T2*ms->T2;
   /* with elements from swi_moshmoon2(), which are fitted to jpl-ephemeris */
   if (J < MOSHNDEPH_START || J > MOSHNDEPH_END) {
     if (serr != NULL) {
@@ -1511,10 +1579,10 @@ int swi_mean_node(double J, double *pol, char *serr)
     }
     return ERR;
   }
-  mean_elements();
+  mean_elements(ms);
   dcor = corr_mean_node(J) * 3600;
   /* longitude */
-  pol[0] = swi_mod2PI((SWELP - NF - dcor) * STR);
+  pol[0] = swi_mod2PI((ms->SWELP - ms->NF - dcor) * STR);
   /* latitude */
   pol[1] = 0.0;
   /* distance */
@@ -1523,8 +1591,8 @@ int swi_mean_node(double J, double *pol, char *serr)
 #if 0
   a = pol[0];
   /* Chapront, according to Meeus, German, p. 339 */
-  pol[0] = 125.0445550 - 1934.1361849 * T + 0.0020762 * T2 +
-	   T3 / 467410 - T4 / 60616000;
+  pol[0] = 125.0445550 - 1934.1361849 * ms->T + 0.0020762 * ms->T2 +
+	   ms->T3 / 467410 - ms->T4 / 60616000;
   pol[0] = swi_mod2PI(pol[0] * DEGTORAD);
   c = pol[0];
   printf ("mean node\n");
@@ -1563,6 +1631,7 @@ static double corr_mean_apog(double J)
  */
 int swi_mean_apog(double J, double *pol, char *serr)
 {
+  struct moon_state mst, *ms = &mst;
 #if 0
   int i;
   double a, b;
@@ -1570,10 +1639,10 @@ int swi_mean_apog(double J, double *pol, char *serr)
 #endif
   double node, dcor;
   char s[AS_MAXCH];
-  T = (J-J2000)/36525.0;
-  T2 = T*T;
-  T3 = T*T2;
-  T4 = T2*T2;
+  ms->T = (J-J2000)/36525.0;
+  ms->T2 = ms->T*ms->T;
+  ms->T3 = ms->T*ms->T2;
+  ms->T4 = ms->T2*ms->T2;
   /* with elements from swi_moshmoon2(), which are fitted to jpl-ephemeris */
   if (J < MOSHNDEPH_START || J > MOSHNDEPH_END) {
     if (serr != NULL) {
@@ -1584,8 +1653,8 @@ int swi_mean_apog(double J, double *pol, char *serr)
     }
     return(ERR);
   }
-  mean_elements();
-  pol[0] = swi_mod2PI((SWELP - MP) * STR + PI);
+  mean_elements(ms);
+  pol[0] = swi_mod2PI((ms->SWELP - ms->MP) * STR + PI);
   pol[1] = 0;
   pol[2] = MOON_MEAN_DIST * (1 + MOON_MEAN_ECC) / AUNIT; /* apogee */
   /* Lilith or Dark Moon is either the empty focal point of the mean 
@@ -1612,7 +1681,7 @@ int swi_mean_apog(double J, double *pol, char *serr)
   dcor = corr_mean_apog(J) * DEGTORAD;
   pol[0] = swi_mod2PI(pol[0] - dcor);
   /* apogee is now projected onto ecliptic */
-  node = (SWELP - NF) * STR;
+  node = (ms->SWELP - ms->NF) * STR;
   dcor = corr_mean_node(J) * DEGTORAD;
   node = swi_mod2PI(node - dcor);
   pol[0] = swi_mod2PI(pol[0] - node);
@@ -1625,7 +1694,7 @@ int swi_mean_apog(double J, double *pol, char *serr)
 
 /* Program to step through the perturbation table
  */
-static void chewm(const short *pt, int nlines, int nangles, int typflg, double *ans )
+static void chewm(struct moon_state *ms, const short *pt, int nlines, int nangles, int typflg, double *ans )
 {
   int i, j, k, k1, m;
   double cu, su, cv, sv, ff;
@@ -1639,8 +1708,8 @@ static void chewm(const short *pt, int nlines, int nangles, int typflg, double *
 	k = j;
 	if( j < 0 ) k = -k; /* make angle factor > 0 */
 	/* sin, cos (k*angle) from lookup table */
-	su = ss[m][k-1];
-	cu = cc[m][k-1];
+	su = ms->ss[m][k-1];
+	cu = ms->cc[m][k-1];
 	if( j < 0 ) su = -su; /* negative angle factor */
 	if( k1 == 0 ) {
 	  /* Set sin, cos of first angle. */
@@ -1690,27 +1759,92 @@ static void chewm(const short *pt, int nlines, int nangles, int typflg, double *
   }
 }
 
+/* Same as chewm(), for the MOON_NBATCH dates of a batch,
+ * with sin and cos tables ss, cc and sums ans stored by date
+ */
+static void chewm_batch(const short *pt, int nlines, int nangles, int typflg,
+  double ss[5][8][MOON_NBATCH], double cc[5][8][MOON_NBATCH],
+  double ans[3][MOON_NBATCH])
+{
+  int i, j, k, k1, l, m;
+  double sgn, ff;
+  double cv[MOON_NBATCH], sv[MOON_NBATCH];
+  for( i=0; i<nlines; i++ ) {
+    k1 = 0;
+    for (l = 0; l < MOON_NBATCH; l++) {
+      sv[l] = 0.0;
+      cv[l] = 0.0;
+    }
+    for( m=0; m<nangles; m++ ) {
+      j = *pt++; /* multiple angle factor */
+      if( j ) {
+	k = (j < 0) ? -j : j;
+	sgn = (j < 0) ? -1.0 : 1.0;
+	if( k1 == 0 ) {
+	  /* Set sin, cos of first angle. */
+	  for (l = 0; l < MOON_NBATCH; l++) {
+	    sv[l] = sgn * ss[m][k-1][l];
+	    cv[l] = cc[m][k-1][l];
+	  }
+	  k1 = 1;
+	}
+	else {
+	  /* Combine angles by trigonometry. */
+	  for (l = 0; l < MOON_NBATCH; l++) {
+	    ff = sgn * ss[m][k-1][l] * cv[l] + cc[m][k-1][l] * sv[l];
+	    cv[l] = cc[m][k-1][l] * cv[l] - sgn * ss[m][k-1][l] * sv[l];
+	    sv[l] = ff;
+	  }
+	}
+      }
+    }
+    /* Accumulate
+     */
+    switch( typflg ) {
+    /* large longitude and radius */
+    case 1:
+      j = *pt++;
+      k = *pt++;
+      for (l = 0; l < MOON_NBATCH; l++)
+	ans[0][l] += (10000.0 * j  + k) * sv[l];
+      j = *pt++;
+      k = *pt++;
+      if( k ) 
+	for (l = 0; l < MOON_NBATCH; l++)
+	  ans[2][l] += (10000.0 * j  + k) * cv[l];
+      break;
+    /* large latitude */
+    case 3:
+      j = *pt++;
+      k = *pt++;
+      for (l = 0; l < MOON_NBATCH; l++)
+	ans[1][l] += ( 10000.0*j + k)*sv[l];
+      break;
+    }
+  }
+}
+
 /* Prepare lookup table of sin and cos ( i*Lj )
  * for required multiple angles
  */
-static void sscc(int k, double arg, int n )
+static void sscc(struct moon_state *ms, int k, double arg, int n )
 {
   double cu, su, cv, sv, s;
   int i;
   su = sin(arg);
   cu = cos(arg);
-  ss[k][0] = su;			/* sin(L) */
-  cc[k][0] = cu;			/* cos(L) */
+  ms->ss[k][0] = su;			/* sin(L) */
+  ms->cc[k][0] = cu;			/* cos(L) */
   sv = 2.0*su*cu;
   cv = cu*cu - su*su;
-  ss[k][1] = sv;			/* sin(2L) */
-  cc[k][1] = cv;
+  ms->ss[k][1] = sv;			/* sin(2L) */
+  ms->cc[k][1] = cv;
   for( i=2; i<n; i++ ) {
     s =  su*cv + cu*sv;
     cv = cu*cv - su*sv;
     sv = s;
-    ss[k][i] = sv;		/* sin( i+1 L ) */
-    cc[k][i] = cv;
+    ms->ss[k][i] = sv;		/* sin( i+1 L ) */
+    ms->cc[k][i] = cv;
   }
 }
 
@@ -1743,71 +1877,72 @@ void swi_mean_lunar_elements(double tjd,
 							 double *node, double *dnode, 
 							 double *peri, double *dperi)
 {
+  struct moon_state mst, *ms = &mst;
   double dcor;
-  T = (tjd - J2000) / 36525.0;
-  T2 = T*T;
-  mean_elements();
-  *node = swe_degnorm((SWELP - NF) * STR * RADTODEG);
-  *peri = swe_degnorm((SWELP - MP) * STR * RADTODEG);
-  T -= 1.0 / 36525;
-  mean_elements();
-  *dnode = swe_degnorm(*node - (SWELP - NF) * STR * RADTODEG);
+  ms->T = (tjd - J2000) / 36525.0;
+  ms->T2 = ms->T*ms->T;
+  mean_elements(ms);
+  *node = swe_degnorm((ms->SWELP - ms->NF) * STR * RADTODEG);
+  *peri = swe_degnorm((ms->SWELP - ms->MP) * STR * RADTODEG);
+  ms->T -= 1.0 / 36525;
+  mean_elements(ms);
+  *dnode = swe_degnorm(*node - (ms->SWELP - ms->NF) * STR * RADTODEG);
   *dnode -= 360;
-  *dperi = swe_degnorm(*peri - (SWELP - MP) * STR * RADTODEG);
+  *dperi = swe_degnorm(*peri - (ms->SWELP - ms->MP) * STR * RADTODEG);
   dcor = corr_mean_node(tjd);
   *node = swe_degnorm(*node - dcor);
   dcor = corr_mean_apog(tjd);
   *peri = swe_degnorm(*peri - dcor);
 }
 
-static void mean_elements(void)
+static void mean_elements(struct moon_state *ms)
 {
-double fracT = fmod(T, 1);
+double fracT = fmod(ms->T, 1);
 /* Mean anomaly of sun = l' (J. Laskar) */
 /*M =  mods3600(129596581.038354 * T +  1287104.76154);*/
-M =  mods3600(129600000.0 * fracT - 3418.961646 * T +  1287104.76154);
-M += ((((((((
-  1.62e-20 * T
-- 1.0390e-17 ) * T
-- 3.83508e-15 ) * T
-+ 4.237343e-13 ) * T
-+ 8.8555011e-11 ) * T
-- 4.77258489e-8 ) * T
-- 1.1297037031e-5 ) * T
-+ 1.4732069041e-4 ) * T
-- 0.552891801772 ) * T2;
+ms->M =  mods3600(129600000.0 * fracT - 3418.961646 * ms->T +  1287104.76154);
+ms->M += ((((((((
+  1.62e-20 * ms->T
+- 1.0390e-17 ) * ms->T
+- 3.83508e-15 ) * ms->T
++ 4.237343e-13 ) * ms->T
++ 8.8555011e-11 ) * ms->T
+- 4.77258489e-8 ) * ms->T
+- 1.1297037031e-5 ) * ms->T
++ 1.4732069041e-4 ) * ms->T
+- 0.552891801772 ) * ms->T2;
 #ifdef MOSH_MOON_200
 /* Mean distance of moon from its ascending node = F */
-NF = mods3600( 1739527263.0983 * T + 335779.55755 );
+ms->NF = mods3600( 1739527263.0983 * ms->T + 335779.55755 );
 /* Mean anomaly of moon = l */
-MP = mods3600( 1717915923.4728 * T +  485868.28096 );
+ms->MP = mods3600( 1717915923.4728 * ms->T +  485868.28096 );
 /* Mean elongation of moon = D */
-D = mods3600( 1602961601.4603 * T + 1072260.73512 );
+ms->D = mods3600( 1602961601.4603 * ms->T + 1072260.73512 );
 /* Mean longitude of moon */
-SWELP = mods3600( 1732564372.83264 * T +  785939.95571 );                      
+ms->SWELP = mods3600( 1732564372.83264 * ms->T +  785939.95571 );                      
 /* Higher degree secular terms found by least squares fit */
-NF += (((((z[5] *T+z[4] )*T + z[3] )*T + z[2] )*T + z[1] )*T + z[0] )*T2;
-MP += (((((z[11]*T+z[10])*T + z[9] )*T + z[8] )*T + z[7] )*T + z[6] )*T2;
-D  += (((((z[17]*T+z[16])*T + z[15])*T + z[14])*T + z[13])*T + z[12])*T2;
-SWELP += (((((z[23]*T+z[22])*T + z[21])*T + z[20])*T + z[19])*T + z[18])*T2;    
+ms->NF += (((((z[5] *ms->T+z[4] )*ms->T + z[3] )*ms->T + z[2] )*ms->T + z[1] )*ms->T + z[0] )*ms->T2;
+ms->MP += (((((z[11]*ms->T+z[10])*ms->T + z[9] )*ms->T + z[8] )*ms->T + z[7] )*ms->T + z[6] )*ms->T2;
+ms->D  += (((((z[17]*ms->T+z[16])*ms->T + z[15])*ms->T + z[14])*ms->T + z[13])*ms->T + z[12])*ms->T2;
+ms->SWELP += (((((z[23]*ms->T+z[22])*ms->T + z[21])*ms->T + z[20])*ms->T + z[19])*ms->T + z[18])*ms->T2;    
 #else
 /* Mean distance of moon from its ascending node = F */
 /*NF = mods3600((1739527263.0983 - 2.079419901760e-01) * T + 335779.55755);*/
-NF = mods3600(1739232000.0 * fracT + 295263.0983 * T - 2.079419901760e-01 * T + 335779.55755);
+ms->NF = mods3600(1739232000.0 * fracT + 295263.0983 * ms->T - 2.079419901760e-01 * ms->T + 335779.55755);
 /* Mean anomaly of moon = l */
 /*MP = mods3600((1717915923.4728 - 2.035946368532e-01) * T +  485868.28096);*/
-MP = mods3600(1717200000.0 * fracT + 715923.4728 * T - 2.035946368532e-01 * T +  485868.28096);
+ms->MP = mods3600(1717200000.0 * fracT + 715923.4728 * ms->T - 2.035946368532e-01 * ms->T +  485868.28096);
 /* Mean elongation of moon = D */
 /*D = mods3600((1602961601.4603 + 3.962893294503e-01) * T + 1072260.73512);*/
-D = mods3600(1601856000.0 * fracT + 1105601.4603 * T + 3.962893294503e-01 * T + 1072260.73512);
+ms->D = mods3600(1601856000.0 * fracT + 1105601.4603 * ms->T + 3.962893294503e-01 * ms->T + 1072260.73512);
 /* Mean longitude of moon, referred to the mean ecliptic and equinox of date */
 /*SWELP = mods3600((1732564372.83264 - 6.784914260953e-01) * T +  785939.95571);*/
-SWELP = mods3600(1731456000.0 * fracT + 1108372.83264 * T - 6.784914260953e-01 * T +  785939.95571);
+ms->SWELP = mods3600(1731456000.0 * fracT + 1108372.83264 * ms->T - 6.784914260953e-01 * ms->T +  785939.95571);
 /* Higher degree secular terms found by least squares fit */
-NF += ((z[2]*T + z[1])*T + z[0])*T2;
-MP += ((z[5]*T + z[4])*T + z[3])*T2;
-D  += ((z[8]*T + z[7])*T + z[6])*T2;
-SWELP += ((z[11]*T + z[10])*T + z[9])*T2;
+ms->NF += ((z[2]*ms->T + z[1])*ms->T + z[0])*ms->T2;
+ms->MP += ((z[5]*ms->T + z[4])*ms->T + z[3])*ms->T2;
+ms->D  += ((z[8]*ms->T + z[7])*ms->T + z[6])*ms->T2;
+ms->SWELP += ((z[11]*ms->T + z[10])*ms->T + z[9])*ms->T2;
 #endif	/* ! MOSH_MOON_200 */
 /* sensitivity of mean elements
  *    delta argument = scale factor times delta amplitude (arcsec)
@@ -1817,42 +1952,43 @@ SWELP += ((z[11]*T + z[10])*T + z[9])*T2;
  */
 }
 
-void mean_elements_pl(void)
+void mean_elements_pl(struct moon_state *ms)
 {
 /* Mean longitudes of planets (Laskar, Bretagnon) */
-Ve = mods3600( 210664136.4335482 * T + 655127.283046 );
-Ve += ((((((((
-  -9.36e-023 * T
- - 1.95e-20 ) * T
- + 6.097e-18 ) * T
- + 4.43201e-15 ) * T
- + 2.509418e-13 ) * T
- - 3.0622898e-10 ) * T
- - 2.26602516e-9 ) * T
- - 1.4244812531e-5 ) * T
- + 0.005871373088 ) * T2;
-Ea = mods3600( 129597742.26669231  * T +  361679.214649 );
-Ea += (((((((( -1.16e-22 * T
- + 2.976e-19 ) * T
- + 2.8460e-17 ) * T
- - 1.08402e-14 ) * T
- - 1.226182e-12 ) * T
- + 1.7228268e-10 ) * T
- + 1.515912254e-7 ) * T
- + 8.863982531e-6 ) * T
- - 2.0199859001e-2 ) * T2;
-Ma = mods3600(  68905077.59284 * T + 1279559.78866 );
-Ma += (-1.043e-5*T + 9.38012e-3)*T2;
-Ju = mods3600( 10925660.428608 * T +  123665.342120 );
-Ju += (1.543273e-5*T - 3.06037836351e-1)*T2;
-Sa = mods3600( 4399609.65932 * T + 180278.89694 );
-Sa += (( 4.475946e-8*T - 6.874806E-5 ) * T + 7.56161437443E-1)*T2;
+ms->Ve = mods3600( 210664136.4335482 * ms->T + 655127.283046 );
+ms->Ve += ((((((((
+  -9.36e-023 * ms->T
+ - 1.95e-20 ) * ms->T
+ + 6.097e-18 ) * ms->T
+ + 4.43201e-15 ) * ms->T
+ + 2.509418e-13 ) * ms->T
+ - 3.0622898e-10 ) * ms->T
+ - 2.26602516e-9 ) * ms->T
+ - 1.4244812531e-5 ) * ms->T
+ + 0.005871373088 ) * ms->T2;
+ms->Ea = mods3600( 129597742.26669231  * ms->T +  361679.214649 );
+ms->Ea += (((((((( -1.16e-22 * ms->T
+ + 2.976e-19 ) * ms->T
+ + 2.8460e-17 ) * ms->T
+ - 1.08402e-14 ) * ms->T
+ - 1.226182e-12 ) * ms->T
+ + 1.7228268e-10 ) * ms->T
+ + 1.515912254e-7 ) * ms->T
+ + 8.863982531e-6 ) * ms->T
+ - 2.0199859001e-2 ) * ms->T2;
+ms->Ma = mods3600(  68905077.59284 * ms->T + 1279559.78866 );
+ms->Ma += (-1.043e-5*ms->T + 9.38012e-3)*ms->T2;
+ms->Ju = mods3600( 10925660.428608 * ms->T +  123665.342120 );
+ms->Ju += (1.543273e-5*ms->T - 3.06037836351e-1)*ms->T2;
+ms->Sa = mods3600( 4399609.65932 * ms->T + 180278.89694 );
+ms->Sa += (( 4.475946e-8*ms->T - 6.874806E-5 ) * ms->T + 7.56161437443E-1)*ms->T2;
 }
 
 /* Calculate geometric coordinates of true interpolated Moon apsides
  */
 int swi_intp_apsides(double J, double *pol, int ipli)
 {
+struct moon_state mst, *ms = &mst;
 double dd;
 double rsv[3];
 double sNF, sD, sLP, sMP, sM, sVe, sEa, sMa, sJu, sSa, fM, fVe, fEa, fMa, fJu, fSa, cMP, zMP, fNF, fD, fLP;
@@ -1869,60 +2005,60 @@ fEa = 365.2563629/zMP;
 fMa = 686.9798519/zMP;
 fJu = 4332.589348/zMP;
 fSa = 10759.22722/zMP;
-T = (J-J2000)/36525.0;
-T2 = T*T;
-T4 = T2*T2;
-mean_elements();
-mean_elements_pl();
-sNF = NF;
-sD  = D;
-sLP = SWELP;
-sMP = MP;
-sM  = M ;
-sVe = Ve;
-sEa = Ea;
-sMa = Ma;
-sJu = Ju;
-sSa = Sa;
-sNF = mods3600(NF);
-sD  = mods3600(D);
-sLP = mods3600(SWELP);
-sMP = mods3600(MP);
-if (ipli == SEI_INTP_PERG) {MP = 0.0; niter = 5;}
-if (ipli == SEI_INTP_APOG) {MP = 648000.0; niter = 4;}
+ms->T = (J-J2000)/36525.0;
+ms->T2 = ms->T*ms->T;
+ms->T4 = ms->T2*ms->T2;
+mean_elements(ms);
+mean_elements_pl(ms);
+sNF = ms->NF;
+sD  = ms->D;
+sLP = ms->SWELP;
+sMP = ms->MP;
+sM  = ms->M ;
+sVe = ms->Ve;
+sEa = ms->Ea;
+sMa = ms->Ma;
+sJu = ms->Ju;
+sSa = ms->Sa;
+sNF = mods3600(ms->NF);
+sD  = mods3600(ms->D);
+sLP = mods3600(ms->SWELP);
+sMP = mods3600(ms->MP);
+if (ipli == SEI_INTP_PERG) {ms->MP = 0.0; niter = 5;}
+if (ipli == SEI_INTP_APOG) {ms->MP = 648000.0; niter = 4;}
 cMP = 0;
 dd = 18000.0;
 for (iii= 0; iii<=niter; iii++) {/**/
- dMP = sMP - MP;
+ dMP = sMP - ms->MP;
  mLP = sLP - dMP;
  mNF = sNF - dMP;
  mD  = sD  - dMP;
  mMP = sMP - dMP;
  for (ii = 0; ii <=2; ii++) {/**/
-   MP = mMP + (ii-1)*dd;       /**/
-   NF = mNF + (ii-1)*dd/fNF;
-   D  = mD  + (ii-1)*dd/fD;
-   SWELP = mLP + (ii-1)*dd/fLP;
-   M  = sM  + (ii-1)*dd/fM ;
-   Ve = sVe + (ii-1)*dd/fVe;
-   Ea = sEa + (ii-1)*dd/fEa;
-   Ma = sMa + (ii-1)*dd/fMa;
-   Ju = sJu + (ii-1)*dd/fJu;
-   Sa = sSa + (ii-1)*dd/fSa;
-   moon1();
-   moon2();
-   moon3();
-   moon4();
+   ms->MP = mMP + (ii-1)*dd;       /**/
+   ms->NF = mNF + (ii-1)*dd/fNF;
+   ms->D  = mD  + (ii-1)*dd/fD;
+   ms->SWELP = mLP + (ii-1)*dd/fLP;
+   ms->M  = sM  + (ii-1)*dd/fM ;
+   ms->Ve = sVe + (ii-1)*dd/fVe;
+   ms->Ea = sEa + (ii-1)*dd/fEa;
+   ms->Ma = sMa + (ii-1)*dd/fMa;
+   ms->Ju = sJu + (ii-1)*dd/fJu;
+   ms->Sa = sSa + (ii-1)*dd/fSa;
+   moon1(ms);
+   moon2(ms);
+   moon3(ms);
+   moon4(ms);
    if (ii==1) {
-     for( i=0; i<3; i++ ) pol[i] = moonpol[i];
+     for( i=0; i<3; i++ ) pol[i] = ms->moonpol[i];
    }
-   rsv[ii] = moonpol[2];
+   rsv[ii] = ms->moonpol[2];
  }
  cMP = (1.5*rsv[0] - 2*rsv[1] + 0.5*rsv[2]) / (rsv[0] + rsv[2] - 2*rsv[1]);/**/
  cMP *= dd;
  cMP = cMP - dd;
  mMP += cMP;
- MP = mMP;
+ ms->MP = mMP;
  dd /= 10;
 }
 return(0);
@@ -129,7 +129,25 @@ static const struct plantbl *planets[] =
 static TLS double ss[9][24];
 static TLS double cc[9][24];
 
+/* multiple angles for swi_moshplan2_batch(), one column per date, so that
+ * the innermost loops run over dates and can be vectorised */
+#define MOSH_NBATCH 8
+static TLS double ssb[9][24][MOSH_NBATCH];
+static TLS double ccb[9][24][MOSH_NBATCH];
+
 static void sscc (int k, double arg, int n);
+static void sscc_batch (int k, const double *arg, int n);
+static void sscc_batch_grid (int k, double arg, double darg, int n);
+
+/* positions precomputed by swi_moshplan_prefetch(), per Moshier body,
+ * sorted by date */
+static TLS struct mosh_cache {
+  int n;
+  double *J;
+  double *x;
+} mcache[9];
+
+static int mcache_lookup (double J, int iplm, double *pobj);
 
 int swi_moshplan2 (double J, int iplm, double *pobj)
 {
@@ -140,6 +158,8 @@ int swi_moshplan2 (double J, int iplm, double *pobj)
   double t, sl, sb, sr;
   const struct plantbl *plan = planets[iplm];
 
+  if (mcache[iplm].n > 0 && mcache_lookup (J, iplm, pobj))
+    return OK;
   T = (J - J2000) / TIMESCALE;
   /* Calculate sin( i*MM ), etc. for needed multiple angles.  */
   for (i = 0; i < 9; i++)
@@ -263,6 +283,280 @@ int swi_moshplan2 (double J, int iplm, double *pobj)
   return OK;
 }
 
+/* Same as swi_moshplan2(), for nb dates J[0..nb-1] at once.
+ * pobj receives 3 values per date.
+ * The tables are walked once per group of MOSH_NBATCH dates, and each
+ * term is evaluated for all dates of the group in loops of fixed length
+ * (a short last group is padded with its last date). The operations per
+ * date are the same as in swi_moshplan2(), so are the results.
+ * Exception: if the group is on the uniform grid of swe_set_uniform_grid(),
+ * the mean longitudes of the later dates are obtained by rotating those
+ * of the first date (differences ~1e-15 rad).
+ */
+int swi_moshplan2_batch (const double *J, int nb, int iplm, double *pobj)
+{
+  int i, j, k, l, m, k1, ip, np, nt, n, i0, uniform;
+  signed char *p;
+  double *pl, *pb, *pr;
+  double t, sgn, step = swed.grid_step;
+  double T[MOSH_NBATCH], arg[MOSH_NBATCH];
+  double sl[MOSH_NBATCH], sb[MOSH_NBATCH], sr[MOSH_NBATCH];
+  double sv[MOSH_NBATCH], cv[MOSH_NBATCH];
+  double su[MOSH_NBATCH], cu[MOSH_NBATCH];
+  const struct plantbl *plan = planets[iplm];
+
+  for (i0 = 0; i0 < nb; i0 += MOSH_NBATCH)
+    {
+      n = nb - i0;
+      if (n > MOSH_NBATCH)
+	n = MOSH_NBATCH;
+      for (l = 0; l < MOSH_NBATCH; l++)
+	T[l] = (J[i0 + (l < n ? l : n - 1)] - J2000) / TIMESCALE;
+      uniform = (step != 0 && n == MOSH_NBATCH);
+      for (l = 1; l < MOSH_NBATCH && uniform; l++)
+	uniform = fabs (J[i0 + l] - J[i0] - l * step) < 1e-7;
+      /* Calculate sin( i*MM ), etc. for needed multiple angles.  */
+      for (i = 0; i < 9; i++)
+	{
+	  if ((j = plan->max_harmonic[i]) > 0)
+	    {
+	      if (uniform)
+		{
+		  arg[0] = (mods3600 (freqs[i] * T[0]) + phases[i]) * STR;
+		  sscc_batch_grid (i, arg[0], freqs[i] * step / TIMESCALE * STR, j);
+		  continue;
+		}
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		arg[l] = (mods3600 (freqs[i] * T[l]) + phases[i]) * STR;
+	      sscc_batch (i, arg, j);
+	    }
+	}
+      p = plan->arg_tbl;
+      pl = plan->lon_tbl;
+      pb = plan->lat_tbl;
+      pr = plan->rad_tbl;
+      for (l = 0; l < MOSH_NBATCH; l++)
+	{
+	  sl[l] = 0.0;
+	  sb[l] = 0.0;
+	  sr[l] = 0.0;
+	}
+      for (;;)
+	{
+	  np = *p++;
+	  if (np < 0)
+	    break;
+	  if (np == 0)
+	    {			/* It is a polynomial term.  */
+	      nt = *p++;
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		cu[l] = *pl;
+	      for (ip = 0; ip < nt; ip++)
+		for (l = 0; l < MOSH_NBATCH; l++)
+		  cu[l] = cu[l] * T[l] + pl[ip + 1];
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		sl[l] += mods3600 (cu[l]);
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		cu[l] = *pb;
+	      for (ip = 0; ip < nt; ip++)
+		for (l = 0; l < MOSH_NBATCH; l++)
+		  cu[l] = cu[l] * T[l] + pb[ip + 1];
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		sb[l] += cu[l];
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		cu[l] = *pr;
+	      for (ip = 0; ip < nt; ip++)
+		for (l = 0; l < MOSH_NBATCH; l++)
+		  cu[l] = cu[l] * T[l] + pr[ip + 1];
+	      for (l = 0; l < MOSH_NBATCH; l++)
+		sr[l] += cu[l];
+	      pl += nt + 1;
+	      pb += nt + 1;
+	      pr += nt + 1;
+	      continue;
+	    }
+	  k1 = 0;
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    {
+	      cv[l] = 0.0;
+	      sv[l] = 0.0;
+	    }
+	  for (ip = 0; ip < np; ip++)
+	    {
+	      j = *p++;
+	      m = *p++ - 1;
+	      if (j)
+		{
+		  k = (j < 0 ? -j : j) - 1;
+		  sgn = (j < 0) ? -1.0 : 1.0;
+		  if (k1 == 0)
+		    {		/* set first angle */
+		      for (l = 0; l < MOSH_NBATCH; l++)
+			{
+			  sv[l] = sgn * ssb[m][k][l];
+			  cv[l] = ccb[m][k][l];
+			}
+		      k1 = 1;
+		    }
+		  else
+		    {		/* combine angles */
+		      for (l = 0; l < MOSH_NBATCH; l++)
+			{
+			  t = sgn * ssb[m][k][l] * cv[l] + ccb[m][k][l] * sv[l];
+			  cv[l] = ccb[m][k][l] * cv[l] - sgn * ssb[m][k][l] * sv[l];
+			  sv[l] = t;
+			}
+		    }
+		}
+	    }
+	  nt = *p++;
+	  /* Longitude, latitude and radius amplitudes.  */
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    {
+	      cu[l] = pl[0];
+	      su[l] = pl[1];
+	    }
+	  for (ip = 0; ip < nt; ip++)
+	    for (l = 0; l < MOSH_NBATCH; l++)
+	      {
+		cu[l] = cu[l] * T[l] + pl[2 * ip + 2];
+		su[l] = su[l] * T[l] + pl[2 * ip + 3];
+	      }
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    sl[l] += cu[l] * cv[l] + su[l] * sv[l];
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    {
+	      cu[l] = pb[0];
+	      su[l] = pb[1];
+	    }
+	  for (ip = 0; ip < nt; ip++)
+	    for (l = 0; l < MOSH_NBATCH; l++)
+	      {
+		cu[l] = cu[l] * T[l] + pb[2 * ip + 2];
+		su[l] = su[l] * T[l] + pb[2 * ip + 3];
+	      }
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    sb[l] += cu[l] * cv[l] + su[l] * sv[l];
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    {
+	      cu[l] = pr[0];
+	      su[l] = pr[1];
+	    }
+	  for (ip = 0; ip < nt; ip++)
+	    for (l = 0; l < MOSH_NBATCH; l++)
+	      {
+		cu[l] = cu[l] * T[l] + pr[2 * ip + 2];
+		su[l] = su[l] * T[l] + pr[2 * ip + 3];
+	      }
+	  for (l = 0; l < MOSH_NBATCH; l++)
+	    sr[l] += cu[l] * cv[l] + su[l] * sv[l];
+	  pl += 2 * nt + 2;
+	  pb += 2 * nt + 2;
+	  pr += 2 * nt + 2;
+	}
+      for (l = 0; l < n; l++)
+	{
+	  pobj[3 * (i0 + l)] = STR * sl[l];
+	  pobj[3 * (i0 + l) + 1] = STR * sb[l];
+	  pobj[3 * (i0 + l) + 2] = STR * plan->distance * sr[l] + plan->distance;
+	}
+    }
+  return OK;
+}
+
+static int mcache_lookup (double J, int iplm, double *pobj)
+{
+  struct mosh_cache *mc = &mcache[iplm];
+  int lo = 0, hi = mc->n - 1, mid;
+  while (lo <= hi)
+    {
+      mid = (lo + hi) / 2;
+      if (mc->J[mid] < J)
+	lo = mid + 1;
+      else if (mc->J[mid] > J)
+	hi = mid - 1;
+      else
+	{
+	  pobj[0] = mc->x[3 * mid];
+	  pobj[1] = mc->x[3 * mid + 1];
+	  pobj[2] = mc->x[3 * mid + 2];
+	  return TRUE;
+	}
+    }
+  return FALSE;
+}
+
+static int dcmp (const void *a, const void *b)
+{
+  double d = *(const double *) a - *(const double *) b;
+  return (d > 0) - (d < 0);
+}
+
+/* Precompute the Moshier theory of internal planet ipli for the dates
+ * tjd[0..n-1], together with the dates used for the speed, with
+ * swi_moshplan2_batch(). Later calls of swi_moshplan2() for these dates
+ * are answered from memory. Previous dates of the body are discarded;
+ * n = 0 only frees them.
+ * The dates and the speed dates are batched as two separate series, so
+ * that a uniform grid of dates stays uniform in each batch, and then
+ * merged.
+ */
+int swi_moshplan_prefetch (const double *tjd, int n, int ipli)
+{
+  int i, j, m, k, iplm = pnoint2msh[ipli];
+  struct mosh_cache *mc = &mcache[iplm];
+  double *J, *x;
+  free (mc->J);
+  free (mc->x);
+  mc->n = 0;
+  mc->J = NULL;
+  mc->x = NULL;
+  if (n <= 0)
+    return OK;
+  J = (double *) malloc (4 * n * sizeof (double));
+  x = (double *) malloc (12 * n * sizeof (double));
+  if (J == NULL || x == NULL)
+    {
+      free (J);
+      free (x);
+      return ERR;
+    }
+  for (i = 0, m = 0; i < n; i++)
+    {
+      if (tjd[i] < MOSHPLEPH_START - 0.3 || tjd[i] > MOSHPLEPH_END + 0.3)
+	continue;
+      J[m++] = tjd[i];
+    }
+  qsort (J, m, sizeof (double), dcmp);
+  for (i = 1, n = (m > 0); i < m; i++)
+    if (J[i] != J[n - 1])
+      J[n++] = J[i];
+  for (i = 0; i < n; i++)
+    J[n + i] = J[i] - PLAN_SPEED_INTV;
+  swi_moshplan2_batch (J, n, iplm, x);
+  swi_moshplan2_batch (J + n, n, iplm, x + 3 * n);
+  /* merge the two sorted series into J + 2 * n, x + 6 * n */
+  for (i = 0, j = n, k = 2 * n; i < n || j < 2 * n; )
+    {
+      if (j == 2 * n || (i < n && J[i] <= J[j]))
+	m = i++;
+      else
+	m = j++;
+      if (k > 2 * n && J[m] == J[k - 1])
+	continue;
+      J[k] = J[m];
+      memcpy (x + 3 * k, x + 3 * m, 3 * sizeof (double));
+      k++;
+    }
+  k -= 2 * n;
+  memmove (J, J + 2 * n, k * sizeof (double));
+  memmove (x, x + 6 * n, 3 * k * sizeof (double));
+  mc->J = J;
+  mc->x = x;
+  mc->n = k;
+  return OK;
+}
+
 /* Moshier ephemeris.
  * computes heliocentric cartesian equatorial coordinates of
  * equinox 2000
@@ -408,6 +702,65 @@ static void sscc (int k, double arg, int n)
 }
 
 
+/* Same as sscc(), for MOSH_NBATCH angles arg[] at once */
+static void sscc_batch (int k, const double *arg, int n)
+{
+  double s[MOSH_NBATCH];
+  int i, l;
+
+  for (l = 0; l < MOSH_NBATCH; l++)
+    {
+      ssb[k][0][l] = sin (arg[l]);	/* sin(L) */
+      ccb[k][0][l] = cos (arg[l]);	/* cos(L) */
+    }
+  for (l = 0; l < MOSH_NBATCH; l++)
+    {
+      ssb[k][1][l] = 2.0 * ssb[k][0][l] * ccb[k][0][l];
+      ccb[k][1][l] = ccb[k][0][l] * ccb[k][0][l] - ssb[k][0][l] * ssb[k][0][l];
+    }
+  for (i = 2; i < n; i++)
+    {
+      for (l = 0; l < MOSH_NBATCH; l++)
+	{
+	  s[l] = ssb[k][0][l] * ccb[k][i-1][l] + ccb[k][0][l] * ssb[k][i-1][l];
+	  ccb[k][i][l] = ccb[k][0][l] * ccb[k][i-1][l] - ssb[k][0][l] * ssb[k][i-1][l];
+	  ssb[k][i][l] = s[l];
+	}
+    }
+}
+
+
+/* Same as sscc_batch(), for the angles arg + l * darg, l = 0..MOSH_NBATCH-1 */
+static void sscc_batch_grid (int k, double arg, double darg, int n)
+{
+  double s[MOSH_NBATCH];
+  double sd = sin (darg), cd = cos (darg);
+  int i, l;
+
+  ssb[k][0][0] = sin (arg);
+  ccb[k][0][0] = cos (arg);
+  for (l = 1; l < MOSH_NBATCH; l++)
+    {
+      ssb[k][0][l] = ssb[k][0][l-1] * cd + ccb[k][0][l-1] * sd;
+      ccb[k][0][l] = ccb[k][0][l-1] * cd - ssb[k][0][l-1] * sd;
+    }
+  for (l = 0; l < MOSH_NBATCH; l++)
+    {
+      ssb[k][1][l] = 2.0 * ssb[k][0][l] * ccb[k][0][l];
+      ccb[k][1][l] = ccb[k][0][l] * ccb[k][0][l] - ssb[k][0][l] * ssb[k][0][l];
+    }
+  for (i = 2; i < n; i++)
+    {
+      for (l = 0; l < MOSH_NBATCH; l++)
+	{
+	  s[l] = ssb[k][0][l] * ccb[k][i-1][l] + ccb[k][0][l] * ssb[k][i-1][l];
+	  ccb[k][i][l] = ccb[k][0][l] * ccb[k][i-1][l] - ssb[k][0][l] * ssb[k][i-1][l];
+	  ssb[k][i][l] = s[l];
+	}
+    }
+}
+
+
 /* Adjust position from Earth-Moon barycenter to Earth
  *
  * J = Julian day number
@@ -89,8 +89,10 @@
 #else
 #define TLS     __declspec(thread)
 #endif
+#define HAVE_TLS 1
 #else
 #define TLS
+#define HAVE_TLS 0	/* swed and the static caches are shared by all threads */
 #endif
 
 #ifdef _WIN32		/* Microsoft VC 5.0 does not define MSDOS anymore */
@@ -117,8 +117,7 @@ TLS struct swe_data swed = {FALSE,	/* ephe_path_is_set = FALSE */
 			    "",		/* astelem[] */
 			    0, 		/* i_saved_planet_name */
 			    "",		/* saved_planet_name[] */
-			    NULL,	/* dpsi */
-			    NULL,	/* deps */
+			    NULL,	/* eop */
 			    0,		/* timeout */
 			    {0,0,0,0,0,0,0,0,}, /* astro_models */
 			    };
@@ -209,7 +208,6 @@ static int app_pos_etc_sun(int32 iflag, char *serr);
 static int app_pos_etc_moon(int32 iflag, char *serr);
 static int app_pos_etc_sbar(int32 iflag, char *serr);
 extern int swi_plan_for_osc_elem(int32 iflag, double tjd, double *xx);
-static void swi_close_keep_topo_etc(void); 
 static int app_pos_etc_mean(int ipl, int32 iflag, char *serr);
 static void nut_matrix(struct nut *nu, struct epsilon *oec); 
 static void calc_epsilon(double tjd, int32 iflag, struct epsilon *e);
@@ -221,8 +219,17 @@ static void calc_speed(double *x0, double *x1, double *x2, double dt);
 static int32 plaus_iflag(int32 iflag, int32 ipl, double tjd, char *serr);
 static int app_pos_rest(struct plan_data *pdp, int32 iflag, 
     double *xx, double *x2000, struct epsilon *oe, char *serr);
+static void frame_to_date(double *xx, double *x2000, double teval, 
+    double tbias, int32 iflag, AS_BOOL do_bias);
+static void ecl_sincos(struct epsilon *oe, int32 iflag, double *seps, double *ceps);
 static int open_jpl_file(double *ss, char *fname, char *fpath, char *serr);
+static int32 jpl_prefetch(double *tjd, int32 *ipl, int32 n);
+static int seg_cache_get(double tjd, int ipl);
+static size_t seg_cache_put(int ipl);
+static int shm_seg_get(double tjd, int ipl, int ifno);
+static void shm_seg_put(double tjd, int ipl, int ifno);
 static void free_planets(void);
+static void eop_release(struct eop_table *eop);
 
 #ifdef TRACE
 static void trace_swe_calc(int param, double tjd, int ipl, int32 iflag, double *xx, char *serr);
@@ -584,6 +591,493 @@ int32 CALL_CONV swe_calc_ut(double tjd_ut, int32 ipl, int32 iflag,
   return retval;
 }
 
+/* Precompute the IAU 2000 nutation for the dates tjd[0..n-1] (ET) and,
+ * if the Moshier ephemeris is requested, the Moshier planetary theory
+ * for the bodies ipl[0..n-1] at these dates, in one batch, which speeds
+ * up the following swe_calc() calls for these dates and bodies. With
+ * the JPL ephemeris, the bodies are interpolated from the JPL file in one 
+ * batch, record by record.
+ * n = 0 frees the precomputed values.
+ */
+int32 CALL_CONV swe_calc_prefetch(double *tjd, int32 *ipl, int32 n, int32 iflag)
+{
+  int i, m, ipli;
+  double *t;
+  for (ipli = SEI_EMB; ipli <= SEI_PLUTO; ipli++) {
+    if (ipli != SEI_MOON)
+      swi_moshplan_prefetch(NULL, 0, ipli);
+  }
+  if (swed.jpl_file_is_open)
+    swi_pleph_prefetch(NULL, 0, 0, NULL);
+  /* nutation, for all ephemerides; not needed on a uniform grid */
+  if (swed.grid_step != 0 || (iflag & SEFLG_NONUT))
+    swi_nutation_prefetch(NULL, 0);
+  else if (swi_nutation_prefetch(tjd, n) != OK)
+    return ERR;
+  if (n > 0 && (iflag & SEFLG_EPHMASK) == SEFLG_JPLEPH)
+    return jpl_prefetch(tjd, ipl, n);
+  if (n <= 0 || (iflag & SEFLG_EPHMASK) != SEFLG_MOSEPH)
+    return OK;
+  if ((t = (double *) malloc(n * sizeof(double))) == NULL)
+    return ERR;
+  /* the earth is needed for all bodies */
+  if (swi_moshplan_prefetch(tjd, n, SEI_EMB) != OK) {
+    free(t);
+    return ERR;
+  }
+  for (ipli = SEI_MERCURY; ipli <= SEI_PLUTO; ipli++) {
+    for (i = 0, m = 0; i < n; i++) {
+      if (ipl[i] >= SE_MERCURY && ipl[i] <= SE_PLUTO && pnoext2int[ipl[i]] == ipli)
+	t[m++] = tjd[i];
+    }
+    if (m > 0 && swi_moshplan_prefetch(t, m, ipli) != OK) {
+      free(t);
+      return ERR;
+    }
+  }
+  free(t);
+  return OK;
+}
+
+/* the JPL part of swe_calc_prefetch(): earth, moon and sun, which all
+ * bodies need, and the planets in ipl[]. The file is opened here if it
+ * is not yet; if it cannot be opened, swe_calc() will report it. */
+static int32 jpl_prefetch(double *tjd, int32 *ipl, int32 n)
+{
+  int i;
+  int32 mask = (1 << J_EARTH) | (1 << J_MOON);
+  double ss[3];
+  if (!swed.jpl_file_is_open 
+      && open_jpl_file(ss, swed.jplfnam, swed.ephepath, NULL) != OK)
+    return OK;
+  for (i = 0; i < n; i++) {
+    if (ipl[i] >= SE_MERCURY && ipl[i] <= SE_PLUTO)
+      mask |= 1 << pnoint2jpl[pnoext2int[ipl[i]]];
+  }
+  if (swi_pleph_prefetch(tjd, n, mask, NULL) != OK)
+    return ERR;
+  return OK;
+}
+
+/* Copies the segment of body ipl for tjd from the cache of swe_prefetch()
+ * into pdp->segp, if it is there. The segment is looked up as 
+ * get_new_segment() computes it, in the file that is open for tjd. */
+static int seg_cache_get(double tjd, int ipl)
+{
+  struct plan_data *pdp = &swed.pldat[ipl];
+  struct seg_cache *scp = &swed.segc[ipl];
+  int lo = 0, hi = scp->n - 1, mid;
+  int32 iseg;
+  double tseg0;
+  size_t size;
+  if (scp->ncoe != pdp->ncoe || pdp->dseg <= 0)
+    return ERR;
+  iseg = (int32) ((tjd - pdp->tfstart) / pdp->dseg);
+  tseg0 = pdp->tfstart + iseg * pdp->dseg;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (scp->tseg0[mid] < tseg0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (scp->tseg0[lo] != tseg0 || scp->tfstart[lo] != pdp->tfstart)
+    return ERR;
+  size = (size_t) pdp->ncoe * 3 * sizeof(double);
+  if (pdp->segp == NULL && (pdp->segp = (double *) malloc(size)) == NULL)
+    return ERR;
+  memcpy((void *) pdp->segp, (void *) (scp->segp + lo * pdp->ncoe * 3), size);
+  pdp->tseg0 = scp->tseg0[lo];
+  pdp->tseg1 = scp->tseg1[lo];
+  pdp->neval = scp->neval[lo];
+  return OK;
+}
+
+/* Adds the current segment of body ipl to the cache of swe_prefetch().
+ * Returns the memory it takes, 0 if it was already there or if there is
+ * no memory. */
+static size_t seg_cache_put(int ipl)
+{
+  struct plan_data *pdp = &swed.pldat[ipl];
+  struct seg_cache *scp = &swed.segc[ipl];
+  int i, nc = pdp->ncoe * 3;
+  size_t size;
+  if (pdp->segp == NULL)
+    return 0;
+  if (scp->n > 0 && scp->ncoe != pdp->ncoe)
+    return 0;
+  scp->ncoe = pdp->ncoe;
+  for (i = scp->n; i > 0 && scp->tseg0[i - 1] >= pdp->tseg0; i--) {
+    if (scp->tseg0[i - 1] == pdp->tseg0 && scp->tfstart[i - 1] == pdp->tfstart)
+      return 0;
+  }
+  if (scp->n == scp->nalloc) {
+    int na = scp->nalloc == 0 ? 64 : 2 * scp->nalloc;
+    double *tf = (double *) realloc(scp->tfstart, na * sizeof(double));
+    double *t0 = tf == NULL ? NULL : (double *) realloc(scp->tseg0, na * sizeof(double));
+    double *t1 = t0 == NULL ? NULL : (double *) realloc(scp->tseg1, na * sizeof(double));
+    int *ne = t1 == NULL ? NULL : (int *) realloc(scp->neval, na * sizeof(int));
+    double *sp = ne == NULL ? NULL : (double *) realloc(scp->segp, (size_t) na * nc * sizeof(double));
+    if (tf != NULL) scp->tfstart = tf;
+    if (t0 != NULL) scp->tseg0 = t0;
+    if (t1 != NULL) scp->tseg1 = t1;
+    if (ne != NULL) scp->neval = ne;
+    if (sp == NULL)
+      return 0;
+    scp->segp = sp;
+    scp->nalloc = na;
+  }
+  size = (size_t) nc * sizeof(double);
+  memmove(scp->tfstart + i + 1, scp->tfstart + i, (scp->n - i) * sizeof(double));
+  memmove(scp->tseg0 + i + 1, scp->tseg0 + i, (scp->n - i) * sizeof(double));
+  memmove(scp->tseg1 + i + 1, scp->tseg1 + i, (scp->n - i) * sizeof(double));
+  memmove(scp->neval + i + 1, scp->neval + i, (scp->n - i) * sizeof(int));
+  memmove(scp->segp + (size_t) (i + 1) * nc, scp->segp + (size_t) i * nc, (scp->n - i) * size);
+  scp->tfstart[i] = pdp->tfstart;
+  scp->tseg0[i] = pdp->tseg0;
+  scp->tseg1[i] = pdp->tseg1;
+  scp->neval[i] = pdp->neval;
+  memcpy((void *) (scp->segp + (size_t) i * nc), (void *) pdp->segp, size);
+  scp->n++;
+  return size + 3 * sizeof(double) + sizeof(int);
+}
+
+/* Segment cache shared between processes: the decoded segments of the
+ * Swiss Ephemeris files, in a file that all processes calling 
+ * swe_set_segment_cache() with the same path map into memory, e.g. a file
+ * in /dev/shm. The process that creates the file writes its header;
+ * files of another layout, or smaller than their header says, are refused.
+ * A segment is keyed by its file, body and segment number and
+ * is written once into a slot found by hashing: a process claims an empty
+ * slot, fills it and then marks it ready, after which the slot does not 
+ * change. Readers therefore need no lock. If the slots of a key are all 
+ * taken, its segment is just not shared. */
+#define SHM_SEG_MAGIC   "SESEGCAC"
+#define SHM_SEG_VERSION 1
+#define SHM_SEG_NAMLEN  32
+#define SHM_SEG_NPROBE  8
+#define SHM_SEG_EMPTY   0
+#define SHM_SEG_BUSY    1
+#define SHM_SEG_READY   2
+
+struct shm_seg_hdr {
+  char magic[8];
+  unsigned int version;
+  unsigned int nslots;
+  unsigned int slotsize;
+  unsigned int reserve;
+};
+
+struct shm_seg {
+  unsigned int state;
+  int ipl, iseg, ncoe, neval, denum;
+  char fname[SHM_SEG_NAMLEN];	/* file name without directory */
+  double tfstart, tfend;	/* of the file */
+  double tseg0, tseg1;
+  double segp[3 * (MAXORD + 1)];
+};
+
+static struct shm_seg_hdr *shm_seg = NULL;
+static size_t shm_seg_len = 0;
+
+static unsigned int shm_load(unsigned int *p)
+{
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+/* returns the file name of ifno without directory, if it fits a slot */
+static const char *shm_seg_fname(int ifno)
+{
+  const char *fname = swed.fidat[ifno].fnam, *sp;
+  for (sp = fname; *sp != '\0'; sp++) {
+    if (*sp == '/' || *sp == '\\')
+      fname = sp + 1;
+  }
+  if (*fname == '\0' || strlen(fname) >= SHM_SEG_NAMLEN)
+    return NULL;
+  return fname;
+}
+
+static struct shm_seg *shm_seg_slot(const char *fname, int ipl, int iseg, int iprobe)
+{
+  unsigned int h = 2166136261u;
+  for (; *fname != '\0'; fname++)
+    h = (h ^ (unsigned char) *fname) * 16777619u;
+  h = (h ^ (unsigned int) ipl) * 16777619u;
+  h = (h ^ (unsigned int) iseg) * 16777619u;
+  h = (h + iprobe) % shm_seg->nslots;
+  return (struct shm_seg *) ((char *) shm_seg + sizeof(struct shm_seg_hdr) + (size_t) h * shm_seg->slotsize);
+}
+
+static AS_BOOL shm_seg_match(struct shm_seg *sp, const char *fname, int ipl, int iseg, int ifno)
+{
+  struct file_data *fdp = &swed.fidat[ifno];
+  return sp->ipl == ipl && sp->iseg == iseg && sp->ncoe == swed.pldat[ipl].ncoe
+    && sp->denum == fdp->sweph_denum && sp->tfstart == fdp->tfstart 
+    && sp->tfend == fdp->tfend && strcmp(sp->fname, fname) == 0;
+}
+
+/* Copies the segment of body ipl (file ifno) for tjd from the shared
+ * cache into pdp->segp, if it is there. */
+static int shm_seg_get(double tjd, int ipl, int ifno)
+{
+  struct plan_data *pdp = &swed.pldat[ipl];
+  struct shm_seg *sp;
+  const char *fname;
+  int i, iseg;
+  unsigned int state;
+  size_t size = (size_t) pdp->ncoe * 3 * sizeof(double);
+  if (pdp->ncoe > MAXORD + 1 || pdp->dseg <= 0 || (fname = shm_seg_fname(ifno)) == NULL)
+    return ERR;
+  iseg = (int) ((tjd - pdp->tfstart) / pdp->dseg);
+  for (i = 0; i < SHM_SEG_NPROBE; i++) {
+    sp = shm_seg_slot(fname, ipl, iseg, i);
+    if ((state = shm_load(&sp->state)) == SHM_SEG_EMPTY)
+      return ERR;
+    if (state != SHM_SEG_READY || !shm_seg_match(sp, fname, ipl, iseg, ifno))
+      continue;
+    if (pdp->segp == NULL && (pdp->segp = (double *) malloc(size)) == NULL)
+      return ERR;
+    memcpy((void *) pdp->segp, (void *) sp->segp, size);
+    pdp->tseg0 = sp->tseg0;
+    pdp->tseg1 = sp->tseg1;
+    pdp->neval = sp->neval;
+    return OK;
+  }
+  return ERR;
+}
+
+/* Adds the segment of body ipl (file ifno) that get_new_segment() has
+ * just read for tjd to the shared cache. */
+static void shm_seg_put(double tjd, int ipl, int ifno)
+{
+  struct plan_data *pdp = &swed.pldat[ipl];
+  struct shm_seg *sp;
+  const char *fname;
+  int i, iseg;
+  unsigned int state;
+  if (pdp->ncoe > MAXORD + 1 || pdp->dseg <= 0 || (fname = shm_seg_fname(ifno)) == NULL)
+    return;
+  iseg = (int) ((tjd - pdp->tfstart) / pdp->dseg);
+  for (i = 0; i < SHM_SEG_NPROBE; i++) {
+    sp = shm_seg_slot(fname, ipl, iseg, i);
+    state = SHM_SEG_EMPTY;
+    if (__atomic_compare_exchange_n(&sp->state, &state, SHM_SEG_BUSY, 0, 
+				    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+      sp->ipl = ipl;
+      sp->iseg = iseg;
+      sp->ncoe = pdp->ncoe;
+      sp->neval = pdp->neval;
+      sp->denum = swed.fidat[ifno].sweph_denum;
+      strcpy(sp->fname, fname);
+      sp->tfstart = swed.fidat[ifno].tfstart;
+      sp->tfend = swed.fidat[ifno].tfend;
+      sp->tseg0 = pdp->tseg0;
+      sp->tseg1 = pdp->tseg1;
+      memcpy((void *) sp->segp, (void *) pdp->segp, (size_t) pdp->ncoe * 3 * sizeof(double));
+      __atomic_store_n(&sp->state, SHM_SEG_READY, __ATOMIC_RELEASE);
+      return;
+    }
+    /* another process has it already */
+    if (state == SHM_SEG_READY && shm_seg_match(sp, fname, ipl, iseg, ifno))
+      return;
+  }
+}
+
+/* Attaches the process to the shared segment cache in the file path, 
+ * which is created with room for about nbytes of segments if it does not
+ * exist, and returns the number of its slots. path = NULL detaches it.
+ * Call it while no other thread of the process computes positions.
+ */
+int32 CALL_CONV swe_set_segment_cache(const char *path, size_t nbytes, char *serr)
+{
+  struct shm_seg_hdr *hdr, head;
+  size_t len = 0, minlen;
+  if (serr != NULL)
+    *serr = '\0';
+  swi_lock();
+  if (shm_seg != NULL) {
+    swi_unmap_file((void *) shm_seg, shm_seg_len);
+    shm_seg = NULL;
+    shm_seg_len = 0;
+  }
+  swi_unlock();
+  if (path == NULL)
+    return OK;
+#if MSDOS
+  if (serr != NULL)
+    strcpy(serr, "shared segment cache not supported on this platform");
+  return ERR;
+#else
+  minlen = sizeof(struct shm_seg_hdr) + SHM_SEG_NPROBE * sizeof(struct shm_seg);
+  if (nbytes < minlen)
+    nbytes = minlen;
+  if ((nbytes - sizeof(struct shm_seg_hdr)) / sizeof(struct shm_seg) > UINT_MAX)
+    nbytes = sizeof(struct shm_seg_hdr) + (size_t) UINT_MAX * sizeof(struct shm_seg);
+  /* header of a new file, which is otherwise filled with zeros, 
+   * i.e. all slots are empty */
+  memset((void *) &head, 0, sizeof(head));
+  memcpy(head.magic, SHM_SEG_MAGIC, 8);
+  head.version = SHM_SEG_VERSION;
+  head.slotsize = sizeof(struct shm_seg);
+  head.nslots = (unsigned int) ((nbytes - sizeof(struct shm_seg_hdr)) / sizeof(struct shm_seg));
+  if ((hdr = (struct shm_seg_hdr *) swi_map_shared_file(path, &head, sizeof(head), nbytes, &len)) == NULL) 
+    goto cache_error;
+  if (len < sizeof(struct shm_seg_hdr) 
+      || memcmp(hdr->magic, SHM_SEG_MAGIC, 8) != 0 
+      || hdr->version != SHM_SEG_VERSION
+      || hdr->slotsize != sizeof(struct shm_seg) || hdr->nslots < SHM_SEG_NPROBE
+      || len < sizeof(struct shm_seg_hdr) + (size_t) hdr->nslots * sizeof(struct shm_seg)) {
+    swi_unmap_file((void *) hdr, len);
+    if (serr != NULL) {
+      strcpy(serr, "invalid segment cache ");
+      strncat(serr, path, AS_MAXCH - 30);
+    }
+    return ERR;
+  }
+  swi_lock();
+  shm_seg = hdr;
+  shm_seg_len = len;
+  swi_unlock();
+  return (int32) hdr->nslots;
+cache_error:
+  if (serr != NULL) {
+    strcpy(serr, "could not map segment cache ");
+    strncat(serr, path, AS_MAXCH - 30);
+  }
+  return ERR;
+#endif
+}
+
+/* Decodes all segments of internal body ipli (file ifno) that cover
+ * tjd_start .. tjd_end into the cache of swe_prefetch(). */
+static int32 seg_prefetch(double tjd_start, double tjd_end, int ipli, int ifno, 
+	int32 iflag, size_t *nbytes, char *serr)
+{
+  int retc;
+  double t = tjd_start, x[6];
+  struct plan_data *pdp = &swed.pldat[ipli];
+  for (;;) {
+    /* force a computation, not a saved position */
+    pdp->teval = 0;
+    retc = sweph(t, ipli, ifno, iflag | SEFLG_SPEED, NULL, NO_SAVE, x, serr);
+    if (retc != OK)
+      return retc;
+    *nbytes += seg_cache_put(ipli);
+    if (pdp->tseg1 >= tjd_end || pdp->dseg <= 0)
+      break;
+    t = pdp->tseg1 + pdp->dseg / 2;
+    if (t > tjd_end)
+      t = tjd_end;
+  }
+  return OK;
+}
+
+/* Opens the ephemeris files that the bodies ipl[0..nipl-1] need for the
+ * dates tjd_start .. tjd_end (ET) and decodes all segments of the Swiss
+ * Ephemeris files for these dates in advance, so that the first swe_calc()
+ * calls for them do not wait for file access. With the JPL ephemeris, 
+ * the records of the file for these dates are paged into memory.
+ * The memory used is returned in nbytes. nipl = 0 frees the segments.
+ */
+int32 CALL_CONV swe_prefetch(double tjd_start, double tjd_end, int32 *ipl, int32 nipl, 
+	int32 iflag, size_t *nbytes, char *serr)
+{
+  int i, j, ipli, ifno, nbody;
+  int32 retc = OK, rc, epheflag;
+  int body[SEI_NPLANETS], bfile[SEI_NPLANETS];
+  double t0, t1, ss[3], xx[6];
+  size_t nb = 0;
+  char serr2[AS_MAXCH];
+  if (nbytes != NULL)
+    *nbytes = 0;
+  if (serr != NULL)
+    *serr = '\0';
+  for (i = 0; i < SEI_NPLANETS; i++) {
+    struct seg_cache *scp = &swed.segc[i];
+    free(scp->tfstart);
+    free(scp->tseg0);
+    free(scp->tseg1);
+    free(scp->neval);
+    free(scp->segp);
+    memset((void *) scp, 0, sizeof(struct seg_cache));
+  }
+  if (nipl <= 0 || ipl == NULL)
+    return OK;
+  swi_init_swed_if_start();
+  if (tjd_end < tjd_start) {
+    t0 = tjd_start;
+    tjd_start = tjd_end;
+    tjd_end = t0;
+  }
+  epheflag = iflag & SEFLG_EPHMASK;
+  if (epheflag == 0)
+    epheflag = SEFLG_SWIEPH;
+  if (epheflag & SEFLG_MOSEPH)
+    return OK;
+  if (epheflag & SEFLG_JPLEPH) {
+    if (!swed.jpl_file_is_open 
+	&& (retc = open_jpl_file(ss, swed.jplfnam, swed.ephepath, serr)) != OK)
+      return ERR;
+    nb = swi_jpl_prefetch_range(tjd_start, tjd_end);
+    if (nbytes != NULL)
+      *nbytes = nb;
+    return OK;
+  }
+  /* the earth, moon and barycentric sun are needed for all bodies */
+  body[0] = SEI_EMB; bfile[0] = SEI_FILE_PLANET;
+  body[1] = SEI_SUNBARY; bfile[1] = SEI_FILE_PLANET;
+  body[2] = SEI_MOON; bfile[2] = SEI_FILE_MOON;
+  nbody = 3;
+  for (i = 0; i < nipl; i++) {
+    if (ipl[i] > SE_PLMOON_OFFSET) {
+      /* any asteroid or planetary moon (SE_AST_OFFSET > SE_PLMOON_OFFSET):
+       * one file is open at a time; open it now */
+      rc = swe_calc(tjd_start, ipl[i], epheflag, xx, serr2);
+      if (rc < 0 && retc == OK) {
+	retc = ERR;
+	if (serr != NULL)
+	  strcpy(serr, serr2);
+      }
+      continue;
+    }
+    /* only planets and main asteroids have segments to prefetch */
+    if (!((ipl[i] >= SE_MERCURY && ipl[i] <= SE_PLUTO)
+	|| (ipl[i] >= SE_CHIRON && ipl[i] <= SE_VESTA)))
+      continue;
+    ipli = pnoext2int[ipl[i]];
+    ifno = ipli >= SEI_CHIRON ? SEI_FILE_MAIN_AST : SEI_FILE_PLANET;
+    for (j = 0; j < nbody && body[j] != ipli; j++)
+      ;
+    if (j < nbody)
+      continue;
+    body[nbody] = ipli;
+    bfile[nbody++] = ifno;
+  }
+  for (i = 0; i < nbody; i++) {
+    t0 = tjd_start;
+    t1 = tjd_end;
+    if (body[i] == SEI_CHIRON) {
+      if (t0 < CHIRON_START) t0 = CHIRON_START;
+      if (t1 > CHIRON_END) t1 = CHIRON_END;
+    } else if (body[i] == SEI_PHOLUS) {
+      if (t0 < PHOLUS_START) t0 = PHOLUS_START;
+      if (t1 > PHOLUS_END) t1 = PHOLUS_END;
+    }
+    if (t1 < t0)
+      continue;
+    rc = seg_prefetch(t0, t1, body[i], bfile[i], iflag, &nb, serr2);
+    if (rc != OK && retc == OK) {
+      retc = ERR;
+      if (serr != NULL)
+	strcpy(serr, serr2);
+    }
+  }
+  if (nbytes != NULL)
+    *nbytes = nb;
+  return retc;
+}
+
 static int32 swecalc(double tjd, int ipl, int32 iplmoon, int32 iflag, double *x, char *serr) 
 {
   int i;
@@ -1195,7 +1689,7 @@ int32 swi_init_swed_if_start(void)
 /* closes all open files, frees space of planetary data, 
  * deletes memory of all computed positions 
  */
-static void swi_close_keep_topo_etc(void) 
+void swi_close_keep_topo_etc(void) 
 {
   int i;
   /* close SWISSEPH files */
@@ -1205,11 +1699,17 @@ static void swi_close_keep_topo_etc(void)
     memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
   }
   free_planets();
+  swe_calc_prefetch(NULL, NULL, 0, 0);
+  swe_prefetch(0, 0, NULL, 0, 0, NULL, NULL);
+  swe_set_uniform_grid(0);
+  swi_deltat_table_free();
+  swe_ayanamsa_prefetch(NULL, 0);
   memset((void *) &swed.oec, 0, sizeof(struct epsilon));
   memset((void *) &swed.oec2000, 0, sizeof(struct epsilon));
   memset((void *) &swed.nut, 0, sizeof(struct nut));
   memset((void *) &swed.nut2000, 0, sizeof(struct nut));
   memset((void *) &swed.nutv, 0, sizeof(struct nut));
+  memset((void *) &swed.frame, 0, sizeof(struct frame_data));
   memset((void *) &swed.astro_models, 0, SEI_NMODELS * sizeof(int32));
   /* close JPL file */
   swi_close_jpl_file();
@@ -1240,11 +1740,18 @@ void CALL_CONV swe_close(void)
     memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
   }
   free_planets();
+  swe_calc_prefetch(NULL, NULL, 0, 0);
+  swe_prefetch(0, 0, NULL, 0, 0, NULL, NULL);
+  swe_set_uniform_grid(0);
+  swi_deltat_table_free();
+  swi_refr_table_free();
+  swe_ayanamsa_prefetch(NULL, 0);
   memset((void *) &swed.oec, 0, sizeof(struct epsilon));
   memset((void *) &swed.oec2000, 0, sizeof(struct epsilon));
   memset((void *) &swed.nut, 0, sizeof(struct nut));
   memset((void *) &swed.nut2000, 0, sizeof(struct nut));
   memset((void *) &swed.nutv, 0, sizeof(struct nut));
+  memset((void *) &swed.frame, 0, sizeof(struct frame_data));
   memset((void *) &swed.astro_models, 0, SEI_NMODELS * sizeof(int32));
   /* close JPL file */
   swi_close_jpl_file();
@@ -1265,14 +1772,10 @@ void CALL_CONV swe_close(void)
   memset((void *) &swed.sidd, 0, sizeof(struct sid_data));
   swed.timeout = 0;
   swed.last_epheflag = 0;
-  if (swed.dpsi != NULL) {
-    free(swed.dpsi);
-    swed.dpsi = NULL;
-  }
-  if (swed.deps != NULL) {
-    free(swed.deps);
-    swed.deps = NULL;
-  }
+  eop_release(swed.eop);
+  swed.eop = NULL;
+  if (swed.eop_dpsi_loaded > 0)
+    swed.eop_dpsi_loaded = 0;
   if (swed.n_fixstars_records > 0) {
     free(swed.fixed_stars);
     swed.fixed_stars = NULL;
@@ -1376,29 +1879,44 @@ void CALL_CONV swe_set_ephe_path(const char *path)
 #endif
 }
 
-void load_dpsi_deps(void)
+/* EOP tables shared by all threads, one per ephemeris path */
+#define EOP_NTABLES	4
+static struct eop_entry {
+  char ephepath[AS_MAXCH];
+  int refcnt;
+  struct eop_table *eop;
+} eop_tables[EOP_NTABLES];
+
+static size_t eop_table_size(int n)
+{
+  return sizeof(struct eop_table) + (n - 1) * sizeof(((struct eop_table *) 0)->coef[0]);
+}
+
+/* reads the EOP files; returns NULL and the error in *loaded if there
+ * are no usable data */
+static struct eop_table *eop_table_read(char *ephepath, int *loaded)
 {
   FILE *fp;
   char s[AS_MAXCH];
   char *cpos[20];
-  int n = 0, iyear, mjd = 0, mjdsv = 0;
+  int i, n = 0, iyear, mjd = 0, mjdsv = 0;
   double dpsi, deps, TJDOFS = 2400000.5;
-  if (swed.eop_dpsi_loaded > 0) 
-    return;
-  fp = swi_fopen(-1, DPSI_DEPS_IAU1980_FILE_EOPC04, swed.ephepath, NULL);
+  double *vpsi, *veps, tjd_beg = 0, tjd_end;
+  struct eop_table *eop;
+  fp = swi_fopen(-1, DPSI_DEPS_IAU1980_FILE_EOPC04, ephepath, NULL);
   if (fp == NULL) {
-    swed.eop_dpsi_loaded = ERR;
-    return;
+    *loaded = ERR;
+    return NULL;
+  }
+  vpsi = (double *) calloc((size_t) SWE_DATA_DPSI_DEPS, sizeof(double));
+  veps = (double *) calloc((size_t) SWE_DATA_DPSI_DEPS, sizeof(double));
+  if (vpsi == NULL || veps == NULL) {
+    *loaded = ERR;
+    free(vpsi);
+    free(veps);
+    fclose(fp);
+    return NULL;
   }
-  if ((swed.dpsi = (double *) calloc((size_t) SWE_DATA_DPSI_DEPS, sizeof(double))) == NULL) {
-    swed.eop_dpsi_loaded = ERR;
-    return;
-  }
-  if ((swed.deps = (double *) calloc((size_t) SWE_DATA_DPSI_DEPS, sizeof(double))) == NULL) {
-    swed.eop_dpsi_loaded = ERR;
-    return;
-  }
-  swed.eop_tjd_beg_horizons = DPSI_DEPS_IAU1980_TJD0_HORIZONS;
   while (fgets(s, AS_MAXCH, fp) != NULL) {
     swi_cutstr(s, " ", cpos, 16);
     if ((iyear = atoi(cpos[0])) == 0) 
@@ -1407,39 +1925,43 @@ void load_dpsi_deps(void)
     /* is file in one-day steps? */
     if (mjdsv > 0 && mjd - mjdsv != 1) {
       /* we cannot return error but we note it as follows: */
-      swed.eop_dpsi_loaded = -2;
+      *loaded = -2;
+      free(vpsi);
+      free(veps);
       fclose(fp);
-      return;
+      return NULL;
     }
     if (n == 0)
-      swed.eop_tjd_beg = mjd + TJDOFS;
-    swed.dpsi[n] = atof(cpos[8]);
-    swed.deps[n] = atof(cpos[9]);
-/*    fprintf(stderr, "n=%d, tjd=%f, dpsi=%f, deps=%f\n", n, mjd + 2400000.5, swed.dpsi[n] * 1000, swed.deps[n] * 1000);exit(0);*/
+      tjd_beg = mjd + TJDOFS;
+    vpsi[n] = atof(cpos[8]);
+    veps[n] = atof(cpos[9]);
     n++;
     mjdsv = mjd;
   }
-  swed.eop_tjd_end = mjd + TJDOFS;
-  swed.eop_dpsi_loaded = 1;
+  tjd_end = mjd + TJDOFS;
+  *loaded = 1;
   fclose(fp);
   /* file finals.all may have some more data, and especially estimations 
-   * for the near future */
-  fp = swi_fopen(-1, DPSI_DEPS_IAU1980_FILE_FINALS, swed.ephepath, NULL);
-  if (fp == NULL) 
-    return; /* return without error as existence of file is not mandatory */
-  while (fgets(s, AS_MAXCH, fp) != NULL) {
+   * for the near future; its existence is not mandatory */
+  fp = swi_fopen(-1, DPSI_DEPS_IAU1980_FILE_FINALS, ephepath, NULL);
+  while (fp != NULL && fgets(s, AS_MAXCH, fp) != NULL) {
     mjd = atoi(s + 7);
-    if (mjd + TJDOFS <= swed.eop_tjd_end)
+    if (mjd + TJDOFS <= tjd_end)
       continue;
-    if (n >= SWE_DATA_DPSI_DEPS)
-      return;
+    if (n >= SWE_DATA_DPSI_DEPS) {
+      fclose(fp);
+      fp = NULL;
+      break;
+    }
     /* are data in one-day steps? */
     if (mjdsv > 0 && mjd - mjdsv != 1) {
       /* no error, as we do have data; however, if this file is usefull,
-       * then swed.eop_dpsi_loaded will be set to 2 */
-      swed.eop_dpsi_loaded = -3;
+       * then the loaded state will be set to 2 */
+      *loaded = -3;
+      free(vpsi);
+      free(veps);
       fclose(fp);
-      return;
+      return NULL;
     }
     /* dpsi, deps Bulletin B */
     dpsi = atof(s + 168);
@@ -1449,21 +1971,114 @@ void load_dpsi_deps(void)
       dpsi = atof(s + 99);
       deps = atof(s + 118);
     }
-    if (dpsi == 0) {
-      swed.eop_dpsi_loaded = 2;
-      /*printf("dpsi from %f to %f \n", swed.eop_tjd_beg, swed.eop_tjd_end);*/
-      fclose(fp);
-      return;
-    }
-    swed.eop_tjd_end = mjd + TJDOFS;
-    swed.dpsi[n] = dpsi / 1000.0;
-    swed.deps[n] = deps / 1000.0;
-    /*fprintf(stderr, "tjd=%f, dpsi=%f, deps=%f\n", mjd + 2400000.5, swed.dpsi[n] * 1000, swed.deps[n] * 1000);*/
+    if (dpsi == 0)
+      break;
+    tjd_end = mjd + TJDOFS;
+    vpsi[n] = dpsi / 1000.0;
+    veps[n] = deps / 1000.0;
     n++;
     mjdsv = mjd;
   }
-  swed.eop_dpsi_loaded = 2;
-  fclose(fp);
+  if (fp != NULL) {
+    *loaded = 2;
+    fclose(fp);
+  }
+  if (n == 0 || (eop = (struct eop_table *) swi_ro_alloc(eop_table_size(n))) == NULL) {
+    *loaded = ERR;
+    free(vpsi);
+    free(veps);
+    return NULL;
+  }
+  eop->tjd_beg = tjd_beg;
+  eop->tjd_end = tjd_end;
+  eop->eop_dpsi_loaded = *loaded;
+  eop->n = n;
+  for (i = 0; i < n; i++) {
+    swi_bessel_coef(vpsi, n, i, eop->coef[i][0]);
+    swi_bessel_coef(veps, n, i, eop->coef[i][1]);
+  }
+  swi_ro_seal(eop, eop_table_size(n));
+  free(vpsi);
+  free(veps);
+  return eop;
+}
+
+/* releases this thread's reference to an EOP table */
+static void eop_release(struct eop_table *eop)
+{
+  int i;
+  if (eop == NULL)
+    return;
+  swi_lock();
+  for (i = 0; i < EOP_NTABLES; i++) {
+    if (eop_tables[i].eop == eop)
+      break;
+  }
+  if (i == EOP_NTABLES) {
+    /* not shared */
+    swi_ro_free(eop, eop_table_size(eop->n));
+  } else if (--eop_tables[i].refcnt == 0) {
+    swi_ro_free(eop, eop_table_size(eop->n));
+    memset((void *) &eop_tables[i], 0, sizeof(struct eop_entry));
+  }
+  swi_unlock();
+}
+
+/* The EOP corrections of dpsi and deps are read once per ephemeris path
+ * and process; further threads get a reference to the same table.
+ */
+void load_dpsi_deps(void)
+{
+  int i, loaded = ERR;
+  struct eop_table *eop = NULL;
+  if (swed.eop_dpsi_loaded > 0) 
+    return;
+  swi_lock();
+  for (i = 0; i < EOP_NTABLES; i++) {
+    if (eop_tables[i].eop != NULL && strcmp(eop_tables[i].ephepath, swed.ephepath) == 0) {
+      eop = eop_tables[i].eop;
+      eop_tables[i].refcnt++;
+      break;
+    }
+  }
+  if (eop == NULL && (eop = eop_table_read(swed.ephepath, &loaded)) != NULL) {
+    for (i = 0; i < EOP_NTABLES; i++) {
+      if (eop_tables[i].eop == NULL) {
+	strcpy(eop_tables[i].ephepath, swed.ephepath);
+	eop_tables[i].refcnt = 1;
+	eop_tables[i].eop = eop;
+	break;
+      }
+    }
+  }
+  swi_unlock();
+  swed.eop_tjd_beg_horizons = DPSI_DEPS_IAU1980_TJD0_HORIZONS;
+  if (eop == NULL) {
+    swed.eop_dpsi_loaded = loaded;
+    return;
+  }
+  swed.eop = eop;
+  swed.eop_tjd_beg = eop->tjd_beg;
+  swed.eop_tjd_end = eop->tjd_end;
+  swed.eop_dpsi_loaded = eop->eop_dpsi_loaded;
+}
+
+/* returns the ephemeris path in path (AS_MAXCH bytes), as set by 
+ * swe_set_ephe_path() and with a trailing directory separator 
+ */
+char *CALL_CONV swe_get_ephe_path(char *path)
+{
+  swi_init_swed_if_start();
+  strcpy(path, swed.ephepath);
+  return path;
+}
+
+/* returns the name of the JPL file in fname (AS_MAXCH bytes) */
+char *CALL_CONV swe_get_jpl_file(char *fname)
+{
+  swi_init_swed_if_start();
+  strcpy(fname, swed.jplfnam);
+  return fname;
 }
 
 /* sets jpl file name.
@@ -2269,7 +2884,9 @@ again:
    * get planet's position      
    ******************************/
   /* get new segment, if necessary */
-  if (pdp->segp == NULL || tjd < pdp->tseg0 || tjd > pdp->tseg1) {
+  if ((pdp->segp == NULL || tjd < pdp->tseg0 || tjd > pdp->tseg1)
+      && (swed.segc[ipl].n == 0 || seg_cache_get(tjd, ipl) != OK)
+      && (shm_seg == NULL || shm_seg_get(tjd, ipl, ifno) != OK)) {
     retc = get_new_segment(tjd, ipl, ifno, serr);
     if (retc != OK)
       return(retc);
@@ -2280,6 +2897,8 @@ again:
     } else {
       pdp->neval = pdp->ncoe;
     }
+    if (shm_seg != NULL)
+      shm_seg_put(tjd, ipl, ifno);
   }
   /* evaluate chebyshew polynomial for tjd */
   t = (tjd - pdp->tseg0) / pdp->dseg;
@@ -2356,6 +2975,440 @@ again:
   return(OK);
 }
 
+/* Ephemeris files registered from memory with swe_set_ephe_buffer() or
+ * swe_set_ephe_bundle(), shared by all threads and guarded by 
+ * swi_lock_files(). swi_fopen() finds them before the files in the 
+ * ephemeris path. They are hashed by name, so that a bundle of thousands 
+ * of asteroid files is searched in constant time. */
+#define MEM_FILE_NHASH  4096
+
+struct mem_file {
+  char fname[AS_MAXCH];
+  const void *buf;
+  size_t len;
+  const void *owner;	/* bundle of the file, NULL from swe_set_ephe_buffer() */
+  struct mem_file *next;
+};
+
+static struct mem_file *mem_files[MEM_FILE_NHASH];
+
+static unsigned int mem_file_hash(const char *fname)
+{
+  unsigned int h = 5381;
+  for (; *fname != '\0'; fname++)
+    h = h * 33 + (unsigned char) *fname;
+  return h % MEM_FILE_NHASH;
+}
+
+/* removes the file fname, or with fname = NULL all files of owner, and
+ * returns the number of files removed; the caller holds swi_lock_files() */
+static int mem_file_remove(const char *fname, const void *owner)
+{
+  struct mem_file *mfp, **mfpp;
+  unsigned int h, h0 = 0, h1 = MEM_FILE_NHASH;
+  int nrem = 0;
+  if (fname != NULL) {
+    h0 = mem_file_hash(fname);
+    h1 = h0 + 1;
+  }
+  for (h = h0; h < h1; h++) {
+    for (mfpp = &mem_files[h]; *mfpp != NULL; ) {
+      mfp = *mfpp;
+      if (fname != NULL ? strcmp(mfp->fname, fname) == 0 : mfp->owner == owner) {
+	*mfpp = mfp->next;
+	free(mfp);
+	nrem++;
+      } else {
+	mfpp = &mfp->next;
+      }
+    }
+  }
+  return nrem;
+}
+
+/* the caller holds swi_lock_files() */
+static int mem_file_add(const char *fname, const void *buf, size_t len, const void *owner)
+{
+  struct mem_file *mfp;
+  unsigned int h = mem_file_hash(fname);
+  mem_file_remove(fname, NULL);
+  if ((mfp = (struct mem_file *) calloc(1, sizeof(struct mem_file))) == NULL)
+    return ERR;
+  strcpy(mfp->fname, fname);
+  mfp->buf = buf;
+  mfp->len = len;
+  mfp->owner = owner;
+  mfp->next = mem_files[h];
+  mem_files[h] = mfp;
+  return OK;
+}
+
+static AS_BOOL ephe_files_are_open(void)
+{
+  int i;
+  for (i = 0; i < SEI_NEPHFILES; i++) {
+    if (swed.fidat[i].fptr != NULL)
+      return TRUE;
+  }
+  return swed.jpl_file_is_open || swed.fixfp != NULL;
+}
+
+/* Closes the ephemeris, JPL and fixed star files of the calling thread and
+ * forgets what was read from them, so that no file reads memory that is 
+ * unregistered. Unlike swe_close(), it keeps all settings, e.g. those of 
+ * swe_set_topo(), swe_set_sid_mode() and swe_set_astro_models(). */
+static void close_ephe_files(void)
+{
+  int i;
+  for (i = 0; i < SEI_NEPHFILES; i++) {
+    if (swed.fidat[i].fptr != NULL) 
+      fclose(swed.fidat[i].fptr);
+    memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
+  }
+  free_planets();
+  swe_calc_prefetch(NULL, NULL, 0, 0);
+  swe_prefetch(0, 0, NULL, 0, 0, NULL, NULL);
+  swi_close_jpl_file();
+  swed.jpl_file_is_open = FALSE;
+  swed.jpldenum = 0;
+  if (swed.fixfp != NULL) {
+    fclose(swed.fixfp);
+    swed.fixfp = NULL;
+  }
+  if (swed.n_fixstars_records > 0) {
+    free(swed.fixed_stars);
+    swed.fixed_stars = NULL;
+    swed.n_fixstars_real = 0;
+    swed.n_fixstars_named = 0;
+    swed.n_fixstars_records = 0;
+  }
+}
+
+/* Registers the file contents buf[0..len-1] under the name fname, e.g.
+ * "sepl_18.se1" or "sefstars.txt", so that the file is read from memory 
+ * instead of the ephemeris path. The memory is not copied and must remain 
+ * valid until the file is unregistered with buf = NULL. fname = NULL 
+ * unregisters all files registered with this function. If a file is 
+ * replaced or unregistered, or files are open, the files of the calling
+ * thread are closed, without changing its settings; other threads must
+ * not compute positions from the memory that is replaced or released.
+ */
+int32 CALL_CONV swe_set_ephe_buffer(const char *fname, const void *buf, size_t len)
+{
+  int32 retc = OK;
+  int nrem;
+  if (fname != NULL && strlen(fname) >= AS_MAXCH)
+    return ERR;
+  swi_lock_files();
+  nrem = mem_file_remove(fname, NULL);
+  if (fname != NULL && buf != NULL && len > 0) 
+    retc = mem_file_add(fname, buf, len, NULL);
+  swi_unlock_files();
+  if (nrem > 0 || ephe_files_are_open())
+    close_ephe_files();
+  return retc;
+}
+
+/* Returns the memory registered for file fname, by its name with or 
+ * without directory, or NULL. */
+const void *swi_mem_lookup(const char *fname, size_t *len)
+{
+  struct mem_file *mfp = NULL;
+  const void *buf = NULL;
+  const char *base = fname, *sp;
+  for (sp = fname; *sp != '\0'; sp++) {
+    if (*sp == '/' || *sp == '\\')
+      base = sp + 1;
+  }
+  swi_lock_files();
+  for (mfp = mem_files[mem_file_hash(fname)]; mfp != NULL; mfp = mfp->next) {
+    if (strcmp(mfp->fname, fname) == 0)
+      break;
+  }
+  if (mfp == NULL && base != fname) {
+    for (mfp = mem_files[mem_file_hash(base)]; mfp != NULL; mfp = mfp->next) {
+      if (strcmp(mfp->fname, base) == 0)
+	break;
+    }
+  }
+  if (mfp != NULL) {
+    buf = mfp->buf;
+    *len = mfp->len;
+  }
+  swi_unlock_files();
+  return buf;
+}
+
+/* Ephemeris bundle: many ephemeris files in one file, which is opened and
+ * mapped once. All integers are little-endian:
+ *   header   "SEBUNDL1", uint32 number of members, uint32 0
+ *   contents per member: name (EPHE_BUNDLE_NAMLEN bytes, padded with NUL),
+ *            uint64 offset, uint64 length; sorted by name
+ *   members  the files in their original encoding, each at an offset that
+ *            is a multiple of 8
+ * Members are registered like files from swe_set_ephe_buffer(), by their 
+ * name without directory. */
+#define EPHE_BUNDLE_MAGIC   "SEBUNDL1"
+#define EPHE_BUNDLE_HDRSZ   16
+#define EPHE_BUNDLE_NAMLEN  56
+#define EPHE_BUNDLE_TOCSZ   (EPHE_BUNDLE_NAMLEN + 16)
+
+struct ephe_bundle {
+  char path[AS_MAXCH];
+  void *addr;
+  size_t len;
+  struct ephe_bundle *next;
+};
+
+static struct ephe_bundle *ephe_bundles = NULL;
+
+static unsigned long long get_le(const unsigned char *p, int nbytes)
+{
+  unsigned long long u = 0;
+  while (nbytes-- > 0)
+    u = (u << 8) | p[nbytes];
+  return u;
+}
+
+static void put_le(unsigned char *p, unsigned long long u, int nbytes)
+{
+  int i;
+  for (i = 0; i < nbytes; i++, u >>= 8)
+    p[i] = (unsigned char) (u & 0xff);
+}
+
+/* Opens the ephemeris bundle path, which replaces a bundle loaded before
+ * from the same path and files registered under the same names, and returns
+ * the number of its members. path = NULL unloads all bundles. The bundle
+ * stays mapped until it is unloaded. If a bundle is unloaded, or files are
+ * open, the files of the calling thread are closed first, without changing
+ * its settings, as in swe_set_ephe_buffer().
+ */
+int32 CALL_CONV swe_set_ephe_bundle(const char *path, char *serr)
+{
+  struct ephe_bundle *bp = NULL, **bpp;
+  const unsigned char *addr = NULL, *toc;
+  size_t len = 0;
+  unsigned long long off, flen, nmem = 0, i;
+  AS_BOOL valid = FALSE, do_close = FALSE;
+  if (path != NULL) {
+    if (strlen(path) >= AS_MAXCH) {
+      if (serr != NULL)
+	strcpy(serr, "bundle path too long");
+      return ERR;
+    }
+    if ((addr = (const unsigned char *) swi_map_file(path, &len)) == NULL) {
+      if (serr != NULL) {
+	strcpy(serr, "could not open bundle ");
+	strncat(serr, path, AS_MAXCH - 30);
+      }
+      return ERR;
+    }
+    if (len >= EPHE_BUNDLE_HDRSZ && memcmp(addr, EPHE_BUNDLE_MAGIC, 8) == 0) {
+      nmem = get_le(addr + 8, 4);
+      valid = (nmem <= (len - EPHE_BUNDLE_HDRSZ) / EPHE_BUNDLE_TOCSZ);
+    }
+    for (i = 0, toc = addr + EPHE_BUNDLE_HDRSZ; valid && i < nmem; i++, toc += EPHE_BUNDLE_TOCSZ) {
+      off = get_le(toc + EPHE_BUNDLE_NAMLEN, 8);
+      flen = get_le(toc + EPHE_BUNDLE_NAMLEN + 8, 8);
+      if (toc[0] == '\0' || toc[EPHE_BUNDLE_NAMLEN - 1] != '\0' 
+	  || off < EPHE_BUNDLE_HDRSZ + nmem * EPHE_BUNDLE_TOCSZ
+	  || off > len || flen > len - off)
+	valid = FALSE;
+    }
+    if (!valid || (bp = (struct ephe_bundle *) calloc(1, sizeof(struct ephe_bundle))) == NULL) {
+      if (serr != NULL) {
+	strcpy(serr, !valid ? "invalid bundle " : "out of memory for bundle ");
+	strncat(serr, path, AS_MAXCH - 30);
+      }
+      swi_unmap_file((void *) addr, len);
+      return ERR;
+    }
+    strcpy(bp->path, path);
+    bp->addr = (void *) addr;
+    bp->len = len;
+  }
+  swi_lock_files();
+  for (bpp = &ephe_bundles; *bpp != NULL; bpp = &(*bpp)->next) {
+    if (path == NULL || strcmp((*bpp)->path, path) == 0)
+      do_close = TRUE;
+  }
+  swi_unlock_files();
+  /* the JPL file is closed under swi_lock(), which precedes 
+   * swi_lock_files() */
+  if (do_close || ephe_files_are_open())
+    close_ephe_files();
+  swi_lock_files();
+  for (bpp = &ephe_bundles; *bpp != NULL; ) {
+    if (path == NULL || strcmp((*bpp)->path, path) == 0) {
+      struct ephe_bundle *bpold = *bpp;
+      *bpp = bpold->next;
+      mem_file_remove(NULL, bpold);
+      swi_unmap_file(bpold->addr, bpold->len);
+      free(bpold);
+    } else {
+      bpp = &(*bpp)->next;
+    }
+  }
+  if (bp != NULL) {
+    for (i = 0, toc = addr + EPHE_BUNDLE_HDRSZ; i < nmem; i++, toc += EPHE_BUNDLE_TOCSZ) {
+      off = get_le(toc + EPHE_BUNDLE_NAMLEN, 8);
+      flen = get_le(toc + EPHE_BUNDLE_NAMLEN + 8, 8);
+      if (flen > 0 && mem_file_add((const char *) toc, addr + off, (size_t) flen, bp) != OK) {
+	mem_file_remove(NULL, bp);
+	swi_unlock_files();
+	if (serr != NULL)
+	  strcpy(serr, "out of memory for bundle");
+	swi_unmap_file(bp->addr, bp->len);
+	free(bp);
+	return ERR;
+      }
+    }
+    bp->next = ephe_bundles;
+    ephe_bundles = bp;
+  }
+  swi_unlock_files();
+  return (int32) nmem;
+}
+
+struct bundle_member {
+  const char *path;
+  const char *name;
+};
+
+static int bundle_member_cmp(const void *a, const void *b)
+{
+  return strcmp(((const struct bundle_member *) a)->name, ((const struct bundle_member *) b)->name);
+}
+
+/* Writes the files files[0..nfiles-1] into the ephemeris bundle path, as 
+ * members named by the file names without directory, and returns the number 
+ * of members. */
+int32 CALL_CONV swe_create_ephe_bundle(const char *path, const char *const *files, int32 nfiles, char *serr)
+{
+  struct bundle_member *mem = NULL;
+  unsigned char hdr[EPHE_BUNDLE_TOCSZ], *toc = NULL, *buf = NULL;
+  unsigned long long off, flen;
+  size_t nb, tocsz;
+  const char *sp;
+  FILE *fp = NULL, *fpin = NULL;
+  int32 i, retc = ERR;
+  AS_BOOL created = FALSE;
+  char s[AS_MAXCH];
+  *s = '\0';
+  if (nfiles < 0)
+    nfiles = 0;
+  tocsz = (size_t) nfiles * EPHE_BUNDLE_TOCSZ;
+  if ((mem = (struct bundle_member *) calloc(nfiles + 1, sizeof(struct bundle_member))) == NULL
+      || (toc = (unsigned char *) calloc(tocsz + 1, 1)) == NULL
+      || (buf = (unsigned char *) malloc(65536)) == NULL) {
+    strcpy(s, "out of memory for bundle");
+    goto end_create;
+  }
+  for (i = 0; i < nfiles; i++) {
+    mem[i].path = mem[i].name = files[i];
+    for (sp = files[i]; *sp != '\0'; sp++) {
+      if (*sp == '/' || *sp == '\\')
+	mem[i].name = sp + 1;
+    }
+    if (*mem[i].name == '\0' || strlen(mem[i].name) >= EPHE_BUNDLE_NAMLEN) {
+      sprintf(s, "invalid bundle member name %.*s", AS_MAXCH - 40, files[i]);
+      goto end_create;
+    }
+  }
+  qsort(mem, nfiles, sizeof(struct bundle_member), bundle_member_cmp);
+  for (i = 1; i < nfiles; i++) {
+    if (strcmp(mem[i - 1].name, mem[i].name) == 0) {
+      sprintf(s, "duplicate bundle member %.*s", AS_MAXCH - 40, mem[i].name);
+      goto end_create;
+    }
+  }
+  if ((fp = fopen(path, BFILE_W_CREATE)) == NULL) {
+    sprintf(s, "could not create bundle %.*s", AS_MAXCH - 40, path);
+    goto end_create;
+  }
+  created = TRUE;
+  /* the contents are written last, when the lengths are known */
+  memcpy(hdr, EPHE_BUNDLE_MAGIC, 8);
+  put_le(hdr + 8, (unsigned long long) nfiles, 4);
+  put_le(hdr + 12, 0, 4);
+  off = EPHE_BUNDLE_HDRSZ + tocsz;
+  if (fwrite(hdr, 1, EPHE_BUNDLE_HDRSZ, fp) != EPHE_BUNDLE_HDRSZ
+      || fwrite(toc, 1, tocsz, fp) != tocsz) 
+    goto write_error;
+  for (i = 0; i < nfiles; i++) {
+    memset(buf, 0, 8);
+    if (off % 8 != 0) {
+      nb = (size_t) (8 - off % 8);
+      if (fwrite(buf, 1, nb, fp) != nb)
+	goto write_error;
+      off += nb;
+    }
+    if ((fpin = fopen(mem[i].path, BFILE_R_ACCESS)) == NULL) {
+      sprintf(s, "could not open %.*s", AS_MAXCH - 40, mem[i].path);
+      goto end_create;
+    }
+    for (flen = 0; (nb = fread(buf, 1, 65536, fpin)) > 0; flen += nb) {
+      if (fwrite(buf, 1, nb, fp) != nb)
+	goto write_error;
+    }
+    if (ferror(fpin)) {
+      sprintf(s, "could not read %.*s", AS_MAXCH - 40, mem[i].path);
+      goto end_create;
+    }
+    fclose(fpin);
+    fpin = NULL;
+    strcpy((char *) toc + i * EPHE_BUNDLE_TOCSZ, mem[i].name);
+    put_le(toc + i * EPHE_BUNDLE_TOCSZ + EPHE_BUNDLE_NAMLEN, off, 8);
+    put_le(toc + i * EPHE_BUNDLE_TOCSZ + EPHE_BUNDLE_NAMLEN + 8, flen, 8);
+    off += flen;
+  }
+  if (fseek(fp, EPHE_BUNDLE_HDRSZ, SEEK_SET) != 0
+      || fwrite(toc, 1, tocsz, fp) != tocsz)
+    goto write_error;
+  if (fclose(fp) != 0) {
+    fp = NULL;
+    goto write_error;
+  }
+  fp = NULL;
+  retc = nfiles;
+  goto end_create;
+write_error:
+  sprintf(s, "could not write bundle %.*s", AS_MAXCH - 40, path);
+end_create:
+  if (fpin != NULL)
+    fclose(fpin);
+  if (fp != NULL)
+    fclose(fp);
+  if (retc == ERR && created)
+    remove(path);
+  if (retc == ERR && serr != NULL)
+    strcpy(serr, s);
+  free(mem);
+  free(toc);
+  free(buf);
+  return retc;
+}
+
+/* a read-only stream on memory */
+static FILE *mem_fopen(const void *buf, size_t len)
+{
+#if MSDOS
+  /* no fmemopen(): copy into a temporary file */
+  FILE *fp = tmpfile();
+  if (fp == NULL)
+    return NULL;
+  if (fwrite(buf, 1, len, fp) != len) {
+    fclose(fp);
+    return NULL;
+  }
+  rewind(fp);
+  return fp;
+#else
+  return fmemopen((void *) buf, len, BFILE_R_ACCESS);
+#endif
+}
+
 /*
  * Alois 2.12.98: inserted error message generation for file not found 
  */
@@ -2367,11 +3420,21 @@ FILE *swi_fopen(int ifno, char *fname, char *ephepath, char *serr)
   char *cpos[20];
   char s[2 * AS_MAXCH];
   char s1[AS_MAXCH];
+  const void *buf;
+  size_t len;
+  swi_atfork_init();
   if (ifno >= 0) {
     fnamp = swed.fidat[ifno].fnam;
   } else {
     fnamp = fn; 
   }
+  /* file registered from memory */
+  if ((buf = swi_mem_lookup(fname, &len)) != NULL 
+      && strlen(fname) < AS_MAXCH
+      && (fp = mem_fopen(buf, len)) != NULL) {
+    strcpy(fnamp, fname);
+    return fp;
+  }
   strcpy(s1, ephepath);
   np = swi_cutstr(s1, PATH_SEPARATOR, cpos, 20);
   *s = '\0';
@@ -2752,24 +3815,17 @@ static int app_pos_etc_plan(int ipli, int iplmoon, int32 iflag, char *serr)
   if (!(iflag & SEFLG_SPEED))
     for (i = 3; i <= 5; i++)
       xx[i] = 0;
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && swi_get_denum(ipli, epheflag) >= 403) {
-    swi_bias(xx, t, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, pdp->teval, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, pdp->teval, iflag, J2000_TO_J);
+  frame_to_date(xx, xxsv, pdp->teval, t, iflag,
+      !(iflag & SEFLG_ICRS) && swi_get_denum(ipli, epheflag) >= 403);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else {
+  else
     oe = &swed.oec2000;
-  }
   return app_pos_rest(pdp, iflag, xx, xxsv, oe, serr);
 }
 
@@ -2778,14 +3834,10 @@ static int app_pos_rest(struct plan_data *pdp, int32 iflag,
                         struct epsilon *oe, char *serr) 
 {
   int i;
-  double daya[2];
+  double daya[2], seps, ceps;
   double xxsv[24];
-  /************************************************
-   * nutation                                     *
-   ************************************************/
-  if (!(iflag & SEFLG_NONUT))
-    swi_nutate(xx, iflag, FALSE);
-  /* now we have equatorial cartesian coordinates; save them */
+  /* xx has been nutated already;
+   * now we have equatorial cartesian coordinates; save them */
   for (i = 0; i <= 5; i++)
     pdp->xreturn[18+i] = xx[i];
   /************************************************
@@ -2793,14 +3845,10 @@ static int app_pos_rest(struct plan_data *pdp, int32 iflag,
    * with sidereal calc. this will be overwritten *
    * afterwards.                                  *
    ************************************************/
-  swi_coortrf2(xx, xx, oe->seps, oe->ceps);
+  ecl_sincos(oe, iflag, &seps, &ceps);
+  swi_coortrf2(xx, xx, seps, ceps);
   if (iflag & SEFLG_SPEED)
-    swi_coortrf2(xx+3, xx+3, oe->seps, oe->ceps);
-  if (!(iflag & SEFLG_NONUT)) {
-    swi_coortrf2(xx, xx, swed.nut.snut, swed.nut.cnut);
-    if (iflag & SEFLG_SPEED)
-      swi_coortrf2(xx+3, xx+3, swed.nut.snut, swed.nut.cnut);
-  }
+    swi_coortrf2(xx+3, xx+3, seps, ceps);
   /* now we have ecliptic cartesian coordinates */
   for (i = 0; i <= 5; i++)
     pdp->xreturn[6+i] = xx[i];
@@ -2926,6 +3974,16 @@ void CALL_CONV swe_set_sid_mode(int32 sid_mode, double t0, double ayan_t0)
   swi_force_app_pos_etc();
 }
 
+/* returns the sidereal mode set by swe_set_sid_mode(), with its t0 and 
+ * ayan_t0 */
+int32 CALL_CONV swe_get_sid_mode(double *t0, double *ayan_t0)
+{
+  swi_init_swed_if_start();
+  *t0 = swed.sidd.t0;
+  *ayan_t0 = swed.sidd.ayan_t0;
+  return swed.sidd.sid_mode;
+}
+
 int32 CALL_CONV swe_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
 {
   struct nut nuttmp;
@@ -2944,6 +4002,142 @@ int32 CALL_CONV swe_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, ch
   return retval;
 }
 
+/* Positions of the stars that define the true-star and galactic
+ * ayanamshas, for a dense set of dates announced by
+ * swe_ayanamsa_prefetch(): computed by swe_fixstar() on a grid of
+ * AYA_STAR_STEP days and interpolated by cubic polynomials. Intervals
+ * where the interpolation error could exceed AYA_STAR_TOL (estimated
+ * from the 4th differences, e.g. near a conjunction of the star with the
+ * sun because of light deflection) are computed directly.
+ */
+#define AYA_STAR_STEP	2.0	/* days */
+#define AYA_STAR_TOL	1e-8	/* degrees */
+static TLS struct aya_star {
+  double tbeg, tend;	/* range of the announced dates */
+  int32 ndates;		/* number of announced dates, 0 if none */
+  char star[AS_MAXCH];	/* star and flags of the table */
+  int32 iflag;
+  int32 retflag;
+  char serr[AS_MAXCH];	/* warning of swe_fixstar(), if any */
+  int32 n;		/* nodes from tbeg - 2 * AYA_STAR_STEP */
+  double *lon;		/* longitude at nodes, without jumps at 360 */
+  char *direct;		/* intervals to compute directly */
+} aya_star;
+
+static void aya_star_free(void)
+{
+  if (aya_star.lon != NULL)
+    free(aya_star.lon);
+  if (aya_star.direct != NULL)
+    free(aya_star.direct);
+  memset((void *) &aya_star, 0, sizeof(struct aya_star));
+}
+
+static int aya_star_build(char *star, int32 iflag)
+{
+  struct aya_star *ap = &aya_star;
+  int32 i, retflag, n;
+  double x[6], d4, t0 = ap->tbeg - 2 * AYA_STAR_STEP;
+  char s[AS_MAXCH], serr[AS_MAXCH];
+  n = (int32) ceil((ap->tend - ap->tbeg) / AYA_STAR_STEP) + 5;
+  /* no gain unless the dates are denser than the nodes */
+  if (n > ap->ndates)
+    return ERR;
+  ap->lon = (double *) malloc(n * sizeof(double));
+  ap->direct = (char *) calloc(n, sizeof(char));
+  if (ap->lon == NULL || ap->direct == NULL) 
+    goto build_failed;
+  *ap->serr = '\0';
+  for (i = 0; i < n; i++) {
+    strcpy(s, star);
+    *serr = '\0';
+    retflag = swe_fixstar(s, t0 + i * AYA_STAR_STEP, iflag, x, serr);
+    if (retflag == ERR || (i > 0 && retflag != ap->retflag))
+      goto build_failed;
+    if (i == 0)
+      strcpy(ap->serr, serr);
+    ap->retflag = retflag;
+    if (i > 0)
+      x[0] = ap->lon[i - 1] + swe_difdeg2n(x[0], ap->lon[i - 1]);
+    ap->lon[i] = x[0];
+  }
+  /* error of the cubic between nodes i and i + 1, from the 4th
+   * differences centred on these nodes; the outermost intervals are
+   * never used */
+  for (i = 0; i < n; i++) 
+    ap->direct[i] = (i < 2 || i > n - 4);
+  for (i = 2; i < n - 2; i++) {
+    d4 = ap->lon[i - 2] - 4 * ap->lon[i - 1] + 6 * ap->lon[i] 
+       - 4 * ap->lon[i + 1] + ap->lon[i + 2];
+    if (fabs(d4) * 3.0 / 128.0 > AYA_STAR_TOL) 
+      ap->direct[i - 1] = ap->direct[i] = 1;
+  }
+  strcpy(ap->star, star);
+  ap->iflag = iflag;
+  ap->n = n;
+  return OK;
+build_failed:
+  free(ap->lon);
+  free(ap->direct);
+  ap->lon = NULL;
+  ap->direct = NULL;
+  return ERR;
+}
+
+/* swe_fixstar() for the star of a true-star or galactic ayanamsha; 
+ * only x[0] is returned from the table */
+static int32 aya_fixstar(char *star, double tjd, int32 iflag, double *x, char *serr)
+{
+  struct aya_star *ap = &aya_star;
+  int32 i;
+  double p, t0;
+  if (ap->ndates > 0 && tjd >= ap->tbeg && tjd <= ap->tend) {
+    if (ap->lon == NULL) {
+      if (aya_star_build(star, iflag) == ERR) 
+	ap->ndates = 0;	/* do not try again */
+    } else if (ap->iflag != iflag || strcmp(ap->star, star) != 0) {
+      ap->ndates = 0;	/* another star or other flags */
+    }
+    if (ap->ndates > 0) {
+      t0 = ap->tbeg - 2 * AYA_STAR_STEP;
+      i = (int32) floor((tjd - t0) / AYA_STAR_STEP);
+      p = (tjd - t0) / AYA_STAR_STEP - i;
+      if (i >= 1 && i < ap->n - 2 && !ap->direct[i]) {
+	/* cubic Lagrange through nodes i-1 .. i+2 */
+	x[0] = swe_degnorm(
+	    -p * (p - 1) * (p - 2) / 6 * ap->lon[i - 1]
+	    + (p + 1) * (p - 1) * (p - 2) / 2 * ap->lon[i]
+	    - (p + 1) * p * (p - 2) / 2 * ap->lon[i + 1]
+	    + (p + 1) * p * (p - 1) / 6 * ap->lon[i + 2]);
+	if (serr != NULL && *ap->serr != '\0')
+	  strcpy(serr, ap->serr);
+	return ap->retflag;
+      }
+    }
+  }
+  return swe_fixstar(star, tjd, iflag, x, serr);
+}
+
+/* Announce calls of swe_get_ayanamsa_ex() for the dates tjd_et[0..n-1]:
+ * for true-star and galactic ayanamshas, the position of the star is
+ * then interpolated if the dates are dense enough. n = 0 releases the
+ * table.
+ */
+int32 CALL_CONV swe_ayanamsa_prefetch(double *tjd_et, int32 n)
+{
+  int32 i;
+  aya_star_free();
+  if (n <= 0)
+    return OK;
+  aya_star.tbeg = aya_star.tend = tjd_et[0];
+  for (i = 1; i < n; i++) {
+    if (tjd_et[i] < aya_star.tbeg) aya_star.tbeg = tjd_et[i];
+    if (tjd_et[i] > aya_star.tend) aya_star.tend = tjd_et[i];
+  }
+  aya_star.ndates = n;
+  return OK;
+}
+
 /*
  * Function calculates a correction for ayanamsha if the ayanamsha was
  * defined using a different precession model than our standard one.
@@ -2956,6 +4150,13 @@ int32 CALL_CONV swe_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, ch
  * must be relative to J2000. Any future precession model should not
  * use a different starting epoch.
  */
+static TLS struct aya_corr {
+  int32 sid_mode;
+  double t0;
+  int prec_model, prec_model_short;
+  double corr;
+} aya_corr = {-1, 0, 0, 0, 0};
+
 static int get_aya_correction(int iflag, double *corr, char *serr) {
   double x[6], eps, t0;
   struct sid_data *sip = &swed.sidd;
@@ -2974,6 +4175,12 @@ static int get_aya_correction(int iflag, double *corr, char *serr) {
   if (prec_offset < 0) prec_offset = 0;
   if (prec_model == prec_offset)
     return 0;
+  /* the correction depends on the date only if t0 is UT (Delta T) */
+  if (!sip->t0_is_UT && aya_corr.sid_mode == sip->sid_mode && aya_corr.t0 == sip->t0
+      && aya_corr.prec_model == prec_model && aya_corr.prec_model_short == prec_model_short) {
+    *corr = aya_corr.corr;
+    return OK;
+  }
   t0 = sip->t0;
   if (sip->t0_is_UT)
     t0 += swe_deltat_ex(t0, iflag, serr);
@@ -2994,6 +4201,13 @@ static int get_aya_correction(int iflag, double *corr, char *serr) {
   /* get ayanamsa */
   *corr = x[0] * RADTODEG;
   if (*corr > 350 /*correct!*/) *corr -= 360; // a signed value near 0
+  if (!sip->t0_is_UT) {
+    aya_corr.sid_mode = sip->sid_mode;
+    aya_corr.t0 = sip->t0;
+    aya_corr.prec_model = prec_model;
+    aya_corr.prec_model_short = prec_model_short;
+    aya_corr.corr = *corr;
+  }
   //fprintf(stderr, "corr=%f\n", *corr * 3600.0);
   return OK;
 }
@@ -3047,7 +4261,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
     swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
   if (sid_mode == SE_SIDM_TRUE_CITRA) {
     strcpy(star, "Spica"); /* Citra */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR) {
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR) {
       return ERR; 
     }
     /*fprintf(stderr, "serr=%s\n", serr);*/
@@ -3056,35 +4270,35 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode == SE_SIDM_TRUE_REVATI) {
     strcpy(star, ",zePsc"); /* Revati */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 359.8333333333);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_PUSHYA) {
     strcpy(star, ",deCnc"); /* Pushya = Asellus Australis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 106);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_SHEORAN) {
     strcpy(star, ",deCnc"); /* Asellus Australis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 103.49264221625);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_MULA) {
     strcpy(star, ",laSco"); /* Mula = lambda Scorpionis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 240);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode ==  SE_SIDM_GALCENT_0SAG) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 240.0);
     return (retflag & SEFLG_EPHMASK);
@@ -3092,7 +4306,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode ==  SE_SIDM_GALCENT_COCHRANE) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 270.0);
     return (retflag & SEFLG_EPHMASK);
@@ -3100,7 +4314,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode ==  SE_SIDM_GALCENT_RGILBRAND) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 210.0 - 90.0 * 0.3819660113);
     return (retflag & SEFLG_EPHMASK);
@@ -3110,7 +4324,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
     strcpy(star, ",SgrA*"); /* Galactic Centre */
     /* right ascension in polar projection onto the ecliptic, 
      * and that point is put in the middle of Mula */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true | SEFLG_EQUATORIAL, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_true | SEFLG_EQUATORIAL, x, serr)) == ERR)
       return ERR;
     eps = swi_epsiln(tjd_et, iflag) * RADTODEG;
     *daya = swi_armc_to_mc(x[0], eps);
@@ -3120,21 +4334,21 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode == SE_SIDM_GALEQU_IAU1958) {
     strcpy(star, ",GP1958"); /* Galactic Pole IAU 1958 */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_GALEQU_TRUE) {
     strcpy(star, ",GPol"); /* Galactic Pole modern, true */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_GALEQU_MULA) {
     strcpy(star, ",GPol"); /* Galactic Pole modern, true */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = aya_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150 - 6.6666666667);
     return (retflag & SEFLG_EPHMASK);
@@ -3529,32 +4743,42 @@ static int app_pos_etc_plan_osc(int ipl, int ipli, int32 iflag, char *serr)
       for (i = 3; i <= 5; i++) 
 	xx[i] += xobs[i] - xobs2[i];
   }
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * precession and nutation,                     *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, pdp->teval, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, pdp->teval, iflag, J2000_TO_J);
+  frame_to_date(xx, xxsv, pdp->teval, pdp->teval, iflag, FALSE);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else
+  else
     oe = &swed.oec2000;
   return app_pos_rest(pdp, iflag, xx, xxsv, oe, serr);
 }
 
+/* speed of general precession in longitude, in radians per day */
+static double precess_rate(double t)
+{
+  double dpre, dpre2;
+  double tprec = (t - J2000) / 36525.0;
+  int prec_model = swed.astro_models[SE_MODEL_PREC_LONGTERM];
+  if (prec_model == 0) prec_model = SEMOD_PREC_DEFAULT;
+  if (prec_model == SEMOD_PREC_VONDRAK_2011) {
+    swi_ldp_peps(t, &dpre, NULL);
+    swi_ldp_peps(t + 1, &dpre2, NULL);
+    return dpre2 - dpre;
+  }
+  /* formula from Montenbruck, German 1994, p. 18 */
+  return (50.290966 + 0.0222226 * tprec) / 3600 / 365.25 * DEGTORAD;
+}
+
 /* influence of precession on speed 
  * xx		position and speed of planet in equatorial cartesian
  *		coordinates */
 void swi_precess_speed(double *xx, double t, int32 iflag, int direction) 
 {
   struct epsilon *oe;
-  double fac, dpre, dpre2;
-  double tprec = (t - J2000) / 36525.0;
-  int prec_model = swed.astro_models[SE_MODEL_PREC_LONGTERM];
-  if (prec_model == 0) prec_model = SEMOD_PREC_DEFAULT;
+  double fac;
   if (direction == J2000_TO_J) {
     fac = 1;
     oe = &swed.oec;
@@ -3570,21 +4794,165 @@ void swi_precess_speed(double *xx, double t, int32 iflag, int direction)
   swi_coortrf2(xx, xx, oe->seps, oe->ceps);
   swi_coortrf2(xx+3, xx+3, oe->seps, oe->ceps);
   swi_cartpol_sp(xx, xx);
-if (1) {
-  if (prec_model == SEMOD_PREC_VONDRAK_2011) {
-    swi_ldp_peps(t, &dpre, NULL);
-    swi_ldp_peps(t + 1, &dpre2, NULL);
-    xx[3] += (dpre2 - dpre) * fac;
-  } else {
-    xx[3] += (50.290966 + 0.0222226 * tprec) / 3600 / 365.25 * DEGTORAD * fac;
-			/* formula from Montenbruck, German 1994, p. 18 */
-  }
-}
+  xx[3] += precess_rate(t) * fac;
   swi_polcart_sp(xx, xx);
   swi_coortrf2(xx, xx, -oe->seps, oe->ceps);
   swi_coortrf2(xx+3, xx+3, -oe->seps, oe->ceps);
 }
 
+#define FRAME_IFLAG_MASK \
+  (SEFLG_SPEED | SEFLG_J2000 | SEFLG_NONUT | SEFLG_JPLHOR | SEFLG_JPLHOR_APPROX)
+
+/* returns the fused frame bias, precession and nutation matrices for
+ * epoch teval. They are rebuilt only if the epoch, the relevant flags,
+ * the nutation or the astronomical models have changed, so that all
+ * bodies and fixed stars of one epoch share them.
+ * Requires swi_check_ecliptic() and swi_check_nutation() for teval.
+ */
+static struct frame_data *get_frame(double teval, int32 iflag, AS_BOOL do_bias)
+{
+  struct frame_data *fp = &swed.frame;
+  struct epsilon *oe = &swed.oec;
+  double x[6], pm[3][3], pb[3][3], nm[3][3], dn[3][3], rk[3][3], rate;
+  int i, j, k;
+  iflag &= FRAME_IFLAG_MASK;
+  if (fp->teval == teval && teval != 0
+      && fp->iflag == iflag && fp->do_bias == do_bias
+      && fp->tnut == swed.nut.tnut && fp->teps == oe->teps
+      && memcmp(fp->astro_models, swed.astro_models, sizeof(fp->astro_models)) == 0)
+    return fp;
+  /* frame bias; the columns are the images of the unit vectors */
+  for (j = 0; j <= 2; j++) {
+    for (i = 0; i <= 5; i++)
+      x[i] = (i == j) ? 1 : 0;
+    if (do_bias)
+      swi_bias(x, teval, iflag & ~SEFLG_SPEED, FALSE);
+    for (i = 0; i <= 2; i++)
+      fp->bias[i][j] = x[i];
+  }
+  /* precession; it is a rotation, therefore the third column 
+   * is the cross product of the first two */
+  for (j = 0; j <= 1; j++) {
+    for (i = 0; i <= 2; i++)
+      x[i] = (i == j) ? 1 : 0;
+    if (!(iflag & SEFLG_J2000))
+      swi_precess(x, teval, iflag, J2000_TO_J);
+    for (i = 0; i <= 2; i++)
+      pm[i][j] = x[i];
+  }
+  pm[0][2] = pm[1][0] * pm[2][1] - pm[2][0] * pm[1][1];
+  pm[1][2] = pm[2][0] * pm[0][1] - pm[0][0] * pm[2][1];
+  pm[2][2] = pm[0][0] * pm[1][1] - pm[1][0] * pm[0][1];
+  /* nutation; swed.nut.matrix is stored transposed */
+  for (i = 0; i <= 2; i++) {
+    for (j = 0; j <= 2; j++) {
+      if (iflag & SEFLG_NONUT) {
+	nm[i][j] = (i == j) ? 1 : 0;
+	dn[i][j] = 0;
+      } else {
+	nm[i][j] = swed.nut.matrix[j][i];
+	dn[i][j] = 0;
+	if (iflag & SEFLG_SPEED)
+	  dn[i][j] = (swed.nut.matrix[j][i] - swed.nutv.matrix[j][i]) / NUT_SPEED_INTV;
+      }
+    }
+  }
+  /* motion of the equinox, as in swi_precess_speed(): rotation about
+   * the pole of the ecliptic of date, n = (0, -sin(eps), cos(eps)) */
+  rate = 0;
+  if ((iflag & SEFLG_SPEED) && !(iflag & SEFLG_J2000))
+    rate = precess_rate(teval);
+  rk[0][0] = 0;                rk[0][1] = -rate * oe->ceps; rk[0][2] = -rate * oe->seps;
+  rk[1][0] = rate * oe->ceps;  rk[1][1] = 0;                rk[1][2] = 0;
+  rk[2][0] = rate * oe->seps;  rk[2][1] = 0;                rk[2][2] = 0;
+  /* rot = N * P * B, drot = (N * rk + dN) * P * B */
+  for (i = 0; i <= 2; i++)
+    for (j = 0; j <= 2; j++)
+      for (pb[i][j] = 0, k = 0; k <= 2; k++)
+	pb[i][j] += pm[i][k] * fp->bias[k][j];
+  for (i = 0; i <= 2; i++) {
+    for (j = 0; j <= 2; j++) {
+      for (x[j] = dn[i][j], k = 0; k <= 2; k++)
+	x[j] += nm[i][k] * rk[k][j];
+    }
+    for (j = 0; j <= 2; j++) {
+      fp->rot[i][j] = fp->drot[i][j] = 0;
+      for (k = 0; k <= 2; k++) {
+	fp->rot[i][j] += nm[i][k] * pb[k][j];
+	fp->drot[i][j] += x[k] * pb[k][j];
+      }
+    }
+  }
+  fp->teval = teval;
+  fp->iflag = iflag;
+  fp->do_bias = do_bias;
+  fp->tnut = swed.nut.tnut;
+  fp->teps = oe->teps;
+  memcpy(fp->astro_models, swed.astro_models, sizeof(fp->astro_models));
+  return fp;
+}
+
+/* ICRS (or J2000) -> true equator of date: frame bias, precession
+ * and nutation in a single matrix product.
+ * xx		cartesian equatorial position and speed, transformed in place
+ * x2000	output: J2000 coordinates (after frame bias only);
+ *		required for sidereal positions
+ * teval	epoch of precession and nutation
+ * tbias	time of the frame bias (light-time corrected)
+ * do_bias	TRUE, if the frame bias ICRS -> J2000 is to be applied
+ */
+static void frame_to_date(double *xx, double *x2000, double teval, 
+                          double tbias, int32 iflag, AS_BOOL do_bias)
+{
+  int i;
+  double x[6];
+  struct frame_data *fp;
+  /* the approximation of JPL Horizons is not a plain rotation;
+   * do it step by step */
+  if (iflag & SEFLG_JPLHOR_APPROX) {
+    if (do_bias)
+      swi_bias(xx, tbias, iflag, FALSE);
+    for (i = 0; i <= 5; i++)
+      x2000[i] = xx[i];
+    if (!(iflag & SEFLG_J2000)) {
+      swi_precess(xx, teval, iflag, J2000_TO_J);
+      if (iflag & SEFLG_SPEED)
+	swi_precess_speed(xx, teval, iflag, J2000_TO_J);
+    }
+    if (!(iflag & SEFLG_NONUT))
+      swi_nutate(xx, iflag, FALSE);
+    return;
+  }
+  fp = get_frame(teval, iflag, do_bias);
+  for (i = 0; i <= 2; i++) {
+    x2000[i] = fp->bias[i][0] * xx[0] + fp->bias[i][1] * xx[1] + fp->bias[i][2] * xx[2];
+    x[i] = fp->rot[i][0] * xx[0] + fp->rot[i][1] * xx[1] + fp->rot[i][2] * xx[2];
+    if (iflag & SEFLG_SPEED) {
+      x2000[i+3] = fp->bias[i][0] * xx[3] + fp->bias[i][1] * xx[4] + fp->bias[i][2] * xx[5];
+      x[i+3] = fp->rot[i][0] * xx[3] + fp->rot[i][1] * xx[4] + fp->rot[i][2] * xx[5]
+             + fp->drot[i][0] * xx[0] + fp->drot[i][1] * xx[1] + fp->drot[i][2] * xx[2];
+    } else {
+      x2000[i+3] = x[i+3] = xx[i+3];
+    }
+  }
+  for (i = 0; i <= 5; i++)
+    xx[i] = x[i];
+}
+
+/* sine and cosine of the obliquity for the transformation from the
+ * equator of date to the ecliptic of date, i.e. mean obliquity plus
+ * nutation in obliquity, unless SEFLG_NONUT */
+static void ecl_sincos(struct epsilon *oe, int32 iflag, double *seps, double *ceps)
+{
+  if (iflag & SEFLG_NONUT) {
+    *seps = oe->seps;
+    *ceps = oe->ceps;
+  } else {
+    *seps = oe->seps * swed.nut.cnut + oe->ceps * swed.nut.snut;
+    *ceps = oe->ceps * swed.nut.cnut - oe->seps * swed.nut.snut;
+  }
+}
+
 /* multiplies cartesian equatorial coordinates with previously
  * calculated nutation matrix. also corrects speed. 
  */
@@ -4048,22 +5416,16 @@ static int app_pos_etc_sun(int32 iflag, char *serr)
   if (!(iflag & SEFLG_SPEED))
     for (i = 3; i <= 5; i++)
       xx[i] = 0;
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && swi_get_denum(SEI_SUN, iflag) >= 403) {
-    swi_bias(xx, t, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, pedp->teval, iflag, J2000_TO_J);/**/
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, pedp->teval, iflag, J2000_TO_J);/**/ 
+  frame_to_date(xx, xxsv, pedp->teval, t, iflag,
+      !(iflag & SEFLG_ICRS) && swi_get_denum(SEI_SUN, iflag) >= 403);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else
+  else
     oe = &swed.oec2000;
   return app_pos_rest(pedp, iflag, xx, xxsv, oe, serr);
 }
@@ -4224,22 +5586,16 @@ static int app_pos_etc_moon(int32 iflag, char *serr)
   if (!(iflag & SEFLG_SPEED))
     for (i = 3; i <= 5; i++)
       xx[i] = 0;
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && swi_get_denum(SEI_MOON, iflag) >= 403) {
-    swi_bias(xx, t, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, pdp->teval, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, pdp->teval, iflag, J2000_TO_J); 
+  frame_to_date(xx, xxsv, pdp->teval, t, iflag,
+      !(iflag & SEFLG_ICRS) && swi_get_denum(SEI_MOON, iflag) >= 403);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else
+  else
     oe = &swed.oec2000;
   return app_pos_rest(pdp, iflag, xx, xxsv, oe, serr);
 }
@@ -4271,22 +5627,16 @@ static int app_pos_etc_sbar(int32 iflag, char *serr)
   if (!(iflag & SEFLG_SPEED))
     for (i = 3; i <= 5; i++)
       xx[i] = 0;
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && swi_get_denum(SEI_SUN, iflag) >= 403) {
-    swi_bias(xx, psdp->teval, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, psbdp->teval, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, psbdp->teval, iflag, J2000_TO_J); 
+  frame_to_date(xx, xxsv, psbdp->teval, psdp->teval, iflag,
+      !(iflag & SEFLG_ICRS) && swi_get_denum(SEI_SUN, iflag) >= 403);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else
+  else
     oe = &swed.oec2000;
   return app_pos_rest(psdp, iflag, xx, xxsv, oe, serr);
 }
@@ -4354,6 +5704,11 @@ static int app_pos_etc_mean(int ipl, int32 iflag, char *serr)
     oe = &swed.oec2000;
   } else
     oe = &swed.oec;
+  /************************************************
+   * nutation                                     *
+   ************************************************/
+  if (!(iflag & SEFLG_NONUT))
+    swi_nutate(xx, iflag, FALSE);
   return app_pos_rest(pdp, iflag, xx, xxsv, oe, serr);
 }
 
@@ -4389,7 +5744,8 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
   retc = do_fread((void *) &fpos, 3, 1, 4, fp, fpos, freord, fendian, ifno, serr);
   if (retc != OK)
     goto return_error_gns;
-  fseek(fp, fpos, SEEK_SET);
+  /* the coefficients are read at explicit positions from here on, 
+   * not at the file offset, which is shared with forked processes */
   /* clear space of chebyshew coefficients */
   if (pdp->segp == NULL)
     pdp->segp = (double *) malloc((size_t) pdp->ncoe * 3 * 8);
@@ -4399,14 +5755,16 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
     idbl = icoord * pdp->ncoe;
     /* first read header */
     /* first bit indicates number of sizes of packed coefficients */
-    retc = do_fread((void *) &c[0], 1, 2, 1, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+    retc = do_fread((void *) &c[0], 1, 2, 1, fp, fpos, freord, fendian, ifno, serr);
     if (retc != OK)
       goto return_error_gns;
+    fpos += 2;
     if (c[0] & 128) {
       nsizes = 6;
-      retc = do_fread((void *) (c+2), 1, 2, 1, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+      retc = do_fread((void *) (c+2), 1, 2, 1, fp, fpos, freord, fendian, ifno, serr);
       if (retc != OK)
 	goto return_error_gns;
+      fpos += 2;
       nsize[0] = (int) c[1] / 16;
       nsize[1] = (int) c[1] % 16;
       nsize[2] = (int) c[2] / 16;
@@ -4442,9 +5800,10 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       if (i < 4) {
 	j = (4 - i);
 	k = nsize[i];
-	retc = do_fread((void *) &longs[0], j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_fread((void *) &longs[0], j, k, 4, fp, fpos, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
+	fpos += j * k;
 	for (m = 0; m < k; m++, idbl++) {
 	  if (longs[m] & 1) 	/* will be negative */
 	    pdp->segp[idbl] = -(((longs[m]+1) / 2) / 1e+9 * pdp->rmax / 2); 
@@ -4454,9 +5813,10 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       } else if (i == 4) {		/* half byte packing */
 	j = 1;
 	k = (nsize[i] + 1) / 2;
-	retc = do_fread((void *) longs, j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_fread((void *) longs, j, k, 4, fp, fpos, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
+	fpos += k;
 	for (m = 0, j = 0; 
 	     m < k && j < nsize[i]; 
 	     m++) {
@@ -4473,9 +5833,10 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       } else if (i == 5) {		/* quarter byte packing */
 	j = 1;
 	k = (nsize[i] + 3) / 4;
-	retc = do_fread((void *) longs, j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_fread((void *) longs, j, k, 4, fp, fpos, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
+	fpos += k;
 	for (m = 0, j = 0; 
 	     m < k && j < nsize[i]; 
 	     m++) {
@@ -4670,7 +6031,8 @@ fendian, ifno, serr);
   /********************************************************** 
    * DE number of JPL ephemeris which this file is based on * 
    **********************************************************/
-  retc = do_fread((void *) &fdp->sweph_denum, 4, 1, 4, fp, fpos, freord,
+  fseek(fp, fpos, SEEK_SET);
+  retc = do_fread((void *) &fdp->sweph_denum, 4, 1, 4, fp, SEI_CURR_FPOS, freord,
 fendian, ifno, serr);
   if (retc != OK)
     goto return_error;
@@ -4894,7 +6256,8 @@ return_error:
  * corrsize	in what size should it be returned 
  *		(e.g. 3 byte int -> 4 byte int)
  * fp		file pointer
- * fpos		file position: if (fpos >= 0) then fseek
+ * fpos		file position: if (fpos >= 0) then read at this position
+ *		with swi_pread(), else at the current file offset
  * freord	reorder bytes or no
  * fendian	little/bigendian
  * ifno		file number
@@ -4907,11 +6270,10 @@ static int do_fread(void *trg, int size, int count, int corrsize, FILE *fp, int3
   unsigned char space[1000];
   unsigned char *targ = (unsigned char *) trg;
   totsize = size * count;
-  if (fpos >= 0) 
-    fseek(fp, fpos, SEEK_SET);
   /* if no byte reorder has to be done, and read size == return size */
   if (!freord && size == corrsize) {
-    if (fread((void *) targ, (size_t) totsize, 1, fp) == 0) {
+    if (fpos >= 0 ? swi_pread(fp, (void *) targ, (size_t) totsize, fpos) != (size_t) totsize
+                  : fread((void *) targ, (size_t) totsize, 1, fp) == 0) {
       if (serr != NULL) {
 	strcpy(serr, "Ephemeris file is damaged (1). ");
 	if (strlen(serr) + strlen(swed.fidat[ifno].fnam) < AS_MAXCH - 1) {
@@ -4922,7 +6284,8 @@ static int do_fread(void *trg, int size, int count, int corrsize, FILE *fp, int3
     } else
       return(OK);
   } else {
-    if (fread((void *) &space[0], (size_t) totsize, 1, fp) == 0) {
+    if (fpos >= 0 ? swi_pread(fp, (void *) &space[0], (size_t) totsize, fpos) != (size_t) totsize
+                  : fread((void *) &space[0], (size_t) totsize, 1, fp) == 0) {
       if (serr != NULL) {
 	strcpy(serr, "Ephemeris file is damaged (3). ");
 	if (strlen(serr) + strlen(swed.fidat[ifno].fnam) < AS_MAXCH - 1) {
@@ -6410,7 +7773,7 @@ static int32 fixstar_calc_from_struct(struct fixed_star *stardata, double tjd, i
   int32 retc = OK;
   double epoch, radv, parall;
   double ra_pm, de_pm, ra, de, t;
-  double daya[2], rdist;
+  double daya[2], rdist, seps, ceps;
   double x[6], xxsv[6], xobs[6], xobs_dt[6], *xpo = NULL, *xpo_dt = NULL;
   static TLS double xearth[6], xearth_dt[6], xsun[6], xsun_dt[6];
   double dt = PLAN_SPEED_INTV * 0.1;
@@ -6567,29 +7930,17 @@ static int32 fixstar_calc_from_struct(struct fixed_star *stardata, double tjd, i
    **********************************/
   if ((iflag & SEFLG_TRUEPOS) == 0 && (iflag & SEFLG_NOABERR) == 0)
     swi_aberr_light_ex(x, xpo, xpo_dt, dt, iflag & SEFLG_SPEED);
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && (swi_get_denum(SEI_SUN, iflag) >= 403 || (iflag & SEFLG_BARYCTR))) {
-    swi_bias(x, tjd, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = x[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  /*x[0] = -0.374018403; x[1] = -0.312548592; x[2] = -0.873168719;*/
-  if ((iflag & SEFLG_J2000) == 0) {
-    swi_precess(x, tjd, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(x, tjd, iflag, J2000_TO_J);
+  frame_to_date(x, xxsv, tjd, tjd, iflag,
+      !(iflag & SEFLG_ICRS) && (swi_get_denum(SEI_SUN, iflag) >= 403 || (iflag & SEFLG_BARYCTR)));
+  if ((iflag & SEFLG_J2000) == 0)
     oe = &swed.oec;
-  } else
+  else
     oe = &swed.oec2000;
-  /************************************************
-   * nutation                                     *
-   ************************************************/
-  if (!(iflag & SEFLG_NONUT))
-    swi_nutate(x, iflag, FALSE);
 if ((0)) {
   double r = sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
   printf("%.17f %.17f %f\n", x[0]/r, x[1]/r, x[2]/r);
@@ -6600,14 +7951,10 @@ if ((0)) {
    * afterwards.                                  *
    ************************************************/
   if ((iflag & SEFLG_EQUATORIAL) == 0) {
-    swi_coortrf2(x, x, oe->seps, oe->ceps);
+    ecl_sincos(oe, iflag, &seps, &ceps);
+    swi_coortrf2(x, x, seps, ceps);
     if (iflag & SEFLG_SPEED)
-      swi_coortrf2(x+3, x+3, oe->seps, oe->ceps);
-    if (!(iflag & SEFLG_NONUT)) {
-      swi_coortrf2(x, x, swed.nut.snut, swed.nut.cnut);
-      if (iflag & SEFLG_SPEED)
-	swi_coortrf2(x+3, x+3, swed.nut.snut, swed.nut.cnut);
-    }
+      swi_coortrf2(x+3, x+3, seps, ceps);
   }
 //  printf("%.17f, %.17f\n", x[0], x[3]);
   /************************************
@@ -7266,6 +8613,17 @@ void CALL_CONV swe_set_topo(double geolon, double geolat, double geoalt)
   swi_force_app_pos_etc();
 }
 
+/* returns the geographic position of the observer set by swe_set_topo(),
+ * and FALSE if none is set */
+int32 CALL_CONV swe_get_topo(double *geolon, double *geolat, double *geoalt)
+{
+  swi_init_swed_if_start();
+  *geolon = swed.topd.geolon;
+  *geolat = swed.topd.geolat;
+  *geoalt = swed.topd.geoalt;
+  return swed.geopos_is_set;
+}
+
 void swi_force_app_pos_etc(void)
 {
   int i;
@@ -7617,7 +8975,7 @@ static int32 swi_fixstar_calc_from_record(char *srecord, double tjd, int32 iflag
   double epoch, radv, parall;
   double ra_pm, de_pm, ra, de, t;
   struct fixed_star stardata;
-  double daya, rdist;
+  double daya, rdist, seps, ceps;
   double x[6], xxsv[6], xobs[6], xobs_dt[6], *xpo = NULL, *xpo_dt = NULL;
   static TLS double xearth[6], xearth_dt[6], xsun[6], xsun_dt[6];
   double dt = PLAN_SPEED_INTV * 0.1;
@@ -7780,31 +9138,17 @@ static int32 swi_fixstar_calc_from_record(char *srecord, double tjd, int32 iflag
    **********************************/
   if ((iflag & SEFLG_TRUEPOS) == 0 && (iflag & SEFLG_NOABERR) == 0)
     swi_aberr_light_ex(x, xpo, xpo_dt, dt, iflag & SEFLG_SPEED);
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && (swi_get_denum(SEI_SUN, iflag) >= 403 || (iflag & SEFLG_BARYCTR))) {
-    swi_bias(x, tjd, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = x[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  /*x[0] = -0.374018403; x[1] = -0.312548592; x[2] = -0.873168719;*/
-  if ((iflag & SEFLG_J2000) == 0) {
-    swi_precess(x, tjd, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED) {
-      swi_precess_speed(x, tjd, iflag, J2000_TO_J);
-    }
+  frame_to_date(x, xxsv, tjd, tjd, iflag,
+      !(iflag & SEFLG_ICRS) && (swi_get_denum(SEI_SUN, iflag) >= 403 || (iflag & SEFLG_BARYCTR)));
+  if ((iflag & SEFLG_J2000) == 0)
     oe = &swed.oec;
-  } else {
+  else
     oe = &swed.oec2000;
-  }
-  /************************************************
-   * nutation                                     *
-   ************************************************/
-  if (!(iflag & SEFLG_NONUT))
-    swi_nutate(x, iflag, FALSE);
 if ((0)) {
   double r = sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
   printf("%.17f %.17f %f\n", x[0]/r, x[1]/r, x[2]/r);
@@ -7815,14 +9159,10 @@ if ((0)) {
    * afterwards.                                  *
    ************************************************/
   if ((iflag & SEFLG_EQUATORIAL) == 0) {
-    swi_coortrf2(x, x, oe->seps, oe->ceps);
+    ecl_sincos(oe, iflag, &seps, &ceps);
+    swi_coortrf2(x, x, seps, ceps);
     if (iflag & SEFLG_SPEED)
-      swi_coortrf2(x+3, x+3, oe->seps, oe->ceps);
-    if (!(iflag & SEFLG_NONUT)) {
-      swi_coortrf2(x, x, swed.nut.snut, swed.nut.cnut);
-      if (iflag & SEFLG_SPEED)
-	swi_coortrf2(x+3, x+3, swed.nut.snut, swed.nut.cnut);
-    }
+      swi_coortrf2(x+3, x+3, seps, ceps);
   }
   /************************************
    * sidereal positions               *
@@ -8043,6 +9383,7 @@ int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag,
 {
   double t = 0, dt, daya[2], dtsave_for_defl = 0;
   double xx[6], xxctr[6], xxctr2[6], xx0[6], xxsv[24], xxsp[6], dx[6], xreturn[24];
+  double seps, ceps;
   double *xs;
   int i, j, niter;
   int32 iflag2, epheflag, retc;
@@ -8169,29 +9510,17 @@ int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag,
   if (!(iflag & SEFLG_SPEED))
     for (i = 3; i <= 5; i++)
       xx[i] = 0;
-  /* ICRS to J2000 */
-  if (!(iflag & SEFLG_ICRS) && swi_get_denum(ipl, epheflag) >= 403) {
-    swi_bias(xx, t, iflag, FALSE);
-  }/**/
-  /* save J2000 coordinates; required for sidereal positions */
-  for (i = 0; i <= 5; i++)
-    xxsv[i] = xx[i];
   /************************************************
-   * precession, equator 2000 -> equator of date *
+   * ICRS to J2000, precession and nutation,      *
+   * equator 2000 -> true equator of date         *
+   * (xxsv: J2000 coordinates, for sidereal pos.) *
    ************************************************/
-  if (!(iflag & SEFLG_J2000)) {
-    swi_precess(xx, tjd, iflag, J2000_TO_J);
-    if (iflag & SEFLG_SPEED)
-      swi_precess_speed(xx, tjd, iflag, J2000_TO_J);
+  frame_to_date(xx, xxsv, tjd, t, iflag,
+      !(iflag & SEFLG_ICRS) && swi_get_denum(ipl, epheflag) >= 403);
+  if (!(iflag & SEFLG_J2000))
     oe = &swed.oec;
-  } else {
+  else
     oe = &swed.oec2000;
-  }
-  /************************************************
-   * nutation                                     *
-   ************************************************/
-  if (!(iflag & SEFLG_NONUT))
-    swi_nutate(xx, iflag, FALSE);
   /* now we have equatorial cartesian coordinates; save them */
   for (i = 0; i <= 5; i++)
     xreturn[18+i] = xx[i];
@@ -8200,14 +9529,10 @@ int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag,
    * with sidereal calc. this will be overwritten *
    * afterwards.                                  *
    ************************************************/
-  swi_coortrf2(xx, xx, oe->seps, oe->ceps);
+  ecl_sincos(oe, iflag, &seps, &ceps);
+  swi_coortrf2(xx, xx, seps, ceps);
   if (iflag & SEFLG_SPEED)
-    swi_coortrf2(xx+3, xx+3, oe->seps, oe->ceps);
-  if (!(iflag & SEFLG_NONUT)) {
-    swi_coortrf2(xx, xx, swed.nut.snut, swed.nut.cnut);
-    if (iflag & SEFLG_SPEED)
-      swi_coortrf2(xx+3, xx+3, swed.nut.snut, swed.nut.cnut);
-  }
+    swi_coortrf2(xx+3, xx+3, seps, ceps);
   /* now we have ecliptic cartesian coordinates */
   for (i = 0; i <= 5; i++)
     xreturn[6+i] = xx[i];
@@ -667,13 +667,17 @@ extern int swi_mean_node(double jd, double *x, char *serr);
 extern int swi_mean_apog(double jd, double *x, char *serr);
 extern int swi_moshmoon(double tjd, AS_BOOL do_save, double *xpm, char *serr) ;
 extern int swi_moshmoon2(double jd, double *x);
+extern int swi_moshmoon2_batch(const double *J, int nb, double *pol);
 extern int swi_intp_apsides(double J, double *pol, int ipli);
 
 /* planets, s. moshplan.c */
 extern int swi_moshplan(double tjd, int ipli, AS_BOOL do_save, double *xpret, double *xeret, char *serr);
 extern int swi_moshplan2(double J, int iplm, double *pobj);
+extern int swi_moshplan2_batch(const double *J, int nb, int iplm, double *pobj);
+extern int swi_moshplan_prefetch(const double *tjd, int n, int ipli);
 extern int swi_osc_el_plan(double tjd, double *xp, int ipl, int ipli, double *xearth, double *xsun, char *serr);
 extern FILE *swi_fopen(int ifno, char *fname, char *ephepath, char *serr);
+extern const void *swi_mem_lookup(const char *fname, size_t *len);
 extern int32 swi_init_swed_if_start(void);
 extern int32 swi_set_tid_acc(double tjd_ut, int32 iflag, int32 denum, char *serr);
 extern int32 swi_get_tid_acc(double tjd_ut, int32 iflag, int32 denum, int32 *denumret, double *tid_acc, char *serr);
@@ -695,6 +699,19 @@ struct nut {
   double matrix[3][3];	
 };
 
+/* fused frame bias, precession and nutation of one epoch;
+ * built once and applied to all bodies and fixed stars of that epoch */
+struct frame_data {
+  double teval;		/* epoch of precession and nutation */
+  int32 iflag;		/* flags the matrices were built with */
+  AS_BOOL do_bias;	/* frame bias ICRS -> J2000 included */
+  double tnut, teps;	/* nutation and obliquity they were built from */
+  int32 astro_models[SEI_NMODELS];
+  double bias[3][3];	/* frame bias, ICRS -> J2000 */
+  double rot[3][3];	/* bias, precession, nutation: ICRS -> true equator of date */
+  double drot[3][3];	/* time derivative of rot, per day */
+};
+
 struct plantbl {
   char max_harmonic[9];
   char max_power_of_t;
@@ -781,6 +798,20 @@ struct fixed_star {
 /* dpsi and deps loaded for 100 years after 1962 */
 #define SWE_DATA_DPSI_DEPS  36525   
 
+/* dpsi and deps (IAU 1980, arcsec) from the EOP files, as coefficients
+ * of the Bessel interpolation per day (see swi_bessel_coef()); entry
+ * n - 1 holds the last values. One table per ephemeris path is shared
+ * read-only by all threads and reference counted, see load_dpsi_deps()
+ * and eop_release() in sweph.c.
+ */
+struct eop_table {
+  double tjd_beg;
+  double tjd_end;
+  int eop_dpsi_loaded;	/* 1 or 2, as swed.eop_dpsi_loaded */
+  int n;
+  double coef[1][2][5];	/* really n: dpsi, deps */
+};
+
 struct interpol {
   double tjd_nut0, tjd_nut2;
   double nut_dpsi0, nut_dpsi1, nut_dpsi2;
@@ -788,6 +819,18 @@ struct interpol {
 };
 
 /* if this is changed, then also update initialisation in sweph.c */
+/* segments of a body decoded in advance by swe_prefetch(), 
+ * sorted by start date */
+struct seg_cache {
+  int n, nalloc;
+  int ncoe;
+  double *tfstart;	/* tfstart of the file of each segment */
+  double *tseg0;	/* start of each segment */
+  double *tseg1;	/* end of each segment */
+  int *neval;
+  double *segp;		/* 3 x ncoe coefficients per segment */
+};
+
 struct swe_data {
   AS_BOOL ephe_path_is_set;
   AS_BOOL jpl_file_is_open;
@@ -818,8 +861,7 @@ struct swe_data {
   char saved_planet_name[80];
   //double dpsi[36525];  /* works for 100 years after 1962 */
   //double deps[36525];
-  double *dpsi;
-  double *deps;
+  struct eop_table *eop;
   int32 timeout;
   int32 astro_models[SEI_NMODELS];
   AS_BOOL do_interpolate_nut;
@@ -827,6 +869,7 @@ struct swe_data {
   struct file_data fidat[SEI_NEPHFILES];
   struct gen_const gcdat;
   struct plan_data pldat[SEI_NPLANETS];
+  struct seg_cache segc[SEI_NPLANETS];
 #if 0
   struct node_data nddat[SEI_NNODE_ETC];
 #else
@@ -844,6 +887,8 @@ struct swe_data {
   AS_BOOL n_fixstars_named;  // number of fixed stars with tradtional name
   AS_BOOL n_fixstars_records;// number of fixed stars records in fixed_stars
   struct fixed_star *fixed_stars;
+  struct frame_data frame;
+  double grid_step;          // spacing of uniform time grid, see swe_set_uniform_grid()
 };
 
 extern TLS struct swe_data swed;
@@ -709,6 +709,10 @@ ext_def(int32) swe_calc_ut(double tjd_ut, int32 ipl, int32 iflag,
 
 ext_def(int32) swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag, double *xxret, char *serr);
 
+ext_def(int32) swe_calc_prefetch(double *tjd, int32 *ipl, int32 n, int32 iflag);
+
+ext_def(int32) swe_prefetch(double tjd_start, double tjd_end, int32 *ipl, int32 nipl, int32 iflag, size_t *nbytes, char *serr);
+
 ext_def(double) swe_solcross(double x2cross, double jd_et, int32 flag, char *serr);
 ext_def(double) swe_solcross_ut(double x2cross, double jd_ut, int32 flag, char *serr);
 ext_def(double) swe_mooncross(double x2cross, double jd_et, int32 flag, char *serr);
@@ -744,24 +748,47 @@ ext_def( void ) swe_close(void);
 
 /* set directory path of ephemeris files */
 ext_def( void ) swe_set_ephe_path(const char *path);
+ext_def( char *) swe_get_ephe_path(char *path);
 
 /* set file name of JPL file */
 ext_def( void ) swe_set_jpl_file(const char *fname);
+ext_def( char *) swe_get_jpl_file(char *fname);
+
+ext_def( int32 ) swe_set_ephe_buffer(const char *fname, const void *buf, size_t len);
+
+/* ephemeris bundle: many ephemeris files in one file */
+ext_def( int32 ) swe_set_ephe_bundle(const char *path, char *serr);
+ext_def( int32 ) swe_create_ephe_bundle(const char *path, const char *const *files, int32 nfiles, char *serr);
+
+/* decoded ephemeris segments shared between processes */
+ext_def( int32 ) swe_set_segment_cache(const char *path, size_t nbytes, char *serr);
+
+/* a thread with the ephemeris settings of the calling thread */
+ext_def( void *) swe_thread_start(void (*fn)(void *arg), void *arg);
+ext_def( void ) swe_thread_join(void *thread);
+
+/* ephemeris settings of the calling thread, to be restored later */
+ext_def( void *) swe_save_settings(void);
+ext_def( void ) swe_restore_settings(const void *settings);
+ext_def( void ) swe_free_settings(void *settings);
 
 /* get planet name */
 ext_def( char *) swe_get_planet_name(int ipl, char *spname);
 
 /* set geographic position of observer */
 ext_def (void) swe_set_topo(double geolon, double geolat, double geoalt);
+ext_def (int32) swe_get_topo(double *geolon, double *geolat, double *geoalt);
 
 /* set sidereal mode */
 ext_def(void) swe_set_sid_mode(int32 sid_mode, double t0, double ayan_t0);
+ext_def(int32) swe_get_sid_mode(double *t0, double *ayan_t0);
 
 /* get ayanamsa */
 ext_def(int32) swe_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr);
 ext_def(int32) swe_get_ayanamsa_ex_ut(double tjd_ut, int32 iflag, double *daya, char *serr);
 ext_def(double) swe_get_ayanamsa(double tjd_et);
 ext_def(double) swe_get_ayanamsa_ut(double tjd_ut);
+ext_def(int32) swe_ayanamsa_prefetch(double *tjd_et, int32 n);
 
 
 ext_def(const char *) swe_get_ayanamsa_name(int32 isidmode);
@@ -826,6 +853,10 @@ ext_def( int ) swe_houses_ex2(
         double tjd_ut, int32 iflag, double geolat, double geolon, int hsys, 
 	double *cusps, double *ascmc, double *cusp_speed, double *ascmc_speed, char *serr);
 
+ext_def( int32 ) swe_houses_multi(
+        double tjd_ut, int32 iflag, double geolat, double geolon, 
+	int32 nsys, int *hsys, double *cusps, double *ascmc, int32 *retc, char *serr);
+
 ext_def( int ) swe_houses_armc(
         double armc, double geolat, double eps, int hsys, 
 	double *cusps, double *ascmc);
@@ -837,6 +868,10 @@ ext_def( int ) swe_houses_armc_ex2(
 ext_def(double) swe_house_pos(
 	double armc, double geolat, double eps, int hsys, double *xpin, char *serr);
 
+ext_def( int32 ) swe_house_pos_array(
+	double armc, double geolat, double eps, int hsys, 
+	int32 n, double *xpin, double *hpos, char *serr);
+
 ext_def(const char *) swe_house_name(int hsys);
 
 
@@ -847,6 +882,8 @@ ext_def(const char *) swe_house_name(int hsys);
 
 ext_def(int32) swe_gauquelin_sector(double t_ut, int32 ipl, char *starname, int32 iflag, int32 imeth, double *geopos, double atpress, double attemp, double *dgsect, char *serr);
 
+ext_def(int32) swe_gauquelin_sector_array(int32 n, double *t_ut, int32 *ipl, char *starname, int32 iflag, int32 imeth, double *geopos, double atpress, double attemp, int32 nthreads, double *dgsect, int32 *retc, char **serr);
+
 /* computes geographic location and attributes of solar 
  * eclipse at a given tjd */
 ext_def (int32) swe_sol_eclipse_where(double tjd, int32 ifl, double *geopos, double *attr, char *serr);
@@ -889,10 +926,16 @@ ext_def (int32) swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
  
 ext_def(int32) swe_pheno_ut(double tjd_ut, int32 ipl, int32 iflag, double *attr, char *serr);
 
+ext_def(int32) swe_pheno_array(int32 n, double *tjd, int32 *ipl, int32 iflag, int32 nthreads, double *attr, int32 *retc, char **serr);
+
+ext_def(int32) swe_pheno_ut_array(int32 n, double *tjd_ut, int32 *ipl, int32 iflag, int32 nthreads, double *attr, int32 *retc, char **serr);
+
 ext_def (double) swe_refrac(double inalt, double atpress, double attemp, int32 calc_flag);
 
 ext_def (double) swe_refrac_extended(double inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *dret);
 
+ext_def (void) swe_refrac_extended_array(int32 n, double *inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *outalt, double *dret);
+
 ext_def (void) swe_set_lapse_rate(double lapse_rate);
 
 ext_def (void) swe_azalt(
@@ -911,6 +954,24 @@ ext_def (void) swe_azalt_rev(
       double *xin, 
       double *xout); 
 
+ext_def (void) swe_azalt_array(
+      double tjd_ut,
+      int32 calc_flag,
+      double *geopos,
+      double atpress,
+      double attemp,
+      int32 n,
+      double *xin, 
+      double *xaz); 
+
+ext_def (void) swe_azalt_rev_array(
+      double tjd_ut,
+      int32 calc_flag,
+      double *geopos,
+      int32 n,
+      double *xin, 
+      double *xout); 
+
 ext_def (int32) swe_rise_trans_true_hor(
                double tjd_ut, int32 ipl, char *starname, 
 	       int32 epheflag, int32 rsmi,
@@ -961,6 +1022,7 @@ ext_def(int32) swe_lat_to_lmt(double tjd_lat, double geolon, double *tjd_lmt, ch
 ext_def( double ) swe_sidtime0(double tjd_ut, double eps, double nut);
 ext_def( double ) swe_sidtime(double tjd_ut);
 ext_def( void ) swe_set_interpolate_nut(AS_BOOL do_interpolate);
+ext_def( void ) swe_set_uniform_grid(double step);
 
 /* coordinate transformation polar -> polar */
 ext_def( void ) swe_cotrans(double *xpo, double *xpn, double eps);
@@ -80,6 +80,13 @@
 #if MSDOS
 # include <process.h>
 # define strdup _strdup
+#else
+# include <pthread.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <errno.h>
 #endif
 
 #ifdef TRACE
@@ -1810,63 +1817,473 @@ static int calc_nutation_iau1980(double J, double *nutlo)
  */
 
 #include "swenut2000a.h"
-static int calc_nutation_iau2000ab(double J, double *nutlo) 
+/* Fundamental arguments of the IAU 2000 nutation series: fa[0..4] for
+ * the luni-solar series, Simon & al. (1994), and with IAU 2000A
+ * fa[5..18] for the planetary series.
+ */
+static void nut2000_fundargs(double T, int nut_model, double *fa)
 {
-  int i, j, k, inls;
-  double M, SM, F, D, OM;
-  double AL, ALSU, AF, AD, AOM, APA;
-  double ALME, ALVE, ALEA, ALMA, ALJU, ALSA, ALUR, ALNE;
-  double darg, sinarg, cosarg;
-  double dpsi = 0, deps = 0;
-  double T = (J - J2000 ) / 36525.0;
-  int nut_model = swed.astro_models[SE_MODEL_NUT];
-  if (nut_model == 0) nut_model = SEMOD_NUT_DEFAULT;
-  /* luni-solar nutation */
-  /* Fundamental arguments, Simon & al. (1994) */
   /* Mean anomaly of the Moon. */
-  M  = swe_degnorm(( 485868.249036 +
+  fa[0] = swe_degnorm(( 485868.249036 +
 	      T*( 1717915923.2178 +
 	      T*(         31.8792 +
 	      T*(          0.051635 +
 	      T*(        - 0.00024470 ))))) / 3600.0) * DEGTORAD;
   /* Mean anomaly of the Sun */
-  SM = swe_degnorm((1287104.79305 +
+  fa[1] = swe_degnorm((1287104.79305 +
 	      T*(  129596581.0481 +
 	      T*(        - 0.5532 +
 	      T*(          0.000136 +
 	      T*(        - 0.00001149 ))))) / 3600.0) * DEGTORAD;
   /* Mean argument of the latitude of the Moon. */
-  F   = swe_degnorm(( 335779.526232 +
+  fa[2] = swe_degnorm(( 335779.526232 +
 	      T*( 1739527262.8478 +
 	      T*(       - 12.7512 +
 	      T*(       -  0.001037 +
 	      T*(          0.00000417 ))))) / 3600.0) * DEGTORAD;
   /* Mean elongation of the Moon from the Sun. */
-  D   = swe_degnorm((1072260.70369 +
+  fa[3] = swe_degnorm((1072260.70369 +
 	      T*( 1602961601.2090 +
 	      T*(        - 6.3706 +
 	      T*(          0.006593 +
 	      T*(        - 0.00003169 ))))) / 3600.0) * DEGTORAD;
   /* Mean longitude of the ascending node of the Moon. */
-  OM  = swe_degnorm(( 450160.398036 +
+  fa[4] = swe_degnorm(( 450160.398036 +
 	      T*(  - 6962890.5431 +
 	      T*(          7.4722 +
 	      T*(          0.007702 +
 	      T*(        - 0.00005939 ))))) / 3600.0) * DEGTORAD;
-  /* luni-solar nutation series, in reverse order, starting with small terms */
+  if (nut_model != SEMOD_NUT_IAU_2000A)
+    return;
+  /* planetary nutation 
+   * note: The MHB2000 code computes the luni-solar and planetary nutation
+   * in different routines, using slightly different Delaunay
+   * arguments in the two cases.  This behaviour is faithfully
+   * reproduced here.  Use of the Simon et al. expressions for both
+   * cases leads to negligible changes, well below 0.1 microarcsecond.*/
+  /* Mean anomaly of the Moon.*/
+  fa[5] = swe_radnorm(2.35555598 + 8328.6914269554 * T);
+  /* Mean anomaly of the Sun.*/
+  fa[6] = swe_radnorm(6.24006013 + 628.301955 * T);
+  /* Mean argument of the latitude of the Moon. */
+  fa[7] = swe_radnorm(1.627905234 + 8433.466158131 * T);
+  /* Mean elongation of the Moon from the Sun. */
+  fa[8] = swe_radnorm(5.198466741 + 7771.3771468121 * T);
+  /* Mean longitude of the ascending node of the Moon. */
+  fa[9] = swe_radnorm(2.18243920 - 33.757045 * T);
+  /* Planetary longitudes, Mercury through Neptune (Souchay et al. 1999). */
+  fa[10] = swe_radnorm(4.402608842 + 2608.7903141574 * T);
+  fa[11] = swe_radnorm(3.176146697 + 1021.3285546211 * T);
+  fa[12] = swe_radnorm(1.753470314 +  628.3075849991 * T);
+  fa[13] = swe_radnorm(6.203480913 +  334.0612426700 * T);
+  fa[14] = swe_radnorm(0.599546497 +   52.9690962641 * T);
+  fa[15] = swe_radnorm(0.874016757 +   21.3299104960 * T);
+  fa[16] = swe_radnorm(5.481293871 +    7.4781598567 * T);
+  fa[17] = swe_radnorm(5.321159000 +    3.8127774000 * T);
+  /* General accumulated precession in longitude. */
+  fa[18] = (0.02438175 + 0.00000538691 * T) * T;
+}
+
+/* argument of luni-solar term i */
+static double nut2000_arg_ls(const double *fa, int i)
+{
+  int j = i * 5;
+  return swe_radnorm((double) nls[j + 0] * fa[0] +
+		     (double) nls[j + 1] * fa[1] +
+		     (double) nls[j + 2] * fa[2] +
+		     (double) nls[j + 3] * fa[3] +
+		     (double) nls[j + 4] * fa[4]);
+}
+
+/* argument of planetary term i */
+static double nut2000_arg_pl(const double *fa, int i)
+{
+  int j = i * 14;
+  return swe_radnorm((double) npl[j + 0] * fa[5] +
+	  (double) npl[j + 1] * fa[6] +
+	  (double) npl[j + 2] * fa[7] +
+	  (double) npl[j + 3] * fa[8] +
+	  (double) npl[j + 4] * fa[9] +
+	  (double) npl[j + 5] * fa[10] +
+	  (double) npl[j + 6] * fa[11] +
+	  (double) npl[j + 7] * fa[12] +
+	  (double) npl[j + 8] * fa[13] +
+	  (double) npl[j + 9] * fa[14] +
+	  (double) npl[j +10] * fa[15] +
+	  (double) npl[j +11] * fa[16] +
+	  (double) npl[j +12] * fa[17] +
+	  (double) npl[j +13] * fa[18]);
+}
+
+/* changes required by adoption of P03 precession 
+ * according to Capitaine et al. A & A 412, 366 (2005) = IAU 2006 */
+static void nut2000_p03(double T, const double *fa, double *nutlo)
+{
+  double dpsi, deps;
+  double F = fa[2], D = fa[3], OM = fa[4];
+  dpsi = -8.1 * sin(OM) - 0.6 * sin(2 * F - 2 * D + 2 * OM);
+  dpsi += T * (47.8 * sin(OM) + 3.7 * sin(2 * F - 2 * D + 2 * OM) + 0.6 * sin(2 * F + 2 * OM) - 0.6 * sin(2 * OM)); 
+  deps = T * (-25.6 * cos(OM) - 1.6 * cos(2 * F - 2 * D + 2 * OM));
+  nutlo[0] += dpsi / (3600.0 * 1000000.0);
+  nutlo[1] += deps / (3600.0 * 1000000.0);
+}
+
+/* The IAU 2000 series are evaluated in chunks of NUT_CHUNK terms, with
+ * loops of fixed length that the compiler can vectorise: the tables of
+ * swenut2000a.h are repacked once per thread as columns of doubles
+ * (padded with zero terms to a multiple of NUT_CHUNK), the arguments of
+ * a chunk are computed column by column, sin and cos of them with a
+ * polynomial kernel, and the terms are summed into NUT_CHUNK partial
+ * sums. Up to NUT_NEPOCH dates share one pass over the tables.
+ */
+#define NUT_CHUNK	32
+#define NUT_NEPOCH	4
+#define NLS_PAD		(((NLS + NUT_CHUNK - 1) / NUT_CHUNK) * NUT_CHUNK)
+#define NPL_PAD		(((NPL + NUT_CHUNK - 1) / NUT_CHUNK) * NUT_CHUNK)
+static TLS struct nut2000_soa {
+  AS_BOOL init;
+  double nls[5][NLS_PAD];	/* multipliers of the luni-solar arguments */
+  double cls[6][NLS_PAD];	/* luni-solar coefficients */
+  double npl[14][NPL_PAD];	/* multipliers of the planetary arguments */
+  double icpl[4][NPL_PAD];	/* planetary coefficients */
+} nsoa;
+
+static void nut2000_soa_init(void)
+{
+  int i, j;
+  if (nsoa.init)
+    return;
+  memset((void *) &nsoa, 0, sizeof(struct nut2000_soa));
+  for (i = 0; i < NLS; i++) {
+    for (j = 0; j < 5; j++)
+      nsoa.nls[j][i] = (double) nls[i * 5 + j];
+    for (j = 0; j < 6; j++)
+      nsoa.cls[j][i] = (double) cls[i * 6 + j];
+  }
+  for (i = 0; i < NPL; i++) {
+    for (j = 0; j < 14; j++)
+      nsoa.npl[j][i] = (double) npl[i * 14 + j];
+    for (j = 0; j < 4; j++)
+      nsoa.icpl[j][i] = (double) icpl[i * 4 + j];
+  }
+  nsoa.init = TRUE;
+}
+
+/* sin and cos of NUT_CHUNK angles (|x| < 2^19 rad).
+ * Reduction by multiples of pi/2 in three parts, then the polynomial
+ * kernels of fdlibm on [-pi/4, pi/4]; the error is about 1 ulp.
+ */
+static void sincos_chunk(const double *x, double *s, double *c)
+{
+  static const double PIO2_1 = 1.57079632673412561417e+00;
+  static const double PIO2_2 = 6.07710050630396597660e-11;
+  static const double PIO2_3 = 2.02226624879595063154e-21;
+  static const double INVPIO2 = 6.36619772367581382433e-01;
+  static const double S1 = -1.66666666666666324348e-01,
+    S2 = 8.33333333332248946124e-03, S3 = -1.98412698298579493134e-04,
+    S4 = 2.75573137070700676789e-06, S5 = -2.50507602534068634195e-08,
+    S6 = 1.58969099521155010221e-10;
+  static const double C1 = 4.16666666666666019037e-02,
+    C2 = -1.38888888888741095749e-03, C3 = 2.48015872894767294178e-05,
+    C4 = -2.75573143513906633035e-07, C5 = 2.08757232129817482790e-09,
+    C6 = -1.13596475577881948265e-11;
+  int l;
+  for (l = 0; l < NUT_CHUNK; l++) {
+    double q = floor(x[l] * INVPIO2 + 0.5);
+    double r = ((x[l] - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    double z = r * r;
+    double sr = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    double cr = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    int n = (int) (q - 4.0 * floor(q * 0.25));	/* quadrant 0..3 */
+    double sv = (n & 1) ? cr : sr;
+    double cv = (n & 1) ? sr : cr;
+    s[l] = (n & 2) ? -sv : sv;
+    c[l] = ((n + 1) & 2) ? -cv : cv;
+  }
+}
+
+/* IAU 2000A/B nutation for the dates J[0..nb-1]; nutlo receives dpsi
+ * and deps (radians) for each date.
+ */
+static void nut2000_batch(const double *J, int nb, int nut_model, double *nutlo)
+{
+  int i, j, e, l, ne, e0, inls;
+  double T[NUT_NEPOCH], fa[NUT_NEPOCH][19];
+  double arg[NUT_CHUNK], sa[NUT_CHUNK], ca[NUT_CHUNK], w[NUT_CHUNK];
+  double psi[NUT_NEPOCH][NUT_CHUNK], eps[NUT_NEPOCH][NUT_CHUNK];
+  double dpsi, deps;
+  nut2000_soa_init();
+  if (nut_model == SEMOD_NUT_IAU_2000B)
+    inls = NLS_2000B;
+  else
+    inls = NLS;
+  for (e0 = 0; e0 < nb; e0 += NUT_NEPOCH) {
+    ne = nb - e0;
+    if (ne > NUT_NEPOCH)
+      ne = NUT_NEPOCH;
+    for (e = 0; e < ne; e++) {
+      T[e] = (J[e0 + e] - J2000) / 36525.0;
+      nut2000_fundargs(T[e], nut_model, fa[e]);
+      for (l = 0; l < NUT_CHUNK; l++) {
+	psi[e][l] = 0;
+	eps[e][l] = 0;
+      }
+    }
+    /* luni-solar nutation series, in reverse order, starting with small terms */
+    for (i = ((inls - 1) / NUT_CHUNK) * NUT_CHUNK; i >= 0; i -= NUT_CHUNK) {
+      /* the 2000B series ends inside a chunk */
+      for (l = 0; l < NUT_CHUNK; l++)
+	w[l] = (i + l < inls) ? 1.0 : 0.0;
+      for (e = 0; e < ne; e++) {
+	for (l = 0; l < NUT_CHUNK; l++)
+	  arg[l] = nsoa.nls[0][i + l] * fa[e][0];
+	for (j = 1; j < 5; j++)
+	  for (l = 0; l < NUT_CHUNK; l++)
+	    arg[l] += nsoa.nls[j][i + l] * fa[e][j];
+	sincos_chunk(arg, sa, ca);
+	for (l = 0; l < NUT_CHUNK; l++) {
+	  sa[l] *= w[l];
+	  ca[l] *= w[l];
+	  psi[e][l] += (nsoa.cls[0][i + l] + nsoa.cls[1][i + l] * T[e]) * sa[l] + nsoa.cls[2][i + l] * ca[l];
+	  eps[e][l] += (nsoa.cls[3][i + l] + nsoa.cls[4][i + l] * T[e]) * ca[l] + nsoa.cls[5][i + l] * sa[l];
+	}
+      }
+    }
+    for (e = 0; e < ne; e++) {
+      dpsi = 0;
+      deps = 0;
+      for (l = NUT_CHUNK - 1; l >= 0; l--) {
+	dpsi += psi[e][l];
+	deps += eps[e][l];
+	psi[e][l] = 0;
+	eps[e][l] = 0;
+      }
+      nutlo[2 * (e0 + e)] = dpsi * O1MAS2DEG;
+      nutlo[2 * (e0 + e) + 1] = deps * O1MAS2DEG;
+    }
+    if (nut_model == SEMOD_NUT_IAU_2000A) {
+      /* planetary nutation series (in reverse order), padded with zero terms */
+      for (i = NPL_PAD - NUT_CHUNK; i >= 0; i -= NUT_CHUNK) {
+	for (e = 0; e < ne; e++) {
+	  for (l = 0; l < NUT_CHUNK; l++)
+	    arg[l] = nsoa.npl[0][i + l] * fa[e][5];
+	  for (j = 1; j < 14; j++)
+	    for (l = 0; l < NUT_CHUNK; l++)
+	      arg[l] += nsoa.npl[j][i + l] * fa[e][5 + j];
+	  sincos_chunk(arg, sa, ca);
+	  for (l = 0; l < NUT_CHUNK; l++) {
+	    psi[e][l] += nsoa.icpl[0][i + l] * sa[l] + nsoa.icpl[1][i + l] * ca[l];
+	    eps[e][l] += nsoa.icpl[2][i + l] * sa[l] + nsoa.icpl[3][i + l] * ca[l];
+	  }
+	}
+      }
+      for (e = 0; e < ne; e++) {
+	dpsi = 0;
+	deps = 0;
+	for (l = NUT_CHUNK - 1; l >= 0; l--) {
+	  dpsi += psi[e][l];
+	  deps += eps[e][l];
+	}
+	nutlo[2 * (e0 + e)] += dpsi * O1MAS2DEG;
+	nutlo[2 * (e0 + e) + 1] += deps * O1MAS2DEG;
+	nut2000_p03(T[e], fa[e], nutlo + 2 * (e0 + e));
+      }
+    }
+    for (e = 0; e < ne; e++) {
+      nutlo[2 * (e0 + e)] *= DEGTORAD;
+      nutlo[2 * (e0 + e) + 1] *= DEGTORAD;
+    }
+  }
+}
+
+/* IAU 2000 nutation precomputed by swi_nutation_prefetch() */
+static TLS struct nut_cache {
+  int n;
+  int nut_model;
+  double *J;		/* sorted dates */
+  double *nutlo;	/* dpsi, deps per date */
+} nut_cache;
+
+static int nut_dcmp(const void *a, const void *b)
+{
+  double d = *(const double *) a - *(const double *) b;
+  return (d > 0) - (d < 0);
+}
+
+/* Precompute IAU 2000 nutation for the dates tjd[0..n-1] and the dates
+ * used for speeds (tjd - NUT_SPEED_INTV), evaluating NUT_NEPOCH dates per
+ * pass over the series. Later calls of calc_nutation() for these dates
+ * and the current nutation model are answered from memory. Previous
+ * dates are discarded; n = 0 only frees them.
+ */
+int swi_nutation_prefetch(const double *tjd, int n)
+{
+  int i, m;
+  int nut_model = swed.astro_models[SE_MODEL_NUT];
+  if (nut_model == 0) nut_model = SEMOD_NUT_DEFAULT;
+  if (nut_cache.J != NULL)
+    free(nut_cache.J);
+  if (nut_cache.nutlo != NULL)
+    free(nut_cache.nutlo);
+  memset((void *) &nut_cache, 0, sizeof(struct nut_cache));
+  if (n <= 0 || (nut_model != SEMOD_NUT_IAU_2000A && nut_model != SEMOD_NUT_IAU_2000B))
+    return OK;
+  nut_cache.J = (double *) malloc(2 * n * sizeof(double));
+  nut_cache.nutlo = (double *) malloc(4 * n * sizeof(double));
+  if (nut_cache.J == NULL || nut_cache.nutlo == NULL) {
+    swi_nutation_prefetch(NULL, 0);
+    return ERR;
+  }
+  for (i = 0; i < n; i++) {
+    nut_cache.J[2 * i] = tjd[i];
+    nut_cache.J[2 * i + 1] = tjd[i] - NUT_SPEED_INTV;
+  }
+  qsort(nut_cache.J, 2 * n, sizeof(double), nut_dcmp);
+  for (i = 1, m = 1; i < 2 * n; i++)
+    if (nut_cache.J[i] != nut_cache.J[m - 1])
+      nut_cache.J[m++] = nut_cache.J[i];
+  nut2000_batch(nut_cache.J, m, nut_model, nut_cache.nutlo);
+  nut_cache.n = m;
+  nut_cache.nut_model = nut_model;
+  return OK;
+}
+
+static AS_BOOL nut_cache_lookup(double J, int nut_model, double *nutlo)
+{
+  int lo = 0, hi = nut_cache.n - 1, mid;
+  if (nut_cache.n == 0 || nut_model != nut_cache.nut_model)
+    return FALSE;
+  while (lo <= hi) {
+    mid = (lo + hi) / 2;
+    if (nut_cache.J[mid] < J) {
+      lo = mid + 1;
+    } else if (nut_cache.J[mid] > J) {
+      hi = mid - 1;
+    } else {
+      nutlo[0] = nut_cache.nutlo[2 * mid];
+      nutlo[1] = nut_cache.nutlo[2 * mid + 1];
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static int calc_nutation_iau2000ab(double J, double *nutlo) 
+{
+  int nut_model = swed.astro_models[SE_MODEL_NUT];
+  if (nut_model == 0) nut_model = SEMOD_NUT_DEFAULT;
+  if (!nut_cache_lookup(J, nut_model, nutlo))
+    nut2000_batch(&J, 1, nut_model, nutlo);
+  return 0;
+}
+
+/* IAU 2000 nutation on a uniform time grid (swe_set_uniform_grid()).
+ * Successive grid dates form a series; for each series, sin and cos of
+ * the term arguments are advanced from the previous date by a rotation
+ * through the increment of the argument, instead of being computed
+ * afresh. The increments are taken at the anchor date, where everything
+ * is computed afresh; re-anchoring every NUT_GRID_ANCHOR steps bounds
+ * the drift from rounding and from the quadratic terms of the
+ * fundamental arguments (well below 1 microarcsecond).
+ */
+#define NUT_GRID_SLOTS	4	/* series, e.g. nut and nutv of swe_calc() */
+#define NUT_GRID_ANCHOR	32
+#define NUT_GRID_EPS	1e-7	/* tolerance of grid dates, days */
+static TLS struct nut_grid {
+  double tprev;		/* last date of the series */
+  int nut_model;
+  int nterms;
+  int nsteps;		/* steps since anchor */
+  int32 used;		/* for replacing the least recently used series */
+  double *sc;		/* per term: sin, cos, sin and cos of increment */
+} nut_grid[NUT_GRID_SLOTS];
+static TLS int32 nut_grid_clock;
+
+static void nut_grid_free(void)
+{
+  int i;
+  for (i = 0; i < NUT_GRID_SLOTS; i++) {
+    if (nut_grid[i].sc != NULL)
+      free(nut_grid[i].sc);
+    memset((void *) &nut_grid[i], 0, sizeof(struct nut_grid));
+  }
+}
+
+static int calc_nutation_iau2000ab_grid(double J, double *nutlo) 
+{
+  int i, k, inls, nterms;
+  double fa[19], fa2[19];
+  double darg, sinarg, cosarg, dpsi, deps, s, c, *sc;
+  double T = (J - J2000 ) / 36525.0;
+  double T2 = (J + swed.grid_step - J2000) / 36525.0;
+  struct nut_grid *g = NULL, *gi;
+  int nut_model = swed.astro_models[SE_MODEL_NUT];
+  if (nut_model == 0) nut_model = SEMOD_NUT_DEFAULT;
   if (nut_model == SEMOD_NUT_IAU_2000B)
     inls = NLS_2000B;
   else
     inls = NLS;
+  nterms = inls;
+  if (nut_model == SEMOD_NUT_IAU_2000A)
+    nterms += NPL;
+  /* find the series continued by J, or replace the oldest one */
+  for (i = 0; i < NUT_GRID_SLOTS; i++) {
+    gi = &nut_grid[i];
+    if (gi->sc != NULL && gi->nut_model == nut_model
+	&& fabs(J - gi->tprev - swed.grid_step) < NUT_GRID_EPS
+	&& gi->nsteps < NUT_GRID_ANCHOR) {
+      g = gi;
+      break;
+    }
+    if (g == NULL || gi->used < g->used)
+      g = gi;
+  }
+  nut2000_fundargs(T, nut_model, fa);
+  if (i < NUT_GRID_SLOTS) {
+    /* advance */
+    for (k = 0, sc = g->sc; k < nterms; k++, sc += 4) {
+      s = sc[0] * sc[3] + sc[1] * sc[2];
+      c = sc[1] * sc[3] - sc[0] * sc[2];
+      sc[0] = s;
+      sc[1] = c;
+    }
+    g->nsteps++;
+  } else {
+    /* anchor */
+    if (g->sc == NULL || g->nterms < nterms) {
+      if (g->sc != NULL)
+	free(g->sc);
+      if ((g->sc = (double *) malloc(4 * nterms * sizeof(double))) == NULL) {
+	memset((void *) g, 0, sizeof(struct nut_grid));
+	return calc_nutation_iau2000ab(J, nutlo);
+      }
+    }
+    nut2000_fundargs(T2, nut_model, fa2);
+    for (k = 0, sc = g->sc; k < nterms; k++, sc += 4) {
+      if (k < inls) {
+	darg = nut2000_arg_ls(fa, k);
+	s = nut2000_arg_ls(fa2, k) - darg;
+      } else {
+	darg = nut2000_arg_pl(fa, k - inls);
+	s = nut2000_arg_pl(fa2, k - inls) - darg;
+      }
+      sc[0] = sin(darg);
+      sc[1] = cos(darg);
+      sc[2] = sin(s);
+      sc[3] = cos(s);
+    }
+    g->nut_model = nut_model;
+    g->nterms = nterms;
+    g->nsteps = 0;
+  }
+  g->tprev = J;
+  g->used = ++nut_grid_clock;
+  /* luni-solar nutation series, in reverse order, starting with small terms */
+  dpsi = 0;
+  deps = 0;
   for (i = inls - 1; i >= 0; i--) {
-    j = i * 5;
-    darg = swe_radnorm((double) nls[j + 0] * M  +
-		       (double) nls[j + 1] * SM +
-		       (double) nls[j + 2] * F   +
-		       (double) nls[j + 3] * D   +
-		       (double) nls[j + 4] * OM);
-    sinarg = sin(darg);
-    cosarg = cos(darg);
+    sinarg = g->sc[4 * i];
+    cosarg = g->sc[4 * i + 1];
     k = i * 6;
     dpsi += (cls[k+0] + cls[k+1] * T) * sinarg + cls[k+2] * cosarg;
     deps += (cls[k+3] + cls[k+4] * T) * cosarg + cls[k+5] * sinarg;
@@ -1874,69 +2291,19 @@ static int calc_nutation_iau2000ab(double J, double *nutlo)
   nutlo[0] = dpsi * O1MAS2DEG;
   nutlo[1] = deps * O1MAS2DEG;
   if (nut_model == SEMOD_NUT_IAU_2000A) {
-    /* planetary nutation 
-     * note: The MHB2000 code computes the luni-solar and planetary nutation
-     * in different routines, using slightly different Delaunay
-     * arguments in the two cases.  This behaviour is faithfully
-     * reproduced here.  Use of the Simon et al. expressions for both
-     * cases leads to negligible changes, well below 0.1 microarcsecond.*/
-    /* Mean anomaly of the Moon.*/
-    AL = swe_radnorm(2.35555598 + 8328.6914269554 * T);
-    /* Mean anomaly of the Sun.*/
-    ALSU = swe_radnorm(6.24006013 + 628.301955 * T);
-    /* Mean argument of the latitude of the Moon. */
-    AF = swe_radnorm(1.627905234 + 8433.466158131 * T);
-    /* Mean elongation of the Moon from the Sun. */
-    AD = swe_radnorm(5.198466741 + 7771.3771468121 * T);
-    /* Mean longitude of the ascending node of the Moon. */
-    AOM = swe_radnorm(2.18243920 - 33.757045 * T);
-    /* Planetary longitudes, Mercury through Neptune (Souchay et al. 1999). */
-    ALME = swe_radnorm(4.402608842 + 2608.7903141574 * T);
-    ALVE = swe_radnorm(3.176146697 + 1021.3285546211 * T);
-    ALEA = swe_radnorm(1.753470314 +  628.3075849991 * T);
-    ALMA = swe_radnorm(6.203480913 +  334.0612426700 * T);
-    ALJU = swe_radnorm(0.599546497 +   52.9690962641 * T);
-    ALSA = swe_radnorm(0.874016757 +   21.3299104960 * T);
-    ALUR = swe_radnorm(5.481293871 +    7.4781598567 * T);
-    ALNE = swe_radnorm(5.321159000 +    3.8127774000 * T);
-    /* General accumulated precession in longitude. */
-    APA = (0.02438175 + 0.00000538691 * T) * T;
     /* planetary nutation series (in reverse order).*/
     dpsi = 0;
     deps = 0;
     for (i = NPL - 1; i >= 0; i--) {
-      j = i * 14;
-      darg = swe_radnorm((double) npl[j + 0] * AL   +
-	  (double) npl[j + 1] * ALSU +
-	  (double) npl[j + 2] * AF   +
-	  (double) npl[j + 3] * AD   +
-	  (double) npl[j + 4] * AOM  +
-	  (double) npl[j + 5] * ALME +
-	  (double) npl[j + 6] * ALVE +
-	  (double) npl[j + 7] * ALEA +
-	  (double) npl[j + 8] * ALMA +
-	  (double) npl[j + 9] * ALJU +
-	  (double) npl[j +10] * ALSA +
-	  (double) npl[j +11] * ALUR +
-	  (double) npl[j +12] * ALNE +
-	  (double) npl[j +13] * APA);
+      sinarg = g->sc[4 * (inls + i)];
+      cosarg = g->sc[4 * (inls + i) + 1];
       k = i * 4;
-      sinarg = sin(darg);
-      cosarg = cos(darg);
       dpsi += (double) icpl[k+0] * sinarg + (double) icpl[k+1] * cosarg;
       deps += (double) icpl[k+2] * sinarg + (double) icpl[k+3] * cosarg;
     }
     nutlo[0] += dpsi * O1MAS2DEG;
     nutlo[1] += deps * O1MAS2DEG;
-#if 1
-    /* changes required by adoption of P03 precession 
-     * according to Capitaine et al. A & A 412, 366 (2005) = IAU 2006 */
-    dpsi = -8.1 * sin(OM) - 0.6 * sin(2 * F - 2 * D + 2 * OM);
-    dpsi += T * (47.8 * sin(OM) + 3.7 * sin(2 * F - 2 * D + 2 * OM) + 0.6 * sin(2 * F + 2 * OM) - 0.6 * sin(2 * OM)); 
-    deps = T * (-25.6 * cos(OM) - 1.6 * cos(2 * F - 2 * D + 2 * OM));
-    nutlo[0] += dpsi / (3600.0 * 1000000.0);
-    nutlo[1] += deps / (3600.0 * 1000000.0);
-#endif
+    nut2000_p03(T, fa, nutlo);
   }
   nutlo[0] *= DEGTORAD;
   nutlo[1] *= DEGTORAD;
@@ -2001,30 +2368,27 @@ static int calc_nutation_woolard(double J, double *nutlo)
   return OK;
 }
 
-static double bessel(double *v, int n, double t)
+/* Coefficients of the Bessel interpolation of the daily values v[0..n-1]
+ * on the interval v[iy]..v[iy+1], as a polynomial of degree 4 in the
+ * fraction of day p: coef[0] + coef[1] p + ... + coef[4] p^4.
+ * Near the ends of the table, higher differences are omitted.
+ */
+void swi_bessel_coef(double *v, int n, int iy, double *coef)
 {
-  int i, iy, k;
-  double ans, p, B, d[6];
-  if (t <= 0) {
-    ans = v[0]; 
-    goto done;
-  } 
-  if (t >= n - 1) {
-    ans = v[n - 1]; 
-    goto done;
-  }
-  p = floor(t);
-  iy = (int) t;
-  /* Zeroth order estimate is value at start of year */
-  ans = v[iy];
+  int i, k;
+  double d[6];
+  /* Bessel factors of the second, third and fourth differences */
+  static const double B2[5] = {0, -0.25, 0.25, 0, 0};
+  static const double B3[5] = {0, 1.0 / 12, -0.25, 1.0 / 6, 0};
+  static const double B4[5] = {0, 2.0 / 48, -1.0 / 48, -2.0 / 48, 1.0 / 48};
+  coef[0] = v[iy];
+  coef[1] = coef[2] = coef[3] = coef[4] = 0;
   k = iy + 1;
   if (k >= n)
-    goto done;
-  /* The fraction of tabulation interval */
-  p = t - p;
-  ans += p * (v[k] - v[iy]);
+    return;
+  coef[1] = v[k] - v[iy];
   if( (iy - 1 < 0) || (iy + 2 >= n) )
-    goto done; /* can't do second differences */
+    return; /* can't do second differences */
   /* Make table of first differences */
   k = iy - 2;
   for (i = 0; i < 5; i++) {
@@ -2037,38 +2401,39 @@ static double bessel(double *v, int n, double t)
   /* Compute second differences */
   for (i = 0; i < 4; i++ )
     d[i] = d[i+1] - d[i];
-  B = 0.25 * p * (p - 1.0);
-  ans += B * (d[1] + d[2]);
-#if DEMO
-  printf("B %.4lf, ans %.4lf\n", B, ans);
-#endif
-  if (iy + 2 >= n)
-    goto done;
+  for (i = 0; i < 5; i++)
+    coef[i] += B2[i] * (d[1] + d[2]);
   /* Compute third differences */
   for (i = 0; i < 3; i++ )
     d[i] = d[i + 1] - d[i];
-  B = 2.0 * B / 3.0;
-  ans += (p - 0.5) * B * d[1];
-#if DEMO
-  printf("B %.4lf, ans %.4lf\n", B * (p - 0.5), ans);
-#endif
+  for (i = 0; i < 5; i++)
+    coef[i] += B3[i] * d[1];
   if ((iy - 2 < 0) || (iy + 3 > n))
-    goto done;
+    return;
   /* Compute fourth differences */
   for (i = 0; i < 2; i++)
     d[i] = d[i + 1] - d[i];
-  B = 0.125 * B * (p + 1.0) * (p - 2.0);
-  ans += B * (d[0] + d[1]);
-#if DEMO
-  printf("B %.4lf, ans %.4lf\n", B, ans);
-#endif
-done:
-  return ans;
+  for (i = 0; i < 5; i++)
+    coef[i] += B4[i] * (d[0] + d[1]);
+}
+
+/* dpsi (j = 0) or deps (j = 1) from the EOP table, t days after its start */
+static double eop_interpolate(const struct eop_table *eop, int j, double t)
+{
+  int iy;
+  const double *c;
+  if (t <= 0)
+    return eop->coef[0][j][0];
+  iy = (int) t;
+  if (iy >= eop->n - 1)
+    return eop->coef[eop->n - 1][j][0];
+  c = eop->coef[iy][j];
+  t -= iy;
+  return c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * c[4])));
 }
 
 static int calc_nutation(double J, int32 iflag, double *nutlo)
 {
-  int n;
   double dpsi, deps, J2;
   int nut_model = swed.astro_models[SE_MODEL_NUT];
   int jplhora_model = swed.astro_models[SE_MODEL_JPLHORA_MODE];
@@ -2084,12 +2449,11 @@ static int calc_nutation(double J, int32 iflag, double *nutlo)
   if (is_jplhor) {
     calc_nutation_iau1980(J, nutlo);
     if (iflag & SEFLG_JPLHOR) {
-      n = (int) (swed.eop_tjd_end - swed.eop_tjd_beg + 0.000001);
       J2 = J;
       if (J < swed.eop_tjd_beg_horizons)
 	J2 = swed.eop_tjd_beg_horizons;
-      dpsi = bessel(swed.dpsi, n + 1, J2 - swed.eop_tjd_beg);
-      deps = bessel(swed.deps, n + 1, J2 - swed.eop_tjd_beg);
+      dpsi = eop_interpolate(swed.eop, 0, J2 - swed.eop_tjd_beg);
+      deps = eop_interpolate(swed.eop, 1, J2 - swed.eop_tjd_beg);
       nutlo[0] += dpsi / 3600.0 * DEGTORAD;
       nutlo[1] += deps / 3600.0 * DEGTORAD;
 #if 0
@@ -2102,7 +2466,10 @@ static int calc_nutation(double J, int32 iflag, double *nutlo)
   } else if (nut_model == SEMOD_NUT_IAU_1980 || nut_model == SEMOD_NUT_IAU_CORR_1987) {
     calc_nutation_iau1980(J, nutlo);
   } else if (nut_model == SEMOD_NUT_IAU_2000A || nut_model == SEMOD_NUT_IAU_2000B) {
-    calc_nutation_iau2000ab(J, nutlo);
+    if (swed.grid_step != 0)
+      calc_nutation_iau2000ab_grid(J, nutlo);
+    else
+      calc_nutation_iau2000ab(J, nutlo);
     if ((iflag & SEFLG_JPLHOR_APPROX) && jplhora_model == SEMOD_JPLHORA_2) {
       nutlo[0] += -41.7750 / 3600.0 / 1000.0 * DEGTORAD;
       nutlo[1] += -6.8192 / 3600.0 / 1000.0 * DEGTORAD;
@@ -2541,38 +2908,12 @@ static const short dt97[TAB97_SIZ] = {
  * If iflag = -1, then the default tidal acceleration is ussed (i.e.
  * that of DE431).
  */
-#define DEMO 0
-static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
+/* Delta T (days) of the model deltat_model with tidal acceleration tid_acc */
+static double deltat_of_model(double tjd, int deltat_model, double tid_acc)
 {
   double ans = 0;
   double B, Y, Ygreg, dd;
   int iy;
-  int32 retc;
-  int deltat_model = swed.astro_models[SE_MODEL_DELTAT];
-  double tid_acc;
-  int32 denum, denumret;
-  int32 epheflag, otherflag;
-//fprintf(stderr, "dmod=%f, %.f\n", (double) deltat_model, (double) SEMOD_DELTAT_DEFAULT);
-  if (deltat_model == 0) deltat_model = SEMOD_DELTAT_DEFAULT;
-  epheflag = iflag & SEFLG_EPHMASK;
-  otherflag = iflag & ~SEFLG_EPHMASK;
-  /* with iflag == -1, we use default tid_acc */
-  if (iflag == -1) {
-    retc = swi_get_tid_acc(tjd, 0, 9999, &denumret, &tid_acc, serr); /* for default tid_acc */
-  /* otherwise we use tid_acc consistent with epheflag */
-  } else {
-    denum = swed.jpldenum;
-    if (epheflag & SEFLG_SWIEPH) denum = swed.fidat[SEI_FILE_MOON].sweph_denum;
-    if (swi_init_swed_if_start() == 1 && !(epheflag & SEFLG_MOSEPH)) {
-      if (serr != NULL) 
-	strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_deltat_ex()");
-      retc = swi_set_tid_acc(tjd, epheflag, denum, NULL);  /* _set_ saves tid_acc in swed */
-    } else {
-      retc = swi_set_tid_acc(tjd, epheflag, denum, serr);  /* _set_ saves tid_acc in swed */
-    }
-    tid_acc = swed.tid_acc;
-  }
-  iflag = otherflag | retc;
   Y = 2000.0 + (tjd - J2000)/365.25;
   Ygreg = 2000.0 + (tjd - J2000)/365.2425;
   /* Model for epochs before 1955, currently default in Swiss Ephemeris:
@@ -2587,11 +2928,11 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * (or Astronomical Almanac K8-K9).
    */
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_ETC_2016 && tjd < 2435108.5) { // tjd < 2432521.453645833) {
-    *deltat = deltat_stephenson_etc_2016(tjd, tid_acc);
+    ans = deltat_stephenson_etc_2016(tjd, tid_acc);
     if (tjd >= 2434108.5) {
-      *deltat += (1.0 - (2435108.5 - tjd) / 1000.0) * 0.6610218 / 86400.0;
+      ans += (1.0 - (2435108.5 - tjd) / 1000.0) * 0.6610218 / 86400.0;
     }
-    return iflag;
+    return ans;
   }
   /* Model used SE 1.77 - 2.05.01, for epochs before 1633:
    * Polynomials by Espenak & Meeus 2006, 
@@ -2601,8 +2942,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * epochs, we use the data provided by Astronomical Almanac K8-K9.)
    */
   if (deltat_model == SEMOD_DELTAT_ESPENAK_MEEUS_2006 && tjd < 2317746.13090277789) {
-    *deltat = deltat_espenak_meeus_1620(tjd, tid_acc);
-    return iflag;
+    ans = deltat_espenak_meeus_1620(tjd, tid_acc);
+    return ans;
   }
   /* delta t model used in SE 1.72 - 1.76:
    * Stephenson & Morrison 2004;
@@ -2610,8 +2951,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_MORRISON_2004 && Y < TABSTART) {
     // before 1600: 
     if (Y < TAB2_END) {
-      *deltat = deltat_stephenson_morrison_2004_1600(tjd, tid_acc);
-      return iflag;
+      ans = deltat_stephenson_morrison_2004_1600(tjd, tid_acc);
+      return ans;
     } else {
       /* between 1600 and 1620:
        * linear interpolation between 
@@ -2622,8 +2963,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
 	dd = (Y - TAB2_END) / B;
 	ans = dt2[iy] + dd * (dt[0] - dt2[iy]);
 	ans = adjust_for_tidacc(ans, Ygreg, tid_acc, SE_TIDAL_26, FALSE);
-	*deltat = ans / 86400.0;
-	return iflag;
+	ans = ans / 86400.0;
+	return ans;
       }
     }
   }
@@ -2633,8 +2974,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_1997 && Y < TABSTART) {
     // before 1600: 
     if (Y < TAB97_END) {
-      *deltat = deltat_stephenson_morrison_1997_1600(tjd, tid_acc);
-      return iflag;
+      ans = deltat_stephenson_morrison_1997_1600(tjd, tid_acc);
+      return ans;
     } else {
       /* between 1600 and 1620:
        * linear interpolation between 
@@ -2645,8 +2986,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
 	dd = (Y - TAB97_END) / B;
 	ans = dt97[iy] + dd * (dt[0] - dt97[iy]);
 	ans = adjust_for_tidacc(ans, Ygreg, tid_acc, SE_TIDAL_26, FALSE);
-	*deltat = ans / 86400.0;
-	return iflag;
+	ans = ans / 86400.0;
+	return ans;
       }
     }
   }
@@ -2664,8 +3005,8 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
       B = 0.01 * (Y - 2000.0)  +  3.75;
       ans = 35.0 * B * B  +  40.;
     }
-    *deltat = ans / 86400.0;
-    return iflag;
+    ans = ans / 86400.0;
+    return ans;
   }
   /* 1620 - today + a few years (tabend):
    * Tabulated values of deltaT from Astronomical Almanac 
@@ -2673,9 +3014,156 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * (http://maia.usno.navy.mil/ser7/deltat.data).
    */
   if (Y >= TABSTART) {
-    *deltat = deltat_aa(tjd, tid_acc);
-    return iflag;
+    ans = deltat_aa(tjd, tid_acc);
+    return ans;
+  }
+  return ans / 86400.0;
+}
+
+/* Delta T table.
+ * Delta T is a smooth function of the date, but each evaluation goes
+ * through the model dispatch, tables with Bessel interpolation and the
+ * tidal acceleration adjustment. deltat_lookup() interpolates instead in
+ * a table of the model at nodes DT_STEP days apart, cubically from the
+ * four nearest nodes. The table is built in blocks of DT_BLOCK intervals
+ * on demand, per model and tidal acceleration, and a few blocks are kept.
+ * A block is built only when DT_BLOCK dates have been requested in it,
+ * so that a few isolated dates never pay for a block.
+ * An interval where the interpolation at one of its quarter points
+ * (u = 0.25, 0.5, 0.75) is off by more than DT_TOL (a jump or kink of the
+ * model, e.g. where models switch) is marked and computed directly.
+ */
+#define DT_STEP		4.0
+#define DT_BLOCK	256
+#define DT_NBLOCKS	16
+#define DT_TOL		1e-12	/* days, ~0.1 microseconds */
+static TLS struct deltat_block {
+  int deltat_model;
+  double tid_acc;
+  double tjd0;		/* start of block */
+  int32 used;
+  int32 nreq;		/* dates requested; built at DT_BLOCK */
+  double *v;		/* DT_BLOCK + 3 values, from tjd0 - DT_STEP */
+  unsigned char *direct;	/* per interval: compute directly */
+} dtb[DT_NBLOCKS];
+static TLS int32 dtb_clock;
+
+void swi_deltat_table_free(void)
+{
+  int i;
+  for (i = 0; i < DT_NBLOCKS; i++) {
+    if (dtb[i].v != NULL)
+      free(dtb[i].v);
+    if (dtb[i].direct != NULL)
+      free(dtb[i].direct);
+    memset((void *) &dtb[i], 0, sizeof(struct deltat_block));
   }
+}
+
+static double deltat_cubic(const double *v, double u)
+{
+  return v[0] * (-u * (u - 1) * (u - 2) / 6)
+    + v[1] * ((u + 1) * (u - 1) * (u - 2) / 2)
+    + v[2] * (-(u + 1) * u * (u - 2) / 2)
+    + v[3] * ((u + 1) * u * (u - 1) / 6);
+}
+
+static double deltat_lookup(double tjd, int deltat_model, double tid_acc)
+{
+  int i, k;
+  double tjd0, x, u;
+  struct deltat_block *b = NULL;
+  if (!(tjd > -1e8 && tjd < 1e8))	/* far out of any block, or NaN */
+    return deltat_of_model(tjd, deltat_model, tid_acc);
+  /* the table of deltat_aa() may be extended from a file on first use */
+  if (!swed.init_dt_done) {
+    swi_deltat_table_free();
+    init_dt();
+  }
+  tjd0 = floor(tjd / (DT_STEP * DT_BLOCK)) * (DT_STEP * DT_BLOCK);
+  for (i = 0; i < DT_NBLOCKS; i++) {
+    if (dtb[i].used != 0 && dtb[i].tjd0 == tjd0 && dtb[i].tid_acc == tid_acc
+	&& dtb[i].deltat_model == deltat_model) {
+      b = &dtb[i];
+      break;
+    }
+  }
+  if (b == NULL) {
+    /* replace the least recently used block */
+    b = &dtb[0];
+    for (i = 1; i < DT_NBLOCKS; i++) {
+      if (dtb[i].used < b->used)
+	b = &dtb[i];
+    }
+    b->tjd0 = tjd0;
+    b->tid_acc = tid_acc;
+    b->deltat_model = deltat_model;
+    b->nreq = 0;
+  }
+  b->used = ++dtb_clock;
+  if (b->nreq < DT_BLOCK) {
+    if (++b->nreq < DT_BLOCK)
+      return deltat_of_model(tjd, deltat_model, tid_acc);
+    /* build the block */
+    if (b->v == NULL) {
+      b->v = (double *) malloc((DT_BLOCK + 3) * sizeof(double));
+      b->direct = (unsigned char *) malloc(DT_BLOCK);
+      if (b->v == NULL || b->direct == NULL) {
+	swi_deltat_table_free();
+	return deltat_of_model(tjd, deltat_model, tid_acc);
+      }
+    }
+    for (k = 0; k < DT_BLOCK + 3; k++)
+      b->v[k] = deltat_of_model(tjd0 + (k - 1) * DT_STEP, deltat_model, tid_acc);
+    for (k = 0; k < DT_BLOCK; k++) {
+      b->direct[k] = 0;
+      for (u = 0.25; u < 1 && !b->direct[k]; u += 0.25) {
+	x = tjd0 + (k + u) * DT_STEP;
+	b->direct[k] = fabs(deltat_cubic(b->v + k, u)
+			    - deltat_of_model(x, deltat_model, tid_acc)) > DT_TOL;
+      }
+    }
+  }
+  x = (tjd - tjd0) / DT_STEP;
+  k = (int) x;
+  if (k >= DT_BLOCK)	/* rounding */
+    k = DT_BLOCK - 1;
+  u = x - k;
+  if (b->direct[k])
+    return deltat_of_model(tjd, deltat_model, tid_acc);
+  return deltat_cubic(b->v + k, u);
+}
+
+#define DEMO 0
+static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
+{
+  int32 retc;
+  int deltat_model = swed.astro_models[SE_MODEL_DELTAT];
+  double tid_acc;
+  int32 denum, denumret;
+  int32 epheflag, otherflag;
+//fprintf(stderr, "dmod=%f, %.f\n", (double) deltat_model, (double) SEMOD_DELTAT_DEFAULT);
+  if (deltat_model == 0) deltat_model = SEMOD_DELTAT_DEFAULT;
+  epheflag = iflag & SEFLG_EPHMASK;
+  otherflag = iflag & ~SEFLG_EPHMASK;
+  /* with iflag == -1, we use default tid_acc */
+  if (iflag == -1) {
+    retc = swi_get_tid_acc(tjd, 0, 9999, &denumret, &tid_acc, serr); /* for default tid_acc */
+  /* otherwise we use tid_acc consistent with epheflag */
+  } else {
+    denum = swed.jpldenum;
+    if (epheflag & SEFLG_SWIEPH) denum = swed.fidat[SEI_FILE_MOON].sweph_denum;
+    if (swi_init_swed_if_start() == 1 && !(epheflag & SEFLG_MOSEPH)) {
+      if (serr != NULL) 
+	strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_deltat_ex()");
+      retc = swi_set_tid_acc(tjd, epheflag, denum, NULL);  /* _set_ saves tid_acc in swed */
+    } else {
+      retc = swi_set_tid_acc(tjd, epheflag, denum, serr);  /* _set_ saves tid_acc in swed */
+    }
+    tid_acc = swed.tid_acc;
+  }
+  iflag = otherflag | retc;
+  *deltat = deltat_lookup(tjd, deltat_model, tid_acc);
 #ifdef TRACE
   swi_open_trace(NULL);
   if (swi_trace_count < TRACE_COUNT_MAX) {
@@ -2689,12 +3177,11 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
       fflush(swi_fp_trace_c);
     }
     if (swi_fp_trace_out != NULL) {
-      fprintf(swi_fp_trace_out, "swe_deltat: %f\t%f\t\n", tjd, ans);
+      fprintf(swi_fp_trace_out, "swe_deltat: %f\t%f\t\n", tjd, *deltat);
       fflush(swi_fp_trace_out);
     }
   }
 #endif
-  *deltat = ans / 86400.0;
   return iflag;
 }
 
@@ -3573,6 +4060,507 @@ void CALL_CONV swe_set_interpolate_nut(AS_BOOL do_interpolate)
   swed.interpol.nut_deps2 = 0;
 }
 
+/* Announce that the following computations are for dates on a uniform
+ * grid with spacing step (days), e.g. a daily time series. Series
+ * expansions then advance sin and cos of their arguments from one date
+ * to the next by recurrences instead of computing them afresh, with
+ * periodic re-anchoring. Dates off the grid are computed as usual.
+ * step = 0 switches this off.
+ */
+void CALL_CONV swe_set_uniform_grid(double step)
+{
+  if (swed.grid_step == step && step != 0)
+    return;
+  swed.grid_step = step;
+  nut_grid_free();
+}
+
+/* Process-wide lock for data shared by all threads (swed is per thread).
+ * Files registered from memory have a lock of their own, because files 
+ * are opened while swi_lock() is held. */
+#if MSDOS
+static SRWLOCK swi_shared_lock = SRWLOCK_INIT;
+static SRWLOCK swi_files_lock = SRWLOCK_INIT;
+void swi_lock(void) { AcquireSRWLockExclusive(&swi_shared_lock); }
+void swi_unlock(void) { ReleaseSRWLockExclusive(&swi_shared_lock); }
+void swi_lock_files(void) { AcquireSRWLockExclusive(&swi_files_lock); }
+void swi_unlock_files(void) { ReleaseSRWLockExclusive(&swi_files_lock); }
+#else
+static pthread_mutex_t swi_shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t swi_files_lock = PTHREAD_MUTEX_INITIALIZER;
+void swi_lock(void) { pthread_mutex_lock(&swi_shared_lock); }
+void swi_unlock(void) { pthread_mutex_unlock(&swi_shared_lock); }
+void swi_lock_files(void) { pthread_mutex_lock(&swi_files_lock); }
+void swi_unlock_files(void) { pthread_mutex_unlock(&swi_files_lock); }
+#endif
+
+/* Reads n bytes at position pos of the file fp without using or moving 
+ * the file offset, which a process shares with its children after fork().
+ * Streams without a file descriptor (files from memory) are read with 
+ * fseek(). Returns the number of bytes read. */
+size_t swi_pread(FILE *fp, void *buf, size_t n, long long pos)
+{
+#if MSDOS
+  if (_fseeki64(fp, pos, SEEK_SET) != 0)
+    return 0;
+#else
+  int fd = fileno(fp);
+  size_t nrd = 0;
+  ssize_t k;
+  if (fd >= 0) {
+    while (nrd < n) {
+      k = pread(fd, (char *) buf + nrd, n - nrd, (off_t) pos + (off_t) nrd);
+      if (k < 0 && errno == EINTR)
+	continue;
+      if (k <= 0)
+	break;
+      nrd += (size_t) k;
+    }
+    return nrd;
+  }
+  if (fseeko(fp, (off_t) pos, SEEK_SET) != 0)
+    return 0;
+#endif
+  return fread(buf, 1, n, fp);
+}
+
+/* fork() handlers. The shared locks are taken before the fork, so that
+ * the child does not inherit them locked by a thread that does not exist
+ * there. In the child, only the forking thread remains, and its open
+ * ephemeris files stay open with their constants and decoded segments:
+ * segments and JPL records are read with swi_pread() or from the mapped
+ * file, which do not depend on the file offset. The fixed stars file is
+ * read sequentially with fgets(); it gets a file description of its own,
+ * so that parent and child do not move each other's offset. */
+#if !MSDOS
+static pthread_once_t swi_atfork_once = PTHREAD_ONCE_INIT;
+
+static void atfork_prepare(void)
+{
+  swi_lock();
+  swi_lock_files();
+}
+
+static void atfork_parent(void)
+{
+  swi_unlock_files();
+  swi_unlock();
+}
+
+static void atfork_child(void)
+{
+  int fd;
+  swi_unlock_files();
+  swi_unlock();
+  if (swed.fixfp != NULL && fileno(swed.fixfp) >= 0
+      && (fd = open(swed.fidat[SEI_FILE_FIXSTAR].fnam, O_RDONLY)) >= 0) {
+    dup2(fd, fileno(swed.fixfp));
+    close(fd);
+    rewind(swed.fixfp);
+  }
+}
+
+static void atfork_register(void)
+{
+  pthread_atfork(atfork_prepare, atfork_parent, atfork_child);
+}
+#endif
+
+void swi_atfork_init(void)
+{
+#if !MSDOS
+  pthread_once(&swi_atfork_once, atfork_register);
+#endif
+}
+
+/* Ephemeris settings of a thread: path, JPL file, tidal acceleration,
+ * Delta T, astronomical models, topocentric and sidereal settings.
+ * Workers of swi_run_threads() start with the settings of the calling
+ * thread, since swed is per thread; swe_save_settings() keeps them for
+ * later computations in the same thread.
+ */
+struct thread_settings {
+  AS_BOOL ephe_path_is_set;
+  char ephepath[AS_MAXCH];
+  char jplfnam[AS_MAXCH];
+  double tid_acc;
+  AS_BOOL is_tid_acc_manual;
+  AS_BOOL delta_t_userdef_is_set;
+  double delta_t_userdef;
+  int32 astro_models[SEI_NMODELS];
+  AS_BOOL geopos_is_set, ayana_is_set;
+  struct topo_data topd;
+  struct sid_data sidd;
+  AS_BOOL do_interpolate_nut;
+  double lapse_rate;
+};
+
+/* copies the settings of the calling thread into st */
+static void thread_settings_get(struct thread_settings *st)
+{
+  swi_init_swed_if_start();
+  st->ephe_path_is_set = swed.ephe_path_is_set;
+  strcpy(st->ephepath, swed.ephepath);
+  strcpy(st->jplfnam, swed.jplfnam);
+  st->tid_acc = swed.tid_acc;
+  st->is_tid_acc_manual = swed.is_tid_acc_manual;
+  st->delta_t_userdef_is_set = swed.delta_t_userdef_is_set;
+  st->delta_t_userdef = swed.delta_t_userdef;
+  memcpy(st->astro_models, swed.astro_models, sizeof(swed.astro_models));
+  st->geopos_is_set = swed.geopos_is_set;
+  st->ayana_is_set = swed.ayana_is_set;
+  st->topd = swed.topd;
+  st->sidd = swed.sidd;
+  st->do_interpolate_nut = swed.do_interpolate_nut;
+  st->lapse_rate = swi_get_lapse_rate();
+}
+
+/* makes st the settings of the calling thread. Files are closed only if
+ * the path, JPL file or models differ, and computed positions are 
+ * forgotten if the observer or sidereal mode differ.
+ */
+static void thread_settings_set(const struct thread_settings *st)
+{
+  swi_init_swed_if_start();
+  if (st->ephe_path_is_set != swed.ephe_path_is_set
+    || strcmp(st->ephepath, swed.ephepath) != 0
+    || strcmp(st->jplfnam, swed.jplfnam) != 0
+    || memcmp(st->astro_models, swed.astro_models, sizeof(swed.astro_models)) != 0) {
+    swi_close_keep_topo_etc();
+    swed.ephe_path_is_set = st->ephe_path_is_set;
+    strcpy(swed.ephepath, st->ephepath);
+    strcpy(swed.jplfnam, st->jplfnam);
+    memcpy(swed.astro_models, st->astro_models, sizeof(swed.astro_models));
+  }
+  swed.tid_acc = st->tid_acc;
+  swed.is_tid_acc_manual = st->is_tid_acc_manual;
+  swed.delta_t_userdef_is_set = st->delta_t_userdef_is_set;
+  swed.delta_t_userdef = st->delta_t_userdef;
+  swe_set_interpolate_nut(st->do_interpolate_nut);
+  swe_set_lapse_rate(st->lapse_rate);
+  if (st->geopos_is_set != swed.geopos_is_set
+    || st->ayana_is_set != swed.ayana_is_set
+    || st->topd.geolon != swed.topd.geolon
+    || st->topd.geolat != swed.topd.geolat
+    || st->topd.geoalt != swed.topd.geoalt
+    || st->sidd.sid_mode != swed.sidd.sid_mode
+    || st->sidd.t0 != swed.sidd.t0
+    || st->sidd.ayan_t0 != swed.sidd.ayan_t0
+    || st->sidd.t0_is_UT != swed.sidd.t0_is_UT) {
+    swed.geopos_is_set = st->geopos_is_set;
+    swed.ayana_is_set = st->ayana_is_set;
+    swed.topd = st->topd;
+    swed.sidd = st->sidd;
+    swi_force_app_pos_etc();
+  }
+}
+
+struct thread_job {
+  void (*fn)(void *arg, int k);
+  void (*fn1)(void *arg);	/* instead of fn, from swe_thread_start() */
+  void *arg;
+  int k;
+  struct thread_settings settings;
+};
+
+static void thread_job_run(struct thread_job *job)
+{
+  thread_settings_set(&job->settings);
+  if (job->fn1 != NULL)
+    job->fn1(job->arg);
+  else
+    job->fn(job->arg, job->k);
+  swe_close();
+}
+
+/* copies the settings of the calling thread into job */
+static void thread_job_init(struct thread_job *job)
+{
+  thread_settings_get(&job->settings);
+}
+
+#if MSDOS
+static unsigned __stdcall thread_job_main(void *p)
+{
+  thread_job_run((struct thread_job *) p);
+  return 0;
+}
+#else
+static void *thread_job_main(void *p)
+{
+  thread_job_run((struct thread_job *) p);
+  return NULL;
+}
+#endif
+
+/* Calls fn(arg, k) for k = 0 .. nthreads - 1 in parallel, k = 0 in the 
+ * calling thread, and returns when all calls are done. If a thread 
+ * cannot be created, its call runs in the calling thread instead. 
+ * Without TLS (HAVE_TLS 0, e.g. macOS and Windows) swed is shared by 
+ * all threads, and all calls run in the calling thread.
+ * fn must not touch data of other calls.
+ */
+void swi_run_threads(int nthreads, void (*fn)(void *arg, int k), void *arg)
+{
+  int k;
+  struct thread_job *jobs;
+  AS_BOOL *started;
+#if MSDOS
+  HANDLE *th;
+#else
+  pthread_t *th;
+#endif
+  if (nthreads <= 1) {
+    fn(arg, 0);
+    return;
+  }
+  if (!HAVE_TLS) {
+    for (k = 0; k < nthreads; k++)
+      fn(arg, k);
+    return;
+  }
+  jobs = (struct thread_job *) calloc(nthreads, sizeof(struct thread_job));
+  started = (AS_BOOL *) calloc(nthreads, sizeof(AS_BOOL));
+  th = calloc(nthreads, sizeof(*th));
+  if (jobs == NULL || started == NULL || th == NULL) {
+    for (k = 0; k < nthreads; k++)
+      fn(arg, k);
+    goto end_run_threads;
+  }
+  for (k = 1; k < nthreads; k++) {
+    struct thread_job *job = &jobs[k];
+    job->fn = fn;
+    job->arg = arg;
+    job->k = k;
+    thread_job_init(job);
+#if MSDOS
+    th[k] = (HANDLE) _beginthreadex(NULL, 0, thread_job_main, job, 0, NULL);
+    started[k] = (th[k] != 0);
+#else
+    started[k] = (pthread_create(&th[k], NULL, thread_job_main, job) == 0);
+#endif
+  }
+  fn(arg, 0);
+  for (k = 1; k < nthreads; k++) {
+    if (!started[k]) {
+      fn(arg, k);
+      continue;
+    }
+#if MSDOS
+    WaitForSingleObject(th[k], INFINITE);
+    CloseHandle(th[k]);
+#else
+    pthread_join(th[k], NULL);
+#endif
+  }
+end_run_threads:
+  free(jobs);
+  free(started);
+  free(th);
+}
+
+/* A thread of its own for fn(arg), e.g. to compute ahead while the caller
+ * is busy with other things, which starts with the ephemeris settings of
+ * the calling thread like the workers of swi_run_threads(). Returns NULL
+ * if the thread cannot be created, or without TLS (HAVE_TLS 0), where it
+ * would share swed with the caller. swe_thread_join() waits for fn to 
+ * return and releases the handle.
+ */
+struct swe_thread {
+  struct thread_job job;
+#if MSDOS
+  HANDLE th;
+#else
+  pthread_t th;
+#endif
+};
+
+void *CALL_CONV swe_thread_start(void (*fn)(void *arg), void *arg)
+{
+  struct swe_thread *tp;
+  if (!HAVE_TLS)
+    return NULL;
+  tp = (struct swe_thread *) calloc(1, sizeof(struct swe_thread));
+  if (tp == NULL)
+    return NULL;
+  tp->job.fn1 = fn;
+  tp->job.arg = arg;
+  thread_job_init(&tp->job);
+#if MSDOS
+  tp->th = (HANDLE) _beginthreadex(NULL, 0, thread_job_main, &tp->job, 0, NULL);
+  if (tp->th == 0) {
+#else
+  if (pthread_create(&tp->th, NULL, thread_job_main, &tp->job) != 0) {
+#endif
+    free(tp);
+    return NULL;
+  }
+  return (void *) tp;
+}
+
+void CALL_CONV swe_thread_join(void *thread)
+{
+  struct swe_thread *tp = (struct swe_thread *) thread;
+  if (tp == NULL)
+    return;
+#if MSDOS
+  WaitForSingleObject(tp->th, INFINITE);
+  CloseHandle(tp->th);
+#else
+  pthread_join(tp->th, NULL);
+#endif
+  free(tp);
+}
+
+/* The ephemeris settings of the calling thread, to compute later with the
+ * settings in effect now: swe_restore_settings() makes them current again,
+ * swe_free_settings() releases them. Returns NULL if out of memory.
+ */
+void *CALL_CONV swe_save_settings(void)
+{
+  struct thread_settings *st;
+  st = (struct thread_settings *) calloc(1, sizeof(struct thread_settings));
+  if (st != NULL)
+    thread_settings_get(st);
+  return (void *) st;
+}
+
+void CALL_CONV swe_restore_settings(const void *settings)
+{
+  if (settings != NULL)
+    thread_settings_set((const struct thread_settings *) settings);
+}
+
+void CALL_CONV swe_free_settings(void *settings)
+{
+  free(settings);
+}
+
+/* Memory for tables that are filled once and then only read, possibly by
+ * many threads: whole pages mapped from the system, which swi_ro_seal()
+ * makes read-only, so that the table stays shared after a fork() and a
+ * stray write faults instead of corrupting it.
+ */
+void *swi_ro_alloc(size_t size)
+{
+#if MSDOS
+  return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+  void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  return p == MAP_FAILED ? NULL : p;
+#endif
+}
+
+void swi_ro_seal(void *p, size_t size)
+{
+#if MSDOS
+  DWORD old;
+  VirtualProtect(p, size, PAGE_READONLY, &old);
+#else
+  mprotect(p, size, PROT_READ);
+#endif
+}
+
+void swi_ro_free(void *p, size_t size)
+{
+  if (p == NULL)
+    return;
+#if MSDOS
+  VirtualFree(p, 0, MEM_RELEASE);
+#else
+  munmap(p, size);
+#endif
+}
+
+/* Maps the file fname read-only into memory and returns its address and
+ * length, or NULL if it cannot be opened or mapped. */
+void *swi_map_file(const char *fname, size_t *len)
+{
+  void *addr = NULL;
+#if MSDOS
+  HANDLE fh, mh;
+  LARGE_INTEGER size;
+  fh = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (fh == INVALID_HANDLE_VALUE)
+    return NULL;
+  if (GetFileSizeEx(fh, &size) && size.QuadPart > 0
+      && (unsigned long long) size.QuadPart <= (unsigned long long) ((size_t) -1)
+      && (mh = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL)) != NULL) {
+    addr = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    *len = (size_t) size.QuadPart;
+    CloseHandle(mh);
+  }
+  CloseHandle(fh);
+#else
+  int fd;
+  struct stat st;
+  if ((fd = open(fname, O_RDONLY)) < 0)
+    return NULL;
+  if (fstat(fd, &st) == 0 && st.st_size > 0
+      && (unsigned long long) st.st_size <= (unsigned long long) ((size_t) -1)) {
+    addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+      addr = NULL;
+    *len = (size_t) st.st_size;
+  }
+  close(fd);
+#endif
+  return addr;
+}
+
+/* Maps the file fname read-write and shared with other processes and
+ * returns its address and length, or NULL. A new or empty file is created
+ * with mode 0600, extended with zeros to minlen bytes and given the first
+ * headlen bytes head. A lock on the file makes this atomic for processes
+ * that map it at the same time. The file is never made smaller, which
+ * would be a bus error for the processes that have it mapped; an existing
+ * file is mapped with its size, which the caller must check. */
+void *swi_map_shared_file(const char *fname, const void *head, size_t headlen, size_t minlen, size_t *len)
+{
+#if MSDOS
+  return NULL;
+#else
+  void *addr = NULL;
+  int fd, rc;
+  struct stat st;
+  struct flock fl;
+  if (headlen > minlen)
+    return NULL;
+  if ((fd = open(fname, O_RDWR | O_CREAT, 0600)) < 0)
+    return NULL;
+  memset((void *) &fl, 0, sizeof(fl));
+  fl.l_type = F_WRLCK;
+  fl.l_whence = SEEK_SET;	/* l_start = l_len = 0: the whole file */
+  while ((rc = fcntl(fd, F_SETLKW, &fl)) < 0 && errno == EINTR)
+    ;
+  if (rc == 0 && fstat(fd, &st) == 0 
+      && (st.st_size > 0 
+	|| (ftruncate(fd, (off_t) minlen) == 0 
+	  && pwrite(fd, head, headlen, 0) == (ssize_t) headlen))
+      && fstat(fd, &st) == 0
+      && (unsigned long long) st.st_size <= (unsigned long long) ((size_t) -1)) {
+    addr = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+      addr = NULL;
+    *len = (size_t) st.st_size;
+  }
+  /* closing the file releases the lock */
+  close(fd);
+  return addr;
+#endif
+}
+
+void swi_unmap_file(void *addr, size_t len)
+{
+  if (addr == NULL)
+    return;
+#if MSDOS
+  UnmapViewOfFile(addr);
+#else
+  munmap(addr, len);
+#endif
+}
+
 /* sidereal time, without eps and nut as parameters.
  * tjd must be UT !!!
  * for more informsation, see comment with swe_sidtime0()
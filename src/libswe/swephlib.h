@@ -127,6 +127,7 @@ extern int swi_trop_ra2sid_lon_sosy(double *xin, double *xout, int32 iflag);
 extern int swi_get_observer(double tjd, int32 iflag, 
 	AS_BOOL do_save, double *xobs, char *serr);
 extern void swi_force_app_pos_etc(void);
+extern void swi_close_keep_topo_etc(void);
 
 /* obliquity of ecliptic */
 extern void swi_check_ecliptic(double tjd, int32 iflag);
@@ -136,6 +137,7 @@ extern void swi_ldp_peps(double J, double *dpre, double *deps);
 /* nutation */
 extern void swi_check_nutation(double tjd, int32 iflag);
 extern int swi_nutation(double J, int32 iflag, double *nutlo);
+extern int swi_nutation_prefetch(const double *tjd, int n);
 extern void swi_nutate(double *xx, int32 iflag, AS_BOOL backward);
 
 extern void swi_mean_lunar_elements(double tjd, 
@@ -174,6 +176,26 @@ extern char *swi_strcpy(char *to, char *from);
 extern char *swi_strncpy(char *to, char *from, size_t n);
 
 extern double swi_deltat_ephe(double tjd_ut, int32 epheflag);
+extern void swi_deltat_table_free(void);
+extern void swi_refr_table_free(void);
+extern double swi_get_lapse_rate(void);
+
+/* data shared by all threads */
+extern void swi_lock(void);
+extern void swi_unlock(void);
+extern void swi_lock_files(void);
+extern void swi_unlock_files(void);
+extern void swi_atfork_init(void);
+extern size_t swi_pread(FILE *fp, void *buf, size_t n, long long pos);
+extern void swi_run_threads(int nthreads, void (*fn)(void *arg, int k), void *arg);
+extern void *swi_ro_alloc(size_t size);
+extern void swi_ro_seal(void *p, size_t size);
+extern void swi_ro_free(void *p, size_t size);
+extern void *swi_map_file(const char *fname, size_t *len);
+extern void *swi_map_shared_file(const char *fname, const void *head, size_t headlen, size_t minlen, size_t *len);
+extern void swi_unmap_file(void *addr, size_t len);
+
+extern void swi_bessel_coef(double *v, int n, int iy, double *coef);
 
 #ifdef TRACE
 #  define TRACE_COUNT_MAX         10000
@@ -16,9 +16,234 @@
 // along with swephR.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <Rcpp.h>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <initializer_list>
+#include <map>
+#include <numeric>
+#include <vector>
 #include <swephexp.h>
 
+// Order in which the rows of a batch are evaluated: grouped by date, so
+// that everything that depends on the epoch only (nutation, the fused
+// bias-precession-nutation matrix, the observer position) is computed
+// once per distinct date and shared by all bodies and stars.
+static std::vector<int> epoch_order(Rcpp::NumericVector jd) {
+  std::vector<int> order(jd.length());
+  std::iota(order.begin(), order.end(), 0);
+  if (!std::is_sorted(jd.begin(), jd.end()))
+    std::stable_sort(order.begin(), order.end(),
+                     [&jd](int a, int b) { return jd[a] < jd[b]; });
+  return order;
+}
+
+// Rows of a batch are computed in blocks of this size. The nutation and,
+// in Moshier mode, the planetary theory for all dates and bodies of a block
+// are evaluated at once beforehand (swe_calc_prefetch()), vectorised over
+// dates.
+static const size_t prefetch_block = 1024;
+
+// Dates of a batch in TT, converted once for the whole batch as
+// swe_calc_ut() converts them (Delta T from the table of the library).
+static std::vector<double> tt_dates(Rcpp::NumericVector jd, int iflag, bool ut) {
+  std::vector<double> tjd(jd.begin(), jd.end());
+  if (ut) {
+    if ((iflag & (SEFLG_JPLEPH | SEFLG_SWIEPH | SEFLG_MOSEPH)) == 0)
+      iflag |= SEFLG_SWIEPH;
+    for (double &t : tjd)
+      t += swe_deltat_ex(t, iflag, NULL);
+  }
+  return tjd;
+}
+
+static void calc_prefetch(const std::vector<double> &tt, Rcpp::IntegerVector ipl, int iflag,
+                          std::vector<int>::const_iterator first,
+                          std::vector<int>::const_iterator last) {
+  // a single row gains nothing from a batch and is computed as on its own
+  if (last - first < 2) {
+    swe_calc_prefetch(NULL, NULL, 0, iflag);
+    return;
+  }
+  std::vector<double> tjd;
+  std::vector<int32> ipl_;
+  for (; first != last; ++first) {
+    tjd.push_back(tt[*first]);
+    ipl_.push_back(ipl[*first]);
+  }
+  swe_calc_prefetch(tjd.data(), ipl_.data(), tjd.size(), iflag);
+}
+
+// If the distinct dates (TT) of a batch are uniformly spaced, return the
+// spacing, so that the series expansions can advance from one date to the
+// next by recurrences (swe_set_uniform_grid()). Otherwise return 0.
+static double uniform_step(const std::vector<double> &tt, const std::vector<int> &order) {
+  std::vector<double> tjd;
+  for (int i : order) {
+    if (tjd.empty() || tt[i] != tjd.back())
+      tjd.push_back(tt[i]);
+  }
+  if (tjd.size() < 3)
+    return 0;
+  double step = tjd[1] - tjd[0];
+  for (size_t i = 2; i < tjd.size(); ++i)
+    if (std::fabs(tjd[i] - tjd[i - 1] - step) > 1e-7)
+      return 0;
+  return step;
+}
+
+// Length of the result of a conversion whose arguments are recycled
+// against each other as in R: the longest argument, or 0 if any is empty.
+static R_xlen_t recycled_length(std::initializer_list<R_xlen_t> len) {
+  R_xlen_t n = 0;
+  for (R_xlen_t l : len) {
+    if (l == 0)
+      return 0;
+    n = std::max(n, l);
+  }
+  return n;
+}
+
+// Seconds since 1970-01-01 00:00 UTC of a POSIXct or Date vector. Both
+// ignore leap seconds, i.e. every day has 86400 seconds.
+static Rcpp::NumericVector posix_seconds(SEXP time) {
+  Rcpp::NumericVector t(time);
+  if (Rf_inherits(time, "Date"))
+    return t * 86400.0;
+  if (!Rf_inherits(time, "POSIXct"))
+    Rcpp::stop("'time' must be a POSIXct or Date vector!");
+  return t;
+}
+
+// Inverse of posix_seconds() for a UTC date as returned by
+// swe_jdet_to_utc() and swe_jdut1_to_utc(). A leap second (sec >= 60)
+// is mapped onto the first second of the next minute.
+static double utc_posix_seconds(int year, int month, int day, int hour, int min, double sec) {
+  double days = swe_julday(year, month, day, 0, SE_GREG_CAL) - 2440587.5;
+  return days * 86400.0 + hour * 3600.0 + min * 60.0 + sec;
+}
+
+static SEXP posix_vector(Rcpp::NumericVector secs, bool date) {
+  if (date) {
+    Rcpp::NumericVector days = Rcpp::floor(secs / 86400.0);
+    days.attr("class") = "Date";
+    return days;
+  }
+  secs.attr("class") = Rcpp::CharacterVector::create("POSIXct", "POSIXt");
+  secs.attr("tzone") = "UTC";
+  return secs;
+}
+
+// Positions of a transformation between equatorial or ecliptical and
+// horizontal coordinates, two coordinates per position: the first two
+// columns of a matrix with one row per position, or the first two
+// elements of a vector for a single position. arg names the argument
+// in error messages.
+static std::vector<double> coordinate_pairs(Rcpp::NumericVector x, const std::string &arg = "xin") {
+  if (!Rf_isMatrix(x)) {
+    if (x.length() < 2)
+      Rcpp::stop("Position '" + arg + "' must have a length of 2 or be a matrix with 2 columns");
+    return std::vector<double>{x[0], x[1]};
+  }
+  Rcpp::NumericMatrix m(x);
+  if (m.ncol() < 2)
+    Rcpp::stop("Position '" + arg + "' must have a length of 2 or be a matrix with 2 columns");
+  std::vector<double> xy(2 * m.nrow());
+  for (int i = 0; i < m.nrow(); ++i) {
+    xy[2 * i] = m(i, 0);
+    xy[2 * i + 1] = m(i, 1);
+  }
+  return xy;
+}
+
+// Geographic positions (longitude, latitude, height): the rows of a
+// matrix with three columns, or the first three elements of a vector.
+static std::vector<double> geographic_positions(Rcpp::NumericVector x) {
+  if (!Rf_isMatrix(x)) {
+    if (x.length() < 3)
+      Rcpp::stop("Geographic position 'geopos' must have a length of 3");
+    return std::vector<double>{x[0], x[1], x[2]};
+  }
+  Rcpp::NumericMatrix m(x);
+  if (m.ncol() < 3)
+    Rcpp::stop("Geographic position 'geopos' must have a length of 3 or be a matrix with 3 columns");
+  std::vector<double> g(3 * m.nrow());
+  for (int i = 0; i < m.nrow(); ++i)
+    for (int j = 0; j < 3; ++j)
+      g[3 * i + j] = m(i, j);
+  return g;
+}
+
+// Positions xy (pairs) recycled against the dates jd_ut, transformed date
+// by date by f(jd_ut, n, xin, xout), which converts n positions of one
+// date (swe_azalt_array(), swe_azalt_rev_array()) with ncol coordinates
+// in the result. Distinct dates follow each other in order, so that the
+// sidereal time advances along a uniform grid.
+template <typename F>
+static Rcpp::NumericMatrix horizontal_batch(Rcpp::NumericVector jd_ut, const std::vector<double> &xy,
+                                            int ncol, F f) {
+  R_xlen_t n = recycled_length({jd_ut.length(), (R_xlen_t) xy.size() / 2});
+  Rcpp::NumericMatrix result(n, ncol);
+  Rcpp::NumericVector jd(n);
+  for (R_xlen_t i = 0; i < n; ++i)
+    jd[i] = jd_ut[i % jd_ut.length()];
+  std::vector<int> order = epoch_order(jd);
+  // swe_sidtime() takes TT with the default Delta T
+  std::vector<double> tt(jd.begin(), jd.end());
+  for (double &t : tt)
+    t += swe_deltat_ex(t, -1, NULL);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  std::vector<double> xin, xout;
+  for (size_t b = 0; b < order.size(); ) {
+    size_t e = b;
+    xin.clear();
+    for (; e < order.size() && jd[order[e]] == jd[order[b]]; ++e) {
+      size_t k = 2 * (order[e] % (xy.size() / 2));
+      xin.push_back(xy[k]);
+      xin.push_back(xy[k + 1]);
+    }
+    xout.resize(ncol * (e - b));
+    f(jd[order[b]], e - b, xin.data(), xout.data());
+    for (size_t r = b; r < e; ++r)
+      for (int j = 0; j < ncol; ++j)
+        result(order[r], j) = xout[ncol * (r - b) + j];
+    b = e;
+  }
+  swe_set_uniform_grid(0);
+  return result;
+}
+
+// Ayanamsa for a vector of dates (UT or ET), in the order of the dates,
+// so that nutation advances along a uniform grid, and with the position of
+// the star of a true-star or galactic ayanamsa interpolated where the
+// dates are dense (swe_ayanamsa_prefetch()).
+static Rcpp::List ayanamsa_batch(Rcpp::NumericVector jd, int iflag, bool ut) {
+  Rcpp::IntegerVector rc_(jd.length());
+  Rcpp::NumericVector daya_(jd.length());
+  Rcpp::CharacterVector serr_(jd.length());
+
+  std::vector<int> order = epoch_order(jd);
+  std::vector<double> tt = tt_dates(jd, iflag, ut);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  swe_ayanamsa_prefetch(tt.data(), tt.size());
+  for (int i : order) {
+    double daya;
+    std::array<char, 256> serr{'\0'};
+    if (ut)
+      rc_(i) = swe_get_ayanamsa_ex_ut(jd[i], iflag, &daya, serr.begin());
+    else
+      rc_(i) = swe_get_ayanamsa_ex(jd[i], iflag, &daya, serr.begin());
+    daya_(i) = daya;
+    serr_(i) = std::string(serr.begin());
+  }
+  swe_ayanamsa_prefetch(NULL, 0);
+  swe_set_uniform_grid(0);
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("daya") = daya_,
+                            Rcpp::Named("serr") = serr_);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //' @title Section 1: The Ephemeris file related functions
 //' @name Section1
@@ -35,14 +260,41 @@
 //'   \item{swe_close()}{At the end of your computations this function releases most
 //'        resources (open files and allocated memory) used by Swiss Ephemeris.}
 //'   \item{swe_set_jpl_file()}{Set name of JPL ephemeris file.}
+//'   \item{swe_prefetch()}{Open the ephemeris files needed for the bodies \code{ipl} between
+//'        \code{jd_start} and \code{jd_end} and decode all their segments in advance, so that
+//'        the first calculations in this range do not wait for the files. With the JPL
+//'        ephemeris, the records of the file for the range are read into memory.
+//'        \code{swe_close()} releases the memory.}
+//'   \item{swe_set_ephe_buffer()}{Register the contents of an ephemeris file (e.g. sepl_18.se1,
+//'        sefstars.txt, seorbel.txt or seleapsec.txt) from a raw vector. The file is then read
+//'        from memory instead of the ephemeris path. Open files are closed first, keeping the
+//'        settings (e.g. of \code{swe_set_topo()} and \code{swe_set_sid_mode()}), so that they are
+//'        read again from the new contents. Position streams with \code{background = TRUE} must
+//'        not be in use while a registered file is replaced or removed.}
+//'   \item{swe_create_ephe_bundle()}{Write the ephemeris files \code{files} into one bundle file
+//'        \code{path}, with a table of contents, keeping each file in its original encoding.}
+//'   \item{swe_set_ephe_bundle()}{Open a bundle written by \code{swe_create_ephe_bundle()}.
+//'        The bundle is mapped into memory once and its files are then read from it instead
+//'        of the ephemeris path, found by name without opening or searching any directory.
+//'        \code{path = NULL} closes all bundles. Open files are closed first, keeping the settings,
+//'        as with \code{swe_set_ephe_buffer()}.}
+//'   \item{swe_set_segment_cache()}{Share the decoded segments of the ephemeris files between
+//'        processes through the cache file \code{path} (e.g. in /dev/shm), which is created with
+//'        room for about \code{bytes} bytes and readable by the user only. An existing file that
+//'        is not such a cache is refused. Worker processes that use the same file decode
+//'        each segment only once. \code{path = NULL} detaches the process. Not available on
+//'        Windows.}
 //'   \item{swe_version()}{The function provides the version number of the Swiss Ephemeris software.}
 //'   \item{swe_get_library_path()}{The function provides the path where the executable resides.}
 //' }
-//' @param path Directory for the sefstars.txt, swe_deltat.txt and jpl files
+//' @param path Directory for the sefstars.txt, swe_deltat.txt and jpl files (for swe_create_ephe_bundle() and swe_set_ephe_bundle() the bundle file, for swe_set_segment_cache() the cache file)
 //' @examples
 //' \dontrun{swe_set_ephe_path("c:\\sweph\\ephe")}
 //' swe_close()
 //' swe_set_jpl_file("de431.eph")
+//' \dontrun{swe_create_ephe_bundle("ephe.seb", list.files("c:\\sweph\\ephe", full.names = TRUE))
+//' swe_set_ephe_bundle("ephe.seb")}
+//' swe_prefetch(2451545, 2451545 + 365, c(SE$SUN, SE$MOON, SE$MARS), SE$FLG_SWIEPH)
 //' swe_version()
 //' swe_get_library_path()
 //' @rdname Section1
@@ -64,7 +316,7 @@ void close() {
 }
 
 
-//' @param fname JPL ephemeris name as string (JPL ephemeris file, e.g. de431.eph)
+//' @param fname Ephemeris file name as string (JPL ephemeris file, e.g. de431.eph, or for swe_set_ephe_buffer() any ephemeris file, e.g. sepl_18.se1)
 //' @rdname Section1
 //' @export
 // [[Rcpp::export(swe_set_jpl_file)]]
@@ -72,6 +324,97 @@ void set_jpl_file(Rcpp::Nullable<Rcpp::CharacterVector> fname) {
     swe_set_jpl_file(fname.as().at(0));
  }
 
+//' @param jd_start Start of the date range (ET) as numeric
+//' @param jd_end End of the date range (ET) as numeric
+//' @param ipl Body numbers as integer vector
+//' @param ephe_flag The ephemeris to use like SE$FLG_SWIEPH or SE$FLG_JPLEPH
+//' @return \code{swe_prefetch} returns a list with named entries: \code{return} status flag as integer,
+//'         \code{bytes} memory used by the decoded segments (or the JPL records paged in) as numeric
+//'         and \code{serr} error message as string.
+//' @rdname Section1
+//' @export
+// [[Rcpp::export(swe_prefetch)]]
+Rcpp::List prefetch(double jd_start, double jd_end, Rcpp::IntegerVector ipl, int ephe_flag) {
+  std::vector<int32> ipl_(ipl.begin(), ipl.end());
+  size_t nbytes = 0;
+  std::array<char, 256> serr{{'\0'}};
+  int rtn = swe_prefetch(jd_start, jd_end, ipl_.data(), ipl_.size(), ephe_flag, &nbytes, serr.begin());
+  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("bytes") = static_cast<double>(nbytes),
+                            Rcpp::Named("serr") = std::string(serr.begin()));
+}
+
+// Raw vectors registered with swe_set_ephe_buffer(). The library reads
+// them in place, so they are kept here until they are replaced or removed;
+// the library closes the files that read them before.
+static std::map<std::string, Rcpp::RawVector> ephe_buffers;
+
+//' @param data File contents as raw vector, e.g. from \code{readBin()}, or NULL to remove the file
+//' @return \code{swe_set_ephe_buffer} returns the status flag as integer
+//' @rdname Section1
+//' @export
+// [[Rcpp::export(swe_set_ephe_buffer)]]
+int set_ephe_buffer(std::string fname, Rcpp::Nullable<Rcpp::RawVector> data) {
+  if (data.isNull()) {
+    int rtn = swe_set_ephe_buffer(fname.c_str(), NULL, 0);
+    ephe_buffers.erase(fname);
+    return rtn;
+  }
+  Rcpp::RawVector buf = data.as();
+  int rtn = swe_set_ephe_buffer(fname.c_str(), buf.begin(), buf.size());
+  if (rtn == OK)
+    ephe_buffers[fname] = buf;
+  return rtn;
+}
+
+//' @param files Ephemeris file names with directory as character vector
+//' @return \code{swe_create_ephe_bundle} and \code{swe_set_ephe_bundle} return a list with named
+//'         entries: \code{return} number of files in the bundle or -1 as integer and \code{serr}
+//'         error message as string.
+//' @rdname Section1
+//' @export
+// [[Rcpp::export(swe_create_ephe_bundle)]]
+Rcpp::List create_ephe_bundle(std::string path, Rcpp::CharacterVector files) {
+  std::vector<std::string> files_(files.begin(), files.end());
+  std::vector<const char *> files_c;
+  for (const std::string &f : files_)
+    files_c.push_back(f.c_str());
+  std::array<char, 256> serr{{'\0'}};
+  int rtn = swe_create_ephe_bundle(path.c_str(), files_c.data(), files_c.size(), serr.begin());
+  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("serr") = std::string(serr.begin()));
+}
+
+//' @rdname Section1
+//' @export
+// [[Rcpp::export(swe_set_ephe_bundle)]]
+Rcpp::List set_ephe_bundle(Rcpp::Nullable<Rcpp::CharacterVector> path) {
+  std::array<char, 256> serr{{'\0'}};
+  int rtn;
+  if (path.isNotNull()) {
+    rtn = swe_set_ephe_bundle(path.as().at(0), serr.begin());
+  } else {
+    rtn = swe_set_ephe_bundle(NULL, serr.begin());
+  }
+  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("serr") = std::string(serr.begin()));
+}
+
+//' @param bytes Size of a new cache file in bytes as numeric
+//' @return \code{swe_set_segment_cache} returns a list with named entries: \code{return} number
+//'         of segments the cache can hold or -1 (0 when detaching) as integer and \code{serr} error
+//'         message as string.
+//' @rdname Section1
+//' @export
+// [[Rcpp::export(swe_set_segment_cache)]]
+Rcpp::List set_segment_cache(Rcpp::Nullable<Rcpp::CharacterVector> path, double bytes) {
+  std::array<char, 256> serr{{'\0'}};
+  int rtn;
+  if (path.isNotNull()) {
+    rtn = swe_set_segment_cache(path.as().at(0), static_cast<size_t>(bytes), serr.begin());
+  } else {
+    rtn = swe_set_segment_cache(NULL, 0, serr.begin());
+  }
+  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("serr") = std::string(serr.begin()));
+}
+
 //' @return \code{swe_version} returns Swiss Ephemeris software version as string
 //' @rdname Section1
 //' @export
@@ -105,14 +448,24 @@ Rcpp::List calc_ut(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, int iflag
   Rcpp::CharacterVector serr_(ipl.length());
   Rcpp::NumericMatrix xx_(ipl.length(), 6);
 
-  for (int i = 0; i < ipl.length(); ++i) {
-    std::array<double, 6> xx{{0.0}};
-    std::array<char, 256> serr{{'\0'}};
-    rc_(i) = swe_calc_ut(jd_ut[i], ipl(i), iflag, xx.begin(), serr.begin());
-    Rcpp::NumericVector tmp(xx.begin(), xx.end());
-    xx_(i, Rcpp::_) = tmp;
-    serr_(i) = std::string(serr.begin());
+  std::vector<int> order = epoch_order(jd_ut);
+  std::vector<double> tt = tt_dates(jd_ut, iflag, true);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  for (size_t b = 0; b < order.size(); b += prefetch_block) {
+    auto last = order.begin() + std::min(order.size(), b + prefetch_block);
+    calc_prefetch(tt, ipl, iflag, order.begin() + b, last);
+    for (auto it = order.begin() + b; it != last; ++it) {
+      int i = *it;
+      std::array<double, 6> xx{{0.0}};
+      std::array<char, 256> serr{{'\0'}};
+      rc_(i) = swe_calc_ut(jd_ut[i], ipl(i), iflag, xx.begin(), serr.begin());
+      Rcpp::NumericVector tmp(xx.begin(), xx.end());
+      xx_(i, Rcpp::_) = tmp;
+      serr_(i) = std::string(serr.begin());
+    }
   }
+  swe_calc_prefetch(NULL, NULL, 0, iflag);
+  swe_set_uniform_grid(0);
 
   // remove dim attribute to return a vector
   if (ipl.length() == 1)
@@ -134,14 +487,24 @@ Rcpp::List calc(Rcpp::NumericVector jd_et, Rcpp::IntegerVector ipl, int iflag) {
   Rcpp::CharacterVector serr_(ipl.length());
   Rcpp::NumericMatrix xx_(ipl.length(), 6);
 
-  for (int i = 0; i < ipl.length(); ++i) {
-    std::array<double, 6> xx{{0.0}};
-    std::array<char, 256> serr{{'\0'}};
-    rc_(i) = swe_calc(jd_et[i], ipl(i), iflag, xx.begin(), serr.begin());
-    Rcpp::NumericVector tmp(xx.begin(), xx.end());
-    xx_(i, Rcpp::_) = tmp;
-    serr_(i) = std::string(serr.begin());
+  std::vector<int> order = epoch_order(jd_et);
+  std::vector<double> tt = tt_dates(jd_et, iflag, false);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  for (size_t b = 0; b < order.size(); b += prefetch_block) {
+    auto last = order.begin() + std::min(order.size(), b + prefetch_block);
+    calc_prefetch(tt, ipl, iflag, order.begin() + b, last);
+    for (auto it = order.begin() + b; it != last; ++it) {
+      int i = *it;
+      std::array<double, 6> xx{{0.0}};
+      std::array<char, 256> serr{{'\0'}};
+      rc_(i) = swe_calc(jd_et[i], ipl(i), iflag, xx.begin(), serr.begin());
+      Rcpp::NumericVector tmp(xx.begin(), xx.end());
+      xx_(i, Rcpp::_) = tmp;
+      serr_(i) = std::string(serr.begin());
+    }
   }
+  swe_calc_prefetch(NULL, NULL, 0, iflag);
+  swe_set_uniform_grid(0);
   // remove dim attribute to return a vector
   if (ipl.length() == 1)
     xx_.attr("dim") = R_NilValue;
@@ -189,7 +552,7 @@ Rcpp::List fixstar2_ut(Rcpp::CharacterVector starname, Rcpp::NumericVector jd_ut
   Rcpp::CharacterVector serr_(starname.length());
   Rcpp::NumericMatrix xx_(starname.length(), 6);
 
-  for (int i = 0; i < starname.length(); ++i) {
+  for (int i : epoch_order(jd_ut)) {
     std::array<double, 6> xx{0.0};
     std::array<char, 256> serr{'\0'};
     std::string starname_(starname(i));
@@ -223,7 +586,7 @@ Rcpp::List fixstar2(Rcpp::CharacterVector starname, Rcpp::NumericVector jd_et, i
   Rcpp::CharacterVector serr_(starname.length());
   Rcpp::NumericMatrix xx_(starname.length(), 6);
 
-  for (int i = 0; i < starname.length(); ++i) {
+  for (int i : epoch_order(jd_et)) {
     std::array<double, 6> xx{0.0};
     std::array<char, 256> serr{'\0'};
     std::string starname_(starname(i));
@@ -407,7 +770,7 @@ Rcpp::List orbit_max_min_true_distance(double jd_et, int ipl, int iflag) {
 //' @param ifltype eclipse type as integer (\code{SE$ECL_CENTRAL=1}, \code{SE$ECL_NONCENTRAL=2},
 //'  \code{SE$ECL_TOTAL=4}, \code{SE$ECL_ANNULAR=8}, \code{SE$ECL_PARTIAL=16}, \code{SE$ECL_ANNULAR_TOTAL=32} or 0 for any)
 //' @param horhgt Horizon apparent altitude as double (deg)
-//' @param xin  Position of body as numeric vector (either ecliptical or equatorial coordinates, depending on coord_flag)
+//' @param xin  Position of body as numeric vector, or matrix with one row per position (either ecliptical or equatorial coordinates, depending on coord_flag)
 //' @param rsmi  Event flag as integer (e.g.: \code{SE$CALC_RISE=1}, \code{SE$CALC_SET=2}, \code{SE$CALC_MTRANSIT=4}, \code{SE$CALC_ITRANSIT=8})
 //' @details
 //' \describe{
@@ -428,6 +791,7 @@ Rcpp::List orbit_max_min_true_distance(double jd_et, int ipl, int iflag) {
 //' swe_rise_trans_true_hor(1234567.5,SE$SUN,"",SE$FLG_MOSEPH,0,c(0,50,10),1013.25,15,0)
 //' swe_pheno_ut(1234567,1,SE$FLG_MOSEPH)
 //' swe_pheno(1234567,1,SE$FLG_MOSEPH)
+//' swe_pheno_ut(1234567 + 0:2, c(SE$MOON, SE$VENUS), SE$FLG_MOSEPH)
 //' swe_azalt(1234567,SE$EQU2HOR,c(0,50,10),15,1013.25,c(186,22))
 //' swe_azalt_rev(1234567,SE$ECL2HOR,c(0, 50,10),c(123,2))
 //' swe_refrac_extended(2,0,1013.25,15,-0.065,SE$TRUE_TO_APP)
@@ -666,23 +1030,69 @@ Rcpp::List rise_trans_true_hor(double jd_ut, int ipl, std::string starname, int
                             Rcpp::Named("serr") = std::string(serr.begin()));
 }
 
+// Messages of the rows of a batch: copies made by the C library, or NULL
+// if a row has none. The copies are released here.
+static Rcpp::CharacterVector batch_messages(std::vector<char *> &serr) {
+  std::vector<std::string> msg(serr.size());
+  for (size_t i = 0; i < serr.size(); ++i) {
+    if (serr[i] != NULL) {
+      msg[i] = serr[i];
+      free(serr[i]);
+    }
+  }
+  Rcpp::CharacterVector serr_(msg.size());
+  for (size_t i = 0; i < msg.size(); ++i)
+    serr_(i) = msg[i];
+  return serr_;
+}
+
+// Phenomena of the bodies ipl at the dates jd, recycled against each
+// other, computed by swe_pheno_array() or swe_pheno_ut_array(), which
+// share the sun between consecutive rows of the same date.
+static Rcpp::List pheno_batch(Rcpp::NumericVector jd, Rcpp::IntegerVector ipl, int ephe_flag, int nthreads,
+                              int32 (*f)(int32, double *, int32 *, int32, int32, double *, int32 *, char **)) {
+  R_xlen_t n = recycled_length({jd.length(), ipl.length()});
+  std::vector<double> tjd(n);
+  std::vector<int32> body(n);
+  for (R_xlen_t i = 0; i < n; ++i) {
+    tjd[i] = jd[i % jd.length()];
+    body[i] = ipl[i % ipl.length()];
+  }
+  std::vector<double> attr(20 * n);
+  std::vector<int32> rc(n);
+  std::vector<char *> serr(n);
+  f(n, tjd.data(), body.data(), ephe_flag, nthreads, attr.data(), rc.data(), serr.data());
+  Rcpp::CharacterVector serr_ = batch_messages(serr);
+  Rcpp::NumericMatrix attr_(n, 20);
+  for (R_xlen_t i = 0; i < n; ++i)
+    for (int j = 0; j < 20; ++j)
+      attr_(i, j) = attr[20 * i + j];
+  // remove dim attribute to return a vector
+  if (n == 1)
+    attr_.attr("dim") = R_NilValue;
+  return Rcpp::List::create(Rcpp::Named("return") = Rcpp::IntegerVector(rc.begin(), rc.end()),
+                            Rcpp::Named("attr") = attr_,
+                            Rcpp::Named("serr") = serr_);
+}
+
 //' @details
 //' \describe{
 //' \item{swe_pheno_ut()}{Compute phase, phase angle, elongation, apparent diameter, apparent magnitude for the Sun, the Moon, all planets and asteroids (UT)}
 //' }
+//' @param nthreads number of threads as integer (one thread on macOS and Windows, where the
+//'        library has no thread-local state)
 //' @return \code{swe_pheno_ut} returns a list with named entries:
 //'      \code{return} status fag as integer, \code{attr} for phenomenon information as numeric vector
-//'      and \code{serr} error warning as string
+//'      and \code{serr} error warning as string.
+//'      Dates and bodies are recycled against each other. For several rows, \code{attr} is a
+//'      matrix with one row per date and body, and \code{return} and \code{serr} have one value
+//'      per row; consecutive rows of the same date share the sun, and the rows can be divided
+//'      over \code{nthreads} threads.
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_pheno_ut)]]
-Rcpp::List pheno_ut(double jd_ut, int ipl, int ephe_flag) {
-  std::array<double, 20> attr{0.0};
-  std::array<char, 256> serr{'\0'};
-  int rtn = swe_pheno_ut(jd_ut, ipl, ephe_flag, attr.begin(), serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("attr") = attr,
-                            Rcpp::Named("serr") = std::string(serr.begin())
-  );
+Rcpp::List pheno_ut(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, int ephe_flag, int nthreads = 1) {
+  return pheno_batch(jd_ut, ipl, ephe_flag, nthreads, swe_pheno_ut_array);
 }
 
 
@@ -692,32 +1102,34 @@ Rcpp::List pheno_ut(double jd_ut, int ipl, int ephe_flag) {
 //' }
 //' @return \code{swe_pheno} returns a list with named entries:
 //'      \code{return} status fag as integer, \code{attr} for phenomenon information as numeric vector
-//'      and \code{serr} error message as string
+//'      and \code{serr} error message as string, for several dates or bodies as \code{swe_pheno_ut}.
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_pheno)]]
-Rcpp::List pheno(double jd_et, int ipl, int ephe_flag) {
-  std::array<double, 20> attr{0.0};
-  std::array<char, 256> serr{'\0'};
-  int rtn = swe_pheno(jd_et, ipl, ephe_flag, attr.begin(), serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = rtn, Rcpp::Named("attr") = attr,
-                            Rcpp::Named("serr") = std::string(serr.begin())
-  );
+Rcpp::List pheno(Rcpp::NumericVector jd_et, Rcpp::IntegerVector ipl, int ephe_flag, int nthreads = 1) {
+  return pheno_batch(jd_et, ipl, ephe_flag, nthreads, swe_pheno_array);
 }
 
 //' @details
 //' \describe{
-//' \item{swe_azalt()}{Compute the horizontal coordinates (azimuth and altitude) of a planet or a star from either ecliptical or equatorial coordinates.}
+//' \item{swe_azalt()}{Compute the horizontal coordinates (azimuth and altitude) of a planet or a star from either ecliptical or equatorial coordinates.
+//' Many positions (the rows of \code{xin}) and dates (\code{jd_ut}, recycled against the rows) are transformed at once.
+//' Sidereal time, obliquity and the rotation are computed once per distinct date.}
 //' }
 //' @return \code{swe_azalt} returns a list with named entries:
-//'      \code{xaz} for azi/alt info as numeric vector.
+//'      \code{xaz} for azi/alt info as numeric vector, or matrix with one row per position.
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_azalt)]]
-Rcpp::List azalt(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, double atpress, double attemp, Rcpp::NumericVector xin) {
+Rcpp::List azalt(Rcpp::NumericVector jd_ut, int coord_flag, Rcpp::NumericVector geopos, double atpress, double attemp, Rcpp::NumericVector xin) {
   if (geopos.length() < 3) Rcpp::stop("Geographic position 'geopos' must have a length of 3");
-  std::array<double, 3> xaz{0.0};
-  swe_azalt(jd_ut, coord_flag, geopos.begin(), atpress, attemp, xin.begin(), xaz.begin());
+  Rcpp::NumericMatrix xaz = horizontal_batch(jd_ut, coordinate_pairs(xin), 3,
+    [&](double jd, int n, double *x, double *y) {
+      swe_azalt_array(jd, coord_flag, geopos.begin(), atpress, attemp, n, x, y);
+    });
+  // remove dim attribute to return a vector
+  if (xaz.nrow() == 1)
+    xaz.attr("dim") = R_NilValue;
   return Rcpp::List::create(Rcpp::Named("xaz") = xaz);
 }
 
@@ -726,17 +1138,22 @@ Rcpp::List azalt(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, doubl
 //' \describe{
 //' \item{swe_azalt_rev()}{Compute either ecliptical or equatorial coordinates from azimuth and true altitude.
 //' If only an apparent altitude is given, the true altitude has to be computed first with
-//' e.g. the function swe_refrac_extended().}
+//' e.g. the function swe_refrac_extended(). Positions and dates are vectorised as in swe_azalt().}
 //' }
 //' @return \code{swe_azalt_rev} returns a list with named entries:
-//'      \code{xaz} for celestial info as numeric vector.
+//'      \code{xout} for celestial info as numeric vector, or matrix with one row per position.
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_azalt_rev)]]
-Rcpp::List azalt_rev(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, Rcpp::NumericVector xin) {
+Rcpp::List azalt_rev(Rcpp::NumericVector jd_ut, int coord_flag, Rcpp::NumericVector geopos, Rcpp::NumericVector xin) {
   if (geopos.length() < 3) Rcpp::stop("Geographic position 'geopos' must have a length of 3");
-  std::array<double, 3> xout{0.0};
-  swe_azalt_rev(jd_ut, coord_flag, geopos.begin(), xin.begin(), xout.begin());
+  Rcpp::NumericMatrix xout = horizontal_batch(jd_ut, coordinate_pairs(xin), 2,
+    [&](double jd, int n, double *x, double *y) {
+      swe_azalt_rev_array(jd, coord_flag, geopos.begin(), n, x, y);
+    });
+  // remove dim attribute to return a vector
+  if (xout.nrow() == 1)
+    xout.attr("dim") = R_NilValue;
   return Rcpp::List::create(Rcpp::Named("xout") = xout);
 }
 
@@ -745,13 +1162,16 @@ Rcpp::List azalt_rev(double jd_ut, int coord_flag, Rcpp::NumericVector geopos, R
 //' \item{swe_refrac()}{Calculate either the topocentric altitude from the apparent altitude
 //' or the apparent altitude from the topocentric altitude.}
 //' }
-//' @param InAlt  object's apparent/topocentric altitude as double (depending on calc_flag) (deg)
-//' @return \code{swe_refrac} returns the (apparent/topocentric) altitude as double (deg)
+//' @param InAlt  object's apparent/topocentric altitude as numeric vector (depending on calc_flag) (deg)
+//' @return \code{swe_refrac} returns the (apparent/topocentric) altitude as numeric vector (deg)
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_refrac)]]
-double refrac(double InAlt, double atpress, double attemp, int calc_flag) {
-  return swe_refrac(InAlt,atpress,attemp,calc_flag);
+Rcpp::NumericVector refrac(Rcpp::NumericVector InAlt, double atpress, double attemp, int calc_flag) {
+  Rcpp::NumericVector alt(InAlt.length());
+  for (int i = 0; i < InAlt.length(); ++i)
+    alt(i) = swe_refrac(InAlt[i], atpress, attemp, calc_flag);
+  return alt;
 }
 
 //' @details
@@ -759,20 +1179,44 @@ double refrac(double InAlt, double atpress, double attemp, int calc_flag) {
 //' \item{swe_refrac_extended()}{Calculate either the topocentric altitude from the apparent altitude
 //' or the apparent altitude from the topocentric altitude.
 //' It allows correct calculation of refraction for heights above sea > 0,
-//' where the ideal horizon and planets that are visible may have a negative altitude. }
+//' where the ideal horizon and planets that are visible may have a negative altitude.
+//' For many altitudes, the apparent altitude is interpolated from a table for the given pressure and temperature.}
 //' }
 //' @param height  observer's height as double (m)
 //' @param lapse_rate  lapse rate as double (K/m)
-//' @return \code{swe_refrac_extended} returns a list with named entries: \code{return} status flag as integer,
-//'      \code{dret} refraction results as numeric vector (TopoAlt, AppAlt, refraction)
+//' @return \code{swe_refrac_extended} returns a list with named entries: \code{return} altitude as numeric vector,
+//'      \code{dret} refraction results as numeric vector (TopoAlt, AppAlt, refraction, dip of the horizon),
+//'      or matrix with one row per altitude
 //' @rdname Section6
 //' @export
 // [[Rcpp::export(swe_refrac_extended)]]
-Rcpp::List refrac_extended(double InAlt, double height, double atpress, double attemp, double lapse_rate, int calc_flag) {
-  std::array<double, 20> dret{0.0};
-  double i = swe_refrac_extended(InAlt,height,atpress,attemp,lapse_rate,calc_flag, dret.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
-                            Rcpp::Named("dret") = dret);
+Rcpp::List refrac_extended(Rcpp::NumericVector InAlt, double height, double atpress, double attemp, double lapse_rate, int calc_flag) {
+  int n = InAlt.length();
+  Rcpp::NumericVector alt(n);
+  std::vector<double> dret(4 * n);
+  swe_refrac_extended_array(n, InAlt.begin(), height, atpress, attemp, lapse_rate, calc_flag,
+                            alt.begin(), dret.data());
+  Rcpp::NumericMatrix dret_(n, 4);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < 4; ++j)
+      dret_(i, j) = dret[4 * i + j];
+  // remove dim attribute to return a vector
+  if (n == 1)
+    dret_.attr("dim") = R_NilValue;
+  return Rcpp::List::create(Rcpp::Named("return") = alt,
+                            Rcpp::Named("dret") = dret_);
+}
+
+//' @details
+//' \describe{
+//' \item{swe_set_lapse_rate()}{Set the atmospheric lapse rate used for the dip of the horizon
+//' by swe_azalt() and the rising and setting functions.}
+//' }
+//' @rdname Section6
+//' @export
+// [[Rcpp::export(swe_set_lapse_rate)]]
+void set_lapse_rate(double lapse_rate) {
+  swe_set_lapse_rate(lapse_rate);
 }
 
 //' @details
@@ -914,6 +1358,9 @@ Rcpp::List heliacal_angle(double jd_ut, Rcpp::NumericVector dgeo, Rcpp::NumericV
 //'   \item{swe_utc_to_jd()}{Convert UTC to Julian day number (UT and ET).}
 //'   \item{swe_jdet_to_utc()}{Convert Julian day number (ET) into UTC.}
 //'   \item{swe_jdut1_to_utc()}{Convert Julian day number (UT1) into UTC.}
+//'   \item{swe_time_to_jd()}{Convert UTC given as POSIXct or Date to Julian day number (UT and ET).}
+//'   \item{swe_jdet_to_time()}{Convert Julian day number (ET) into UTC as POSIXct or Date.}
+//'   \item{swe_jdut1_to_time()}{Convert Julian day number (UT1) into UTC as POSIXct or Date.}
 //'   \item{swe_time_equ()}{Calculate equation of time (LAT-LMT).}
 //'   \item{swe_lmt_to_lat()}{Convert Julian day number (LMT) into Julian day number (LAT).}
 //'   \item{swe_lat_to_lmt()}{Convert Julian day number (LAT) into Julian day number (LMT).}
@@ -927,29 +1374,37 @@ Rcpp::List heliacal_angle(double jd_ut, Rcpp::NumericVector dgeo, Rcpp::NumericV
 //' swe_utc_to_jd(2000,1,1,0,12,3.4,SE$GREG_CAL)
 //' swe_jdet_to_utc(2452500,SE$GREG_CAL)
 //' swe_jdut1_to_utc(2452500,SE$GREG_CAL)
+//' swe_julday(2000,1,1:31,12,SE$GREG_CAL)
+//' swe_time_to_jd(as.POSIXct("2000-01-01 00:12:03", tz = "UTC"))
+//' swe_jdet_to_time(2452500)
+//' swe_jdut1_to_time(2452500 + 0:6, date = TRUE)
 //' swe_time_equ(2452500)
 //' swe_lmt_to_lat(2452500,0)
 //' swe_lat_to_lmt(2452500,0)
-//' @param year  Astronomical year as integer
-//' @param month  Month as integer
-//' @param day  Day as integer
-//' @param hourd  Hour as double
-//' @param houri  Hour as integer
-//' @param min  min as integer
-//' @param sec  Second as double
+//' @param year  Astronomical year as integer vector
+//' @param month  Month as integer vector
+//' @param day  Day as integer vector
+//' @param hourd  Hour as double vector
+//' @param houri  Hour as integer vector
+//' @param min  min as integer vector
+//' @param sec  Second as double vector
 //' @param geolon  geographic longitude as double (deg)
 //' @param gregflag  Calendar type as integer (SE$JUL_CAL=0 or SE$GREG_CAL=1)
-//' @param jd_et  Julian day number (ET) as double (day)
-//' @param jd_ut  Julian day number (UT) as double (day)
+//' @param jd_et  Julian day number (ET) as double vector (day)
+//' @param jd_ut  Julian day number (UT) as double vector (day)
 //' @param jd_lmt  Julian day number (LMT=UT+geolon/360) as double (day)
 //' @param jd_lat  Julian day number (LAT) as double (day)
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_julday)]]
-double julday(int year, int month, int day, double hourd, int gregflag) {
-    double i;
-    i = swe_julday(year, month, day, hourd, gregflag);
-  return i;
+Rcpp::NumericVector julday(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day,
+                           Rcpp::NumericVector hourd, int gregflag) {
+  R_xlen_t n = recycled_length({year.length(), month.length(), day.length(), hourd.length()});
+  Rcpp::NumericVector jd(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    jd(i) = swe_julday(year[i % year.length()], month[i % month.length()], day[i % day.length()],
+                       hourd[i % hourd.length()], gregflag);
+  return jd;
 }
 
 //' @param cal  Calendar type "g" [Gregorian] or "j" [Julian] as char
@@ -965,39 +1420,43 @@ Rcpp::List date_conversion(int year, int month, int day, double hourd, char cal)
                             Rcpp::Named("jd") = jd);
 }
 
-//' @param jd  Julian day number as double
+//' @param jd  Julian day number as double vector
 //' @return \code{swe_revjul} returns a list with named entries: \code{year} year as integer,
 //'      \code{month} month as integer, \code{day} day as integer and \code{hour} hour as double.
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_revjul)]]
-Rcpp::List revjul(double jd, int gregflag ) {
-  int year;
-  int month;
-  int day;
-  double hour;
-  swe_revjul(jd, gregflag, &year, &month, &day, &hour);
+Rcpp::List revjul(Rcpp::NumericVector jd, int gregflag) {
+  R_xlen_t n = jd.length();
+  Rcpp::IntegerVector year(n), month(n), day(n);
+  Rcpp::NumericVector hour(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    swe_revjul(jd[i], gregflag, &year[i], &month[i], &day[i], &hour[i]);
   return Rcpp::List::create(Rcpp::Named("year") = year,
                             Rcpp::Named("month") = month,
                             Rcpp::Named("day") = day,
                             Rcpp::Named("hour") = hour);
 }
 
-//' @param d_timezone  Timezone offset as double (hour)
+//' @param d_timezone  Timezone offset as double vector (hour)
 //' @return \code{swe_utc_time_zone} returns a list with named entries: \code{year_out} year as integer,
 //'      \code{month_out} month as integer, \code{day_out} day as integer, \code{hour_out} hour as integer, \code{min_out} minute as integer, 
 //'      \code{sec_out} second as double,
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_utc_time_zone)]]
-Rcpp::List utc_time_zone(int year, int month, int day, int houri, int min, double sec, double d_timezone) {
-  int year_out;
-  int month_out;
-  int day_out;
-  int hour_out;
-  int min_out;
-  double sec_out;
-  swe_utc_time_zone(year, month, day, houri, min, sec, d_timezone, &year_out,&month_out,&day_out,&hour_out,&min_out,&sec_out);
+Rcpp::List utc_time_zone(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day,
+                         Rcpp::IntegerVector houri, Rcpp::IntegerVector min, Rcpp::NumericVector sec,
+                         Rcpp::NumericVector d_timezone) {
+  R_xlen_t n = recycled_length({year.length(), month.length(), day.length(), houri.length(),
+                                min.length(), sec.length(), d_timezone.length()});
+  Rcpp::IntegerVector year_out(n), month_out(n), day_out(n), hour_out(n), min_out(n);
+  Rcpp::NumericVector sec_out(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    swe_utc_time_zone(year[i % year.length()], month[i % month.length()], day[i % day.length()],
+                      houri[i % houri.length()], min[i % min.length()], sec[i % sec.length()],
+                      d_timezone[i % d_timezone.length()],
+                      &year_out[i], &month_out[i], &day_out[i], &hour_out[i], &min_out[i], &sec_out[i]);
   return Rcpp::List::create(Rcpp::Named("year_out") = year_out,
                             Rcpp::Named("month_out") = month_out,
                             Rcpp::Named("day_out") = day_out,
@@ -1008,17 +1467,37 @@ Rcpp::List utc_time_zone(int year, int month, int day, int houri, int min, doubl
 }
 
 //' @return \code{swe_utc_to_jd} returns a list with named entries: \code{return} status flag as integer,
-//'      \code{dret} Julian day number as numeric vector and \code{serr} for error message as string.
+//'      \code{dret} Julian day numbers (ET and UT) as numeric vector, or as matrix with one row per date
+//'      if several dates are given, and \code{serr} for error message as string.
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_utc_to_jd)]]
-Rcpp::List utc_to_jd (int year, int month, int day, int houri, int min, double sec, int gregflag) {
-  std::array<char, 256> serr{'\0'};
-  std::array<double, 2> dret{0.0};
-  int i = swe_utc_to_jd(year, month, day, houri, min,sec,gregflag, dret.begin(),serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
-                            Rcpp::Named("dret") = dret,
-                            Rcpp::Named("serr") = std::string(serr.begin()));
+Rcpp::List utc_to_jd(Rcpp::IntegerVector year, Rcpp::IntegerVector month, Rcpp::IntegerVector day,
+                     Rcpp::IntegerVector houri, Rcpp::IntegerVector min, Rcpp::NumericVector sec,
+                     int gregflag) {
+  R_xlen_t n = recycled_length({year.length(), month.length(), day.length(), houri.length(),
+                                min.length(), sec.length()});
+  Rcpp::IntegerVector rc_(n);
+  Rcpp::NumericMatrix dret_(n, 2);
+  Rcpp::CharacterVector serr_(n);
+  for (R_xlen_t i = 0; i < n; i++) {
+    std::array<char, 256> serr{'\0'};
+    std::array<double, 2> dret{0.0};
+    rc_(i) = swe_utc_to_jd(year[i % year.length()], month[i % month.length()], day[i % day.length()],
+                           houri[i % houri.length()], min[i % min.length()], sec[i % sec.length()],
+                           gregflag, dret.begin(), serr.begin());
+    dret_(i, 0) = dret[0];
+    dret_(i, 1) = dret[1];
+    serr_(i) = std::string(serr.begin());
+  }
+
+  // remove dim attribute to return a vector
+  if (n == 1)
+    dret_.attr("dim") = R_NilValue;
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("dret") = dret_,
+                            Rcpp::Named("serr") = serr_);
 }
 
 //' @return \code{swe_jdet_to_utc} returns a list with named entries: \code{year_out} year as integer,
@@ -1027,14 +1506,13 @@ Rcpp::List utc_to_jd (int year, int month, int day, int houri, int min, double s
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_jdet_to_utc )]]
-Rcpp::List jdet_to_utc(double jd_et, int gregflag) {
-  int year_out;
-  int month_out;
-  int day_out;
-  int hour_out;
-  int min_out;
-  double sec_out;
-  swe_jdet_to_utc(jd_et,gregflag, &year_out,&month_out,&day_out,&hour_out,&min_out,&sec_out);
+Rcpp::List jdet_to_utc(Rcpp::NumericVector jd_et, int gregflag) {
+  R_xlen_t n = jd_et.length();
+  Rcpp::IntegerVector year_out(n), month_out(n), day_out(n), hour_out(n), min_out(n);
+  Rcpp::NumericVector sec_out(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    swe_jdet_to_utc(jd_et[i], gregflag,
+                    &year_out[i], &month_out[i], &day_out[i], &hour_out[i], &min_out[i], &sec_out[i]);
   return Rcpp::List::create(Rcpp::Named("year_out") = year_out,
                             Rcpp::Named("month_out") = month_out,
                             Rcpp::Named("day_out") = day_out,
@@ -1050,14 +1528,13 @@ Rcpp::List jdet_to_utc(double jd_et, int gregflag) {
 //' @rdname Section7
 //' @export
 // [[Rcpp::export(swe_jdut1_to_utc)]]
-Rcpp::List jdut1_to_utc(double jd_ut, int gregflag) {
-  int year_out;
-  int month_out;
-  int day_out;
-  int hour_out;
-  int min_out;
-  double sec_out;
-  swe_jdut1_to_utc(jd_ut,gregflag, &year_out,&month_out,&day_out,&hour_out,&min_out,&sec_out);
+Rcpp::List jdut1_to_utc(Rcpp::NumericVector jd_ut, int gregflag) {
+  R_xlen_t n = jd_ut.length();
+  Rcpp::IntegerVector year_out(n), month_out(n), day_out(n), hour_out(n), min_out(n);
+  Rcpp::NumericVector sec_out(n);
+  for (R_xlen_t i = 0; i < n; i++)
+    swe_jdut1_to_utc(jd_ut[i], gregflag,
+                     &year_out[i], &month_out[i], &day_out[i], &hour_out[i], &min_out[i], &sec_out[i]);
   return Rcpp::List::create(Rcpp::Named("year_out") = year_out,
                             Rcpp::Named("month_out") = month_out,
                             Rcpp::Named("day_out") = day_out,
@@ -1067,6 +1544,92 @@ Rcpp::List jdut1_to_utc(double jd_ut, int gregflag) {
   );
 }
 
+//' @param time  UTC date and time as POSIXct or Date vector
+//' @return \code{swe_time_to_jd} returns a list with named entries: \code{return} status flag as integer,
+//'      \code{dret} Julian day numbers (ET and UT) as numeric vector, or as matrix with one row per date
+//'      if several dates are given, and \code{serr} for error message as string.
+//' @rdname Section7
+//' @export
+// [[Rcpp::export(swe_time_to_jd)]]
+Rcpp::List time_to_jd(SEXP time) {
+  Rcpp::NumericVector secs = posix_seconds(time);
+  R_xlen_t n = secs.length();
+  Rcpp::IntegerVector rc_(n);
+  Rcpp::NumericMatrix dret_(n, 2);
+  Rcpp::CharacterVector serr_(n);
+  for (R_xlen_t i = 0; i < n; i++) {
+    std::array<char, 256> serr{'\0'};
+    std::array<double, 2> dret{0.0};
+    if (!std::isfinite(secs[i])) {
+      rc_(i) = ERR;
+      dret_(i, 0) = dret_(i, 1) = NA_REAL;
+      serr_(i) = "invalid date";
+      continue;
+    }
+    double days = std::floor(secs[i] / 86400.0);
+    double sod = secs[i] - days * 86400.0;
+    int year, month, day;
+    double hour;
+    swe_revjul(2440587.5 + days, SE_GREG_CAL, &year, &month, &day, &hour);
+    int houri = (int) (sod / 3600.0);
+    int min = (int) ((sod - houri * 3600.0) / 60.0);
+    rc_(i) = swe_utc_to_jd(year, month, day, houri, min, sod - houri * 3600.0 - min * 60.0,
+                           SE_GREG_CAL, dret.begin(), serr.begin());
+    dret_(i, 0) = dret[0];
+    dret_(i, 1) = dret[1];
+    serr_(i) = std::string(serr.begin());
+  }
+
+  // remove dim attribute to return a vector
+  if (n == 1)
+    dret_.attr("dim") = R_NilValue;
+
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("dret") = dret_,
+                            Rcpp::Named("serr") = serr_);
+}
+
+//' @param date  Return a Date vector (UTC day) instead of POSIXct as logical
+//' @return \code{swe_jdet_to_time} returns the UTC date and time as POSIXct (time zone UTC) or Date vector.
+//' @rdname Section7
+//' @export
+// [[Rcpp::export(swe_jdet_to_time)]]
+SEXP jdet_to_time(Rcpp::NumericVector jd_et, bool date = false) {
+  R_xlen_t n = jd_et.length();
+  Rcpp::NumericVector secs(n);
+  for (R_xlen_t i = 0; i < n; i++) {
+    int year, month, day, hour, min;
+    double sec;
+    if (!std::isfinite(jd_et[i])) {
+      secs(i) = NA_REAL;
+      continue;
+    }
+    swe_jdet_to_utc(jd_et[i], SE_GREG_CAL, &year, &month, &day, &hour, &min, &sec);
+    secs(i) = utc_posix_seconds(year, month, day, hour, min, sec);
+  }
+  return posix_vector(secs, date);
+}
+
+//' @return \code{swe_jdut1_to_time} returns the UTC date and time as POSIXct (time zone UTC) or Date vector.
+//' @rdname Section7
+//' @export
+// [[Rcpp::export(swe_jdut1_to_time)]]
+SEXP jdut1_to_time(Rcpp::NumericVector jd_ut, bool date = false) {
+  R_xlen_t n = jd_ut.length();
+  Rcpp::NumericVector secs(n);
+  for (R_xlen_t i = 0; i < n; i++) {
+    int year, month, day, hour, min;
+    double sec;
+    if (!std::isfinite(jd_ut[i])) {
+      secs(i) = NA_REAL;
+      continue;
+    }
+    swe_jdut1_to_utc(jd_ut[i], SE_GREG_CAL, &year, &month, &day, &hour, &min, &sec);
+    secs(i) = utc_posix_seconds(year, month, day, hour, min, sec);
+  }
+  return posix_vector(secs, date);
+}
+
 //' @return \code{swe_swe_time_equ} returns a list with named entries: \code{return} status flag as integer,
 //'      \code{e} equation of time (day) as double and \code{serr} for error message as string.
 //' @rdname Section7
@@ -1266,38 +1829,28 @@ std::string get_ayanamsa_name(int sid_mode) {
 //' \describe{
 //' \item{swe_get_ayanamsa_ex_ut()}{It computes ayanamsa using UT.}
 //' }
-//' @param jd_ut  UT Julian day number as double (day)
+//' @param jd_ut  UT Julian day number as double vector (day)
 //' @return \code{swe_get_ayanamsa_ex_ut} returns a list with named entries: \code{return} status flag as integer,
-//'      \code{daya} ayanamsa value as double and \code{serr} error message as string
+//'      \code{daya} ayanamsa value as double and \code{serr} error message as string, with one element per date
 //' @rdname Section10
 //' @export
 // [[Rcpp::export(swe_get_ayanamsa_ex_ut)]]
-Rcpp::List get_ayanamsa_ex_ut(double jd_ut, int iflag){
-  double daya;
-  std::array<char, 256> serr{'\0'};
-  int i = swe_get_ayanamsa_ex_ut(jd_ut, iflag,  &daya, serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
-                            Rcpp::Named("daya") = daya,
-                            Rcpp::Named("serr") = std::string(serr.begin()));
+Rcpp::List get_ayanamsa_ex_ut(Rcpp::NumericVector jd_ut, int iflag){
+  return ayanamsa_batch(jd_ut, iflag, true);
 }
 
 //' @details
 //' \describe{
 //' \item{swe_get_ayanamsa_ex()}{It computes ayanamsa using ET.}
 //' }
-//' @param jd_et  ET Julian day number as double (day)
+//' @param jd_et  ET Julian day number as double vector (day)
 //' @return \code{swe_get_ayanamsa_ex} returns a list with named entries: \code{return} status flag as integer,
-//'      \code{daya} ayanamsa value as double and \code{serr} error message as string
+//'      \code{daya} ayanamsa value as double and \code{serr} error message as string, with one element per date
 //' @rdname Section10
 //' @export
 // [[Rcpp::export(swe_get_ayanamsa_ex)]]
-Rcpp::List get_ayanamsa_ex(double jd_et, int iflag){
-  double daya;
-  std::array<char, 256> serr{'\0'};
-  int i = swe_get_ayanamsa_ex(jd_et, iflag,  &daya, serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
-                            Rcpp::Named("daya") = daya,
-                            Rcpp::Named("serr") = std::string(serr.begin()));
+Rcpp::List get_ayanamsa_ex(Rcpp::NumericVector jd_et, int iflag){
+  return ayanamsa_batch(jd_et, iflag, false);
 }
 
 
@@ -1308,7 +1861,7 @@ Rcpp::List get_ayanamsa_ex(double jd_et, int iflag){
 //' @seealso Section 13 in \url{https://www.astro.com/swisseph/swephprg.htm}. Remember that array indices start in R at 1, while in C they start at 0!
 //' @param geolat  geographic latitude as double (deg)
 //' @param geolon  geographic longitude as double (deg)
-//' @param hsys  house method, one-letter case sensitive as char
+//' @param hsys  house method, one-letter case sensitive as char (for \code{swe_houses_multi} a character vector of such letters, or "all")
 //' @details
 //' \describe{
 //' \item{swe_houses_ex()}{Calculate houses' cusps, ascendant, Medium Coeli (MC), etc.}
@@ -1354,6 +1907,89 @@ Rcpp::List houses_armc(double armc, double geolat, double eps, char hsys){
                             Rcpp::Named("ascmc") = ascmc);
 }
 
+//' @details
+//' \describe{
+//' \item{swe_houses_multi()}{Calculate houses' cusps, ascendant, Medium Coeli (MC), etc. of several house systems at once,
+//' for one or more charts (\code{jd_ut}, \code{geolat} and \code{geolon} are recycled against each other).
+//' ARMC, obliquity, nutation and the angles are computed once per chart.}
+//' }
+//' @return \code{swe_houses_multi} returns a list with named entries: \code{return} status flag as integer
+//'      (one per system and chart), \code{cusps} cusps values as double (systems x cusps x charts, 36 cusps if
+//'      system 'G' is included, otherwise 12) and \code{ascmc} ascendent, MCs, etc. as double (systems x 10 x charts).
+//'      For a single chart, the last dimension is dropped.
+//' @examples
+//' swe_houses_multi(1234567, 0, 53, 0, c('P', 'K', 'R', 'C'))
+//' swe_houses_multi(1234567 + 0:2, 0, 53, 0)
+//' @rdname Section13
+//' @export
+// [[Rcpp::export(swe_houses_multi)]]
+Rcpp::List houses_multi(Rcpp::NumericVector jd_ut, int cuspflag, Rcpp::NumericVector geolat, Rcpp::NumericVector geolon,
+                        Rcpp::CharacterVector hsys = "all") {
+  std::string codes;
+  if (hsys.length() == 1 && std::string(hsys[0]) == "all") {
+    codes = "ABCDEFGHIiJKLMNOPQRSTUVWXY";
+  } else {
+    for (int k = 0; k < hsys.length(); ++k) {
+      std::string code(hsys[k]);
+      if (code.length() != 1)
+        Rcpp::stop("House systems 'hsys' must be one-letter codes or \"all\"");
+      codes += code;
+    }
+  }
+  int nsys = codes.length();
+  int ncusp = codes.find('G') == std::string::npos ? 12 : 36;
+  R_xlen_t n = recycled_length({jd_ut.length(), geolat.length(), geolon.length()});
+  std::vector<int> hsys_(codes.begin(), codes.end());
+  Rcpp::IntegerVector rc_(nsys * n);
+  Rcpp::NumericVector cusps_(nsys * ncusp * n, NA_REAL);
+  Rcpp::NumericVector ascmc_(nsys * 10 * n);
+
+  Rcpp::NumericVector jd(n);
+  for (R_xlen_t i = 0; i < n; ++i)
+    jd[i] = jd_ut[i % jd_ut.length()];
+  std::vector<int> order = epoch_order(jd);
+  std::vector<double> tt = tt_dates(jd, cuspflag, true);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  std::vector<double> cusps(37 * nsys), ascmc(10 * nsys);
+  std::vector<int32> rc(nsys);
+  std::array<char, 256> serr{{'\0'}};
+  for (int i : order) {
+    swe_houses_multi(jd[i], cuspflag, geolat[i % geolat.length()], geolon[i % geolon.length()],
+                     nsys, hsys_.data(), cusps.data(), ascmc.data(), rc.data(), serr.begin());
+    // column-major arrays: system varies fastest, then cusp, then chart
+    for (int k = 0; k < nsys; ++k) {
+      rc_[i * nsys + k] = rc[k];
+      int ito = (codes[k] == 'G' && rc[k] >= 0) ? 36 : 12;
+      for (int j = 0; j < ito; ++j)
+        cusps_[(i * ncusp + j) * nsys + k] = cusps[37 * k + j + 1];
+      for (int j = 0; j < 10; ++j)
+        ascmc_[(i * 10 + j) * nsys + k] = ascmc[10 * k + j];
+    }
+  }
+  swe_set_uniform_grid(0);
+
+  Rcpp::CharacterVector names(nsys);
+  for (int k = 0; k < nsys; ++k)
+    names[k] = std::string(1, codes[k]);
+  if (n == 1) {
+    rc_.attr("names") = names;
+    cusps_.attr("dim") = Rcpp::Dimension(nsys, ncusp);
+    cusps_.attr("dimnames") = Rcpp::List::create(names, R_NilValue);
+    ascmc_.attr("dim") = Rcpp::Dimension(nsys, 10);
+    ascmc_.attr("dimnames") = Rcpp::List::create(names, R_NilValue);
+  } else {
+    rc_.attr("dim") = Rcpp::Dimension(nsys, n);
+    rc_.attr("dimnames") = Rcpp::List::create(names, R_NilValue);
+    cusps_.attr("dim") = Rcpp::Dimension(nsys, ncusp, n);
+    cusps_.attr("dimnames") = Rcpp::List::create(names, R_NilValue, R_NilValue);
+    ascmc_.attr("dim") = Rcpp::Dimension(nsys, 10, n);
+    ascmc_.attr("dimnames") = Rcpp::List::create(names, R_NilValue, R_NilValue);
+  }
+  return Rcpp::List::create(Rcpp::Named("return") = rc_,
+                            Rcpp::Named("cusps") = cusps_,
+                            Rcpp::Named("ascmc") = ascmc_);
+}
+
 //' @details
 //' \describe{
 //' \item{swe_houses_name()}{Provide the house name.}
@@ -1377,55 +2013,81 @@ std::string house_name(char hsys) {
 //' @param hsys  house method, one-letter case sensitive as char
 //' @param armc  right ascension of the MC as double (deg)
 //' @param eps  ecliptic obliquity as double (deg)
-//' @param xpin  longitude and latitude of the given body as numeric vector (deg)
+//' @param xpin  longitude and latitude of the given body as numeric vector, or matrix with one row per body (deg)
 //' @details
 //' \describe{
-//' \item{swe_house_pos()}{Calculate house position of given body.}
+//' \item{swe_house_pos()}{Calculate house position of given body.
+//' Many bodies (the rows of \code{xpin}) are placed at once in the same house frame,
+//' whose cusps and angles are computed only once.}
 //' }
 //' @return \code{swe_house_pos} returns a list with named entries: \code{return} how far from body's cusp as double,
-//'      and \code{serr} error message as string.
+//'      one value per body, and \code{serr} error message as string.
 //' @examples
 //' swe_house_pos(12, 53, 23, 'B', c(0,0))
+//' swe_house_pos(12, 53, 23, 'P', cbind(c(0, 90, 180), c(0, 5, -5)))
 //' @rdname Section14
 //' @export
 // [[Rcpp::export(swe_house_pos)]]
 Rcpp::List house_pos(double armc, double geolat, double eps, char hsys ,Rcpp::NumericVector xpin){
+  std::vector<double> xy = coordinate_pairs(xpin, "xpin");
+  int n = xy.size() / 2;
+  Rcpp::NumericVector hpos(n);
   std::array<char, 256> serr{'\0'};
-  double i = swe_house_pos(armc,geolat,eps, hsys, xpin.begin(), serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
+  swe_house_pos_array(armc, geolat, eps, hsys, n, xy.data(), hpos.begin(), serr.begin());
+  return Rcpp::List::create(Rcpp::Named("return") = hpos,
                             Rcpp::Named("serr") =  std::string(serr.begin()));
 }
 
 
 //' @details
 //' \describe{
-//' \item{swe_gauquelin_sector()}{Compute the Gauquelin sector position of a planet or star. }
+//' \item{swe_gauquelin_sector()}{Compute the Gauquelin sector position of a planet or star.
+//' Dates, bodies and the rows of \code{geopos} are recycled against each other.
+//' Births of the same body and place between the same rise and set share these times
+//' (methods 2 to 5), and the work can be divided over \code{nthreads} threads.}
 //' }
 //' @param ipl  Body/planet as integer (\code{SE$SUN=0}, \code{SE$MOON=1}, ... \code{SE$PLUTO=9})
 //' @param starname  Star name as string (\code{""} for no star)
 //' @param jd_ut  UT Julian day number as double (day)
-//' @param geopos position as numeric vector (longitude, latitude, height)
+//' @param geopos position as numeric vector (longitude, latitude, height), or matrix with one row per position
 //' @param atpress Atmospheric pressure as double (hPa)
 //' @param attemp Atmospheric temperature as double (Celsius)
 //' @param ephe_flag Ephemeris flag as integer (\code{SE$FLG_JPLEPH=1}, \code{SE$FLG_SWIEPH=2} or \code{SE$FLG_MOSEPH=4})
 //' @param imeth Gauquelin method as integer (0, 1, 2, 3, 4 or 5)
+//' @param nthreads number of threads as integer (one thread on macOS and Windows, where the
+//'        library has no thread-local state)
 //' @examples
 //' data(SE)
 //' swe_gauquelin_sector(1234567.5,SE$VENUS,"",SE$FLG_MOSEPH,0,c(0,50,10),1013.25,15)
+//' swe_gauquelin_sector(1234567.5 + 0:3 / 8, SE$SUN, "", SE$FLG_MOSEPH, 2, c(0,50,10), 1013.25, 15)
 //' @return \code{swe_gauquelin_sector} returns a list with named entries: \code{return} status flag as integer,
-//'      \code{dgsect} for Gauquelin sector as double and \code{serr} error message as string
+//'      \code{dgsect} for Gauquelin sector as double and \code{serr} error message as string, one value per row
 //' @rdname Section14
 //' @export
 // [[Rcpp::export(swe_gauquelin_sector)]]
-Rcpp::List gauquelin_sector(double jd_ut, int ipl, std::string starname, int ephe_flag, int imeth,Rcpp::NumericVector geopos, double atpress, double attemp) {
-  if (geopos.length() < 3) Rcpp::stop("Geographic position 'geopos' must have a length of 3");
-  std::array<char, 256> serr{'\0'};
-  double dgsect;
+Rcpp::List gauquelin_sector(Rcpp::NumericVector jd_ut, Rcpp::IntegerVector ipl, std::string starname, int ephe_flag, int imeth,
+                            Rcpp::NumericVector geopos, double atpress, double attemp, int nthreads = 1) {
+  std::vector<double> pos = geographic_positions(geopos);
+  R_xlen_t npos = pos.size() / 3;
+  R_xlen_t n = recycled_length({jd_ut.length(), ipl.length(), npos});
+  std::vector<double> t(n), g(3 * n);
+  std::vector<int32> body(n);
+  for (R_xlen_t i = 0; i < n; ++i) {
+    t[i] = jd_ut[i % jd_ut.length()];
+    body[i] = ipl[i % ipl.length()];
+    std::copy_n(&pos[3 * (i % npos)], 3, &g[3 * i]);
+  }
+  std::vector<int32> rc(n);
+  Rcpp::NumericVector dgsect(n);
+  std::vector<char *> serr(n);
   starname.resize(41);
-  int i = swe_gauquelin_sector(jd_ut, ipl, &starname[0], ephe_flag, imeth, geopos.begin(), atpress, attemp, &dgsect, serr.begin());
-  return Rcpp::List::create(Rcpp::Named("return") = i,
+  swe_gauquelin_sector_array(n, t.data(), body.data(), &starname[0], ephe_flag, imeth, g.data(), atpress, attemp,
+                             nthreads, dgsect.begin(), rc.data(), serr.data());
+  Rcpp::CharacterVector serr_ = batch_messages(serr);
+  Rcpp::IntegerVector rtn(rc.begin(), rc.end());
+  return Rcpp::List::create(Rcpp::Named("return") = rtn,
                             Rcpp::Named("dgsect") = dgsect,
-                            Rcpp::Named("serr") = std::string(serr.begin()));
+                            Rcpp::Named("serr") = serr_);
 }
 
 
@@ -1438,15 +2100,26 @@ Rcpp::List gauquelin_sector(double jd_ut, int ipl, std::string starname, int eph
 //' \describe{
 //' \item{swe_sidtime()}{Determine the sidereal time.}
 //' }
-//' @param jd_ut  UT Julian day number as double (day)
-//' @return \code{swe_sidtime} returns the sidereal time as double (deg)
+//' @param jd_ut  UT Julian day number as double vector (day)
+//' @return \code{swe_sidtime} returns the sidereal time as double vector (deg)
 //' @examples
 //' swe_sidtime(2451545)
+//' swe_sidtime(2451545 + 0:365)
 //' @rdname Section15
 //' @export
 // [[Rcpp::export(swe_sidtime)]]
-double sidtime(double jd_ut) {
-  return swe_sidtime(jd_ut);
+Rcpp::NumericVector sidtime(Rcpp::NumericVector jd_ut) {
+  Rcpp::NumericVector tsid(jd_ut.length());
+  std::vector<int> order = epoch_order(jd_ut);
+  // swe_sidtime() takes TT with the default Delta T
+  std::vector<double> tt(jd_ut.begin(), jd_ut.end());
+  for (double &t : tt)
+    t += swe_deltat_ex(t, -1, NULL);
+  swe_set_uniform_grid(uniform_step(tt, order));
+  for (int i : order)
+    tsid(i) = swe_sidtime(jd_ut[i]);
+  swe_set_uniform_grid(0);
+  return tsid;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1470,3 +2143,16 @@ Rcpp::IntegerVector day_of_week(Rcpp::NumericVector jd) {
   std::transform(jd.begin(), jd.end(), result.begin(), swe_day_of_week);
   return result;
 }
+
+//' @details
+//' \describe{
+//'   \item{swe_set_interpolate_nut()}{Interpolate the nutation from values one day apart
+//'   instead of computing it for every date (faster, less precise by about 3 mas).}
+//' }
+//' @param do_interpolate  interpolate the nutation as logical
+//' @rdname Section16
+//' @export
+// [[Rcpp::export(swe_set_interpolate_nut)]]
+void set_interpolate_nut(bool do_interpolate) {
+  swe_set_interpolate_nut(do_interpolate ? TRUE : FALSE);
+}